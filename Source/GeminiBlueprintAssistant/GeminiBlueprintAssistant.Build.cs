@@ -57,7 +57,11 @@ public class GeminiBlueprintAssistant : ModuleRules
                 "Kismet",
                 "GraphEditor",
                 "UnrealEd",
-                "ApplicationCore"
+                "ApplicationCore",
+                "Sockets",
+                "Networking",
+                "SQLiteCore",
+                "Projects"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
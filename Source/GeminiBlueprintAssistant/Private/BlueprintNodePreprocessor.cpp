@@ -1,5 +1,6 @@
 // BlueprintNodePreprocessor.cpp
 #include "BlueprintNodePreprocessor.h"
+#include "GeminiAssistantTrace.h"
 #include "Kismet2/BlueprintEditorUtils.h"
 #include "EdGraph/EdGraphPin.h"
 #include "Engine/MemberReference.h"
@@ -23,6 +24,8 @@ FBlueprintNodePreprocessor::~FBlueprintNodePreprocessor()
 
 FString FBlueprintNodePreprocessor::PreprocessNodes(const TArray<UK2Node*>& Nodes)
 {
+    GEMINI_STAGE_SCOPE("Gemini.PreprocessNodes", STAT_GeminiPreprocessNodes);
+
     TArray<FProcessedNodeData> ProcessedNodes;
 
     for (UK2Node* Node : Nodes)
@@ -477,40 +480,43 @@ FString FBlueprintNodePreprocessor::FormatOutput(const TArray<FProcessedNodeData
 
     for (int32 i = 0; i < ProcessedNodes.Num(); i++)
     {
-        const FProcessedNodeData& NodeData = ProcessedNodes[i];
-
-        FString Line = FString::Printf(TEXT("%d. %s"), i + 1, *NodeData.NodeType);
-
-        if (!NodeData.DisplayName.IsEmpty())
+        Output += FString::Printf(TEXT("%d. %s"), i + 1, *FormatNodeLine(ProcessedNodes[i]));
+        if (i < ProcessedNodes.Num() - 1)
         {
-            Line += FString::Printf(TEXT(": %s"), *NodeData.DisplayName);
+            Output += TEXT("\n");
         }
+    }
 
-        // Add parameters if any
-        if (NodeData.Parameters.Num() > 0)
-        {
-            TArray<FString> ParamStrings;
-            for (const auto& Param : NodeData.Parameters)
-            {
-                ParamStrings.Add(FString::Printf(TEXT("%s=%s"), *Param.Key, *Param.Value));
-            }
-            Line += FString::Printf(TEXT("(%s)"), *FString::Join(ParamStrings, TEXT(", ")));
-        }
+    return Output;
+}
 
-        // Add comment if exists
-        if (!NodeData.Comment.IsEmpty())
-        {
-            Line += FString::Printf(TEXT(" // %s"), *NodeData.Comment);
-        }
+FString FBlueprintNodePreprocessor::FormatNodeLine(const FProcessedNodeData& NodeData) const
+{
+    FString Line = NodeData.NodeType;
 
-        Output += Line;
-        if (i < ProcessedNodes.Num() - 1)
+    if (!NodeData.DisplayName.IsEmpty())
+    {
+        Line += FString::Printf(TEXT(": %s"), *NodeData.DisplayName);
+    }
+
+    // Add parameters if any
+    if (NodeData.Parameters.Num() > 0)
+    {
+        TArray<FString> ParamStrings;
+        for (const auto& Param : NodeData.Parameters)
         {
-            Output += TEXT("\n");
+            ParamStrings.Add(FString::Printf(TEXT("%s=%s"), *Param.Key, *Param.Value));
         }
+        Line += FString::Printf(TEXT("(%s)"), *FString::Join(ParamStrings, TEXT(", ")));
     }
 
-    return Output;
+    // Add comment if exists
+    if (!NodeData.Comment.IsEmpty())
+    {
+        Line += FString::Printf(TEXT(" // %s"), *NodeData.Comment);
+    }
+
+    return Line;
 }
 
 FString FBlueprintNodePreprocessor::SanitizeString(const FString& Input)
@@ -553,6 +559,6 @@ void YourPluginFunction()
     FString CleanText = Preprocessor.PreprocessNodes(Nodes);
 
     // Use CleanText for your LLM summarization
-    UE_LOG(LogTemp, Warning, TEXT("Preprocessed Blueprint: %s"), *CleanText);
+    UE_LOG(LogGeminiAssistant, Warning, TEXT("Preprocessed Blueprint: %s"), *CleanText);
 }
 */
\ No newline at end of file
@@ -1,152 +1,1929 @@
 // Private/GeminiAPIClient.cpp
 #include "GeminiAPIClient.h"
+#include "GeminiSSEParser.h"
+#include "GeminiAssistantTrace.h"
+#include "GeminiTimingLog.h"
+#include "GeminiResponseParser.h"
+#include "GeminiJsonReader.h"
+#include "GeminiJsonWriter.h"
+#include "GeminiModelRouter.h"
+#include "GeminiBackend.h"
+#include "GeminiUsageTracker.h"
 #include "HttpModule.h"
 #include "Interfaces/IHttpResponse.h"
-#include "Serialization/JsonSerializer.h"
-#include "Dom/JsonObject.h"
+#include "Serialization/Archive.h"
 #include "Templates/SharedPointer.h"
+#include "Async/Async.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Compression.h"
+#include "Misc/ScopeExit.h"
+#include "Hash/CityHash.h"
 
 #define LOCTEXT_NAMESPACE "FGeminiAPIClient"
 
+// Raw response bodies; off by default, enable with "Log LogGeminiRaw Verbose"
+DEFINE_LOG_CATEGORY_STATIC(LogGeminiRaw, Warning, All);
+
+/**
+ * Shared state of one streamed request. Bytes may arrive on the HTTP thread, so everything is guarded.
+ */
+class FGeminiStreamState : public TSharedFromThis<FGeminiStreamState, ESPMode::ThreadSafe>
+{
+public:
+	explicit FGeminiStreamState(TSharedRef<const IGeminiBackend, ESPMode::ThreadSafe> InBackend)
+		: StartTime(FPlatformTime::Seconds())
+		, bFirstChunkLogged(false)
+		, bCompleted(false)
+		, ContentReadOffset(0)
+		, Backend(MoveTemp(InBackend))
+	{
+	}
+
+	// Feeds raw response bytes through the SSE parser and returns the text contained in completed events
+	FString ReceiveBytes(const uint8* Data, int64 Num)
+	{
+		FScopeLock Lock(&CriticalSection);
+		RawBytes.Append(Data, static_cast<int32>(Num));
+
+		TArray<TArray<uint8>> Events;
+		Parser.Feed(Data, Num, Events);
+		return ConsumeEvents(Events);
+	}
+
+	// Feeds whatever part of a (partial) response body has not been seen yet
+	FString ReceiveContent(const TArray<uint8>& Content)
+	{
+		if (Content.Num() <= ContentReadOffset)
+		{
+			return FString();
+		}
+		const int32 Offset = ContentReadOffset;
+		ContentReadOffset = Content.Num();
+		return ReceiveBytes(Content.GetData() + Offset, Content.Num() - Offset);
+	}
+
+	// Flushes the parser at end of stream and marks the stream as complete so late chunks are dropped
+	void Complete()
+	{
+		FScopeLock Lock(&CriticalSection);
+		TArray<TArray<uint8>> Events;
+		Parser.Finish(Events);
+		ConsumeEvents(Events);
+		bCompleted = true;
+	}
+
+	bool IsCompleted() const
+	{
+		FScopeLock Lock(&CriticalSection);
+		return bCompleted;
+	}
+
+	FString GetAccumulatedText() const
+	{
+		FScopeLock Lock(&CriticalSection);
+		return AccumulatedText;
+	}
+
+	FString GetStreamError() const
+	{
+		FScopeLock Lock(&CriticalSection);
+		return StreamError;
+	}
+
+	FGeminiTokenUsage GetUsage() const
+	{
+		FScopeLock Lock(&CriticalSection);
+		return Usage;
+	}
+
+	FString GetFinishReason() const
+	{
+		FScopeLock Lock(&CriticalSection);
+		return FinishReason;
+	}
+
+	TArray<uint8> GetRawBytes() const
+	{
+		FScopeLock Lock(&CriticalSection);
+		return RawBytes;
+	}
+
+	FString GetRawBodyAsString() const
+	{
+		FScopeLock Lock(&CriticalSection);
+		FString RawBody;
+		FGeminiJsonReader::AppendUtf8(RawBody, RawBytes.GetData(), RawBytes.Num());
+		return RawBody;
+	}
+
+	// Parses the whole body as one response, used when the server answered with an error instead of events
+	void ParseRawBody(FGeminiParsedResponse& OutResponse) const
+	{
+		FScopeLock Lock(&CriticalSection);
+		Backend->ParseResponse(RawBytes.GetData(), RawBytes.Num(), OutResponse);
+	}
+
+	// Time the request was sent, used to report time-to-first-text
+	double StartTime;
+	bool bFirstChunkLogged;
+
+private:
+	FString ConsumeEvents(const TArray<TArray<uint8>>& Events)
+	{
+		FString NewText;
+		for (const TArray<uint8>& Event : Events)
+		{
+			FGeminiParsedResponse Chunk;
+			const bool bHasText = Backend->ParseStreamEvent(Event.GetData(), Event.Num(), Chunk);
+			if (Chunk.Usage.IsSet())
+			{
+				Usage = Chunk.Usage;
+			}
+			// Only the last event of a stream carries it
+			if (!Chunk.FinishReason.IsEmpty())
+			{
+				FinishReason = Chunk.FinishReason;
+			}
+			if (bHasText)
+			{
+				NewText += Chunk.Text;
+			}
+			else if (!Chunk.ErrorMessage.IsEmpty())
+			{
+				StreamError = Chunk.ErrorMessage;
+			}
+		}
+		AccumulatedText += NewText;
+		return NewText;
+	}
+
+	mutable FCriticalSection CriticalSection;
+	FGeminiSSEParser Parser;
+	TArray<uint8> RawBytes;
+	FString AccumulatedText;
+	FString StreamError;
+	FString FinishReason;
+	FGeminiTokenUsage Usage;
+	bool bCompleted;
+	int32 ContentReadOffset;
+
+	// Wire format of the events; parsing runs on the HTTP thread, which is fine as backends are immutable
+	TSharedRef<const IGeminiBackend, ESPMode::ThreadSafe> Backend;
+};
+
+/**
+ * Archive handed to the HTTP module as response body sink; forwards every received slice of bytes.
+ */
+class FGeminiStreamArchive : public FArchive
+{
+public:
+	explicit FGeminiStreamArchive(TFunction<void(const uint8*, int64)> InOnBytes)
+		: OnBytes(MoveTemp(InOnBytes))
+	{
+		SetIsSaving(true);
+	}
+
+	virtual void Serialize(void* Data, int64 Num) override
+	{
+		if (Data && Num > 0)
+		{
+			OnBytes(static_cast<const uint8*>(Data), Num);
+		}
+	}
+
+	virtual FString GetArchiveName() const override
+	{
+		return TEXT("FGeminiStreamArchive");
+	}
+
+private:
+	TFunction<void(const uint8*, int64)> OnBytes;
+};
+
+/**
+ * A later caller that asked for exactly what a pending request asks and shares its answer.
+ */
+struct FGeminiRequestWaiter
+{
+	FGeminiRequestHandle Handle;
+	FGeminiResponseDelegate OnComplete;
+	FGeminiChunkDelegate OnChunk;
+	FString SupersessionKey;
+	// Joined after text was streamed; gets everything so far with the next chunk
+	bool bNeedsStreamedText = false;
+};
+
+/**
+ * Book-keeping for one submitted request, from queueing until its callback has fired.
+ */
+struct FGeminiPendingRequest
+{
+	FGeminiRequestHandle Handle;
+	uint64 Sequence = 0;
+	FString Prompt;
+	FString APIKey;
+	// Name of the cached content the prompt refers to, and the context to send inline instead if the cache is gone
+	FString CachedContent;
+	FString InlineContext;
+	FGeminiRequestOptions Options;
+	FGeminiResponseDelegate OnComplete;
+	FGeminiChunkDelegate OnChunk;
+	bool bStream = false;
+	bool bChunksDelivered = false;
+	// Content hash under which identical requests attach to this one, and the callers that did
+	FString CoalescingKey;
+	TArray<FGeminiRequestWaiter> Waiters;
+	// Text streamed so far, kept for callers joining mid-stream
+	FString StreamedText;
+	// The submitting caller cancelled, the request only goes on for its waiters
+	bool bCallerCancelled = false;
+	double QueuedTime = 0.0;
+	int32 EstimatedTokens = 0;
+	int32 Attempt = 0;
+	// The answer hit the output token cap once and was asked for again with a larger one
+	bool bRaisedOutputCap = false;
+	double RetryTime = 0.0;
+	double Deadline = 0.0;
+	// Start of the current wait for a slot (submission or the last failure) and of the current HTTP attempt
+	double WaitStartTime = 0.0;
+	double SentTime = 0.0;
+	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> HttpRequest;
+	TSharedPtr<FGeminiStreamState, ESPMode::ThreadSafe> Stream;
+	// Hash of the request while fixtures are in use, and the body it was taken of while recording
+	FString FixtureKey;
+	TArray<uint8> FixtureRequestBody;
+	// Body of a resent recorded request, sent instead of one written from the prompt
+	TArray<uint8> RecordedBody;
+};
+
+/**
+ * Progress of one GenerateContentBatch call, shared by the requests it was split into.
+ */
+struct FGeminiBatchRun
+{
+	TArray<FGeminiBatchTask> Tasks;
+	TArray<FGeminiBatchTaskResult> Results;
+	int32 NumPendingRequests = 0;
+	FGeminiBatchDelegate OnComplete;
+};
+
+/**
+ * Outcome of one HTTP attempt. Plain responses are parsed into it on a worker thread, so only the
+ * extracted text travels back to the game thread.
+ */
+struct FGeminiRequestResult
+{
+	bool bConnectedSuccessfully = false;
+	int32 ResponseCode = 0;
+	bool bSuccess = false;
+	FString Content;
+	FString ErrorMessage = TEXT("Unknown error.");
+	FString ErrorBody;
+	FString RetryAfterHeader;
+	double ParseSeconds = 0.0;
+	FGeminiTokenUsage Usage;
+	// Why generation stopped, e.g. STOP or MAX_TOKENS (LENGTH on OpenAI servers)
+	FString FinishReason;
+};
+
+// Heap order of the request queue: higher priority first, then first come first served
+struct FGeminiRequestQueueOrder
+{
+	bool operator()(const TSharedRef<FGeminiPendingRequest>& A, const TSharedRef<FGeminiPendingRequest>& B) const
+	{
+		if (A->Options.Priority != B->Options.Priority)
+		{
+			return A->Options.Priority > B->Options.Priority;
+		}
+		return A->Sequence < B->Sequence;
+	}
+};
+
+namespace GeminiAPIClient
+{
+	static const int32 DefaultMaxConcurrentRequests = 4;
+	static const int32 DefaultMaxRetries = 4;
+	static const double DefaultTimeout = 120.0;
+	static const double DefaultRetryBaseDelay = 1.0;
+	static const double DefaultRetryMaxDelay = 60.0;
+	static const int32 DefaultRawLogMaxBytes = 2048;
+	static const int32 DefaultCompressRequestsAboveBytes = 0;
+	static const int32 DefaultMaxTasksPerBatchRequest = 16;
+	static const int32 DefaultMaxBatchRequestChars = 400000;
+	static const double DefaultBatchJobPollInterval = 30.0;
+	static const double DefaultContextCacheTTL = 600.0;
+	static const int32 DefaultMaxRaisedOutputTokens = 8192;
+
+	// Below this size a context is sent inline; Gemini rejects cached content under its minimum token count anyway
+	static const int32 DefaultMinCachedContextChars = 8000;
+
+	// Shortest wait before polling the rate limiter again
+	static const double MinPumpDelay = 0.05;
+
+	// Tokens charged to the rate limiter for a request; the answer is not known yet, so only what is sent counts
+	static int32 EstimateRequestTokens(const FGeminiPendingRequest& PendingRequest)
+	{
+		int32 Tokens = FGeminiTokenEstimator::EstimateTokens(PendingRequest.Prompt) + 1;
+		for (const FGeminiChatTurn& Turn : PendingRequest.Options.History)
+		{
+			Tokens += FGeminiTokenEstimator::EstimateTokens(Turn.Text);
+		}
+		return Tokens;
+	}
+
+	// Identifies what a request asks, so identical requests can share one answer; a streaming request only shares the
+	// answer of another that streams, the one leader whose chunks it can be given
+	static FString MakeCoalescingKey(const FGeminiPendingRequest& PendingRequest, const FString& DefaultModel)
+	{
+		uint64 Hash = 0;
+		auto Mix = [&Hash](const FString& Text)
+		{
+			Hash = CityHash64WithSeed(reinterpret_cast<const char*>(*Text), Text.Len() * sizeof(TCHAR), Hash);
+		};
+
+		const FGeminiGenerationConfig& Config = PendingRequest.Options.GenerationConfig;
+		Mix(PendingRequest.Options.Model.IsEmpty() ? DefaultModel : PendingRequest.Options.Model);
+		Mix(PendingRequest.bStream ? TEXT("stream") : TEXT("generate"));
+		Mix(PendingRequest.APIKey);
+		Mix(PendingRequest.CachedContent);
+		Mix(PendingRequest.InlineContext);
+		Mix(FString::Printf(TEXT("%d|%d|%g|%s"), Config.MaxOutputTokens, Config.ThinkingBudget, Config.Temperature, *Config.ResponseMimeType));
+		Mix(Config.ResponseSchema);
+		for (const FGeminiChatTurn& Turn : PendingRequest.Options.History)
+		{
+			Mix(Turn.bFromModel ? TEXT("model") : TEXT("user"));
+			Mix(Turn.Text);
+		}
+		Mix(PendingRequest.Prompt);
+		return FString::Printf(TEXT("%016llx"), Hash);
+	}
+
+	// The answer stopped at the output token cap rather than where the model meant to end it
+	static bool IsTruncated(const FString& FinishReason)
+	{
+		return FinishReason == TEXT("MAX_TOKENS") || FinishReason == TEXT("LENGTH");
+	}
+
+	// Puts the context of a request without usable cache entry in front of the conversation
+	static void MoveContextInline(FGeminiPendingRequest& PendingRequest)
+	{
+		if (PendingRequest.InlineContext.IsEmpty())
+		{
+			return;
+		}
+		FString& FirstMessage = PendingRequest.Options.History.Num() > 0 ? PendingRequest.Options.History[0].Text : PendingRequest.Prompt;
+		FirstMessage = PendingRequest.InlineContext + TEXT("\n\n") + FirstMessage;
+		PendingRequest.InlineContext.Empty();
+	}
+}
+
 FGeminiAPIClient::FGeminiAPIClient()
+	: Backend(IGeminiBackend::CreateFromConfig())
+	, ContextCache(MakeShared<FGeminiContextCache>())
+	, bUseContextCache(true)
+	, bCoalesceRequests(true)
+	, FixtureMode(EGeminiFixtureMode::Off)
+	, bReplayWithLatency(false)
+	, ScheduledPumpTime(0.0)
+	, APIBaseURL(Backend->GetDefaultBaseURL())
+	, ModelName(Backend->GetDefaultModel())
+	, MaxConcurrentRequests(GeminiAPIClient::DefaultMaxConcurrentRequests)
+	, MaxRetries(GeminiAPIClient::DefaultMaxRetries)
+	, DefaultTimeout(GeminiAPIClient::DefaultTimeout)
+	, RetryBaseDelay(GeminiAPIClient::DefaultRetryBaseDelay)
+	, RetryMaxDelay(GeminiAPIClient::DefaultRetryMaxDelay)
+	, RawLogMaxBytes(GeminiAPIClient::DefaultRawLogMaxBytes)
+	, CompressRequestsAboveBytes(GeminiAPIClient::DefaultCompressRequestsAboveBytes)
+	, MaxTasksPerBatchRequest(GeminiAPIClient::DefaultMaxTasksPerBatchRequest)
+	, MaxBatchRequestChars(GeminiAPIClient::DefaultMaxBatchRequestChars)
+	, BatchJobPollInterval(GeminiAPIClient::DefaultBatchJobPollInterval)
+	, MaxRaisedOutputTokens(GeminiAPIClient::DefaultMaxRaisedOutputTokens)
+	, NextRequestId(1)
+	, NextSequence(0)
 {
-	
+	int32 RequestsPerMinute = 0;
+	int32 TokensPerMinute = 0;
+	double ContextCacheTTL = GeminiAPIClient::DefaultContextCacheTTL;
+	int32 MinCachedContextChars = GeminiAPIClient::DefaultMinCachedContextChars;
+	if (GConfig)
+	{
+		GConfig->GetString(TEXT("GeminiAssistant"), TEXT("APIBaseURL"), APIBaseURL, GEditorPerProjectIni);
+		GConfig->GetString(TEXT("GeminiAssistant"), TEXT("Model"), ModelName, GEditorPerProjectIni);
+		int32 ConfiguredMaxConcurrentRequests = 0;
+		if (GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("MaxConcurrentRequests"), ConfiguredMaxConcurrentRequests, GEditorPerProjectIni))
+		{
+			MaxConcurrentRequests = FMath::Max(1, ConfiguredMaxConcurrentRequests);
+		}
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("RequestsPerMinute"), RequestsPerMinute, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("TokensPerMinute"), TokensPerMinute, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("MaxRetries"), MaxRetries, GEditorPerProjectIni);
+		GConfig->GetDouble(TEXT("GeminiAssistant"), TEXT("RequestTimeoutSeconds"), DefaultTimeout, GEditorPerProjectIni);
+		GConfig->GetDouble(TEXT("GeminiAssistant"), TEXT("RetryBaseDelaySeconds"), RetryBaseDelay, GEditorPerProjectIni);
+		GConfig->GetDouble(TEXT("GeminiAssistant"), TEXT("RetryMaxDelaySeconds"), RetryMaxDelay, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("RawLogMaxBytes"), RawLogMaxBytes, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("CompressRequestsAboveBytes"), CompressRequestsAboveBytes, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("MaxTasksPerBatchRequest"), MaxTasksPerBatchRequest, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("MaxBatchRequestChars"), MaxBatchRequestChars, GEditorPerProjectIni);
+		GConfig->GetDouble(TEXT("GeminiAssistant"), TEXT("BatchJobPollIntervalSeconds"), BatchJobPollInterval, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("MaxRaisedOutputTokens"), MaxRaisedOutputTokens, GEditorPerProjectIni);
+		GConfig->GetBool(TEXT("GeminiAssistant"), TEXT("bUseContextCache"), bUseContextCache, GEditorPerProjectIni);
+		GConfig->GetDouble(TEXT("GeminiAssistant"), TEXT("ContextCacheTTLSeconds"), ContextCacheTTL, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("MinCachedContextChars"), MinCachedContextChars, GEditorPerProjectIni);
+		GConfig->GetBool(TEXT("GeminiAssistant"), TEXT("bCoalesceRequests"), bCoalesceRequests, GEditorPerProjectIni);
+
+		FString ConfiguredFixtureMode;
+		if (GConfig->GetString(TEXT("GeminiAssistant"), TEXT("FixtureMode"), ConfiguredFixtureMode, GEditorPerProjectIni))
+		{
+			FString FixtureDir = FGeminiFixtureStore::GetDefaultDirectory();
+			GConfig->GetString(TEXT("GeminiAssistant"), TEXT("FixtureDir"), FixtureDir, GEditorPerProjectIni);
+			bool bConfiguredReplayWithLatency = false;
+			GConfig->GetBool(TEXT("GeminiAssistant"), TEXT("bReplayWithLatency"), bConfiguredReplayWithLatency, GEditorPerProjectIni);
+			SetFixtureMode(FGeminiFixtureStore::ParseMode(ConfiguredFixtureMode), FixtureDir, bConfiguredReplayWithLatency);
+		}
+	}
+	APIBaseURL.RemoveFromEnd(TEXT("/"));
+
+	// The server decides how much it can take; settings can only ask for less
+	const FGeminiBackendLimits& Limits = Backend->GetLimits();
+	if (Limits.MaxConcurrentRequests > 0)
+	{
+		MaxConcurrentRequests = FMath::Min(MaxConcurrentRequests, Limits.MaxConcurrentRequests);
+	}
+	// A packed batch prompt has to fit the context window with room left for the answers (about 3 characters per token)
+	MaxBatchRequestChars = FMath::Min(MaxBatchRequestChars, static_cast<int32>(FMath::Min<int64>(static_cast<int64>(Limits.MaxContextTokens) * 3 / 2, MAX_int32)));
+	bUseContextCache = bUseContextCache && Limits.bSupportsContextCache;
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAPIClient: Using the %s backend at %s (%d requests at once, %d context tokens)"),
+		Backend->GetName(), *APIBaseURL, MaxConcurrentRequests, Limits.MaxContextTokens);
+
+	RateLimiter.Configure(RequestsPerMinute, TokensPerMinute);
+	ContextCache->Configure(APIBaseURL, ModelName, ContextCacheTTL, MinCachedContextChars);
+}
+
+FGeminiAPIClient::~FGeminiAPIClient()
+{
+	if (PumpTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(PumpTickerHandle);
+	}
+
+	// Callbacks are bound to the client by weak pointer, so in-flight requests can simply be abandoned
+	for (const TPair<uint64, TSharedRef<FGeminiPendingRequest>>& Pair : ActiveRequests)
+	{
+		if (Pair.Value->HttpRequest.IsValid())
+		{
+			Pair.Value->HttpRequest->OnProcessRequestComplete().Unbind();
+			Pair.Value->HttpRequest->CancelRequest();
+		}
+	}
+}
+
+FString FGeminiAPIClient::GetModelURL(const FString& InModelName) const
+{
+	return FString::Printf(TEXT("%s/models/%s"), *APIBaseURL, InModelName.IsEmpty() ? *ModelName : *InModelName);
+}
+
+const FGeminiBackendLimits& FGeminiAPIClient::GetBackendLimits() const
+{
+	return Backend->GetLimits();
+}
+
+void FGeminiAPIClient::SetEndpoint(const FString& InAPIBaseURL, const FString& InModelName)
+{
+	APIBaseURL = InAPIBaseURL;
+	APIBaseURL.RemoveFromEnd(TEXT("/"));
+	ModelName = InModelName;
+	ContextCache->SetEndpoint(APIBaseURL, ModelName);
+}
+
+void FGeminiAPIClient::SetUseContextCache(bool bInUseContextCache)
+{
+	bUseContextCache = bInUseContextCache && Backend->GetLimits().bSupportsContextCache;
+}
+
+void FGeminiAPIClient::SetFixtureMode(EGeminiFixtureMode InMode, const FString& Directory, bool bInReplayWithLatency)
+{
+	FixtureMode = InMode;
+	bReplayWithLatency = bInReplayWithLatency;
+	Fixtures.Reset();
+	if (FixtureMode != EGeminiFixtureMode::Off)
+	{
+		Fixtures = MakeShared<FGeminiFixtureStore>(Directory.IsEmpty() ? FGeminiFixtureStore::GetDefaultDirectory() : Directory);
+		UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAPIClient: Fixture mode %s, fixtures in %s"), FGeminiFixtureStore::GetModeName(FixtureMode), *Fixtures->GetDirectory());
+	}
+}
+
+void FGeminiAPIClient::SetRateLimits(int32 RequestsPerMinute, int32 TokensPerMinute)
+{
+	RateLimiter.Configure(RequestsPerMinute, TokensPerMinute);
+	PumpQueue();
+}
+
+TSharedRef<IHttpRequest, ESPMode::ThreadSafe> FGeminiAPIClient::CreateGenerateRequest(const FString& Url, const FGeminiPendingRequest& PendingRequest) const
+{
+	GEMINI_STAGE_SCOPE("Gemini.SerializeRequest", STAT_GeminiSerializeRequest);
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(Url);
+	Request->SetVerb(TEXT("POST"));
+	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	// Ask to keep the connection open so queued requests reuse it instead of paying for a new TLS handshake
+	Request->SetHeader(TEXT("Connection"), TEXT("keep-alive"));
+
+	Backend->SetRequestHeaders(*Request, PendingRequest.APIKey);
+
+	TArray<uint8> Body;
+	if (PendingRequest.FixtureRequestBody.Num() > 0)
+	{
+		Body = PendingRequest.FixtureRequestBody;
+	}
+	else
+	{
+		WriteRequestBody(PendingRequest, Body);
+	}
+
+	// Large graph dumps compress well; only worth the CPU time above the configured size
+	TArray<uint8> CompressedBody;
+	if (CompressRequestsAboveBytes > 0 && Body.Num() >= CompressRequestsAboveBytes && CompressBody(Body, CompressedBody))
+	{
+		Request->SetHeader(TEXT("Content-Encoding"), TEXT("gzip"));
+		Body = MoveTemp(CompressedBody);
+	}
+
+	Request->SetContent(MoveTemp(Body));
+	return Request;
+}
+
+void FGeminiAPIClient::WriteRequestBody(const FGeminiPendingRequest& PendingRequest, TArray<uint8>& OutBody) const
+{
+	if (PendingRequest.RecordedBody.Num() > 0)
+	{
+		OutBody = PendingRequest.RecordedBody;
+		return;
+	}
+
+	OutBody.Reset();
+	FGeminiJsonWriter Writer(OutBody);
+	const FString& Model = PendingRequest.Options.Model.IsEmpty() ? ModelName : PendingRequest.Options.Model;
+	Backend->WriteRequestBody(Writer, FGeminiBackendPrompt{ Model, PendingRequest.Prompt, PendingRequest.CachedContent,
+		PendingRequest.Options.GenerationConfig, PendingRequest.Options.History, PendingRequest.bStream });
+}
+
+void FGeminiAPIClient::WriteGenerateContentBody(const FString& InPrompt, TArray<uint8>& OutBody, const FString& CachedContent, const FGeminiGenerationConfig& GenerationConfig,
+	TArrayView<const FGeminiChatTurn> History)
+{
+	OutBody.Reset();
+	FGeminiJsonWriter Writer(OutBody);
+	WriteGenerateContentRequest(Writer, InPrompt, CachedContent, GenerationConfig, History);
+}
+
+void FGeminiAPIClient::WriteGenerateContentRequest(FGeminiJsonWriter& Writer, const FString& InPrompt, const FString& CachedContent, const FGeminiGenerationConfig& GenerationConfig,
+	TArrayView<const FGeminiChatTurn> History)
+{
+	// {"cachedContent":"cachedContents/...","contents":[{"role":"user","parts":[{"text":"..."}]},{"role":"model",...},...]}
+	Writer.BeginObject();
+	if (!CachedContent.IsEmpty())
+	{
+		// The cached context acts as the start of the conversation, the prompt is only the question
+		Writer.WriteStringField("cachedContent", CachedContent);
+	}
+	Writer.WriteKey("contents");
+	Writer.BeginArray();
+	for (const FGeminiChatTurn& Turn : History)
+	{
+		Writer.BeginObject();
+		Writer.WriteStringField("role", Turn.bFromModel ? TEXT("model") : TEXT("user"));
+		Writer.WriteKey("parts");
+		Writer.BeginArray();
+		Writer.BeginObject();
+		Writer.WriteStringField("text", Turn.Text);
+		Writer.EndObject();
+		Writer.EndArray();
+		Writer.EndObject();
+	}
+	Writer.BeginObject();
+	if (History.Num() > 0)
+	{
+		Writer.WriteStringField("role", TEXT("user"));
+	}
+	Writer.WriteKey("parts");
+	Writer.BeginArray();
+	Writer.BeginObject();
+	Writer.WriteStringField("text", InPrompt);
+	Writer.EndObject();
+	Writer.EndArray();
+	Writer.EndObject();
+	Writer.EndArray();
+
+	// "generationConfig":{"maxOutputTokens":N,"temperature":T,"responseMimeType":M,"responseSchema":{...},"thinkingConfig":{"thinkingBudget":B}}
+	if (GenerationConfig.IsSet())
+	{
+		Writer.WriteKey("generationConfig");
+		Writer.BeginObject();
+		if (GenerationConfig.MaxOutputTokens > 0)
+		{
+			Writer.WriteIntegerField("maxOutputTokens", GenerationConfig.MaxOutputTokens);
+		}
+		if (GenerationConfig.Temperature >= 0.0f)
+		{
+			Writer.WriteNumberField("temperature", GenerationConfig.Temperature);
+		}
+		if (!GenerationConfig.ResponseMimeType.IsEmpty())
+		{
+			Writer.WriteStringField("responseMimeType", GenerationConfig.ResponseMimeType);
+			if (!GenerationConfig.ResponseSchema.IsEmpty())
+			{
+				// The schema is kept as JSON text and copied into the body as it is
+				FTCHARToUTF8 SchemaUtf8(*GenerationConfig.ResponseSchema, GenerationConfig.ResponseSchema.Len());
+				Writer.WriteKey("responseSchema");
+				Writer.WriteRawValue(reinterpret_cast<const uint8*>(SchemaUtf8.Get()), SchemaUtf8.Length());
+			}
+		}
+		if (GenerationConfig.ThinkingBudget >= 0)
+		{
+			Writer.WriteKey("thinkingConfig");
+			Writer.BeginObject();
+			Writer.WriteIntegerField("thinkingBudget", GenerationConfig.ThinkingBudget);
+			Writer.EndObject();
+		}
+		Writer.EndObject();
+	}
+
+	Writer.EndObject();
+}
+
+bool FGeminiAPIClient::CompressBody(const TArray<uint8>& Body, TArray<uint8>& OutCompressed)
+{
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Gzip, Body.Num());
+	OutCompressed.SetNumUninitialized(CompressedSize);
+	if (!FCompression::CompressMemory(NAME_Gzip, OutCompressed.GetData(), CompressedSize, Body.GetData(), Body.Num()) || CompressedSize >= Body.Num())
+	{
+		OutCompressed.Reset();
+		return false;
+	}
+	OutCompressed.SetNum(CompressedSize);
+	return true;
+}
+
+FGeminiRequestHandle FGeminiAPIClient::GenerateContent(const FString& InPrompt, const FString& APIKey, FGeminiResponseDelegate OnComplete, const FGeminiRequestOptions& Options)
+{
+	TSharedRef<FGeminiPendingRequest> PendingRequest = MakeShared<FGeminiPendingRequest>();
+	PendingRequest->Prompt = InPrompt;
+	PendingRequest->APIKey = APIKey;
+	PendingRequest->Options = Options;
+	PendingRequest->OnComplete = MoveTemp(OnComplete);
+	return EnqueueRequest(PendingRequest);
+}
+
+FGeminiRequestHandle FGeminiAPIClient::GenerateContentStream(const FString& InPrompt, const FString& APIKey, FGeminiChunkDelegate OnChunk, FGeminiResponseDelegate OnComplete, const FGeminiRequestOptions& Options)
+{
+	TSharedRef<FGeminiPendingRequest> PendingRequest = MakeShared<FGeminiPendingRequest>();
+	PendingRequest->Prompt = InPrompt;
+	PendingRequest->APIKey = APIKey;
+	PendingRequest->Options = Options;
+	PendingRequest->OnComplete = MoveTemp(OnComplete);
+	PendingRequest->OnChunk = MoveTemp(OnChunk);
+	PendingRequest->bStream = true;
+	return EnqueueRequest(PendingRequest);
+}
+
+FGeminiRequestHandle FGeminiAPIClient::ResendRecordedRequest(const FGeminiFixture& Fixture, const FString& APIKey, FGeminiChunkDelegate OnChunk, FGeminiResponseDelegate OnComplete)
+{
+	if (Fixture.Backend != Backend->GetName() || Fixture.RequestBody.Num() == 0)
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiAPIClient: Cannot resend fixture %s, recorded for the %s backend"), *Fixture.Key, *Fixture.Backend);
+		return FGeminiRequestHandle();
+	}
+
+	// The body stands in for the prompt where requests are estimated and compared
+	FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Fixture.RequestBody.GetData()), Fixture.RequestBody.Num());
+	TSharedRef<FGeminiPendingRequest> PendingRequest = MakeShared<FGeminiPendingRequest>();
+	PendingRequest->Prompt = FString(Converter.Length(), Converter.Get());
+	PendingRequest->RecordedBody = Fixture.RequestBody;
+	PendingRequest->APIKey = APIKey;
+	PendingRequest->Options.Model = Fixture.Model;
+	PendingRequest->OnComplete = MoveTemp(OnComplete);
+	PendingRequest->OnChunk = MoveTemp(OnChunk);
+	PendingRequest->bStream = Fixture.bStream;
+	return EnqueueRequest(PendingRequest);
+}
+
+FGeminiRequestHandle FGeminiAPIClient::GenerateContentWithContext(const FString& ContextKey, const FString& Context, const FString& Question, const FString& APIKey,
+	FGeminiChunkDelegate OnChunk, FGeminiResponseDelegate OnComplete, const FGeminiRequestOptions& Options)
+{
+	check(IsInGameThread());
+
+	TSharedRef<FGeminiPendingRequest> PendingRequest = MakeShared<FGeminiPendingRequest>();
+	PendingRequest->Prompt = Question;
+	PendingRequest->InlineContext = Context;
+	PendingRequest->APIKey = APIKey;
+	PendingRequest->Options = Options;
+	PendingRequest->OnComplete = MoveTemp(OnComplete);
+	PendingRequest->OnChunk = MoveTemp(OnChunk);
+	PendingRequest->bStream = PendingRequest->OnChunk.IsBound();
+
+	if (!bUseContextCache || FixtureMode != EGeminiFixtureMode::Off || Context.IsEmpty() || Question.IsEmpty() || (APIKey.IsEmpty() && Backend->GetLimits().bRequiresAPIKey))
+	{
+		GeminiAPIClient::MoveContextInline(*PendingRequest);
+		return EnqueueRequest(PendingRequest);
+	}
+
+	CancelRequestsWithKey(Options.SupersessionKey);
+
+	// The handle exists from the start so the caller can cancel while the context is still being uploaded
+	PendingRequest->Handle = FGeminiRequestHandle(NextRequestId++);
+	PendingRequest->QueuedTime = FPlatformTime::Seconds();
+	const double Timeout = Options.TimeoutSeconds > 0.0f ? Options.TimeoutSeconds : DefaultTimeout;
+	PendingRequest->Deadline = Timeout > 0.0 ? PendingRequest->QueuedTime + Timeout : MAX_dbl;
+	AwaitingContextRequests.Add(PendingRequest->Handle.Id, PendingRequest);
+
+	const FGeminiRequestHandle Handle = PendingRequest->Handle;
+	ContextCache->Acquire(ContextKey, Context, Options.Model.IsEmpty() ? ModelName : Options.Model, APIKey, FGeminiCacheReadyDelegate::CreateSP(this, &FGeminiAPIClient::OnContextReady, Handle.Id));
+	return Handle;
+}
+
+void FGeminiAPIClient::OnContextReady(const FString& CachedContentName, uint64 RequestId)
+{
+	TSharedRef<FGeminiPendingRequest>* Found = AwaitingContextRequests.Find(RequestId);
+	if (!Found)
+	{
+		// Cancelled or timed out while the context was uploaded
+		return;
+	}
+	TSharedRef<FGeminiPendingRequest> PendingRequest = *Found;
+	AwaitingContextRequests.Remove(RequestId);
+
+	// Without a cache entry the context goes inline, as if caching were off
+	if (CachedContentName.IsEmpty())
+	{
+		GeminiAPIClient::MoveContextInline(*PendingRequest);
+	}
+	PendingRequest->CachedContent = CachedContentName;
+	EnqueueRequest(PendingRequest, false);
+}
+
+FGeminiRequestHandle FGeminiAPIClient::EnqueueRequest(TSharedRef<FGeminiPendingRequest> PendingRequest, bool bSupersede)
+{
+	check(IsInGameThread());
+
+	if (PendingRequest->Prompt.IsEmpty() || (PendingRequest->APIKey.IsEmpty() && Backend->GetLimits().bRequiresAPIKey))
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiAPIClient: Prompt or API Key is empty. Skipping request."));
+		PendingRequest->OnComplete.ExecuteIfBound(TEXT(""), false, TEXT("Prompt or API Key was empty."));
+		return FGeminiRequestHandle();
+	}
+
+	// Latest wins: whatever was asked before under the same key is no longer of interest
+	if (bSupersede && !PendingRequest->Options.SupersessionKey.IsEmpty())
+	{
+		const int32 NumSuperseded = CancelRequestsWithKey(PendingRequest->Options.SupersessionKey);
+		if (NumSuperseded > 0)
+		{
+			UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAPIClient: New request superseded %d pending request(s) for '%s'"), NumSuperseded, *PendingRequest->Options.SupersessionKey);
+		}
+	}
+
+	// Requests parked while their context was uploaded already handed out their handle and started their clock
+	if (!PendingRequest->Handle.IsValid())
+	{
+		PendingRequest->Handle = FGeminiRequestHandle(NextRequestId++);
+		PendingRequest->QueuedTime = FPlatformTime::Seconds();
+		const double Timeout = PendingRequest->Options.TimeoutSeconds > 0.0f ? PendingRequest->Options.TimeoutSeconds : DefaultTimeout;
+		PendingRequest->Deadline = Timeout > 0.0 ? PendingRequest->QueuedTime + Timeout : MAX_dbl;
+	}
+	// The same question is already on its way: wait for that answer instead of asking again
+	if (bCoalesceRequests && AttachToIdenticalRequest(PendingRequest))
+	{
+		return PendingRequest->Handle;
+	}
+
+	PendingRequest->Sequence = NextSequence++;
+	PendingRequest->WaitStartTime = PendingRequest->QueuedTime;
+
+	FGeminiRequestTiming& Timing = FGeminiTimingLog::Get().FindOrAdd(PendingRequest->Handle.Id);
+	Timing.SubmitTime = PendingRequest->QueuedTime;
+	Timing.Model = PendingRequest->Options.Model.IsEmpty() ? ModelName : PendingRequest->Options.Model;
+	Timing.PromptChars = PendingRequest->Prompt.Len();
+	PendingRequest->EstimatedTokens = GeminiAPIClient::EstimateRequestTokens(*PendingRequest);
+
+	QueuedRequests.HeapPush(PendingRequest, FGeminiRequestQueueOrder());
+	PumpQueue();
+
+	return PendingRequest->Handle;
+}
+
+bool FGeminiAPIClient::AttachToIdenticalRequest(TSharedRef<FGeminiPendingRequest> PendingRequest)
+{
+	const FString Key = GeminiAPIClient::MakeCoalescingKey(*PendingRequest, ModelName);
+	TSharedRef<FGeminiPendingRequest>* Found = CoalescedRequests.Find(Key);
+	if (!Found)
+	{
+		PendingRequest->CoalescingKey = Key;
+		CoalescedRequests.Add(Key, PendingRequest);
+		return false;
+	}
+
+	TSharedRef<FGeminiPendingRequest> Leader = *Found;
+	FGeminiRequestWaiter& Waiter = Leader->Waiters.AddDefaulted_GetRef();
+	Waiter.Handle = PendingRequest->Handle;
+	Waiter.OnComplete = MoveTemp(PendingRequest->OnComplete);
+	Waiter.OnChunk = MoveTemp(PendingRequest->OnChunk);
+	Waiter.SupersessionKey = PendingRequest->Options.SupersessionKey;
+	Waiter.bNeedsStreamedText = !Leader->StreamedText.IsEmpty();
+	WaiterKeys.Add(Waiter.Handle.Id, Key);
+
+	// A queued request moves up to the priority of its most urgent caller
+	if (PendingRequest->Options.Priority > Leader->Options.Priority)
+	{
+		Leader->Options.Priority = PendingRequest->Options.Priority;
+		QueuedRequests.Heapify(FGeminiRequestQueueOrder());
+	}
+
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAPIClient: Request %llu is identical to pending request %llu and waits for its answer (%d waiting)"),
+		Waiter.Handle.Id, Leader->Handle.Id, Leader->Waiters.Num());
+	return true;
+}
+
+bool FGeminiAPIClient::DetachCoalescedCaller(FGeminiRequestHandle Handle)
+{
+	FString Key;
+	if (WaiterKeys.RemoveAndCopyValue(Handle.Id, Key))
+	{
+		if (TSharedRef<FGeminiPendingRequest>* Found = CoalescedRequests.Find(Key))
+		{
+			TSharedRef<FGeminiPendingRequest> Leader = *Found;
+			Leader->Waiters.RemoveAll([Handle](const FGeminiRequestWaiter& Waiter) { return Waiter.Handle == Handle; });
+
+			// Nobody is left who wants the answer
+			TSharedPtr<FGeminiPendingRequest> Removed;
+			if (Leader->bCallerCancelled && Leader->Waiters.Num() == 0 && RemovePendingRequest(Leader->Handle, Removed))
+			{
+				ReleaseCoalescingKey(*Removed);
+			}
+		}
+		return true;
+	}
+
+	for (const TPair<FString, TSharedRef<FGeminiPendingRequest>>& Pair : CoalescedRequests)
+	{
+		const TSharedRef<FGeminiPendingRequest>& Leader = Pair.Value;
+		if (Leader->Handle == Handle && Leader->Waiters.Num() > 0)
+		{
+			// The request goes on for the callers that attached to it, its own caller just stops hearing about it
+			Leader->bCallerCancelled = true;
+			Leader->OnComplete.Unbind();
+			Leader->OnChunk.Unbind();
+			Leader->Options.SupersessionKey.Empty();
+			return true;
+		}
+	}
+	return false;
+}
+
+void FGeminiAPIClient::ReleaseCoalescingKey(FGeminiPendingRequest& PendingRequest)
+{
+	if (PendingRequest.CoalescingKey.IsEmpty())
+	{
+		return;
+	}
+	const TSharedRef<FGeminiPendingRequest>* Registered = CoalescedRequests.Find(PendingRequest.CoalescingKey);
+	if (Registered && &Registered->Get() == &PendingRequest)
+	{
+		CoalescedRequests.Remove(PendingRequest.CoalescingKey);
+	}
+	PendingRequest.CoalescingKey.Empty();
+}
+
+void FGeminiAPIClient::CompleteRequest(TSharedRef<FGeminiPendingRequest> PendingRequest, const FString& Content, bool bSuccess, const FString& ErrorMessage)
+{
+	// A request submitted from one of the callbacks asks anew rather than attaching to an answer already given
+	ReleaseCoalescingKey(*PendingRequest);
+	const TArray<FGeminiRequestWaiter> Waiters = MoveTemp(PendingRequest->Waiters);
+
+	PendingRequest->OnComplete.ExecuteIfBound(Content, bSuccess, ErrorMessage);
+	for (const FGeminiRequestWaiter& Waiter : Waiters)
+	{
+		// Skips callers cancelled by an earlier callback
+		if (WaiterKeys.Remove(Waiter.Handle.Id) > 0)
+		{
+			Waiter.OnComplete.ExecuteIfBound(Content, bSuccess, ErrorMessage);
+		}
+	}
+}
+
+TArray<FGeminiRequestHandle> FGeminiAPIClient::GenerateContentBatch(const TArray<FGeminiBatchTask>& Tasks, const FString& APIKey, FGeminiBatchDelegate OnComplete, const FGeminiRequestOptions& Options)
+{
+	check(IsInGameThread());
+
+	TArray<FGeminiRequestHandle> Handles;
+	if (Tasks.Num() == 0)
+	{
+		OnComplete.ExecuteIfBound(TArray<FGeminiBatchTaskResult>());
+		return Handles;
+	}
+
+	TSharedRef<FGeminiBatchRun> Run = MakeShared<FGeminiBatchRun>();
+	Run->Tasks = Tasks;
+	Run->OnComplete = MoveTemp(OnComplete);
+	Run->Results.SetNum(Tasks.Num());
+	for (int32 Index = 0; Index < Tasks.Num(); ++Index)
+	{
+		Run->Results[Index].Id = Tasks[Index].Id;
+	}
+
+	// Supersede once for the whole run; its own requests share the key and must not cancel each other
+	CancelRequestsWithKey(Options.SupersessionKey);
+
+	TArray<TArray<int32>> Groups;
+	FGeminiPromptBatcher::SplitIntoGroups(Tasks, MaxTasksPerBatchRequest, MaxBatchRequestChars, Groups);
+	Run->NumPendingRequests = Groups.Num();
+
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAPIClient: Packed %d batch tasks into %d request(s)"), Tasks.Num(), Groups.Num());
+
+	for (const TArray<int32>& Group : Groups)
+	{
+		const FGeminiRequestHandle Handle = SubmitBatchGroup(Run, Group, APIKey, Options);
+		if (Handle.IsValid())
+		{
+			Handles.Add(Handle);
+		}
+	}
+	return Handles;
+}
+
+FGeminiRequestHandle FGeminiAPIClient::SubmitBatchGroup(TSharedRef<FGeminiBatchRun> Run, const TArray<int32>& TaskIndices, const FString& APIKey, const FGeminiRequestOptions& Options)
+{
+	TArray<FGeminiBatchTask> GroupTasks;
+	for (int32 TaskIndex : TaskIndices)
+	{
+		GroupTasks.Add(Run->Tasks[TaskIndex]);
+	}
+
+	TSharedRef<FGeminiPendingRequest> PendingRequest = MakeShared<FGeminiPendingRequest>();
+	PendingRequest->Prompt = GroupTasks.Num() == 1 ? GroupTasks[0].Prompt : FGeminiPromptBatcher::PackTasks(GroupTasks);
+	PendingRequest->APIKey = APIKey;
+	PendingRequest->Options = Options;
+	PendingRequest->Options.GenerationConfig.MaxOutputTokens *= GroupTasks.Num();
+	PendingRequest->OnComplete = FGeminiResponseDelegate::CreateSP(this, &FGeminiAPIClient::OnBatchGroupComplete, Run, TaskIndices, APIKey, Options);
+	return EnqueueRequest(PendingRequest, false);
+}
+
+void FGeminiAPIClient::OnBatchGroupComplete(FString ResponseContent, bool bSuccess, FString ErrorMessage, TSharedRef<FGeminiBatchRun> Run, TArray<int32> TaskIndices, FString APIKey, FGeminiRequestOptions Options)
+{
+	if (!bSuccess)
+	{
+		for (int32 TaskIndex : TaskIndices)
+		{
+			Run->Results[TaskIndex].ErrorMessage = ErrorMessage;
+		}
+	}
+	else if (TaskIndices.Num() == 1)
+	{
+		Run->Results[TaskIndices[0]].Text = ResponseContent;
+		Run->Results[TaskIndices[0]].bSuccess = true;
+	}
+	else
+	{
+		TArray<FString> Answers;
+		FGeminiPromptBatcher::UnpackResponse(ResponseContent, TaskIndices.Num(), Answers);
+
+		for (int32 Position = 0; Position < TaskIndices.Num(); ++Position)
+		{
+			const int32 TaskIndex = TaskIndices[Position];
+			if (!Answers[Position].IsEmpty())
+			{
+				Run->Results[TaskIndex].Text = MoveTemp(Answers[Position]);
+				Run->Results[TaskIndex].bSuccess = true;
+				continue;
+			}
+
+			// The model skipped or merged this task; ask for it on its own
+			UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiAPIClient: Batched answer has no block for task '%s', sending it separately"), *Run->Tasks[TaskIndex].Id);
+			Run->NumPendingRequests++;
+			SubmitBatchGroup(Run, { TaskIndex }, APIKey, Options);
+		}
+	}
+
+	if (--Run->NumPendingRequests == 0)
+	{
+		Run->OnComplete.ExecuteIfBound(Run->Results);
+	}
+}
+
+FGeminiRequestHandle FGeminiAPIClient::SubmitBatchJob(const TArray<FGeminiBatchTask>& Tasks, const FString& APIKey, FGeminiBatchDelegate OnComplete)
+{
+	check(IsInGameThread());
+
+	if (Tasks.Num() == 0 || APIKey.IsEmpty() || !Backend->GetLimits().bSupportsBatchJobs)
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiAPIClient: Batch job has no tasks or no API key, or the %s backend has no batch jobs. Skipping."), Backend->GetName());
+		OnComplete.ExecuteIfBound(TArray<FGeminiBatchTaskResult>());
+		return FGeminiRequestHandle();
+	}
+
+	const FGeminiRequestHandle Handle(NextRequestId++);
+	TSharedRef<FGeminiBatchJob> Job = MakeShared<FGeminiBatchJob>(APIBaseURL, GetModelURL(), APIKey, Tasks, BatchJobPollInterval, MoveTemp(OnComplete));
+	TWeakPtr<FGeminiAPIClient> WeakClient = AsShared();
+	Job->OnFinished.BindLambda([WeakClient, Handle]()
+	{
+		if (TSharedPtr<FGeminiAPIClient> Client = WeakClient.Pin())
+		{
+			Client->BatchJobs.Remove(Handle.Id);
+		}
+	});
+	BatchJobs.Add(Handle.Id, Job);
+	Job->Submit();
+
+	return IsRequestPending(Handle) ? Handle : FGeminiRequestHandle();
+}
+
+void FGeminiAPIClient::PumpQueue()
+{
+	const double Now = FPlatformTime::Seconds();
+	double NextWakeUpTime = ExpireTimedOutRequests(Now);
+
+	// Retries whose backoff has elapsed compete for a slot again
+	for (int32 Index = DelayedRequests.Num() - 1; Index >= 0; --Index)
+	{
+		if (DelayedRequests[Index]->RetryTime <= Now)
+		{
+			QueuedRequests.HeapPush(DelayedRequests[Index], FGeminiRequestQueueOrder());
+			DelayedRequests.RemoveAtSwap(Index);
+		}
+		else
+		{
+			NextWakeUpTime = FMath::Min(NextWakeUpTime, DelayedRequests[Index]->RetryTime);
+		}
+	}
+
+	while (ActiveRequests.Num() < MaxConcurrentRequests && QueuedRequests.Num() > 0)
+	{
+		TSharedRef<FGeminiPendingRequest> NextRequest = QueuedRequests.HeapTop();
+
+		// Out of quota: keep the queue intact and come back when the buckets have refilled
+		if (!RateLimiter.TryAcquire(NextRequest->EstimatedTokens, Now))
+		{
+			const double WaitTime = FMath::Max(GeminiAPIClient::MinPumpDelay, RateLimiter.GetWaitTime(NextRequest->EstimatedTokens, Now));
+			NextWakeUpTime = FMath::Min(NextWakeUpTime, Now + WaitTime);
+			break;
+		}
+
+		QueuedRequests.HeapPopDiscard(FGeminiRequestQueueOrder());
+		StartRequest(NextRequest);
+	}
+
+	if (NextWakeUpTime < MAX_dbl)
+	{
+		SchedulePump(NextWakeUpTime - Now);
+	}
+
+	SET_DWORD_STAT(STAT_GeminiRequestsInFlight, ActiveRequests.Num());
+	SET_DWORD_STAT(STAT_GeminiRequestsWaiting, GetNumQueuedRequests());
+}
+
+double FGeminiAPIClient::ExpireTimedOutRequests(double Now)
+{
+	TArray<FGeminiRequestHandle> ExpiredHandles;
+	double NextDeadline = MAX_dbl;
+
+	auto CheckDeadline = [Now, &ExpiredHandles, &NextDeadline](const TSharedRef<FGeminiPendingRequest>& PendingRequest)
+	{
+		if (PendingRequest->Deadline <= Now)
+		{
+			ExpiredHandles.Add(PendingRequest->Handle);
+		}
+		else
+		{
+			NextDeadline = FMath::Min(NextDeadline, PendingRequest->Deadline);
+		}
+	};
+	for (const TPair<uint64, TSharedRef<FGeminiPendingRequest>>& Pair : ActiveRequests)
+	{
+		CheckDeadline(Pair.Value);
+	}
+	for (const TSharedRef<FGeminiPendingRequest>& PendingRequest : QueuedRequests)
+	{
+		CheckDeadline(PendingRequest);
+	}
+	for (const TSharedRef<FGeminiPendingRequest>& PendingRequest : DelayedRequests)
+	{
+		CheckDeadline(PendingRequest);
+	}
+	for (const TPair<uint64, TSharedRef<FGeminiPendingRequest>>& Pair : AwaitingContextRequests)
+	{
+		CheckDeadline(Pair.Value);
+	}
+
+	for (const FGeminiRequestHandle& Handle : ExpiredHandles)
+	{
+		TSharedPtr<FGeminiPendingRequest> Expired;
+		if (RemovePendingRequest(Handle, Expired))
+		{
+			const double Elapsed = Now - Expired->QueuedTime;
+			UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiAPIClient: Request %llu timed out after %.1f s"), Handle.Id, Elapsed);
+			CompleteRequest(Expired.ToSharedRef(), TEXT(""), false, FString::Printf(TEXT("Request timed out after %.0f seconds."), Elapsed));
+		}
+	}
+
+	return NextDeadline;
+}
+
+bool FGeminiAPIClient::RemovePendingRequest(FGeminiRequestHandle Handle, TSharedPtr<FGeminiPendingRequest>& OutRemoved)
+{
+	TSharedRef<FGeminiPendingRequest>* ActiveRequest = ActiveRequests.Find(Handle.Id);
+	if (ActiveRequest)
+	{
+		OutRemoved = *ActiveRequest;
+		ActiveRequests.Remove(Handle.Id);
+
+		// Unbind first so aborting does not report a failure through the normal completion path
+		if (OutRemoved->HttpRequest.IsValid())
+		{
+			OutRemoved->HttpRequest->OnProcessRequestComplete().Unbind();
+			OutRemoved->HttpRequest->CancelRequest();
+		}
+		if (OutRemoved->Stream.IsValid())
+		{
+			OutRemoved->Stream->Complete();
+		}
+		return true;
+	}
+
+	const int32 QueuedIndex = QueuedRequests.IndexOfByPredicate([Handle](const TSharedRef<FGeminiPendingRequest>& Pending) { return Pending->Handle == Handle; });
+	if (QueuedIndex != INDEX_NONE)
+	{
+		OutRemoved = QueuedRequests[QueuedIndex];
+		QueuedRequests.HeapRemoveAt(QueuedIndex, FGeminiRequestQueueOrder());
+		return true;
+	}
+
+	const int32 DelayedIndex = DelayedRequests.IndexOfByPredicate([Handle](const TSharedRef<FGeminiPendingRequest>& Pending) { return Pending->Handle == Handle; });
+	if (DelayedIndex != INDEX_NONE)
+	{
+		OutRemoved = DelayedRequests[DelayedIndex];
+		DelayedRequests.RemoveAtSwap(DelayedIndex);
+		return true;
+	}
+
+	// The upload of its context goes on; other questions about the same context will use it
+	if (TSharedRef<FGeminiPendingRequest>* AwaitingRequest = AwaitingContextRequests.Find(Handle.Id))
+	{
+		OutRemoved = *AwaitingRequest;
+		AwaitingContextRequests.Remove(Handle.Id);
+		return true;
+	}
+
+	return false;
+}
+
+bool FGeminiAPIClient::CancelRequest(FGeminiRequestHandle Handle)
+{
+	check(IsInGameThread());
+
+	if (TSharedRef<FGeminiBatchJob>* BatchJob = BatchJobs.Find(Handle.Id))
+	{
+		// Cancel removes the job from the map through OnFinished
+		TSharedRef<FGeminiBatchJob> Job = *BatchJob;
+		Job->Cancel();
+		return true;
+	}
+
+	if (Handle.IsValid() && DetachCoalescedCaller(Handle))
+	{
+		UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAPIClient: Request %llu cancelled, the identical request it shares goes on"), Handle.Id);
+		PumpQueue();
+		return true;
+	}
+
+	TSharedPtr<FGeminiPendingRequest> Cancelled;
+	if (!Handle.IsValid() || !RemovePendingRequest(Handle, Cancelled))
+	{
+		return false;
+	}
+	ReleaseCoalescingKey(*Cancelled);
+
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAPIClient: Request %llu cancelled"), Handle.Id);
+
+	// A cancelled in-flight request frees its slot for the next one
+	PumpQueue();
+	return true;
+}
+
+int32 FGeminiAPIClient::CancelRequestsWithKey(const FString& SupersessionKey)
+{
+	if (SupersessionKey.IsEmpty())
+	{
+		return 0;
+	}
+
+	TArray<FGeminiRequestHandle> Handles;
+	auto CollectMatching = [&Handles, &SupersessionKey](const TSharedRef<FGeminiPendingRequest>& PendingRequest)
+	{
+		if (PendingRequest->Options.SupersessionKey == SupersessionKey)
+		{
+			Handles.Add(PendingRequest->Handle);
+		}
+	};
+	for (const TPair<uint64, TSharedRef<FGeminiPendingRequest>>& Pair : ActiveRequests)
+	{
+		CollectMatching(Pair.Value);
+	}
+	for (const TSharedRef<FGeminiPendingRequest>& PendingRequest : QueuedRequests)
+	{
+		CollectMatching(PendingRequest);
+	}
+	for (const TSharedRef<FGeminiPendingRequest>& PendingRequest : DelayedRequests)
+	{
+		CollectMatching(PendingRequest);
+	}
+	for (const TPair<uint64, TSharedRef<FGeminiPendingRequest>>& Pair : AwaitingContextRequests)
+	{
+		CollectMatching(Pair.Value);
+	}
+	for (const TPair<FString, TSharedRef<FGeminiPendingRequest>>& Pair : CoalescedRequests)
+	{
+		for (const FGeminiRequestWaiter& Waiter : Pair.Value->Waiters)
+		{
+			if (Waiter.SupersessionKey == SupersessionKey)
+			{
+				Handles.Add(Waiter.Handle);
+			}
+		}
+	}
+
+	int32 NumCancelled = 0;
+	for (const FGeminiRequestHandle& Handle : Handles)
+	{
+		if (DetachCoalescedCaller(Handle))
+		{
+			++NumCancelled;
+			continue;
+		}
+		TSharedPtr<FGeminiPendingRequest> Cancelled;
+		if (RemovePendingRequest(Handle, Cancelled))
+		{
+			ReleaseCoalescingKey(*Cancelled);
+			++NumCancelled;
+		}
+	}
+	return NumCancelled;
 }
 
-void FGeminiAPIClient::GenerateContent(const FString& InPrompt, const FString& APIKey)
+void FGeminiAPIClient::SchedulePump(double Delay)
 {
-	if (InPrompt.IsEmpty() || APIKey.IsEmpty())
+	const double WakeUpTime = FPlatformTime::Seconds() + FMath::Max(Delay, GeminiAPIClient::MinPumpDelay);
+	if (PumpTickerHandle.IsValid())
 	{
-		UE_LOG(LogTemp, Warning, TEXT("GeminiAPIClient: Prompt or API Key is empty. Skipping request."));
-		OnGeminiResponseReceived.ExecuteIfBound(TEXT(""), false, TEXT("Prompt or API Key was empty."));
-		return;
+		if (ScheduledPumpTime <= WakeUpTime)
+		{
+			return;
+		}
+		FTSTicker::GetCoreTicker().RemoveTicker(PumpTickerHandle);
 	}
 
-	CurrentAPIKey = APIKey;
+	ScheduledPumpTime = WakeUpTime;
+	PumpTickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateSP(this, &FGeminiAPIClient::OnPumpTicker),
+		static_cast<float>(WakeUpTime - FPlatformTime::Seconds()));
+}
 
-	FString Url = TEXT("https://generativelanguage.googleapis.com/v1beta/models/gemini-3-flash-preview:generateContent?key=") + APIKey;
+bool FGeminiAPIClient::OnPumpTicker(float DeltaTime)
+{
+	PumpTickerHandle.Reset();
+	ScheduledPumpTime = 0.0;
+	PumpQueue();
 
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-	Request->OnProcessRequestComplete().BindRaw(this, &FGeminiAPIClient::OnRequestComplete);
-	Request->SetURL(Url);
-	Request->SetVerb(TEXT("POST"));
-	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	// One-shot; PumpQueue schedules the next wake-up itself if needed
+	return false;
+}
+
+void FGeminiAPIClient::ScheduleRetry(TSharedRef<FGeminiPendingRequest> PendingRequest, double RetryAfterSeconds, int32 ResponseCode)
+{
+	// Exponential backoff with jitter so parallel requests do not retry in lockstep; a longer server hint wins
+	const double Backoff = FMath::Min(RetryMaxDelay, RetryBaseDelay * static_cast<double>(1 << FMath::Min(PendingRequest->Attempt, 16)));
+	const double Delay = FMath::Max(RetryAfterSeconds, Backoff * FMath::FRandRange(0.5, 1.0));
+
+	PendingRequest->Attempt++;
+	PendingRequest->RetryTime = FPlatformTime::Seconds() + Delay;
+	PendingRequest->WaitStartTime = FPlatformTime::Seconds();
+	INC_DWORD_STAT(STAT_GeminiRetries);
+	PendingRequest->HttpRequest.Reset();
+	PendingRequest->Stream.Reset();
+
+	// The rejected request did not consume quota; a 429 however means the quota is exhausted for everyone
+	RateLimiter.Refund(PendingRequest->EstimatedTokens);
+	if (ResponseCode == 429)
+	{
+		RateLimiter.BlockUntil(PendingRequest->RetryTime);
+	}
 
-	// Construct the JSON request body for Gemini Pro
-	TSharedPtr<FJsonObject> RequestBody = MakeShareable(new FJsonObject());
-	TArray<TSharedPtr<FJsonValue>> ContentsArray;
-	TSharedPtr<FJsonObject> ContentObject = MakeShareable(new FJsonObject());
-	TArray<TSharedPtr<FJsonValue>> PartsArray;
+	DelayedRequests.Add(PendingRequest);
 
-	// Create a new FJsonObject to hold the "text" field for the part
-	TSharedPtr<FJsonObject> TextPartObject = MakeShareable(new FJsonObject());
-	TextPartObject->SetStringField(TEXT("text"), InPrompt); // Set the "text" field with the actual prompt
+	UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiAPIClient: Request %llu failed transiently (code %d), retry %d/%d in %.1f s"),
+		PendingRequest->Handle.Id, ResponseCode, PendingRequest->Attempt, MaxRetries, Delay);
+}
 
-	// Add this TextPartObject (wrapped as an FJsonValueObject) to the PartsArray
-	PartsArray.Add(MakeShareable(new FJsonValueObject(TextPartObject)));
+EGeminiErrorKind FGeminiAPIClient::ClassifyFailure(bool bConnectedSuccessfully, int32 ResponseCode)
+{
+	if (!bConnectedSuccessfully || ResponseCode == 0)
+	{
+		return EGeminiErrorKind::Transient;
+	}
 
-	ContentObject->SetArrayField(TEXT("parts"), PartsArray);
-	ContentsArray.Add(MakeShareable(new FJsonValueObject(ContentObject)));
-	RequestBody->SetArrayField(TEXT("contents"), ContentsArray);
+	switch (ResponseCode)
+	{
+	case 408: // Request Timeout
+	case 429: // Too Many Requests
+	case 500: // Internal Server Error
+	case 502: // Bad Gateway
+	case 503: // Service Unavailable
+	case 504: // Gateway Timeout
+		return EGeminiErrorKind::Transient;
+	default:
+		return EGeminiErrorKind::Permanent;
+	}
+}
 
-	// Optional: Add generation config (e.g., temperature, max output tokens)
-	// TSharedPtr<FJsonObject> GenerationConfig = MakeShareable(new FJsonObject());
-	// GenerationConfig->SetNumberField(TEXT("temperature"), 0.7);
-	// RequestBody->SetObjectField(TEXT("generationConfig"), GenerationConfig);
+double FGeminiAPIClient::GetRetryAfterSeconds(const FString& RetryAfterHeader, const FString& ErrorBody)
+{
+	if (RetryAfterHeader.IsNumeric())
+	{
+		return FCString::Atod(*RetryAfterHeader);
+	}
 
-	FString RequestBodyString;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&RequestBodyString);
-	FJsonSerializer::Serialize(RequestBody.ToSharedRef(), Writer);
+	FDateTime RetryDate;
+	if (!RetryAfterHeader.IsEmpty() && FDateTime::ParseHttpDate(RetryAfterHeader, RetryDate))
+	{
+		return FMath::Max(0.0, (RetryDate - FDateTime::UtcNow()).GetTotalSeconds());
+	}
 
-	Request->SetContentAsString(RequestBodyString);
-	Request->ProcessRequest();
+	// Gemini reports its suggestion as RetryInfo in the error details, e.g. "retryDelay": "27s"
+	const FString RetryDelayKey = TEXT("\"retryDelay\"");
+	const int32 KeyIndex = ErrorBody.Find(RetryDelayKey, ESearchCase::CaseSensitive);
+	if (KeyIndex != INDEX_NONE)
+	{
+		const int32 ValueIndex = ErrorBody.Find(TEXT("\""), ESearchCase::CaseSensitive, ESearchDir::FromStart, KeyIndex + RetryDelayKey.Len());
+		if (ValueIndex != INDEX_NONE)
+		{
+			// Atod stops at the trailing 's'
+			return FCString::Atod(*ErrorBody.Mid(ValueIndex + 1, 16));
+		}
+	}
 
-	UE_LOG(LogTemp, Log, TEXT("GeminiAPIClient: Sending request to Gemini API..."));
+	return -1.0;
 }
 
-void FGeminiAPIClient::OnRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully)
+void FGeminiAPIClient::StartRequest(TSharedRef<FGeminiPendingRequest> PendingRequest)
 {
-	FString ResponseContent = TEXT("");
-	bool bSuccess = false;
-	FString ErrorMessage = TEXT("Unknown error.");
+	const uint64 RequestId = PendingRequest->Handle.Id;
+	const FString& Model = PendingRequest->Options.Model.IsEmpty() ? ModelName : PendingRequest->Options.Model;
+	const FString Url = Backend->GetGenerateURL(APIBaseURL, Model, PendingRequest->bStream, PendingRequest->APIKey);
 
-	if (bConnectedSuccessfully)
+	const double SerializeStartTime = FPlatformTime::Seconds();
+	FGeminiTimingLog::Get().AddStageTime(RequestId, EGeminiTimingStage::Wait, SerializeStartTime - PendingRequest->WaitStartTime);
+
+	if (FixtureMode != EGeminiFixtureMode::Off && Fixtures.IsValid())
 	{
-		if (Response.IsValid() && Response->GetResponseCode() >= 200 && Response->GetResponseCode() <= 299)
+		// The key leaves out the API key and the URL, so fixtures replay with any key and against any endpoint
+		TArray<uint8> Body;
+		WriteRequestBody(*PendingRequest, Body);
+		PendingRequest->FixtureKey = FGeminiFixtureStore::MakeKey(Backend->GetName(), Model, PendingRequest->bStream, Body);
+		if (FixtureMode == EGeminiFixtureMode::Replay)
 		{
-			ResponseContent = Response->GetContentAsString();
-			UE_LOG(LogTemp, Log, TEXT("GeminiAPIClient: Raw Response: %s"), *ResponseContent);
+			FGeminiTimingLog::Get().AddStageTime(RequestId, EGeminiTimingStage::SerializeRequest, FPlatformTime::Seconds() - SerializeStartTime);
+			ReplayFixture(PendingRequest);
+			return;
+		}
+		PendingRequest->FixtureRequestBody = MoveTemp(Body);
+	}
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = CreateGenerateRequest(Url, *PendingRequest);
+	FGeminiTimingLog::Get().AddStageTime(RequestId, EGeminiTimingStage::SerializeRequest, FPlatformTime::Seconds() - SerializeStartTime);
 
-			// Attempt to parse the JSON response
-			TSharedPtr<FJsonObject> JsonResponse;
-			TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ResponseContent);
+	if (PendingRequest->bStream)
+	{
+		TSharedRef<FGeminiStreamState, ESPMode::ThreadSafe> Stream = MakeShared<FGeminiStreamState, ESPMode::ThreadSafe>(Backend);
+		PendingRequest->Stream = Stream;
+		TWeakPtr<FGeminiAPIClient> WeakClient = AsShared();
 
-			if (FJsonSerializer::Deserialize(Reader, JsonResponse))
+		Request->SetHeader(TEXT("Accept"), TEXT("text/event-stream"));
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 3
+		// Parses the received bytes on the HTTP thread and forwards new text to the game thread
+		Request->SetResponseBodyReceiveStream(MakeShared<FGeminiStreamArchive>([WeakClient, Stream, RequestId](const uint8* Data, int64 Num)
+		{
+			FString ChunkText = Stream->ReceiveBytes(Data, Num);
+			if (!ChunkText.IsEmpty())
 			{
-				// Check for 'candidates' array and extract the text
-				const TArray<TSharedPtr<FJsonValue>>* CandidatesArray;
-				if (JsonResponse->TryGetArrayField(TEXT("candidates"), CandidatesArray))
+				AsyncTask(ENamedThreads::GameThread, [WeakClient, RequestId, ChunkText]()
 				{
-					if (CandidatesArray->Num() > 0)
+					if (TSharedPtr<FGeminiAPIClient> Client = WeakClient.Pin())
 					{
-						const TSharedPtr<FJsonObject>* CandidateObjectValue;
-						if ((*CandidatesArray)[0]->TryGetObject(CandidateObjectValue))
-						{
-							const TSharedPtr<FJsonObject>* ContentObjectValue;
-							if ((*CandidateObjectValue)->TryGetObjectField(TEXT("content"), ContentObjectValue))
-							{
-								const TArray<TSharedPtr<FJsonValue>>* PartsArray;
-								if ((*ContentObjectValue)->TryGetArrayField(TEXT("parts"), PartsArray))
-								{
-									if (PartsArray->Num() > 0)
-									{
-										const TSharedPtr<FJsonObject>* PartObjectValue;
-										if ((*PartsArray)[0]->TryGetObject(PartObjectValue))
-										{
-											FString Text;
-											if ((*PartObjectValue)->TryGetStringField(TEXT("text"), Text))
-											{
-												ResponseContent = Text;
-												bSuccess = true;
-												ErrorMessage = TEXT("");
-											}
-										}
-									}
-								}
-							}
-						}
+						Client->HandleStreamChunk(RequestId, ChunkText);
 					}
-				}
-				else if (JsonResponse->HasField(TEXT("error")))
+				});
+			}
+		}));
+#else
+		// Older engines have no body stream, so poll the partially received payload on progress instead
+		Request->OnRequestProgress().BindLambda([WeakClient, Stream, RequestId](FHttpRequestPtr InRequest, int32 BytesSent, int32 BytesReceived)
+		{
+			TSharedPtr<FGeminiAPIClient> Client = WeakClient.Pin();
+			FHttpResponsePtr PartialResponse = InRequest.IsValid() ? InRequest->GetResponse() : nullptr;
+			if (Client.IsValid() && PartialResponse.IsValid())
+			{
+				FString ChunkText = Stream->ReceiveContent(PartialResponse->GetContent());
+				if (!ChunkText.IsEmpty())
 				{
-					const TSharedPtr<FJsonObject>* ErrorObject;
-					if (JsonResponse->TryGetObjectField(TEXT("error"), ErrorObject))
-					{
-						FString ErrorMessageFromAPI;
-						if ((*ErrorObject)->TryGetStringField(TEXT("message"), ErrorMessageFromAPI))
-						{
-							ErrorMessage = FString::Printf(TEXT("Gemini API Error: %s"), *ErrorMessageFromAPI);
-						}
-					}
+					Client->HandleStreamChunk(RequestId, ChunkText);
 				}
 			}
+		});
+#endif
+	}
+
+	// The HTTP module enforces the remaining time as well, in case the editor stops ticking our watchdog
+	if (PendingRequest->Deadline < MAX_dbl)
+	{
+		Request->SetTimeout(FMath::Max(1.0f, static_cast<float>(PendingRequest->Deadline - FPlatformTime::Seconds())));
+	}
+
+	Request->OnProcessRequestComplete().BindSP(AsShared(), &FGeminiAPIClient::OnRequestComplete, RequestId);
+	PendingRequest->HttpRequest = Request;
+	ActiveRequests.Add(RequestId, PendingRequest);
+
+	PendingRequest->SentTime = FPlatformTime::Seconds();
+	Request->ProcessRequest();
+	INC_DWORD_STAT(STAT_GeminiRequestsSent);
+
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAPIClient: Sending request %llu to Gemini API (waited %.3f s in queue, %d in flight)..."),
+		RequestId, FPlatformTime::Seconds() - PendingRequest->QueuedTime, ActiveRequests.Num());
+}
+
+void FGeminiAPIClient::PrewarmConnection(const FString& APIKey)
+{
+	if ((APIKey.IsEmpty() && Backend->GetLimits().bRequiresAPIKey) || ActiveRequests.Num() > 0)
+	{
+		return;
+	}
+
+	// A cheap metadata lookup establishes DNS, TCP and TLS; the HTTP module keeps the connection for reuse
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(Backend->GetPrewarmURL(APIBaseURL, ModelName, APIKey));
+	Request->SetVerb(TEXT("GET"));
+	Backend->SetRequestHeaders(*Request, APIKey);
+	Request->SetHeader(TEXT("Connection"), TEXT("keep-alive"));
+	Request->ProcessRequest();
+}
+
+void FGeminiAPIClient::SetMaxConcurrentRequests(int32 InMaxConcurrentRequests)
+{
+	MaxConcurrentRequests = FMath::Max(1, InMaxConcurrentRequests);
+	PumpQueue();
+}
+
+bool FGeminiAPIClient::IsRequestPending(FGeminiRequestHandle Handle) const
+{
+	if (!Handle.IsValid())
+	{
+		return false;
+	}
+	if (WaiterKeys.Contains(Handle.Id))
+	{
+		return true;
+	}
+	for (const TPair<FString, TSharedRef<FGeminiPendingRequest>>& Pair : CoalescedRequests)
+	{
+		// Still running, but only for the callers that attached to it
+		if (Pair.Value->Handle == Handle && Pair.Value->bCallerCancelled)
+		{
+			return false;
+		}
+	}
+	if (ActiveRequests.Contains(Handle.Id) || BatchJobs.Contains(Handle.Id) || AwaitingContextRequests.Contains(Handle.Id))
+	{
+		return true;
+	}
+	auto MatchesHandle = [Handle](const TSharedRef<FGeminiPendingRequest>& Pending) { return Pending->Handle == Handle; };
+	return QueuedRequests.ContainsByPredicate(MatchesHandle) || DelayedRequests.ContainsByPredicate(MatchesHandle);
+}
+
+bool FGeminiAPIClient::IsRequestInFlight(FGeminiRequestHandle Handle) const
+{
+	if (const FString* SharedKey = WaiterKeys.Find(Handle.Id))
+	{
+		// A caller sharing another request's answer waits on that request
+		const TSharedRef<FGeminiPendingRequest>* Shared = CoalescedRequests.Find(*SharedKey);
+		return Shared && ActiveRequests.Contains((*Shared)->Handle.Id);
+	}
+	return Handle.IsValid() && (ActiveRequests.Contains(Handle.Id) || BatchJobs.Contains(Handle.Id));
+}
+
+void FGeminiAPIClient::HandleStreamChunk(uint64 RequestId, const FString& ChunkText)
+{
+	TSharedRef<FGeminiPendingRequest>* PendingRequest = ActiveRequests.Find(RequestId);
+
+	// Chunks still queued when the request completed are already part of the final response
+	if (!PendingRequest || !(*PendingRequest)->Stream.IsValid() || (*PendingRequest)->Stream->IsCompleted())
+	{
+		return;
+	}
+
+	FGeminiStreamState& Stream = *(*PendingRequest)->Stream;
+	if (!Stream.bFirstChunkLogged)
+	{
+		Stream.bFirstChunkLogged = true;
+		if (FGeminiRequestTiming* Timing = FGeminiTimingLog::Get().Find(RequestId))
+		{
+			Timing->TimeToFirstText = FPlatformTime::Seconds() - Stream.StartTime;
+		}
+		UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAPIClient: First streamed text of request %llu after %.3f s"), RequestId, FPlatformTime::Seconds() - Stream.StartTime);
+	}
+
+	// Callbacks may submit or cancel requests, which can move the map entry
+	TSharedRef<FGeminiPendingRequest> Request = *PendingRequest;
+	Request->bChunksDelivered = true;
+	Request->StreamedText += ChunkText;
+
+	TArray<TTuple<FGeminiRequestHandle, FGeminiChunkDelegate, FString>> WaiterChunks;
+	for (FGeminiRequestWaiter& Waiter : Request->Waiters)
+	{
+		if (Waiter.OnChunk.IsBound())
+		{
+			// Callers that joined mid-stream first get everything streamed before
+			WaiterChunks.Emplace(Waiter.Handle, Waiter.OnChunk, Waiter.bNeedsStreamedText ? Request->StreamedText : ChunkText);
+			Waiter.bNeedsStreamedText = false;
+		}
+	}
+
+	Request->OnChunk.ExecuteIfBound(ChunkText);
+	for (const TTuple<FGeminiRequestHandle, FGeminiChunkDelegate, FString>& WaiterChunk : WaiterChunks)
+	{
+		// Skips callers cancelled by an earlier callback
+		if (WaiterKeys.Contains(WaiterChunk.Get<0>().Id))
+		{
+			WaiterChunk.Get<1>().ExecuteIfBound(WaiterChunk.Get<2>());
+		}
+	}
+}
+
+namespace GeminiAPIClient
+{
+	// Writes at most MaxBytes of a response body to LogGeminiRaw
+	static void LogRawBody(uint64 RequestId, const TArray<uint8>& Body, int32 MaxBytes)
+	{
+		if (UE_LOG_ACTIVE(LogGeminiRaw, Verbose) && MaxBytes > 0)
+		{
+			FString Preview;
+			FGeminiJsonReader::AppendUtf8(Preview, Body.GetData(), FMath::Min(Body.Num(), MaxBytes));
+			UE_LOG(LogGeminiRaw, Verbose, TEXT("Request %llu: %d bytes%s: %s"), RequestId, Body.Num(), Body.Num() > MaxBytes ? TEXT(" (truncated)") : TEXT(""), *Preview);
+		}
+	}
+
+	// Extracts the answer from a complete response body
+	static void ParseResponseBody(const IGeminiBackend& Backend, uint64 RequestId, int32 ResponseCode, const TArray<uint8>& Body, const FString& RetryAfterHeader,
+		int32 RawLogMaxBytes, FGeminiRequestResult& OutResult)
+	{
+		OutResult.ResponseCode = ResponseCode;
+		LogRawBody(RequestId, Body, RawLogMaxBytes);
+
+		FGeminiParsedResponse Parsed;
+		const bool bHasText = Backend.ParseResponse(Body.GetData(), Body.Num(), Parsed);
+		OutResult.Usage = Parsed.Usage;
+		OutResult.FinishReason = Parsed.FinishReason;
+		if (ResponseCode >= 200 && ResponseCode <= 299)
+		{
+			if (bHasText)
+			{
+				OutResult.Content = MoveTemp(Parsed.Text);
+				OutResult.bSuccess = true;
+				OutResult.ErrorMessage = TEXT("");
+			}
+			else
+			{
+				OutResult.ErrorMessage = Parsed.ErrorMessage;
+			}
+		}
+		else
+		{
+			// Kept for the retry delay Gemini puts into its error details
+			FGeminiJsonReader::AppendUtf8(OutResult.ErrorBody, Body.GetData(), Body.Num());
+			OutResult.RetryAfterHeader = RetryAfterHeader;
+			OutResult.ErrorMessage = FString::Printf(TEXT("HTTP Request Failed: Response code %d - %s"), ResponseCode, Parsed.bApiError ? *Parsed.ErrorMessage : *OutResult.ErrorBody);
+		}
+	}
+
+	// Extracts the answer from a finished non-streamed response; runs on a worker thread
+	static void ParsePlainResponse(const IGeminiBackend& Backend, uint64 RequestId, FHttpResponsePtr Response, bool bConnectedSuccessfully, int32 RawLogMaxBytes, FGeminiRequestResult& OutResult)
+	{
+		GEMINI_STAGE_SCOPE("Gemini.ParseResponse", STAT_GeminiParseResponse);
+		const double StartTime = FPlatformTime::Seconds();
+		ON_SCOPE_EXIT
+		{
+			OutResult.ParseSeconds = FPlatformTime::Seconds() - StartTime;
+		};
+
+		OutResult.bConnectedSuccessfully = bConnectedSuccessfully;
+		if (!bConnectedSuccessfully || !Response.IsValid())
+		{
+			OutResult.ErrorMessage = TEXT("HTTP Request Failed: No connection or invalid response.");
+			return;
+		}
+		ParseResponseBody(Backend, RequestId, Response->GetResponseCode(), Response->GetContent(), Response->GetHeader(TEXT("Retry-After")), RawLogMaxBytes, OutResult);
+	}
+
+	// Turns a stream that has ended into the final response
+	static void CollectStreamResult(const FGeminiStreamState& Stream, int32 ResponseCode, const FString& RetryAfterHeader, FGeminiRequestResult& OutResult)
+	{
+		OutResult.ResponseCode = ResponseCode;
+		OutResult.Usage = Stream.GetUsage();
+		OutResult.FinishReason = Stream.GetFinishReason();
+		if (ResponseCode >= 200 && ResponseCode <= 299)
+		{
+			OutResult.Content = Stream.GetAccumulatedText();
+			if (!OutResult.Content.IsEmpty())
+			{
+				OutResult.bSuccess = true;
+				OutResult.ErrorMessage = TEXT("");
+			}
+			else if (!Stream.GetStreamError().IsEmpty())
+			{
+				OutResult.ErrorMessage = Stream.GetStreamError();
+			}
+			else if (!OutResult.FinishReason.IsEmpty() && OutResult.FinishReason != TEXT("STOP"))
+			{
+				OutResult.ErrorMessage = FString::Printf(TEXT("The server returned no text (finish reason %s)."), *OutResult.FinishReason);
+			}
 			else
 			{
-				ErrorMessage = FString::Printf(TEXT("Failed to parse JSON response: %s"), *ResponseContent);
+				OutResult.ErrorMessage = TEXT("The server returned an empty stream.");
 			}
 		}
 		else
 		{
-			ErrorMessage = FString::Printf(TEXT("HTTP Request Failed: Response code %d - %s"), Response->GetResponseCode(), *Response->GetContentAsString());
+			OutResult.ErrorBody = Stream.GetRawBodyAsString();
+			OutResult.RetryAfterHeader = RetryAfterHeader;
+
+			FGeminiParsedResponse Parsed;
+			Stream.ParseRawBody(Parsed);
+			OutResult.ErrorMessage = FString::Printf(TEXT("HTTP Request Failed: Response code %d - %s"), ResponseCode, Parsed.bApiError ? *Parsed.ErrorMessage : *OutResult.ErrorBody);
+		}
+	}
+}
+
+void FGeminiAPIClient::OnRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully, uint64 RequestId)
+{
+	TSharedRef<FGeminiPendingRequest>* FoundRequest = ActiveRequests.Find(RequestId);
+	if (!FoundRequest)
+	{
+		return;
+	}
+	FGeminiTimingLog::Get().AddStageTime(RequestId, EGeminiTimingStage::Network, FPlatformTime::Seconds() - (*FoundRequest)->SentTime);
+
+	// Streamed text was parsed as it arrived, only the outcome is left to collect
+	if ((*FoundRequest)->Stream.IsValid())
+	{
+		FGeminiStreamState& Stream = *(*FoundRequest)->Stream;
+		FGeminiRequestResult Result;
+		CompleteStreamedRequest(Stream, Response, bConnectedSuccessfully, Result);
+		UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAPIClient: Stream of request %llu finished after %.3f s"), RequestId, FPlatformTime::Seconds() - Stream.StartTime);
+		if (FixtureMode == EGeminiFixtureMode::Record && Result.ResponseCode >= 200 && Result.ResponseCode <= 299)
+		{
+			RecordFixture(**FoundRequest, Result.ResponseCode, Stream.GetRawBytes());
+		}
+		FinishRequest(RequestId, Result);
+		return;
+	}
+
+	// Failures are not recorded, so a replay never reproduces a rate limit or an outage
+	if (FixtureMode == EGeminiFixtureMode::Record && bConnectedSuccessfully && Response.IsValid() && Response->GetResponseCode() >= 200 && Response->GetResponseCode() <= 299)
+	{
+		RecordFixture(**FoundRequest, Response->GetResponseCode(), Response->GetContent());
+	}
+
+	// The request keeps its slot while the body is parsed; if it is cancelled meanwhile the result is dropped
+	TWeakPtr<FGeminiAPIClient> WeakClient = AsShared();
+	const int32 MaxLogBytes = RawLogMaxBytes;
+	TSharedRef<const IGeminiBackend, ESPMode::ThreadSafe> ResponseBackend = Backend;
+	Async(EAsyncExecution::ThreadPool, [WeakClient, ResponseBackend, Response, bConnectedSuccessfully, RequestId, MaxLogBytes]()
+	{
+		FGeminiRequestResult Result;
+		GeminiAPIClient::ParsePlainResponse(*ResponseBackend, RequestId, Response, bConnectedSuccessfully, MaxLogBytes, Result);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakClient, RequestId, Result = MoveTemp(Result)]()
+		{
+			if (TSharedPtr<FGeminiAPIClient> Client = WeakClient.Pin())
+			{
+				Client->FinishRequest(RequestId, Result);
+			}
+		});
+	});
+}
+
+void FGeminiAPIClient::ReplayFixture(TSharedRef<FGeminiPendingRequest> PendingRequest)
+{
+	const uint64 RequestId = PendingRequest->Handle.Id;
+	ActiveRequests.Add(RequestId, PendingRequest);
+	PendingRequest->SentTime = FPlatformTime::Seconds();
+	INC_DWORD_STAT(STAT_GeminiRequestsSent);
+
+	FGeminiFixture Fixture;
+	const bool bFound = Fixtures->Load(PendingRequest->FixtureKey, Fixture);
+	const float Delay = bFound && bReplayWithLatency ? static_cast<float>(Fixture.LatencySeconds) : 0.0f;
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAPIClient: Replaying request %llu from fixture %s%s"), RequestId, *PendingRequest->FixtureKey, bFound ? TEXT("") : TEXT(" (not recorded)"));
+
+	// Answered from the ticker like a real response, never from within the caller's submit
+	TWeakPtr<FGeminiAPIClient> WeakClient = AsShared();
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakClient, RequestId, bFound, Fixture = MoveTemp(Fixture)](float DeltaTime)
+	{
+		if (TSharedPtr<FGeminiAPIClient> Client = WeakClient.Pin())
+		{
+			Client->FinishReplay(RequestId, bFound, Fixture);
+		}
+		return false;
+	}), Delay);
+}
+
+void FGeminiAPIClient::FinishReplay(uint64 RequestId, bool bFound, const FGeminiFixture& Fixture)
+{
+	TSharedRef<FGeminiPendingRequest>* FoundRequest = ActiveRequests.Find(RequestId);
+	if (!FoundRequest)
+	{
+		// Cancelled or timed out while the replay was delayed
+		return;
+	}
+	TSharedRef<FGeminiPendingRequest> PendingRequest = *FoundRequest;
+	FGeminiTimingLog::Get().AddStageTime(RequestId, EGeminiTimingStage::Network, FPlatformTime::Seconds() - PendingRequest->SentTime);
+
+	FGeminiRequestResult Result;
+	Result.bConnectedSuccessfully = true;
+	if (!bFound)
+	{
+		Result.ResponseCode = EHttpResponseCodes::NotFound;
+		Result.ErrorMessage = FString::Printf(TEXT("No recorded response for this request (fixture %s in %s)."), *PendingRequest->FixtureKey, *Fixtures->GetDirectory());
+	}
+	else if (PendingRequest->bStream)
+	{
+		// The whole recorded stream arrives as one chunk
+		TSharedRef<FGeminiStreamState, ESPMode::ThreadSafe> Stream = MakeShared<FGeminiStreamState, ESPMode::ThreadSafe>(Backend);
+		PendingRequest->Stream = Stream;
+		const FString ChunkText = Stream->ReceiveBytes(Fixture.ResponseBody.GetData(), Fixture.ResponseBody.Num());
+		if (!ChunkText.IsEmpty())
+		{
+			HandleStreamChunk(RequestId, ChunkText);
 		}
+		Stream->Complete();
+		GeminiAPIClient::CollectStreamResult(*Stream, Fixture.ResponseCode, FString(), Result);
 	}
 	else
 	{
-		ErrorMessage = TEXT("HTTP Request Failed: No connection or invalid response.");
+		const double ParseStartTime = FPlatformTime::Seconds();
+		GeminiAPIClient::ParseResponseBody(*Backend, RequestId, Fixture.ResponseCode, Fixture.ResponseBody, FString(), RawLogMaxBytes, Result);
+		Result.ParseSeconds = FPlatformTime::Seconds() - ParseStartTime;
 	}
 
-	OnGeminiResponseReceived.ExecuteIfBound(ResponseContent, bSuccess, ErrorMessage);
+	// The chunk callback may have cancelled the request, in which case this does nothing
+	FinishRequest(RequestId, Result);
 }
 
-#undef LOCTEXT_NAMESPACE
+void FGeminiAPIClient::RecordFixture(const FGeminiPendingRequest& PendingRequest, int32 ResponseCode, const TArray<uint8>& ResponseBody) const
+{
+	if (!Fixtures.IsValid() || PendingRequest.FixtureKey.IsEmpty())
+	{
+		return;
+	}
+
+	FGeminiFixture Fixture;
+	Fixture.Key = PendingRequest.FixtureKey;
+	Fixture.Backend = Backend->GetName();
+	Fixture.Model = PendingRequest.Options.Model.IsEmpty() ? ModelName : PendingRequest.Options.Model;
+	Fixture.bStream = PendingRequest.bStream;
+	Fixture.ResponseCode = ResponseCode;
+	Fixture.LatencySeconds = FPlatformTime::Seconds() - PendingRequest.SentTime;
+	Fixture.RequestBody = PendingRequest.FixtureRequestBody;
+	Fixture.ResponseBody = ResponseBody;
+	Fixtures->Save(Fixture);
+}
+
+void FGeminiAPIClient::FinishRequest(uint64 RequestId, const FGeminiRequestResult& Result)
+{
+	TSharedRef<FGeminiPendingRequest>* FoundRequest = ActiveRequests.Find(RequestId);
+	if (!FoundRequest)
+	{
+		return;
+	}
+	TSharedRef<FGeminiPendingRequest> PendingRequest = *FoundRequest;
+	ActiveRequests.Remove(RequestId);
+	FGeminiTimingLog::Get().AddStageTime(RequestId, EGeminiTimingStage::ParseResponse, Result.ParseSeconds);
+
+	// Every attempt the server counted is billed, whether or not it is retried; coalesced callers shared this one
+	if (Result.Usage.IsSet())
+	{
+		FGeminiUsageTracker::Get().Record(PendingRequest->Options.UsageSource, Result.Usage);
+	}
+
+	FString ErrorMessage = Result.ErrorMessage;
+
+	// The cached context expired or was deleted on the server: forget it and ask again with the context inline
+	if (!Result.bSuccess && !PendingRequest->CachedContent.IsEmpty() && (Result.ResponseCode == 403 || Result.ResponseCode == 404))
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiAPIClient: Cached content %s of request %llu was rejected (code %d), resending with the context inline"),
+			*PendingRequest->CachedContent, RequestId, Result.ResponseCode);
+		ContextCache->Invalidate(PendingRequest->CachedContent);
+		RateLimiter.Refund(PendingRequest->EstimatedTokens);
+		PendingRequest->CachedContent.Empty();
+		GeminiAPIClient::MoveContextInline(*PendingRequest);
+		PendingRequest->HttpRequest.Reset();
+		PendingRequest->Stream.Reset();
+		PendingRequest->EstimatedTokens = GeminiAPIClient::EstimateRequestTokens(*PendingRequest);
+		QueuedRequests.HeapPush(PendingRequest, FGeminiRequestQueueOrder());
+		PumpQueue();
+		return;
+	}
+
+	// The answer was cut off at the output cap: ask once more with a larger one, unless the cut-off text is already on screen
+	if (Result.bSuccess && GeminiAPIClient::IsTruncated(Result.FinishReason))
+	{
+		FGeminiGenerationConfig& Config = PendingRequest->Options.GenerationConfig;
+		const int32 RaisedCap = FMath::Min(Config.MaxOutputTokens * 2, MaxRaisedOutputTokens);
+		if (!PendingRequest->bRaisedOutputCap && !PendingRequest->bChunksDelivered && Config.MaxOutputTokens > 0 && RaisedCap > Config.MaxOutputTokens
+			&& FPlatformTime::Seconds() < PendingRequest->Deadline)
+		{
+			UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiAPIClient: Answer to request %llu hit the output cap of %d tokens, asking again with %d"),
+				RequestId, Config.MaxOutputTokens, RaisedCap);
+			Config.MaxOutputTokens = RaisedCap;
+			PendingRequest->bRaisedOutputCap = true;
+			PendingRequest->HttpRequest.Reset();
+			PendingRequest->Stream.Reset();
+			PendingRequest->FixtureKey.Empty();
+			PendingRequest->FixtureRequestBody.Reset();
+			PendingRequest->WaitStartTime = FPlatformTime::Seconds();
+			QueuedRequests.HeapPush(PendingRequest, FGeminiRequestQueueOrder());
+			PumpQueue();
+			return;
+		}
+		// Still a usable answer; the message tells the caller it is incomplete
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiAPIClient: Answer to request %llu was cut off at the output cap of %d tokens"), RequestId, Config.MaxOutputTokens);
+		ErrorMessage = FString::Printf(TEXT("The answer was cut off at the output limit of %d tokens."), Config.MaxOutputTokens);
+	}
+
+	// The HTTP module gave up because the remaining time ran out: report it as a timeout rather than retrying
+	if (!Result.bSuccess && !Result.bConnectedSuccessfully && FPlatformTime::Seconds() >= PendingRequest->Deadline - 1.0)
+	{
+		ErrorMessage = FString::Printf(TEXT("Request timed out after %.0f seconds."), FPlatformTime::Seconds() - PendingRequest->QueuedTime);
+	}
+	else if (!Result.bSuccess)
+	{
+		const int32 ResponseCode = Result.bConnectedSuccessfully ? Result.ResponseCode : 0;
+		if (ClassifyFailure(Result.bConnectedSuccessfully, ResponseCode) == EGeminiErrorKind::Transient)
+		{
+			// A stream that already showed text cannot be replayed without duplicating it on screen
+			if (PendingRequest->Attempt < MaxRetries && !PendingRequest->bChunksDelivered && FPlatformTime::Seconds() < PendingRequest->Deadline)
+			{
+				ScheduleRetry(PendingRequest, GetRetryAfterSeconds(Result.RetryAfterHeader, Result.ErrorBody), ResponseCode);
+				PumpQueue();
+				return;
+			}
+			ErrorMessage = FString::Printf(TEXT("%s (transient error, gave up after %d attempts)"), *ErrorMessage, PendingRequest->Attempt + 1);
+		}
+	}
+
+	FGeminiRequestTiming& Timing = FGeminiTimingLog::Get().FindOrAdd(RequestId);
+	Timing.Attempts = PendingRequest->Attempt + 1;
+	Timing.bSuccess = Result.bSuccess;
+	Timing.bCompleted = true;
+	Timing.ResponseChars = Result.Content.Len();
 
+	// The callback's own work (UI update, comment writing) is part of the request's total
+	CompleteRequest(PendingRequest, Result.Content, Result.bSuccess, ErrorMessage);
+	if (FGeminiRequestTiming* CompletedTiming = FGeminiTimingLog::Get().Find(RequestId))
+	{
+		CompletedTiming->TotalSeconds = FPlatformTime::Seconds() - PendingRequest->QueuedTime;
+	}
+
+	// The finished request freed a slot
+	PumpQueue();
+}
+
+void FGeminiAPIClient::CompleteStreamedRequest(FGeminiStreamState& Stream, FHttpResponsePtr Response, bool bConnectedSuccessfully, FGeminiRequestResult& OutResult)
+{
+#if !(ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 3)
+	// Pick up whatever arrived after the last progress notification
+	if (Response.IsValid())
+	{
+		Stream.ReceiveContent(Response->GetContent());
+	}
+#endif
+	Stream.Complete();
+
+	OutResult.bConnectedSuccessfully = bConnectedSuccessfully;
+	if (!bConnectedSuccessfully || !Response.IsValid())
+	{
+		OutResult.ErrorMessage = TEXT("HTTP Request Failed: No connection or invalid response.");
+		return;
+	}
+
+	GeminiAPIClient::CollectStreamResult(Stream, Response->GetResponseCode(), Response->GetHeader(TEXT("Retry-After")), OutResult);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -6,6 +6,8 @@
 #include "Widgets/Layout/SWidgetSwitcher.h"
 #include "Widgets/Layout/SBorder.h"
 #include "Widgets/Layout/SBox.h"
+#include "Widgets/Layout/SScrollBox.h"
+#include "Widgets/Views/STableRow.h"
 #include "Widgets/SBoxPanel.h"
 #include "Widgets/Text/STextBlock.h"
 #include "Widgets/Input/SMultiLineEditableTextBox.h" 
@@ -21,6 +23,7 @@
 #include "HAL/FileManager.h"
 #include "Misc/FileHelper.h"
 #include "HAL/PlatformApplicationMisc.h"
+#include "Misc/PackageName.h"
 
 // Blueprint Core Classes (These exist as direct headers)
 #include "Engine/Blueprint.h"
@@ -31,8 +34,6 @@
 
 #include "K2Node.h"
 
-#include "BlueprintEditorModule.h"
-
 #include "Editor.h"
 
 #include "Kismet2/BlueprintEditorUtils.h"
@@ -43,6 +44,19 @@
 #include "ScopedTransaction.h"
 
 #include "BlueprintNodePreprocessor.h"
+#include "GeminiBlueprintAssistant.h"
+#include "GeminiModelRouter.h"
+#include "GeminiPromptTemplate.h"
+#include "GeminiBackend.h"
+#include "GeminiUsageTracker.h"
+#include "GeminiAssistantTrace.h"
+#include "GeminiTimingLog.h"
+#include "GeminiEditorTracker.h"
+#include "GeminiAutoSummarizer.h"
+#include "GeminiSummaryStore.h"
+#include "GeminiResponseView.h"
+#include "GeminiCommentWriter.h"
+#include "GeminiGraphClusterer.h"
 
 #define LOCTEXT_NAMESPACE "FGeminiBlueprintAssistantModule"
 
@@ -50,10 +64,16 @@
 BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
 void GeminiAssistantPanel::Construct(const FArguments& InArgs)
 {
-	GeminiClient = MakeShared<FGeminiAPIClient>();
-	GeminiClient->OnGeminiResponseReceived.BindRaw(this, &GeminiAssistantPanel::OnGeminiResponse);
+	GeminiClient = FGeminiBlueprintAssistantModule::Get().GetAPIClient();
 
 	bHasValidApiKey = CheckApiKeyExists();
+	if (bHasValidApiKey && GeminiClient.IsValid())
+	{
+		// Open the connection while the user is still selecting nodes
+		FString APIKey;
+		GConfig->GetString(TEXT("GeminiAssistant"), TEXT("APIKey"), APIKey, GEditorPerProjectIni);
+		GeminiClient->PrewarmConnection(APIKey);
+	}
 
 	ChildSlot
 		[
@@ -77,296 +97,1205 @@ void GeminiAssistantPanel::Construct(const FArguments& InArgs)
 				]
 		];
 
-	// Set the active widget based on API key existence
-	ContentSwitcher->SetActiveWidgetIndex(bHasValidApiKey ? 1 : 0);
+	// Set the active widget based on API key existence
+	ContentSwitcher->SetActiveWidgetIndex(bHasValidApiKey ? 1 : 0);
+
+	CurrentPromptText = FText::GetEmpty();
+
+	// Summaries written in the background while nobody had the panel open are ready right away; the binding goes with the panel
+	FGeminiBlueprintAssistantModule::Get().GetAutoSummarizer()->OnSummaryUpdated().AddSP(this, &GeminiAssistantPanel::OnAutoSummaryUpdated);
+	if (UBlueprint* ActiveBlueprint = GetActiveBlueprint())
+	{
+		ShowAutoSummaries(ActiveBlueprint->GetPathName());
+	}
+}
+END_SLATE_FUNCTION_BUILD_OPTIMIZATION
+
+GeminiAssistantPanel::~GeminiAssistantPanel()
+{
+	// Nobody is left to read the answers, so stop paying for them
+	if (GeminiClient.IsValid())
+	{
+		for (const TSharedPtr<FGeminiPanelJob>& Job : Jobs)
+		{
+			if (Job->IsRunning())
+			{
+				GeminiClient->CancelRequest(Job->Request);
+				for (const FGeminiRequestHandle& BatchRequest : Job->BatchRequests)
+				{
+					GeminiClient->CancelRequest(BatchRequest);
+				}
+			}
+		}
+	}
+}
+
+FReply GeminiAssistantPanel::OnProcessButtonClicked()
+{
+	/*
+	if (CurrentPromptText.IsEmpty())
+	{
+		ResponseView->SetText(LOCTEXT("EmptyPromptWarning", "Please enter a prompt.").ToString());
+		return FReply::Handled();
+	}
+	*/
+	StatusTextBlock->SetText(FText::GetEmpty());
+	UE_LOG(LogGeminiAssistant, Log, TEXT("Gemini Blueprint Assistant: Process button clicked. Prompt: %s"), *CurrentPromptText.ToString());
+
+	// The client tells whether the backend needs a key at all, so it is checked first
+	if (!GeminiClient.IsValid())
+	{
+		StatusTextBlock->SetText(LOCTEXT("ClientError", "Gemini API Client is not initialized."));
+		UE_LOG(LogGeminiAssistant, Error, TEXT("GeminiAPIClient: Client not valid!"));
+		return FReply::Handled();
+	}
+
+	FString APIKey;
+	if (!GConfig->GetString(TEXT("GeminiAssistant"), TEXT("APIKey"), APIKey, GEditorPerProjectIni) && GeminiClient->GetBackendLimits().bRequiresAPIKey)
+	{
+		StatusTextBlock->SetText(LOCTEXT("APIKeyMissing", "Gemini API Key not found in config! Please add it to [GeminiAssistant] section in EditorPerProjectUserSettings.ini."));
+		UE_LOG(LogGeminiAssistant, Error, TEXT("GeminiAPIClient: API Key not found in config."));
+		return FReply::Handled();
+	}
+
+	UBlueprint* ActiveBlueprint = GetActiveBlueprint();
+	if (!ActiveBlueprint)
+	{
+		StatusTextBlock->SetText(LOCTEXT("NoBlueprintActive", "No Blueprint editor is currently active. Please open a Blueprint."));
+		UE_LOG(LogGeminiAssistant, Error, TEXT("GeminiBlueprintAssistant: No active Blueprint found."));
+		return FReply::Handled();
+	}
+
+	// Token usage is recorded per graph, and a used-up budget may block the request or make it cheaper
+	UEdGraph* FocusedGraph = GetFocusedGraph(ActiveBlueprint);
+	const FString UsageSource = FGeminiUsageTracker::MakeSource(ActiveBlueprint->GetPathName(), FocusedGraph ? FocusedGraph->GetName() : FString());
+	FString ProfileName = TEXT("fast");
+	GConfig->GetString(TEXT("GeminiAssistant"), TEXT("Profile"), ProfileName, GEditorPerProjectIni);
+	if (!CheckUsageBudget(UsageSource, ProfileName))
+	{
+		return FReply::Handled();
+	}
+
+	// Stage times are recorded against the request once it has a handle; prompt building is what remains
+	const double PrepareStartTime = FPlatformTime::Seconds();
+	double CollectSeconds = 0.0;
+	double PreprocessSeconds = 0.0;
+	FString NodesData;
+	TArray<UEdGraphNode*> SelectedNodes;
+	{
+		FGeminiStageTimer CollectTimer(CollectSeconds);
+		SelectedNodes = GetSelectedBlueprintNodes(ActiveBlueprint);
+	}
+	{
+		FGeminiStageTimer PreprocessTimer(PreprocessSeconds);
+		NodesData = ExtractNodeDataForGemini(SelectedNodes);
+	}
+
+	// Latest wins: a new question replaces a running job asking the same instead of paying for both
+	const FString SupersessionKey = MakeSupersessionKey(ActiveBlueprint, FocusedGraph, SelectedNodes);
+	bool bLatestRequestWins = true;
+	GConfig->GetBool(TEXT("GeminiAssistant"), TEXT("bLatestRequestWins"), bLatestRequestWins, GEditorPerProjectIni);
+	if (bLatestRequestWins)
+	{
+		for (const TSharedPtr<FGeminiPanelJob>& Job : TArray<TSharedPtr<FGeminiPanelJob>>(Jobs))
+		{
+			if (Job->IsRunning() && Job->SupersessionKey == SupersessionKey)
+			{
+				CancelJob(Job.ToSharedRef(), LOCTEXT("JobSuperseded", "Replaced by a newer request."));
+			}
+		}
+	}
+
+	const FString Title = SelectedNodes.Num() > 0
+		? FString::Printf(TEXT("%s: %d nodes"), *ActiveBlueprint->GetName(), SelectedNodes.Num())
+		: FString::Printf(TEXT("%s: %s"), *ActiveBlueprint->GetName(), FocusedGraph ? *FocusedGraph->GetName() : TEXT("graph"));
+	TSharedRef<FGeminiPanelJob> Job = AddJob(Title);
+	Job->Blueprint = ActiveBlueprint;
+	Job->Graph = FocusedGraph;
+	for (UEdGraphNode* Node : SelectedNodes)
+	{
+		Job->Nodes.Add(Node);
+	}
+	Job->bWriteComments = WriteCommentsCheckBox->IsChecked();
+	Job->SupersessionKey = SupersessionKey;
+	FString PromptToSend;
+
+	// Structured answers come back as JSON following FGeminiSummarySchema instead of DETAILS/SUMMARY text
+	bool bStructuredResponses = true;
+	GConfig->GetBool(TEXT("GeminiAssistant"), TEXT("bStructuredResponses"), bStructuredResponses, GEditorPerProjectIni);
+
+	// Graph data sent as a separately cached context, so follow-up questions about the same graph only send the question
+	FString ContextToSend;
+
+	// Keys both the cached context and the conversation about the focused graph
+	const FString GraphKey = FString::Printf(TEXT("Panel|%s|%s"), *ActiveBlueprint->GetPathName(), FocusedGraph ? *FocusedGraph->GetName() : TEXT(""));
+
+	// Whole-graph questions continue a conversation per graph that only sends what changed since the last answer;
+	// while another job is still waiting on the conversation this one sends the whole graph instead
+	bool bUseSessions = true;
+	GConfig->GetBool(TEXT("GeminiAssistant"), TEXT("bUseSessions"), bUseSessions, GEditorPerProjectIni);
+	bUseSessions = bUseSessions && !Jobs.ContainsByPredicate([&GraphKey](const TSharedPtr<FGeminiPanelJob>& Other)
+	{
+		return Other->IsRunning() && Other->SessionKey == GraphKey;
+	});
+	TArray<FGeminiChatTurn> SessionHistory;
+
+	// Template the prompt is built from; it also sizes the answer
+	FGeminiPromptTemplate Template;
+
+	// Static instructions lead every prompt and the Blueprint name and question trail it, so requests share a cacheable prefix
+	FStringFormatNamedArguments TaskArguments;
+	TaskArguments.Add(TEXT("Blueprint"), ActiveBlueprint->GetName());
+	const FString UserQuery = CurrentPromptText.ToString();
+	Job->bStoreSummary = UserQuery.IsEmpty() && FocusedGraph != nullptr;
+	if (Job->bStoreSummary)
+	{
+		Job->ContentHash = FGeminiSummaryStore::MakeContentHash(FocusedGraph, SelectedNodes);
+	}
+
+	// Nodes the prompt describes, split into parts if they do not fit into one request
+	TArray<UEdGraphNode*> PromptNodes = SelectedNodes;
+	if (SelectedNodes.Num() == 0)
+	{
+		{
+			FGeminiStageTimer CollectTimer(CollectSeconds);
+			PromptNodes = GetAllNodesFromActiveGraph(ActiveBlueprint);
+		}
+		FGeminiGraphSnapshot Snapshot;
+		{
+			FGeminiStageTimer PreprocessTimer(PreprocessSeconds);
+			if (bUseSessions)
+			{
+				Snapshot = FGeminiGraphSnapshot::Capture(PromptNodes);
+			}
+			else
+			{
+				NodesData = ExtractNodeDataForGemini(PromptNodes);
+			}
+		}
+
+		if (bUseSessions ? Snapshot.Nodes.Num() == 0 : NodesData.IsEmpty())
+		{
+			Template = FGeminiPromptTemplate::Load(TEXT("EmptyGraph"));
+			PromptToSend = Template.GetPrefix(bStructuredResponses) + Template.FormatTask(TaskArguments, UserQuery);
+		}
+		else
+		{
+			// The context holds the prefix and the graph; the Blueprint is named in the task so equal graphs share their context
+			Template = FGeminiPromptTemplate::Load(TEXT("Graph"));
+			const FString ContextHeader = Template.GetPrefix(bStructuredResponses) + TEXT("Blueprint Graph Data: ");
+			if (bUseSessions)
+			{
+				TSharedRef<FGeminiSession>* Session = Sessions.Find(GraphKey);
+				if (!Session)
+				{
+					int32 MaxSessionHistoryTokens = 32000;
+					GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("MaxSessionHistoryTokens"), MaxSessionHistoryTokens, GEditorPerProjectIni);
+					Session = &Sessions.Add(GraphKey, MakeShared<FGeminiSession>(MaxSessionHistoryTokens));
+				}
+				Job->SessionTurn = (*Session)->BeginTurn(Snapshot, ContextHeader);
+				Job->SessionKey = GraphKey;
+				ContextToSend = Job->SessionTurn.Context;
+				SessionHistory = MoveTemp(Job->SessionTurn.History);
+				if (!Job->SessionTurn.GraphChanges.IsEmpty())
+				{
+					PromptToSend = FString::Printf(TEXT("The graph changed since my last message. Node numbers refer to the numbered node list.\n%s\n"), *Job->SessionTurn.GraphChanges);
+				}
+			}
+			else
+			{
+				ContextToSend = ContextHeader + NodesData + TEXT("\n");
+			}
+			PromptToSend += Template.FormatTask(TaskArguments, UserQuery);
+		}
+		SetJobText(*Job, LOCTEXT("SummarizingEntireGraph", "Summarizing entire Blueprint graph with Gemini...").ToString());
+	}
+	else
+	{
+		Template = FGeminiPromptTemplate::Load(TEXT("Selection"));
+		PromptToSend = Template.GetPrefix(bStructuredResponses) + TEXT("Blueprint Graph Nodes Data: ") + NodesData + TEXT("\n") + Template.FormatTask(TaskArguments, UserQuery);
+		SetJobText(*Job, LOCTEXT("SummarizingSelected", "Summarizing selected Blueprint nodes with Gemini...").ToString());
+	}
+	const double BuildPromptSeconds = FPlatformTime::Seconds() - PrepareStartTime - CollectSeconds - PreprocessSeconds;
+
+	// Streaming is on by default so the response fills in while Gemini is still generating
+	bool bStreamResponses = true;
+	GConfig->GetBool(TEXT("GeminiAssistant"), TEXT("bStreamResponses"), bStreamResponses, GEditorPerProjectIni);
+
+	// Interactive requests jump ahead of any background work queued on the shared client
+	FGeminiRequestOptions Options;
+	Options.Priority = EGeminiRequestPriority::High;
+	Options.History = MoveTemp(SessionHistory);
+	Options.UsageSource = UsageSource;
+	if (bLatestRequestWins)
+	{
+		Options.SupersessionKey = SupersessionKey;
+	}
+
+	// The estimated prompt size picks the model; the profile sets answer length, thinking and temperature
+	int32 EstimatedTokens = FGeminiTokenEstimator::EstimateTokens(ContextToSend) + FGeminiTokenEstimator::EstimateTokens(PromptToSend);
+	for (const FGeminiChatTurn& Turn : Options.History)
+	{
+		EstimatedTokens += FGeminiTokenEstimator::EstimateTokens(Turn.Text);
+	}
+	const FGeminiRoute Route = FGeminiModelRouter(GeminiClient->GetBackendLimits()).Apply(EstimatedTokens, FGeminiGenerationProfile::Load(ProfileName), Options);
+	if (!Route.bNeedsChunking)
+	{
+		Template.ApplyOutputCap(Options.GenerationConfig);
+		if (bStructuredResponses)
+		{
+			Options.GenerationConfig.ResponseMimeType = TEXT("application/json");
+			Options.GenerationConfig.ResponseSchema = FGeminiSummarySchema::GetSchemaJson();
+		}
+	}
+
+	Job->SessionPrompt = PromptToSend;
+	const FGeminiChunkDelegate OnChunk = bStreamResponses ? FGeminiChunkDelegate::CreateSP(this, &GeminiAssistantPanel::OnGeminiChunk, Job->Id) : FGeminiChunkDelegate();
+	const FGeminiResponseDelegate OnComplete = FGeminiResponseDelegate::CreateSP(this, &GeminiAssistantPanel::OnGeminiResponse, Job->Id);
+	if (Route.bNeedsChunking && PromptNodes.Num() > 1)
+	{
+		// Parts are summarized independently, outside the conversation, and only their combined text is shown
+		Job->SessionKey.Empty();
+		Job->bStoreSummary = false;
+		SubmitChunkedSummary(Job, ActiveBlueprint, PromptNodes, Route.NumChunks, APIKey, Options);
+	}
+	else if (!ContextToSend.IsEmpty())
+	{
+		// Keyed by graph: once the graph changes, its previous cache entry is dropped
+		Job->Request = GeminiClient->GenerateContentWithContext(GraphKey, ContextToSend, PromptToSend, APIKey, OnChunk, OnComplete, Options);
+	}
+	else if (bStreamResponses)
+	{
+		Job->Request = GeminiClient->GenerateContentStream(PromptToSend, APIKey, OnChunk, OnComplete, Options);
+	}
+	else
+	{
+		Job->Request = GeminiClient->GenerateContent(PromptToSend, APIKey, OnComplete, Options);
+	}
+
+	AddJobStageTime(*Job, EGeminiTimingStage::CollectNodes, CollectSeconds);
+	AddJobStageTime(*Job, EGeminiTimingStage::PreprocessNodes, PreprocessSeconds);
+	AddJobStageTime(*Job, EGeminiTimingStage::BuildPrompt, BuildPromptSeconds);
+
+	return FReply::Handled();
+}
+
+void GeminiAssistantPanel::OnPromptTextChanged(const FText& InText)
+{
+	CurrentPromptText = InText;
+}
+
+void GeminiAssistantPanel::OnPromptTextCommitted(const FText& InText, ETextCommit::Type InCommitType)
+{
+	if (InCommitType == ETextCommit::OnEnter)
+	{
+		OnProcessButtonClicked();
+	}
+}
+
+void GeminiAssistantPanel::OnGeminiChunk(FString ChunkText, int32 JobId)
+{
+	TSharedPtr<FGeminiPanelJob> Job = FindJob(JobId);
+	if (!Job.IsValid())
+	{
+		return;
+	}
+
+	GEMINI_STAGE_SCOPE("Gemini.UpdateUI", STAT_GeminiUpdateUI);
+	double UpdateSeconds = 0.0;
+	{
+		FGeminiStageTimer UpdateTimer(UpdateSeconds);
+		AddStreamedChunk(*Job, ChunkText, ShownJob.Get() == Job.Get() ? ResponseView.Get() : nullptr);
+	}
+	AddJobStageTime(*Job, EGeminiTimingStage::UpdateUI, UpdateSeconds);
+}
+
+void GeminiAssistantPanel::OnGeminiResponse(FString ResponseContent, bool bSuccess, FString ErrorMessage, int32 JobId)
+{
+	TSharedPtr<FGeminiPanelJob> Job = FindJob(JobId);
+	if (!Job.IsValid() || !Job->IsRunning())
+	{
+		return;
+	}
+	const uint64 RequestId = Job->Request.Id;
+
+	// Only answered turns become part of the conversation
+	if (bSuccess && !Job->SessionKey.IsEmpty())
+	{
+		if (TSharedRef<FGeminiSession>* Session = Sessions.Find(Job->SessionKey))
+		{
+			(*Session)->CompleteTurn(Job->SessionTurn, Job->SessionPrompt, ResponseContent);
+		}
+	}
+
+	if (bSuccess)
+	{
+		double UpdateSeconds = 0.0;
+		{
+			GEMINI_STAGE_SCOPE("Gemini.UpdateUI", STAT_GeminiUpdateUI);
+			FGeminiStageTimer UpdateTimer(UpdateSeconds);
+			Job->Results = ParseLLMResponse(ResponseContent);
+			FinishJob(Job.ToSharedRef(), EGeminiPanelJobState::Succeeded, Job->Results.Details);
+		}
+
+		// The answer is shown even if it was cut off, but not as if it were complete
+		if (!ErrorMessage.IsEmpty())
+		{
+			StatusTextBlock->SetText(FText::FromString(ErrorMessage));
+		}
+		FGeminiTimingLog::Get().AddStageTime(RequestId, EGeminiTimingStage::UpdateUI, UpdateSeconds);
+
+		// The body itself is only logged by the client, to LogGeminiRaw and capped at RawLogMaxBytes
+		UE_LOG(LogGeminiAssistant, Verbose, TEXT("Gemini API Response: %d characters"), ResponseContent.Len());
+
+		// Written to the graph the question was about, even if another Blueprint is open by now
+		UBlueprint* JobBlueprint = Job->Blueprint.Get();
+		UEdGraph* JobGraph = Job->Graph.Get();
+		TArray<UEdGraphNode*> JobNodes;
+		for (const TWeakObjectPtr<UEdGraphNode>& Node : Job->Nodes)
+		{
+			if (Node.IsValid())
+			{
+				JobNodes.Add(Node.Get());
+			}
+		}
+
+		// A selection with deleted nodes no longer matches the summary
+		if (Job->bStoreSummary && JobGraph && JobNodes.Num() == Job->Nodes.Num())
+		{
+			FGeminiSummaryStore::Get().Put(JobGraph, JobNodes, Job->ContentHash, Job->Results.Summary, Job->Results.Details);
+		}
+
+		if (Job->bWriteComments && JobBlueprint && JobGraph && Job->Results.Summary.Len() > 1)
+		{
+			double WriteSeconds = 0.0;
+			{
+				FGeminiStageTimer WriteTimer(WriteSeconds);
+				AddCommentNodeToBlueprint(JobBlueprint, JobGraph, Job->Results.Summary, JobNodes);
+			}
+			FGeminiTimingLog::Get().AddStageTime(RequestId, EGeminiTimingStage::WriteComments, WriteSeconds);
+		}
+	}
+	else
+	{
+		FinishJob(Job.ToSharedRef(), EGeminiPanelJobState::Failed, FText::Format(LOCTEXT("GeminiError", "Gemini API Error: {0}"), FText::FromString(ErrorMessage)).ToString());
+		UE_LOG(LogGeminiAssistant, Error, TEXT("Gemini API Error: %s"), *ErrorMessage);
+	}
+}
+
+FReply GeminiAssistantPanel::OnCopyResponseClicked()
+{
+	if (ResponseView.IsValid())
+	{
+		const FString& ResponseText = ResponseView->GetText();
+		if (!ResponseText.IsEmpty())
+		{
+			FPlatformApplicationMisc::ClipboardCopy(*ResponseText);
+
+			// Optional: Show a notification that text was copied
+			FNotificationInfo Info(FText::FromString("Response copied to clipboard!"));
+			Info.ExpireDuration = 3.0f;
+			FSlateNotificationManager::Get().AddNotification(Info);
+		}
+	}
+	return FReply::Handled();
+}
+
+FReply GeminiAssistantPanel::OnSummarizeAllGraphsClicked()
+{
+	StatusTextBlock->SetText(FText::GetEmpty());
+	if (!GeminiClient.IsValid())
+	{
+		StatusTextBlock->SetText(LOCTEXT("ClientError", "Gemini API Client is not initialized."));
+		return FReply::Handled();
+	}
+
+	FString APIKey;
+	if (!GConfig->GetString(TEXT("GeminiAssistant"), TEXT("APIKey"), APIKey, GEditorPerProjectIni) && GeminiClient->GetBackendLimits().bRequiresAPIKey)
+	{
+		StatusTextBlock->SetText(LOCTEXT("APIKeyMissing", "Gemini API Key not found in config! Please add it to [GeminiAssistant] section in EditorPerProjectUserSettings.ini."));
+		return FReply::Handled();
+	}
+
+	UBlueprint* ActiveBlueprint = GetActiveBlueprint();
+	if (!ActiveBlueprint)
+	{
+		StatusTextBlock->SetText(LOCTEXT("NoBlueprintActive", "No Blueprint editor is currently active. Please open a Blueprint."));
+		return FReply::Handled();
+	}
+
+	// One task per event graph, function and macro; they are independent, so the client may pack them together
+	TArray<UEdGraph*> Graphs;
+	for (UEdGraph* Graph : ActiveBlueprint->UbergraphPages)
+	{
+		Graphs.Add(Graph);
+	}
+	for (UEdGraph* Graph : ActiveBlueprint->FunctionGraphs)
+	{
+		Graphs.Add(Graph);
+	}
+	for (UEdGraph* Graph : ActiveBlueprint->MacroGraphs)
+	{
+		Graphs.Add(Graph);
+	}
+
+	const FGeminiPromptTemplate GraphSummaryTemplate = FGeminiPromptTemplate::Load(TEXT("GraphSummary"));
+	TArray<FGeminiBatchTask> Tasks;
+	TMap<FString, FString> GraphContentHashes;
+	double PreprocessSeconds = 0.0;
+	for (UEdGraph* Graph : Graphs)
+	{
+		if (!Graph)
+		{
+			continue;
+		}
+
+		TArray<UEdGraphNode*> GraphNodes;
+		for (UEdGraphNode* Node : Graph->Nodes)
+		{
+			if (Node && IsValid(Node))
+			{
+				GraphNodes.Add(Node);
+			}
+		}
+		FString NodesData;
+		{
+			FGeminiStageTimer PreprocessTimer(PreprocessSeconds);
+			NodesData = ExtractNodeDataForGemini(GraphNodes);
+		}
+		if (NodesData.IsEmpty())
+		{
+			continue;
+		}
+
+		FGeminiBatchTask& Task = Tasks.AddDefaulted_GetRef();
+		Task.Id = Graph->GetName();
+		GraphContentHashes.Add(Task.Id, FGeminiSummaryStore::MakeContentHash(Graph, {}));
+		FStringFormatNamedArguments TaskArguments;
+		TaskArguments.Add(TEXT("Graph"), Graph->GetName());
+		TaskArguments.Add(TEXT("Blueprint"), ActiveBlueprint->GetName());
+		Task.Prompt = GraphSummaryTemplate.GetPrefix(false) + TEXT("Blueprint Graph Data: ") + NodesData + TEXT("\n") + GraphSummaryTemplate.FormatTask(TaskArguments);
+	}
+
+	if (Tasks.Num() == 0)
+	{
+		StatusTextBlock->SetText(LOCTEXT("NoGraphsToSummarize", "The Blueprint has no graphs with processable nodes."));
+		return FReply::Handled();
+	}
+
+	// The pass has no profile of its own; a downgrade only matters once a budget is used up
+	const FString UsageSource = FGeminiUsageTracker::MakeSource(ActiveBlueprint->GetPathName(), FString());
+	FString ProfileName;
+	if (!CheckUsageBudget(UsageSource, ProfileName))
+	{
+		return FReply::Handled();
+	}
+
+	// Very large runs go to the offline Batch API: slower, but cheaper and outside the interactive quota
+	int32 BatchJobMinGraphs = 100;
+	GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("BatchJobMinGraphs"), BatchJobMinGraphs, GEditorPerProjectIni);
+
+	// A new pass replaces the one still running for the same Blueprint
+	const FString SupersessionKey = FString::Printf(TEXT("Panel|AllGraphs|%s"), *ActiveBlueprint->GetPathName());
+	for (const TSharedPtr<FGeminiPanelJob>& Job : TArray<TSharedPtr<FGeminiPanelJob>>(Jobs))
+	{
+		if (Job->IsRunning() && Job->SupersessionKey == SupersessionKey)
+		{
+			CancelJob(Job.ToSharedRef(), LOCTEXT("JobSuperseded", "Replaced by a newer request."));
+		}
+	}
+
+	TSharedRef<FGeminiPanelJob> Job = AddJob(FString::Printf(TEXT("%s: all graphs"), *ActiveBlueprint->GetName()));
+	Job->Blueprint = ActiveBlueprint;
+	Job->SupersessionKey = SupersessionKey;
+	Job->bStoreSummary = true;
+	Job->GraphContentHashes = MoveTemp(GraphContentHashes);
+	const FGeminiBatchDelegate OnComplete = FGeminiBatchDelegate::CreateSP(this, &GeminiAssistantPanel::OnGraphSummariesComplete, Job->Id);
+
+	if (BatchJobMinGraphs > 0 && Tasks.Num() >= BatchJobMinGraphs && GeminiClient->GetBackendLimits().bSupportsBatchJobs)
+	{
+		SetJobText(*Job, FText::Format(LOCTEXT("SummarizingGraphsBatchJob", "Submitted {0} graphs as a Gemini batch job. Results can take a while; keep this panel open."), Tasks.Num()).ToString());
+		const FGeminiRequestHandle BatchJob = GeminiClient->SubmitBatchJob(Tasks, APIKey, OnComplete);
+		if (BatchJob.IsValid())
+		{
+			Job->BatchRequests.Add(BatchJob);
+		}
+	}
+	else
+	{
+		SetJobText(*Job, FText::Format(LOCTEXT("SummarizingGraphs", "Summarizing {0} graphs with Gemini..."), Tasks.Num()).ToString());
+
+		// Background documentation work yields to interactive questions
+		FGeminiRequestOptions Options;
+		Options.Priority = EGeminiRequestPriority::Low;
+		Options.SupersessionKey = SupersessionKey;
+		Options.UsageSource = UsageSource;
+		if (!ProfileName.IsEmpty())
+		{
+			FGeminiModelRouter(GeminiClient->GetBackendLimits()).Apply(0, FGeminiGenerationProfile::Load(ProfileName), Options);
+			GraphSummaryTemplate.ApplyOutputCap(Options.GenerationConfig);
+		}
+		Job->BatchRequests = GeminiClient->GenerateContentBatch(Tasks, APIKey, OnComplete, Options);
+	}
+	Job->NumBatchRequests = Job->BatchRequests.Num();
+	AddJobStageTime(*Job, EGeminiTimingStage::PreprocessNodes, PreprocessSeconds);
+
+	return FReply::Handled();
+}
+
+void GeminiAssistantPanel::SubmitChunkedSummary(const TSharedRef<FGeminiPanelJob>& Job, UBlueprint* InBlueprint, const TArray<UEdGraphNode*>& InNodes, int32 NumChunks, const FString& APIKey, const FGeminiRequestOptions& Options)
+{
+	// Consecutive runs of nodes keep most connections inside one part
+	NumChunks = FMath::Clamp(NumChunks, 1, InNodes.Num());
+	const FGeminiPromptTemplate GraphPartTemplate = FGeminiPromptTemplate::Load(TEXT("GraphPart"));
+	const int32 NodesPerChunk = FMath::DivideAndRoundUp(InNodes.Num(), NumChunks);
+	TArray<FGeminiBatchTask> Tasks;
+	double PreprocessSeconds = 0.0;
+	for (int32 Start = 0; Start < InNodes.Num(); Start += NodesPerChunk)
+	{
+		TArray<UEdGraphNode*> ChunkNodes;
+		for (int32 Index = Start; Index < FMath::Min(Start + NodesPerChunk, InNodes.Num()); ++Index)
+		{
+			ChunkNodes.Add(InNodes[Index]);
+		}
+
+		FGeminiBatchTask& Task = Tasks.AddDefaulted_GetRef();
+		Task.Id = FString::Printf(TEXT("Part %d of %d"), Tasks.Num(), NumChunks);
+		FStringFormatNamedArguments TaskArguments;
+		TaskArguments.Add(TEXT("Part"), Tasks.Num());
+		TaskArguments.Add(TEXT("NumParts"), NumChunks);
+		TaskArguments.Add(TEXT("Blueprint"), InBlueprint->GetName());
+		FString NodesData;
+		{
+			FGeminiStageTimer PreprocessTimer(PreprocessSeconds);
+			NodesData = ExtractNodeDataForGemini(ChunkNodes);
+		}
+		Task.Prompt = GraphPartTemplate.GetPrefix(false) + TEXT("Blueprint Graph Data: ") + NodesData + TEXT("\n") + GraphPartTemplate.FormatTask(TaskArguments);
+	}
+
+	SetJobText(*Job, FText::Format(LOCTEXT("SummarizingInParts", "The graph is too large for one request, summarizing it in {0} parts..."), Tasks.Num()).ToString());
+	Job->BatchRequests = GeminiClient->GenerateContentBatch(Tasks, APIKey,
+		FGeminiBatchDelegate::CreateSP(this, &GeminiAssistantPanel::OnGraphSummariesComplete, Job->Id), Options);
+	Job->NumBatchRequests = Job->BatchRequests.Num();
+	AddJobStageTime(*Job, EGeminiTimingStage::PreprocessNodes, PreprocessSeconds);
+}
+
+void GeminiAssistantPanel::OnGraphSummariesComplete(const TArray<FGeminiBatchTaskResult>& Results, int32 JobId)
+{
+	TSharedPtr<FGeminiPanelJob> Job = FindJob(JobId);
+	if (!Job.IsValid() || !Job->IsRunning())
+	{
+		return;
+	}
+
+	int32 NumFailed = 0;
+	double UpdateSeconds = 0.0;
+	{
+		GEMINI_STAGE_SCOPE("Gemini.UpdateUI", STAT_GeminiUpdateUI);
+		FGeminiStageTimer UpdateTimer(UpdateSeconds);
+		FString Combined;
+		for (const FGeminiBatchTaskResult& Result : Results)
+		{
+			Combined += FString::Printf(TEXT("%s:\n%s\n\n"), *Result.Id, Result.bSuccess ? *Result.Text : *FString::Printf(TEXT("(failed: %s)"), *Result.ErrorMessage));
+			NumFailed += Result.bSuccess ? 0 : 1;
+		}
+		FinishJob(Job.ToSharedRef(), NumFailed < Results.Num() ? EGeminiPanelJobState::Succeeded : EGeminiPanelJobState::Failed, Combined.TrimEnd());
+	}
+	AddJobStageTime(*Job, EGeminiTimingStage::UpdateUI, UpdateSeconds);
+	UE_LOG(LogGeminiAssistant, Log, TEXT("Gemini Blueprint Assistant: Summarized %d graphs, %d failed"), Results.Num(), NumFailed);
+
+	// Results of Summarize All Graphs are keyed by graph name
+	UBlueprint* JobBlueprint = Job->Blueprint.Get();
+	if (Job->bStoreSummary && JobBlueprint)
+	{
+		TArray<UEdGraph*> Graphs;
+		JobBlueprint->GetAllGraphs(Graphs);
+		for (const FGeminiBatchTaskResult& Result : Results)
+		{
+			UEdGraph** Graph = Graphs.FindByPredicate([&Result](const UEdGraph* Candidate) { return Candidate->GetName() == Result.Id; });
+			const FString* ContentHash = Job->GraphContentHashes.Find(Result.Id);
+			if (Result.bSuccess && Graph && ContentHash)
+			{
+				FGeminiSummaryStore::Get().Put(*Graph, {}, *ContentHash, FString(), Result.Text.TrimStartAndEnd());
+			}
+		}
+	}
+}
+
+FReply GeminiAssistantPanel::OnAnnotateClustersClicked()
+{
+	StatusTextBlock->SetText(FText::GetEmpty());
+	if (!GeminiClient.IsValid())
+	{
+		StatusTextBlock->SetText(LOCTEXT("ClientError", "Gemini API Client is not initialized."));
+		return FReply::Handled();
+	}
+
+	FString APIKey;
+	if (!GConfig->GetString(TEXT("GeminiAssistant"), TEXT("APIKey"), APIKey, GEditorPerProjectIni) && GeminiClient->GetBackendLimits().bRequiresAPIKey)
+	{
+		StatusTextBlock->SetText(LOCTEXT("APIKeyMissing", "Gemini API Key not found in config! Please add it to [GeminiAssistant] section in EditorPerProjectUserSettings.ini."));
+		return FReply::Handled();
+	}
+
+	UBlueprint* ActiveBlueprint = GetActiveBlueprint();
+	UEdGraph* FocusedGraph = ActiveBlueprint ? GetFocusedGraph(ActiveBlueprint) : nullptr;
+	if (!FocusedGraph)
+	{
+		StatusTextBlock->SetText(LOCTEXT("NoBlueprintActive", "No Blueprint editor is currently active. Please open a Blueprint."));
+		return FReply::Handled();
+	}
+
+	// Clustering is local; only the clusters' node data goes to Gemini
+	const TArray<FGeminiNodeCluster> Clusters = FGeminiGraphClusterer().Cluster(FocusedGraph);
+	if (Clusters.Num() == 0)
+	{
+		StatusTextBlock->SetText(LOCTEXT("NoClustersToAnnotate", "Every part of the graph is inside a comment already, or too small to get one."));
+		return FReply::Handled();
+	}
+
+	const FString UsageSource = FGeminiUsageTracker::MakeSource(ActiveBlueprint->GetPathName(), FocusedGraph->GetName());
+	FString ProfileName = TEXT("fast");
+	GConfig->GetString(TEXT("GeminiAssistant"), TEXT("Profile"), ProfileName, GEditorPerProjectIni);
+	if (!CheckUsageBudget(UsageSource, ProfileName))
+	{
+		return FReply::Handled();
+	}
+
+	// Clusters are numbered across the whole graph, so answers map back to them however the prompt is split
+	TArray<FString> ClusterData;
+	int32 NumNodes = 0;
+	int32 EstimatedTokens = 0;
+	double PreprocessSeconds = 0.0;
+	for (int32 Index = 0; Index < Clusters.Num(); ++Index)
+	{
+		{
+			FGeminiStageTimer PreprocessTimer(PreprocessSeconds);
+			ClusterData.Add(FString::Printf(TEXT("CLUSTER %d:\n%s\n"), Index + 1, *ExtractNodeDataForGemini(Clusters[Index].Nodes)));
+		}
+		EstimatedTokens += FGeminiTokenEstimator::EstimateTokens(ClusterData.Last());
+		NumNodes += Clusters[Index].Nodes.Num();
+	}
+
+	FGeminiRequestOptions Options;
+	Options.Priority = EGeminiRequestPriority::High;
+	Options.SupersessionKey = FString::Printf(TEXT("Panel|Clusters|%s"), *UsageSource);
+	Options.UsageSource = UsageSource;
+	const FGeminiRoute Route = FGeminiModelRouter(GeminiClient->GetBackendLimits()).Apply(EstimatedTokens, FGeminiGenerationProfile::Load(ProfileName), Options);
+
+	// One request for all clusters; only graphs beyond every context window are sent as several, side by side
+	const FGeminiPromptTemplate Template = FGeminiPromptTemplate::Load(TEXT("Clusters"));
+	const int32 NumParts = Route.bNeedsChunking ? FMath::Clamp(Route.NumChunks, 1, Clusters.Num()) : 1;
+	const int32 ClustersPerPart = FMath::DivideAndRoundUp(Clusters.Num(), NumParts);
+	TArray<FGeminiBatchTask> Tasks;
+	for (int32 Start = 0; Start < Clusters.Num(); Start += ClustersPerPart)
+	{
+		const int32 End = FMath::Min(Start + ClustersPerPart, Clusters.Num());
+		FGeminiBatchTask& Task = Tasks.AddDefaulted_GetRef();
+		Task.Id = FString::Printf(TEXT("Clusters %d to %d"), Start + 1, End);
+		Task.Prompt = Template.GetPrefix(false) + TEXT("Blueprint Graph Data:\n");
+		for (int32 Index = Start; Index < End; ++Index)
+		{
+			Task.Prompt += ClusterData[Index];
+		}
+		FStringFormatNamedArguments TaskArguments;
+		TaskArguments.Add(TEXT("Graph"), FocusedGraph->GetName());
+		TaskArguments.Add(TEXT("Blueprint"), ActiveBlueprint->GetName());
+		TaskArguments.Add(TEXT("NumClusters"), End - Start);
+		Task.Prompt += Template.FormatTask(TaskArguments);
+	}
+
+	for (const TSharedPtr<FGeminiPanelJob>& Job : TArray<TSharedPtr<FGeminiPanelJob>>(Jobs))
+	{
+		if (Job->IsRunning() && Job->SupersessionKey == Options.SupersessionKey)
+		{
+			CancelJob(Job.ToSharedRef(), LOCTEXT("JobSuperseded", "Replaced by a newer request."));
+		}
+	}
+
+	TSharedRef<FGeminiPanelJob> Job = AddJob(FString::Printf(TEXT("%s: %s clusters"), *ActiveBlueprint->GetName(), *FocusedGraph->GetName()));
+	Job->Blueprint = ActiveBlueprint;
+	Job->Graph = FocusedGraph;
+	Job->SupersessionKey = Options.SupersessionKey;
+	for (const FGeminiNodeCluster& Cluster : Clusters)
+	{
+		TArray<TWeakObjectPtr<UEdGraphNode>>& ClusterNodes = Job->Clusters.AddDefaulted_GetRef();
+		for (UEdGraphNode* Node : Cluster.Nodes)
+		{
+			ClusterNodes.Add(Node);
+		}
+	}
+
+	SetJobText(*Job, FText::Format(LOCTEXT("AnnotatingClusters", "Writing comments for {0} clusters of {1} nodes with Gemini..."), Clusters.Num(), NumNodes).ToString());
+	Job->BatchRequests = GeminiClient->GenerateContentBatch(Tasks, APIKey,
+		FGeminiBatchDelegate::CreateSP(this, &GeminiAssistantPanel::OnClustersAnnotated, Job->Id), Options);
+	Job->NumBatchRequests = Job->BatchRequests.Num();
+	AddJobStageTime(*Job, EGeminiTimingStage::PreprocessNodes, PreprocessSeconds);
+	return FReply::Handled();
+}
+
+void GeminiAssistantPanel::OnClustersAnnotated(const TArray<FGeminiBatchTaskResult>& Results, int32 JobId)
+{
+	TSharedPtr<FGeminiPanelJob> Job = FindJob(JobId);
+	if (!Job.IsValid() || !Job->IsRunning())
+	{
+		return;
+	}
+
+	TMap<int32, FString> Comments;
+	FString Failures;
+	for (const FGeminiBatchTaskResult& Result : Results)
+	{
+		if (Result.bSuccess)
+		{
+			Comments.Append(FGeminiGraphClusterer::ParseClusterComments(Result.Text));
+		}
+		else
+		{
+			Failures += FString::Printf(TEXT("%s: (failed: %s)\n"), *Result.Id, *Result.ErrorMessage);
+		}
+	}
+
+	// Every comment in one transaction, so a single undo removes them all
+	FGeminiCommentWriter CommentWriter(Job->Blueprint.Get(), Job->Graph.Get());
+	FString Report;
+	for (int32 Index = 0; Index < Job->Clusters.Num(); ++Index)
+	{
+		TArray<UEdGraphNode*> ClusterNodes;
+		for (const TWeakObjectPtr<UEdGraphNode>& Node : Job->Clusters[Index])
+		{
+			if (Node.IsValid())
+			{
+				ClusterNodes.Add(Node.Get());
+			}
+		}
+		const FString* Comment = Comments.Find(Index + 1);
+		if (Comment && ClusterNodes.Num() > 0)
+		{
+			CommentWriter.Add(*Comment, ClusterNodes);
+			Report += FString::Printf(TEXT("Cluster %d (%d nodes): %s\n"), Index + 1, ClusterNodes.Num(), **Comment);
+		}
+	}
+	double WriteSeconds = 0.0;
+	int32 NumWritten = 0;
+	{
+		FGeminiStageTimer WriteTimer(WriteSeconds);
+		NumWritten = CommentWriter.Write(LOCTEXT("AddGeminiClusterComments", "Add Gemini Cluster Comments")).Num();
+	}
+	AddJobStageTime(*Job, EGeminiTimingStage::WriteComments, WriteSeconds);
+
+	const FString Text = FString::Printf(TEXT("Wrote %d of %d cluster comments.\n\n%s%s"), NumWritten, Job->Clusters.Num(), *Report, *Failures);
+	FinishJob(Job.ToSharedRef(), NumWritten > 0 ? EGeminiPanelJobState::Succeeded : EGeminiPanelJobState::Failed, Text.TrimEnd());
+	UE_LOG(LogGeminiAssistant, Log, TEXT("Gemini Blueprint Assistant: Wrote %d of %d cluster comments"), NumWritten, Job->Clusters.Num());
+}
+
+FReply GeminiAssistantPanel::OnClearClicked()
+{
+	// Finished jobs and their tabs go, running ones stay
+	for (const TSharedPtr<FGeminiPanelJob>& Job : TArray<TSharedPtr<FGeminiPanelJob>>(Jobs))
+	{
+		if (!Job->IsRunning())
+		{
+			RemoveJob(Job.ToSharedRef());
+		}
+	}
+	StatusTextBlock->SetText(FText::GetEmpty());
+
+	// The next question starts new conversations with the whole graph
+	Sessions.Empty();
+	return FReply::Handled();
+}
 
-	CurrentPromptText = FText::GetEmpty();
+FReply GeminiAssistantPanel::OnUsageClicked()
+{
+	TSharedRef<FGeminiPanelJob> Job = AddJob(TEXT("Usage"));
+	FinishJob(Job, EGeminiPanelJobState::Succeeded, FGeminiUsageTracker::Get().FormatReport(30, 10));
+	return FReply::Handled();
 }
-END_SLATE_FUNCTION_BUILD_OPTIMIZATION
 
-FReply GeminiAssistantPanel::OnProcessButtonClicked()
+void GeminiAssistantPanel::ShowAutoSummaries(const FString& BlueprintPath)
 {
-	/*
-	if (CurrentPromptText.IsEmpty())
+	UBlueprint* Blueprint = FindObject<UBlueprint>(nullptr, *BlueprintPath);
+	const TArray<FGeminiStoredSummary> Summaries = FGeminiSummaryStore::Get().GetGraphSummaries(Blueprint);
+	if (Summaries.Num() == 0)
 	{
-		ResponseTextBlock->SetText(LOCTEXT("EmptyPromptWarning", "Please enter a prompt."));
-		return FReply::Handled();
+		return;
 	}
-	*/
-	CopyButton.Get()->SetVisibility(EVisibility::Collapsed);
-	ClearButton.Get()->SetVisibility(EVisibility::Collapsed);
-	ProcessButton.Get()->SetVisibility(EVisibility::Hidden);
-	ResponseTextBlock->SetText(LOCTEXT("ProcessingRequest", "Sending request to Gemini..."));
-	UE_LOG(LogTemp, Log, TEXT("Gemini Blueprint Assistant: Process button clicked. Prompt: %s"), *CurrentPromptText.ToString());
 
-	FString APIKey;
-	if (!GConfig->GetString(TEXT("GeminiAssistant"), TEXT("APIKey"), APIKey, GEditorPerProjectIni))
+	const FString SupersessionKey = FString::Printf(TEXT("Auto|%s"), *BlueprintPath);
+	for (const TSharedPtr<FGeminiPanelJob>& Job : TArray<TSharedPtr<FGeminiPanelJob>>(Jobs))
 	{
-		ResponseTextBlock->SetText(LOCTEXT("APIKeyMissing", "Gemini API Key not found in config! Please add it to [GeminiAssistant] section in EditorPerProjectUserSettings.ini."));
-		UE_LOG(LogTemp, Error, TEXT("GeminiAPIClient: API Key not found in config."));
-		return FReply::Handled();
+		if (Job->SupersessionKey == SupersessionKey)
+		{
+			RemoveJob(Job.ToSharedRef());
+		}
+	}
+
+	// Same layout as the results of Summarize All Graphs
+	FString Combined;
+	for (const FGeminiStoredSummary& Summary : Summaries)
+	{
+		Combined += FString::Printf(TEXT("%s:\n%s\n\n"), *Summary.GraphName, *Summary.GetText());
 	}
+	TSharedRef<FGeminiPanelJob> Job = AddJob(FString::Printf(TEXT("%s: stored summaries"), *FPackageName::ObjectPathToObjectName(BlueprintPath)));
+	Job->SupersessionKey = SupersessionKey;
+	FinishJob(Job, EGeminiPanelJobState::Succeeded, Combined.TrimEnd());
+}
 
+void GeminiAssistantPanel::OnAutoSummaryUpdated(const FString& BlueprintPath)
+{
+	// Only the Blueprint being looked at; summaries of the others wait until the panel is opened on them
 	UBlueprint* ActiveBlueprint = GetActiveBlueprint();
-	if (!ActiveBlueprint)
+	if (ActiveBlueprint && ActiveBlueprint->GetPathName() == BlueprintPath)
 	{
-		ResponseTextBlock->SetText(LOCTEXT("NoBlueprintActive", "No Blueprint editor is currently active. Please open a Blueprint."));
-		UE_LOG(LogTemp, Error, TEXT("GeminiBlueprintAssistant: No active Blueprint found."));
-		return FReply::Handled();
+		ShowAutoSummaries(BlueprintPath);
 	}
+}
 
-	SelectedNodes = GetSelectedBlueprintNodes(ActiveBlueprint);
-	FString NodesData = ExtractNodeDataForGemini(SelectedNodes);
-	CachedBlueprint = ActiveBlueprint;
-	CachedFocusedGraph = GetFocusedGraph(ActiveBlueprint);
-	FString PromptToSend;
-	if (SelectedNodes.Num() == 0)
+bool GeminiAssistantPanel::CheckUsageBudget(const FString& UsageSource, FString& InOutProfileName)
+{
+	FString BudgetMessage;
+	bool bFirstWarning = false;
+	FGeminiUsageTracker& Usage = FGeminiUsageTracker::Get();
+	const EGeminiBudgetStatus Status = Usage.CheckBudget(UsageSource, BudgetMessage, bFirstWarning);
+	if (Status == EGeminiBudgetStatus::WithinBudget)
 	{
-		TArray<UEdGraphNode*> NodesToProcess = GetAllNodesFromActiveGraph(ActiveBlueprint);
-		NodesData = ExtractNodeDataForGemini(NodesToProcess);
+		return true;
+	}
 
-		if (NodesData.IsEmpty())
-		{
-			PromptToSend = FString::Printf(TEXT("Summarize the main purpose of the Blueprint named '%s'. The graph appears to be empty or has no processable nodes. Please respond in this exact format :  DETAILS: [summarise the blueprint in a user-friendly manner with available information]."),
-				*ActiveBlueprint->GetName(),
-				CurrentPromptText.IsEmpty() ? TEXT("") : *FString::Printf(TEXT("\nUser Query: %s"), *CurrentPromptText.ToString()));
-		}
-		else
+	if (Status == EGeminiBudgetStatus::Warning)
+	{
+		if (bFirstWarning)
 		{
-			PromptToSend = FString::Printf(TEXT("Given the following Unreal Engine Blueprint graph from Blueprint '%s', summarize the entire graph's purpose and functionality. Please respond in this exact format :  DETAILS: [summarise the nodes in user-friendly manner]\nSUMMARY:[keep empty]. Blueprint Graph Data: %s\n"),
-				*ActiveBlueprint->GetName(), *NodesData, 
-				CurrentPromptText.IsEmpty() ? TEXT("") : *FString::Printf(TEXT("\nUser Query: %s"), *CurrentPromptText.ToString()));
+			FNotificationInfo Info(FText::Format(LOCTEXT("BudgetWarning", "Gemini token budget almost used up. {0}"), FText::FromString(BudgetMessage)));
+			Info.ExpireDuration = 8.0f;
+			FSlateNotificationManager::Get().AddNotification(Info);
 		}
-		ResponseTextBlock->SetText(LOCTEXT("SummarizingEntireGraph", "Summarizing entire Blueprint graph with Gemini..."));
+		return true;
 	}
-	else
+
+	if (Usage.GetBudgetAction() == EGeminiBudgetAction::Block)
 	{
-		PromptToSend = FString::Printf(TEXT("Given the following Unreal Engine Blueprint nodes from Blueprint '%s', summarize their collective purpose and Please respond in this exact format :  DETAILS: [summarise the selected nodes in user-friendly manner] \nSUMMARY: [concise one-line summary]. Blueprint Graph Nodes Data: %s\n"),
-			*ActiveBlueprint->GetName(), *NodesData, 
-			CurrentPromptText.IsEmpty() ? TEXT("") : *FString::Printf(TEXT("\nUser Query: %s"), *CurrentPromptText.ToString()));
-		ResponseTextBlock->SetText(LOCTEXT("SummarizingSelected", "Summarizing selected Blueprint nodes with Gemini..."));
+		StatusTextBlock->SetText(FText::Format(LOCTEXT("BudgetExceeded", "Gemini token budget used up, request not sent. {0}"), FText::FromString(BudgetMessage)));
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiBlueprintAssistant: Request blocked. %s"), *BudgetMessage);
+		return false;
 	}
-	PromptToSend += "\nRespond as if you're writing for a basic text display that cannot render formatting - use only letters, numbers, basic punctuation, and spaces.";
-	if (GeminiClient.IsValid())
+
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiBlueprintAssistant: %s, using profile '%s' instead of '%s'"), *BudgetMessage, *Usage.GetDowngradeProfile(), *InOutProfileName);
+	InOutProfileName = Usage.GetDowngradeProfile();
+	return true;
+}
+
+// --- JOBS ---
+
+TSharedRef<FGeminiPanelJob> GeminiAssistantPanel::AddJob(const FString& Title)
+{
+	TSharedRef<FGeminiPanelJob> Job = MakeShared<FGeminiPanelJob>();
+	Job->Id = NextJobId++;
+	Job->Title = Title;
+	Job->StartTime = FPlatformTime::Seconds();
+	Jobs.Add(Job);
+	RefreshJobViews();
+
+	// The job just started is the one the user wants to watch
+	ShowJob(Job);
+	return Job;
+}
+
+TSharedPtr<FGeminiPanelJob> GeminiAssistantPanel::FindJob(int32 JobId) const
+{
+	const TSharedPtr<FGeminiPanelJob>* Found = Jobs.FindByPredicate([JobId](const TSharedPtr<FGeminiPanelJob>& Job) { return Job->Id == JobId; });
+	return Found ? *Found : nullptr;
+}
+
+void GeminiAssistantPanel::CancelJob(const TSharedRef<FGeminiPanelJob>& Job, const FText& Reason)
+{
+	if (!Job->IsRunning())
 	{
-		GeminiClient->GenerateContent(PromptToSend, APIKey);
+		return;
 	}
-	else
+	if (GeminiClient.IsValid())
 	{
-		ResponseTextBlock->SetText(LOCTEXT("ClientError", "Gemini API Client is not initialized."));
-		UE_LOG(LogTemp, Error, TEXT("GeminiAPIClient: Client not valid!"));
+		GeminiClient->CancelRequest(Job->Request);
+		for (const FGeminiRequestHandle& BatchRequest : Job->BatchRequests)
+		{
+			GeminiClient->CancelRequest(BatchRequest);
+		}
 	}
-	
-	return FReply::Handled();
+	FinishJob(Job, EGeminiPanelJobState::Cancelled, Reason.ToString());
 }
 
-void GeminiAssistantPanel::OnPromptTextChanged(const FText& InText)
+void GeminiAssistantPanel::FinishJob(const TSharedRef<FGeminiPanelJob>& Job, EGeminiPanelJobState State, const FString& Text)
 {
-	CurrentPromptText = InText;
+	Job->State = State;
+	Job->EndTime = FPlatformTime::Seconds();
+	Job->StreamedText.Empty();
+	Job->StreamingDetails = FGeminiStreamingDetails();
+	SetJobText(*Job, Text);
 }
 
-void GeminiAssistantPanel::OnPromptTextCommitted(const FText& InText, ETextCommit::Type InCommitType)
+void GeminiAssistantPanel::RemoveJob(const TSharedRef<FGeminiPanelJob>& Job)
 {
-	if (InCommitType == ETextCommit::OnEnter)
+	CancelJob(Job, FText::GetEmpty());
+	const int32 Index = Jobs.IndexOfByKey(TSharedPtr<FGeminiPanelJob>(Job));
+	Jobs.RemoveAt(Index);
+	if (ShownJob == Job)
 	{
-		OnProcessButtonClicked();
+		ShowJob(Jobs.IsValidIndex(Index) ? Jobs[Index] : (Jobs.Num() > 0 ? Jobs.Last() : nullptr));
 	}
+	RefreshJobViews();
 }
 
-void GeminiAssistantPanel::OnGeminiResponse(FString ResponseContent, bool bSuccess, FString ErrorMessage)
+void GeminiAssistantPanel::SetJobText(FGeminiPanelJob& Job, const FString& Text)
 {
-	if (bSuccess)
+	Job.DisplayText = Text;
+	if (ShownJob.Get() == &Job)
 	{
-		Results = ParseLLMResponse(ResponseContent);
-		ResponseTextBlock->SetText(FText::FromString(Results.Details));
-		UE_LOG(LogTemp, Log, TEXT("Gemini API Response: %s"), *ResponseContent);
+		ResponseView->SetText(Text);
+	}
+}
 
-		UBlueprint* ActiveBlueprint = GetActiveBlueprint();
-		// Ensure there's an active blueprint and at least one graph (UbergraphPages[0] is typically the Event Graph)
-		if (WriteCommentsCheckBox->IsChecked())
+void GeminiAssistantPanel::AddStreamedChunk(FGeminiPanelJob& Job, const FString& ChunkText, SGeminiResponseView* View)
+{
+	// Show only the DETAILS part while streaming; the SUMMARY is meant for the comment node
+	const bool bFirstChunk = Job.StreamedText.IsEmpty();
+	Job.StreamedText += ChunkText;
+	FString AppendedDetails;
+	if (!Job.StreamingDetails.Update(Job.StreamedText, AppendedDetails) || bFirstChunk)
+	{
+		// Replaces the "Summarizing..." text, or details that turned out to be a preface
+		Job.DisplayText = Job.StreamingDetails.GetDetails();
+		if (View)
 		{
-			if (CachedFocusedGraph && CachedBlueprint)
-			// Add comment to the first graph (usually Event Graph) for simplicity
-				Results.Summary.Len() > 1 ? AddCommentNodeToBlueprint(CachedBlueprint, CachedFocusedGraph, Results.Summary) : (void)0;
+			View->SetText(Job.DisplayText);
 		}
 	}
-	else
+	else if (!AppendedDetails.IsEmpty())
 	{
-		ResponseTextBlock->SetText(FText::Format(LOCTEXT("GeminiError", "Gemini API Error: {0}"), FText::FromString(ErrorMessage)));
-		UE_LOG(LogTemp, Error, TEXT("Gemini API Error: %s"), *ErrorMessage);
+		Job.DisplayText += AppendedDetails;
+		if (View)
+		{
+			View->AppendText(AppendedDetails);
+		}
 	}
-	ProcessButton.Get()->SetVisibility(EVisibility::Visible);
-	CopyButton.Get()->SetVisibility(EVisibility::Visible);
-	ClearButton.Get()->SetVisibility(EVisibility::Visible);
-	CachedFocusedGraph = nullptr;
-	CachedBlueprint = nullptr;
-	SelectedNodes.Empty();
 }
 
-FReply GeminiAssistantPanel::OnCopyResponseClicked()
+void GeminiAssistantPanel::AddJobStageTime(const FGeminiPanelJob& Job, EGeminiTimingStage Stage, double Seconds) const
 {
-	if (ResponseTextBlock.IsValid())
+	if (Job.Request.IsValid() || Job.BatchRequests.Num() == 0)
 	{
-		FString ResponseText = ResponseTextBlock->GetText().ToString();
-		if (!ResponseText.IsEmpty())
-		{
-			FPlatformApplicationMisc::ClipboardCopy(*ResponseText);
-
-			// Optional: Show a notification that text was copied
-			FNotificationInfo Info(FText::FromString("Response copied to clipboard!"));
-			Info.ExpireDuration = 3.0f;
-			FSlateNotificationManager::Get().AddNotification(Info);
-		}
+		FGeminiTimingLog::Get().AddStageTime(Job.Request.Id, Stage, Seconds);
+		return;
 	}
-	return FReply::Handled();
-}
 
-FReply GeminiAssistantPanel::OnClearClicked()
-{
-	if (ResponseTextBlock.IsValid())
+	// Shared work of a batched job is split evenly, so the stage still adds up to its real time across the CSV
+	for (const FGeminiRequestHandle& BatchRequest : Job.BatchRequests)
 	{
-		ResponseTextBlock->SetText(FText::FromString(""));
+		FGeminiTimingLog::Get().AddStageTime(BatchRequest.Id, Stage, Seconds / Job.BatchRequests.Num());
 	}
-	return FReply::Handled();
 }
 
-
-// --- BLUEPRINT INTERACTION FUNCTIONS ---
-
-UBlueprint* GeminiAssistantPanel::GetActiveBlueprint() const
+void GeminiAssistantPanel::ShowJob(const TSharedPtr<FGeminiPanelJob>& Job)
 {
-	if (GEditor)
+	ShownJob = Job;
+	ResponseView->SetText(Job.IsValid() ? Job->DisplayText : LOCTEXT("InitialResponseText", "Response will appear here...").ToString());
+	if (!Job.IsValid())
 	{
-		// The UAssetEditorSubsystem manages all currently open asset editors.
-		// It's exposed via GEditor and is part of the UnrealEd module.
-		UAssetEditorSubsystem* AssetEditorSubsystem = GEditor->GetEditorSubsystem<UAssetEditorSubsystem>();
-		if (AssetEditorSubsystem)
-		{
-			// Get all currently edited assets.
-			TArray<UObject*> EditedAssets = AssetEditorSubsystem->GetAllEditedAssets();
-			for (UObject* Asset : EditedAssets)
-			{
-				// Try to cast each edited asset to a UBlueprint.
-				if (UBlueprint* Blueprint = Cast<UBlueprint>(Asset))
-				{
-					return Blueprint;
-				}
-			}
-		}
+		JobListView->ClearSelection();
+	}
+	else if (!JobListView->IsItemSelected(Job))
+	{
+		JobListView->SetSelection(Job, ESelectInfo::Direct);
 	}
-	return nullptr; 
 }
 
-UEdGraph* GeminiAssistantPanel::GetFocusedGraph(UBlueprint* InBlueprint)
+FText GeminiAssistantPanel::GetJobStageText(const FGeminiPanelJob& Job) const
 {
-	FBlueprintEditorModule& BlueprintEditorModule = FModuleManager::LoadModuleChecked<FBlueprintEditorModule>("Kismet");
+	switch (Job.State)
+	{
+	case EGeminiPanelJobState::Succeeded: return LOCTEXT("JobDone", "Done");
+	case EGeminiPanelJobState::Failed: return LOCTEXT("JobFailed", "Failed");
+	case EGeminiPanelJobState::Cancelled: return LOCTEXT("JobCancelled", "Cancelled");
+	default: break;
+	}
 
-	UEdGraph* FocusedGraph;
-	// Find the specific Blueprint editor instance that is editing our InBlueprint.
-	for (TSharedRef<IBlueprintEditor> BlueprintEditorInstance : BlueprintEditorModule.GetBlueprintEditors())
+	if (Job.NumBatchRequests > 0)
 	{
-#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 2
-		FocusedGraph = BlueprintEditorInstance->GetFocusedGraph();
-#else
-		FocusedGraph = (StaticCastSharedRef<FBlueprintEditor>(BlueprintEditorInstance))->GetFocusedGraph();
-#endif	
-		if (FocusedGraph && FBlueprintEditorUtils::FindBlueprintForGraph(FocusedGraph) == InBlueprint)
+		int32 NumPending = 0;
+		for (const FGeminiRequestHandle& BatchRequest : Job.BatchRequests)
 		{
-			return FocusedGraph;
+			NumPending += GeminiClient->IsRequestPending(BatchRequest) ? 1 : 0;
 		}
+		return FText::Format(LOCTEXT("JobBatchStage", "{0} of {1} requests left"), NumPending, Job.NumBatchRequests);
+	}
+	if (!GeminiClient->IsRequestInFlight(Job.Request))
+	{
+		return GeminiClient->IsRequestPending(Job.Request) ? LOCTEXT("JobQueued", "Queued") : LOCTEXT("JobPreparing", "Preparing");
 	}
-	return nullptr;
+	return Job.StreamedText.IsEmpty() ? LOCTEXT("JobWaiting", "Waiting for answer") : LOCTEXT("JobReceiving", "Receiving answer");
 }
 
-TArray<UEdGraphNode*> GeminiAssistantPanel::GetSelectedBlueprintNodes(UBlueprint* InBlueprint) const
+TSharedRef<ITableRow> GeminiAssistantPanel::OnGenerateJobRow(TSharedPtr<FGeminiPanelJob> Job, const TSharedRef<STableViewBase>& OwnerTable)
 {
-	TArray<UEdGraphNode*> FSelectedNodes;
+	TWeakPtr<FGeminiPanelJob> WeakJob = Job;
+	return SNew(STableRow<TSharedPtr<FGeminiPanelJob>>, OwnerTable)
+		.Padding(FMargin(2.0f))
+		[
+			SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.FillWidth(1.0f)
+				.VAlign(VAlign_Center)
+				[
+					SNew(STextBlock)
+						.Text(FText::FromString(Job->Title))
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.VAlign(VAlign_Center)
+				.Padding(FMargin(10, 0, 0, 0))
+				[
+					SNew(STextBlock)
+						.Text_Lambda([this, WeakJob]()
+						{
+							TSharedPtr<FGeminiPanelJob> PinnedJob = WeakJob.Pin();
+							return PinnedJob.IsValid() ? GetJobStageText(*PinnedJob) : FText::GetEmpty();
+						})
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.VAlign(VAlign_Center)
+				.Padding(FMargin(10, 0, 0, 0))
+				[
+					SNew(STextBlock)
+						.Text_Lambda([WeakJob]()
+						{
+							TSharedPtr<FGeminiPanelJob> PinnedJob = WeakJob.Pin();
+							return PinnedJob.IsValid() ? FText::Format(LOCTEXT("JobElapsed", "{0} s"), FText::AsNumber(FMath::RoundToInt(PinnedJob->GetElapsedSeconds()))) : FText::GetEmpty();
+						})
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.VAlign(VAlign_Center)
+				.Padding(FMargin(10, 0, 0, 0))
+				[
+					SNew(SButton)
+						.Text_Lambda([WeakJob]()
+						{
+							TSharedPtr<FGeminiPanelJob> PinnedJob = WeakJob.Pin();
+							return PinnedJob.IsValid() && PinnedJob->IsRunning() ? LOCTEXT("CancelButtonText", "Cancel") : LOCTEXT("CloseJobButtonText", "Close");
+						})
+						.ToolTipText(LOCTEXT("CancelButtonTooltip", "Stop this job, or close its result once it has finished"))
+						.OnClicked_Lambda([this, WeakJob]()
+						{
+							if (TSharedPtr<FGeminiPanelJob> PinnedJob = WeakJob.Pin())
+							{
+								if (PinnedJob->IsRunning())
+								{
+									CancelJob(PinnedJob.ToSharedRef(), LOCTEXT("RequestCancelled", "Request cancelled."));
+								}
+								else
+								{
+									RemoveJob(PinnedJob.ToSharedRef());
+								}
+							}
+							return FReply::Handled();
+						})
+				]
+		];
+}
 
-	if (!InBlueprint)
+void GeminiAssistantPanel::OnJobSelectionChanged(TSharedPtr<FGeminiPanelJob> Job, ESelectInfo::Type SelectInfo)
+{
+	if (Job.IsValid() && Job != ShownJob)
 	{
-		return FSelectedNodes;
+		ShowJob(Job);
 	}
+}
 
-	FBlueprintEditorModule& BlueprintEditorModule = FModuleManager::LoadModuleChecked<FBlueprintEditorModule>("Kismet");
+void GeminiAssistantPanel::RefreshJobViews()
+{
+	JobListView->RequestListRefresh();
 
-	TSharedPtr<IBlueprintEditor> FoundBlueprintEditor;
-	
-	for (TSharedRef<IBlueprintEditor> BlueprintEditorInstance : BlueprintEditorModule.GetBlueprintEditors())
+	// One tab per job; tabs only change when jobs are added or removed, their labels follow the job state
+	ResultTabBox->ClearChildren();
+	for (const TSharedPtr<FGeminiPanelJob>& Job : Jobs)
 	{
+		TWeakPtr<FGeminiPanelJob> WeakJob = Job;
+		ResultTabBox->AddSlot()
+			.AutoWidth()
+			.Padding(FMargin(0, 0, 2, 0))
+			[
+				SNew(SCheckBox)
 #if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 2
-		if (FBlueprintEditorUtils::FindBlueprintForGraph(BlueprintEditorInstance->GetFocusedGraph()) == InBlueprint)
+					.Style(&FAppStyle::Get().GetWidgetStyle<FCheckBoxStyle>("ToggleButtonCheckbox"))
 #else
-		if (FBlueprintEditorUtils::FindBlueprintForGraph((StaticCastSharedRef<FBlueprintEditor>(BlueprintEditorInstance))->GetFocusedGraph()) == InBlueprint)
+					.Style(&FEditorStyle::Get().GetWidgetStyle<FCheckBoxStyle>("ToggleButtonCheckbox"))
 #endif
-		{
-			FoundBlueprintEditor = BlueprintEditorInstance;
-			break;
-		}
+					.IsChecked_Lambda([this, WeakJob]()
+					{
+						return WeakJob.IsValid() && ShownJob == WeakJob.Pin() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+					})
+					.OnCheckStateChanged_Lambda([this, WeakJob](ECheckBoxState NewState)
+					{
+						ShowJob(WeakJob.Pin());
+					})
+					[
+						SNew(STextBlock)
+							.Text_Lambda([WeakJob]()
+							{
+								TSharedPtr<FGeminiPanelJob> PinnedJob = WeakJob.Pin();
+								if (!PinnedJob.IsValid())
+								{
+									return FText::GetEmpty();
+								}
+								return PinnedJob->IsRunning() ? FText::Format(LOCTEXT("RunningJobTab", "{0} ..."), FText::FromString(PinnedJob->Title)) : FText::FromString(PinnedJob->Title);
+							})
+					]
+			];
 	}
+}
 
-	if (FoundBlueprintEditor.IsValid())
-	{
-		TSharedPtr<FBlueprintEditor> BlueprintEditor = StaticCastSharedPtr<FBlueprintEditor>(FoundBlueprintEditor);
-
-		if (BlueprintEditor.IsValid())
-		{
-			FGraphPanelSelectionSet FoundSelectedNodes = BlueprintEditor->GetSelectedNodes();
-			for (UObject* Node : FoundSelectedNodes)
-			{
-				if (UEdGraphNode* CurrentNode = Cast<UEdGraphNode>(Node))
-				{
-					FSelectedNodes.Add(CurrentNode);
-				}
-			}
-		}
-	}
+// --- BLUEPRINT INTERACTION FUNCTIONS ---
 
-	return FSelectedNodes;
+UBlueprint* GeminiAssistantPanel::GetActiveBlueprint() const
+{
+	// The tracker follows editor focus, so this is the Blueprint the user looked at last rather than the first one open
+	return FGeminiBlueprintAssistantModule::Get().GetEditorTracker()->GetActiveBlueprint();
 }
 
-TArray<UEdGraphNode*> GeminiAssistantPanel::GetAllNodesFromActiveGraph(UBlueprint* InBlueprint) const
+UEdGraph* GeminiAssistantPanel::GetFocusedGraph(UBlueprint* InBlueprint)
 {
-	TArray<UEdGraphNode*> AllNodes;
+	return InBlueprint ? FGeminiBlueprintAssistantModule::Get().GetEditorTracker()->GetFocusedGraph(InBlueprint) : nullptr;
+}
 
+TArray<UEdGraphNode*> GeminiAssistantPanel::GetSelectedBlueprintNodes(UBlueprint* InBlueprint) const
+{
+	GEMINI_STAGE_SCOPE("Gemini.CollectNodes", STAT_GeminiCollectNodes);
 	if (!InBlueprint)
 	{
-		return AllNodes;
+		return TArray<UEdGraphNode*>();
 	}
+	return FGeminiBlueprintAssistantModule::Get().GetEditorTracker()->GetSelectedNodes(InBlueprint);
+}
 
-	// Get the currently focused graph from the Blueprint editor
-	FBlueprintEditorModule& BlueprintEditorModule = FModuleManager::LoadModuleChecked<FBlueprintEditorModule>("Kismet");
-
-	TSharedPtr<IBlueprintEditor> FoundBlueprintEditor;
+TArray<UEdGraphNode*> GeminiAssistantPanel::GetAllNodesFromActiveGraph(UBlueprint* InBlueprint) const
+{
+	GEMINI_STAGE_SCOPE("Gemini.CollectNodes", STAT_GeminiCollectNodes);
+	TArray<UEdGraphNode*> AllNodes;
 
-	for (TSharedRef<IBlueprintEditor> BlueprintEditorInstance : BlueprintEditorModule.GetBlueprintEditors())
+	if (!InBlueprint)
 	{
-#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 2
-		if (FBlueprintEditorUtils::FindBlueprintForGraph(BlueprintEditorInstance->GetFocusedGraph()) == InBlueprint)
-#else
-		if (FBlueprintEditorUtils::FindBlueprintForGraph((StaticCastSharedRef<FBlueprintEditor>(BlueprintEditorInstance))->GetFocusedGraph()) == InBlueprint)
-#endif
-		{
-			FoundBlueprintEditor = BlueprintEditorInstance;
-			break;
-		}
+		return AllNodes;
 	}
 
-	if (FoundBlueprintEditor.IsValid())
+	if (UEdGraph* FocusedGraph = FGeminiBlueprintAssistantModule::Get().GetEditorTracker()->GetFocusedGraph(InBlueprint))
 	{
-#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 2
-		UEdGraph* FocusedGraph = FoundBlueprintEditor->GetFocusedGraph();
-#else
-		UEdGraph* FocusedGraph = (StaticCastSharedPtr<FBlueprintEditor>(FoundBlueprintEditor))->GetFocusedGraph();
-#endif
-		if (FocusedGraph)
+		// Get all nodes from the focused graph
+		for (UEdGraphNode* Node : FocusedGraph->Nodes)
 		{
-			// Get all nodes from the focused graph
-			for (UEdGraphNode* Node : FocusedGraph->Nodes)
+			if (Node && IsValid(Node))
 			{
-				if (Node && IsValid(Node))
-				{
-					AllNodes.Add(Node);
-				}
+				AllNodes.Add(Node);
 			}
 		}
 	}
@@ -441,111 +1370,28 @@ FString GeminiAssistantPanel::ExtractNodeDataForGemini(const TArray<UEdGraphNode
 	return NormalisedNodeText;
 }
 
-void GeminiAssistantPanel::AddCommentNodeToBlueprint(UBlueprint* InBlueprint, UEdGraph* TargetGraph, const FString& CommentText) const
+void GeminiAssistantPanel::AddCommentNodeToBlueprint(UBlueprint* InBlueprint, UEdGraph* TargetGraph, const FString& CommentText, const TArray<UEdGraphNode*>& InNodes) const
 {
-	if (!InBlueprint || !TargetGraph || CommentText.IsEmpty())
-	{
-		return;
-	}
-
-	FScopedTransaction Transaction(LOCTEXT("AddGeminiCommentNode", "Add Gemini Generated Comment Node"));
-
-	FBlueprintEditorUtils::MarkBlueprintAsStructurallyModified(InBlueprint);
-	InBlueprint->Modify();
-	TargetGraph->Modify();
-
-	UEdGraphNode_Comment* NewCommentNode = NewObject<UEdGraphNode_Comment>(TargetGraph);
-	NewCommentNode->NodeComment = CommentText;
-
-	NewCommentNode->NodeWidth = FMath::Clamp(CommentText.Len() * 10 + 50, 200, 800);
-	NewCommentNode->NodeHeight = FMath::Clamp(CommentText.Len() / 30 * 20 + 80, 100, 400);
-
-	NewCommentNode->NodePosX = 0;
-	NewCommentNode->NodePosY = 0;
-
-	NewCommentNode->ErrorType = EMessageSeverity::Info;
-
-	// Add the new node to the graph.
-	TargetGraph->AddNode(NewCommentNode);
-	NewCommentNode->CreateNewGuid();
-	NewCommentNode->PostPlacedNewNode();
-
-	FBlueprintEditorModule& BlueprintEditorModule = FModuleManager::LoadModuleChecked<FBlueprintEditorModule>("Kismet");
-	TSharedPtr<IBlueprintEditor> FoundBlueprintEditor;
-
-	// Find the specific Blueprint editor instance that is editing our InBlueprint.
-	for (TSharedRef<IBlueprintEditor> BlueprintEditorInstance : BlueprintEditorModule.GetBlueprintEditors())
-	{
-#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 2
-		if (FBlueprintEditorUtils::FindBlueprintForGraph(CachedFocusedGraph) == InBlueprint)
-#else
-		if (FBlueprintEditorUtils::FindBlueprintForGraph((StaticCastSharedRef<FBlueprintEditor>(BlueprintEditorInstance))->GetFocusedGraph()) == InBlueprint)
-#endif		
-		{
-			FoundBlueprintEditor = BlueprintEditorInstance;
-			break;
-		}
-	}
-	
-	if (FoundBlueprintEditor.IsValid())
-	{
-		TSharedPtr<FBlueprintEditor> BlueprintEditor = StaticCastSharedPtr<FBlueprintEditor>(FoundBlueprintEditor);
-
-		if (BlueprintEditor.IsValid())
-		{
-			if (SelectedNodes.Num() == 0)
-			{
-				UE_LOG(LogTemp, Warning, TEXT("No nodes selected to wrap with comment"));
-				return;
-			}
-			float MinX = FLT_MAX, MinY = FLT_MAX;
-			float MaxX = -FLT_MAX, MaxY = -FLT_MAX;
-
-			for (UObject* ANode : SelectedNodes)
-			{
-				if (UEdGraphNode* Node = Cast<UEdGraphNode>(ANode))
-				{
-					float NodeX = Node->NodePosX;
-					float NodeY = Node->NodePosY;
-
-					float NodeWidth = 200.0f;
-					float NodeHeight = 100.0f;
-
-					MinX = FMath::Min(MinX, NodeX);
-					MinY = FMath::Min(MinY, NodeY);
-					MaxX = FMath::Max(MaxX, NodeX + NodeWidth);
-					MaxY = FMath::Max(MaxY, NodeY + NodeHeight);
-				}
-			}
-			const float Padding = 50.f;
-			MinX -= Padding;
-			MinY -= Padding + 30.f;
-			MaxX += Padding;
-			MaxY += Padding;
-
-			NewCommentNode->NodeComment = CommentText;
-			NewCommentNode->NodePosX = MinX;
-			NewCommentNode->NodePosY = MinY;
-			NewCommentNode->NodeWidth = MaxX - MinX;
-			NewCommentNode->NodeHeight = MaxY - MinY;
-			NewCommentNode->CommentColor = FLinearColor::White;
-
-			for (UObject* Node : SelectedNodes)
-			{
-				if (UEdGraphNode* CurrentNode = Cast<UEdGraphNode>(Node))
-				{
-					NewCommentNode->AddNodeUnderComment(CurrentNode);
-				}
-			}
-		}
-
-		FBlueprintEditorUtils::MarkBlueprintAsModified(InBlueprint);
-	}
+	FGeminiCommentWriter CommentWriter(InBlueprint, TargetGraph);
+	CommentWriter.Add(CommentText, InNodes);
+	CommentWriter.Write(LOCTEXT("AddGeminiCommentNode", "Add Gemini Generated Comment Node"));
 }
+
 LLMResponseParts GeminiAssistantPanel::ParseLLMResponse(const FString& FullResponse)
 {
 	LLMResponseParts Result;
 
+	// Structured answer first; markers remain for bStructuredResponses=False and endpoints ignoring the schema
+	FGeminiStructuredSummary Structured;
+	if (FGeminiSummarySchema::Parse(FullResponse, Structured))
+	{
+		Result.Details = Structured.Details.TrimStartAndEnd();
+		Result.Summary = Structured.Summary.TrimStartAndEnd();
+		Result.NodeNotes = MoveTemp(Structured.NodeNotes);
+		Result.Confidence = Structured.Confidence;
+		return Result;
+	}
+
 	FString DetailsMarker = TEXT("DETAILS:");
 	FString SummaryMarker = TEXT("SUMMARY:");
 
@@ -562,12 +1408,54 @@ LLMResponseParts GeminiAssistantPanel::ParseLLMResponse(const FString& FullRespo
 		int32 SummaryStart = SummaryIndex + SummaryMarker.Len();
 		Result.Summary = FullResponse.Mid(SummaryStart).TrimStartAndEnd();
 	}
+	else if (FullResponse.TrimStart().StartsWith(TEXT("{")))
+	{
+		// JSON cut short, e.g. by the token limit: keep whatever details arrived
+		Result.Details = FGeminiSummarySchema::ExtractPartialDetails(FullResponse).TrimStartAndEnd();
+	}
+
+	// Never leave the panel blank because the answer ignored the format
+	if (Result.Details.IsEmpty())
+	{
+		Result.Details = FullResponse.TrimStartAndEnd();
+	}
 
 	return Result;
 }
 
+FString GeminiAssistantPanel::MakeSupersessionKey(UBlueprint* InBlueprint, UEdGraph* InGraph, const TArray<UEdGraphNode*>& InNodes) const
+{
+	// Same Blueprint, graph and selection (in any order) means the same question
+	TArray<FGuid> NodeGuids;
+	for (UEdGraphNode* Node : InNodes)
+	{
+		if (Node)
+		{
+			NodeGuids.Add(Node->NodeGuid);
+		}
+	}
+	NodeGuids.Sort([](const FGuid& A, const FGuid& B) { return A < B; });
+
+	uint32 SelectionHash = 0;
+	for (const FGuid& NodeGuid : NodeGuids)
+	{
+		SelectionHash = HashCombine(SelectionHash, GetTypeHash(NodeGuid));
+	}
+
+	return FString::Printf(TEXT("Panel|%s|%s|%08x"),
+		InBlueprint ? *InBlueprint->GetPathName() : TEXT(""),
+		InGraph ? *InGraph->GetName() : TEXT(""),
+		SelectionHash);
+}
+
 bool GeminiAssistantPanel::CheckApiKeyExists()
 {
+	// Local servers usually run without a key, so there is nothing to set up
+	if (GeminiClient.IsValid() && !GeminiClient->GetBackendLimits().bRequiresAPIKey)
+	{
+		return true;
+	}
+
 	// Check if API key exists in EditorPerProjectUserSettings
 	FString ApiKey;
 	if (GConfig->GetString(TEXT("GeminiAssistant"), TEXT("APIKey"), ApiKey, GEditorPerProjectIni))
@@ -661,10 +1549,65 @@ TSharedRef<SWidget> GeminiAssistantPanel::CreateMainInterfaceWidget()
 		.HAlign(HAlign_Left)
 		.Padding(FMargin(0, 0, 0, 10))
 		[
-			SAssignNew(ProcessButton, SButton)
-				.Text(LOCTEXT("ProcessButtonText", "Process with Gemini"))
-				.OnClicked(this, &GeminiAssistantPanel::OnProcessButtonClicked)
-				.IsEnabled_Lambda([this]() { return true; /*!CurrentPromptText.IsEmpty();*/ })
+			SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				[
+					SAssignNew(ProcessButton, SButton)
+						.Text(LOCTEXT("ProcessButtonText", "Process with Gemini"))
+						.OnClicked(this, &GeminiAssistantPanel::OnProcessButtonClicked)
+						.IsEnabled_Lambda([this]() { return true; /*!CurrentPromptText.IsEmpty();*/ })
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(FMargin(5, 0, 0, 0))
+				[
+					SAssignNew(SummarizeAllButton, SButton)
+						.Text(LOCTEXT("SummarizeAllButtonText", "Summarize All Graphs"))
+						.OnClicked(this, &GeminiAssistantPanel::OnSummarizeAllGraphsClicked)
+						.ToolTipText(LOCTEXT("SummarizeAllButtonTooltip", "Summarize every graph of the open Blueprint, batched into as few requests as possible"))
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(FMargin(5, 0, 0, 0))
+				[
+					SNew(SButton)
+						.Text(LOCTEXT("AnnotateClustersButtonText", "Annotate Clusters"))
+						.OnClicked(this, &GeminiAssistantPanel::OnAnnotateClustersClicked)
+						.ToolTipText(LOCTEXT("AnnotateClustersButtonTooltip", "Group the uncommented nodes of the open graph into clusters and wrap each in a generated comment, all from one request"))
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(FMargin(5, 0, 0, 0))
+				[
+					SNew(SButton)
+						.Text(LOCTEXT("UsageButtonText", "Usage"))
+						.OnClicked(this, &GeminiAssistantPanel::OnUsageClicked)
+						.ToolTipText(LOCTEXT("UsageButtonTooltip", "Show tokens used today and this month, budgets, and the graphs that used the most tokens"))
+				]
+		]
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		[
+			SAssignNew(StatusTextBlock, STextBlock)
+				.AutoWrapText(true)
+				.Visibility_Lambda([this]() { return StatusTextBlock.IsValid() && !StatusTextBlock->GetText().IsEmpty() ? EVisibility::Visible : EVisibility::Collapsed; })
+		]
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		.Padding(FMargin(0, 5, 0, 0))
+		[
+			// Every job started from the panel with what it is doing, how long it has taken and a way to stop it
+			SNew(SBox)
+				.MaxDesiredHeight(150.0f)
+				.Visibility_Lambda([this]() { return Jobs.Num() > 0 ? EVisibility::Visible : EVisibility::Collapsed; })
+				[
+					SAssignNew(JobListView, SListView<TSharedPtr<FGeminiPanelJob>>)
+						.ListItemsSource(&Jobs)
+						.SelectionMode(ESelectionMode::Single)
+						.OnGenerateRow(this, &GeminiAssistantPanel::OnGenerateJobRow)
+						.OnSelectionChanged(this, &GeminiAssistantPanel::OnJobSelectionChanged)
+				]
 		]
 		+ SVerticalBox::Slot()
 		.FillHeight(1.0f)
@@ -692,12 +1635,22 @@ TSharedRef<SWidget> GeminiAssistantPanel::CreateMainInterfaceWidget()
 #endif
 						]
 						+ SVerticalBox::Slot()
+						.AutoHeight()
+						.Padding(FMargin(0, 0, 0, 5))
+						[
+							SNew(SScrollBox)
+								.Orientation(Orient_Horizontal)
+								+ SScrollBox::Slot()
+								[
+									SAssignNew(ResultTabBox, SHorizontalBox)
+								]
+						]
+						+ SVerticalBox::Slot()
 						.FillHeight(1.0f)
 						[
-							SAssignNew(ResponseTextBlock, SMultiLineEditableText)
-								.IsReadOnly(true)
-								.AutoWrapText(true)
-								.Text(LOCTEXT("InitialResponseText", "Response will appear here..."))
+							// Rows per paragraph: long reports scroll smoothly and streamed chunks only touch the last rows
+							SAssignNew(ResponseView, SGeminiResponseView)
+								.Text(LOCTEXT("InitialResponseText", "Response will appear here...").ToString())
 						]
 				]
 		]
@@ -710,7 +1663,7 @@ TSharedRef<SWidget> GeminiAssistantPanel::CreateMainInterfaceWidget()
 				.Text(FText::FromString("Copy Response"))
 				.OnClicked(this, &GeminiAssistantPanel::OnCopyResponseClicked)
 				.ToolTipText(FText::FromString("Copy the Gemini response to clipboard"))
-				.Visibility(EVisibility::Collapsed)
+				.Visibility_Lambda([this]() { return ShownJob.IsValid() && !ShownJob->IsRunning() ? EVisibility::Visible : EVisibility::Collapsed; })
 		]
 		+ SVerticalBox::Slot()
 		.AutoHeight()
@@ -720,8 +1673,8 @@ TSharedRef<SWidget> GeminiAssistantPanel::CreateMainInterfaceWidget()
 			SAssignNew(ClearButton, SButton)
 				.Text(FText::FromString("Clear Response"))
 				.OnClicked(this, &GeminiAssistantPanel::OnClearClicked)
-				.ToolTipText(FText::FromString("Clear the text from panel"))
-				.Visibility(EVisibility::Collapsed)
+				.ToolTipText(FText::FromString("Close every finished job and start new conversations about the graphs"))
+				.Visibility_Lambda([this]() { return Sessions.Num() > 0 || Jobs.ContainsByPredicate([](const TSharedPtr<FGeminiPanelJob>& Job) { return !Job->IsRunning(); }) ? EVisibility::Visible : EVisibility::Collapsed; })
 		];
 }
 
@@ -0,0 +1,310 @@
+// Private/GeminiAutoSummarizer.cpp
+#include "GeminiAutoSummarizer.h"
+#include "GeminiAssistantTrace.h"
+#include "GeminiBackend.h"
+#include "GeminiModelRouter.h"
+#include "GeminiPromptTemplate.h"
+#include "GeminiSummaryStore.h"
+#include "GeminiUsageTracker.h"
+#include "BlueprintNodePreprocessor.h"
+#include "Editor.h"
+#include "Engine/Blueprint.h"
+#include "EdGraph/EdGraph.h"
+#include "K2Node.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectHash.h"
+#include "UObject/ObjectSaveContext.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/CoreDelegates.h"
+
+namespace GeminiAutoSummarizer
+{
+	// How often the queue is looked at; one graph is preprocessed per look at most
+	static const float TickInterval = 0.5f;
+}
+
+FGeminiAutoSummarizer::FGeminiAutoSummarizer(TSharedRef<FGeminiAPIClient> InClient)
+	: Client(InClient)
+	, ProfileName(TEXT("economy"))
+	, bEnabled(false)
+	, IdleSeconds(5.0f)
+{
+}
+
+FGeminiAutoSummarizer::~FGeminiAutoSummarizer()
+{
+	Shutdown();
+}
+
+void FGeminiAutoSummarizer::Initialize()
+{
+	if (GConfig)
+	{
+		GConfig->GetBool(TEXT("GeminiAssistant"), TEXT("bAutoSummarize"), bEnabled, GEditorPerProjectIni);
+		GConfig->GetFloat(TEXT("GeminiAssistant"), TEXT("AutoSummarizeIdleSeconds"), IdleSeconds, GEditorPerProjectIni);
+		GConfig->GetString(TEXT("GeminiAssistant"), TEXT("AutoSummarizeProfile"), ProfileName, GEditorPerProjectIni);
+	}
+	IdleSeconds = FMath::Max(0.0f, IdleSeconds);
+
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	if (GEditor)
+	{
+		BindEditorEvents();
+	}
+	else
+	{
+		PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddRaw(this, &FGeminiAutoSummarizer::BindEditorEvents);
+	}
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FGeminiAutoSummarizer::Tick), GeminiAutoSummarizer::TickInterval);
+}
+
+void FGeminiAutoSummarizer::Shutdown()
+{
+	if (PostEngineInitHandle.IsValid())
+	{
+		FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+		PostEngineInitHandle.Reset();
+	}
+	if (PreCompileHandle.IsValid() && GEditor)
+	{
+		GEditor->OnBlueprintPreCompile().Remove(PreCompileHandle);
+	}
+	PreCompileHandle.Reset();
+	if (PackageSavedHandle.IsValid())
+	{
+		UPackage::PackageSavedWithContextEvent.Remove(PackageSavedHandle);
+		PackageSavedHandle.Reset();
+	}
+	if (TickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+		TickerHandle.Reset();
+	}
+	if (ActiveRequest.IsValid())
+	{
+		Client->CancelRequest(ActiveRequest);
+		ActiveRequest.Invalidate();
+	}
+	QueuedBlueprints.Empty();
+	QueuedGraphs.Empty();
+}
+
+void FGeminiAutoSummarizer::BindEditorEvents()
+{
+	if (PostEngineInitHandle.IsValid())
+	{
+		FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+		PostEngineInitHandle.Reset();
+	}
+	if (GEditor)
+	{
+		PreCompileHandle = GEditor->OnBlueprintPreCompile().AddRaw(this, &FGeminiAutoSummarizer::OnBlueprintPreCompile);
+	}
+	PackageSavedHandle = UPackage::PackageSavedWithContextEvent.AddRaw(this, &FGeminiAutoSummarizer::OnPackageSaved);
+}
+
+void FGeminiAutoSummarizer::OnBlueprintPreCompile(UBlueprint* Blueprint)
+{
+	// Loading and the recompiles of dependents touch many Blueprints whose graphs nobody edited
+	if (!Blueprint || Blueprint->bIsRegeneratingOnLoad)
+	{
+		return;
+	}
+
+	// An unsaved edit, or a summary a dependency change made stale, e.g. by renaming a function the graph calls
+	const UPackage* Package = Blueprint->GetPackage();
+	if ((Package && Package->IsDirty()) || FGeminiSummaryStore::Get().HasStaleGraphSummaries(Blueprint))
+	{
+		// The graphs are read once the editor is idle, long after the compile has finished
+		QueueBlueprint(Blueprint);
+	}
+}
+
+void FGeminiAutoSummarizer::OnPackageSaved(const FString& PackageFileName, UPackage* Package, FObjectPostSaveContext SaveContext)
+{
+	if (!Package || SaveContext.IsProceduralSave())
+	{
+		return;
+	}
+	ForEachObjectWithPackage(Package, [this](UObject* Object)
+	{
+		if (UBlueprint* Blueprint = Cast<UBlueprint>(Object))
+		{
+			QueueBlueprint(Blueprint);
+		}
+		return true;
+	}, false);
+}
+
+void FGeminiAutoSummarizer::QueueBlueprint(UBlueprint* Blueprint)
+{
+	if (Blueprint && !QueuedBlueprints.Contains(Blueprint))
+	{
+		QueuedBlueprints.Add(Blueprint);
+	}
+}
+
+bool FGeminiAutoSummarizer::IsEditorIdle() const
+{
+	if (!GEditor || GEditor->PlayWorld || GIsSlowTask || !FSlateApplication::IsInitialized())
+	{
+		return false;
+	}
+	const FSlateApplication& SlateApplication = FSlateApplication::Get();
+	return SlateApplication.GetCurrentTime() - SlateApplication.GetLastUserInteractionTime() >= IdleSeconds;
+}
+
+bool FGeminiAutoSummarizer::Tick(float DeltaTime)
+{
+	if (QueuedGraphs.Num() == 0 && QueuedBlueprints.Num() == 0)
+	{
+		return true;
+	}
+
+	// Cancelled from outside, e.g. by a client shutting down; its callback will not come
+	if (ActiveRequest.IsValid() && !Client->IsRequestPending(ActiveRequest))
+	{
+		ActiveRequest.Invalidate();
+	}
+
+	// Interactive requests go first; background work waits until the client has nothing else queued or in flight
+	if (ActiveRequest.IsValid() || Client->GetNumActiveRequests() > 0 || Client->GetNumQueuedRequests() > 0 || !IsEditorIdle())
+	{
+		return true;
+	}
+
+	if (QueuedGraphs.Num() == 0)
+	{
+		UBlueprint* Blueprint = QueuedBlueprints[0].Get();
+		QueuedBlueprints.RemoveAt(0);
+		if (Blueprint)
+		{
+			for (UEdGraph* Graph : Blueprint->UbergraphPages)
+			{
+				QueuedGraphs.Add(Graph);
+			}
+			for (UEdGraph* Graph : Blueprint->FunctionGraphs)
+			{
+				QueuedGraphs.Add(Graph);
+			}
+			for (UEdGraph* Graph : Blueprint->MacroGraphs)
+			{
+				QueuedGraphs.Add(Graph);
+			}
+		}
+		return true;
+	}
+
+	// One graph per tick keeps preprocessing from stacking up into a hitch
+	UEdGraph* Graph = QueuedGraphs[0].Get();
+	QueuedGraphs.RemoveAt(0);
+	if (Graph)
+	{
+		SummarizeGraph(Graph);
+	}
+	return true;
+}
+
+bool FGeminiAutoSummarizer::SummarizeGraph(UEdGraph* Graph)
+{
+	UBlueprint* Blueprint = Graph->GetTypedOuter<UBlueprint>();
+	if (!Blueprint)
+	{
+		return false;
+	}
+
+	// Unchanged since its last summary, whoever wrote it
+	FGeminiStoredSummary Existing;
+	if (FGeminiSummaryStore::Get().Find(Graph, {}, Existing))
+	{
+		return false;
+	}
+
+	FString NodesData;
+	{
+		GEMINI_STAGE_SCOPE("Gemini.PreprocessNodes", STAT_GeminiPreprocessNodes);
+		TArray<UK2Node*> Nodes;
+		for (UEdGraphNode* Node : Graph->Nodes)
+		{
+			if (UK2Node* K2Node = Cast<UK2Node>(Node))
+			{
+				Nodes.Add(K2Node);
+			}
+		}
+		FBlueprintNodePreprocessor NodePreprocessor;
+		NodesData = NodePreprocessor.PreprocessNodes(Nodes);
+	}
+	if (NodesData.IsEmpty())
+	{
+		return false;
+	}
+
+	// The graph as the prompt describes it; edits made while the request is out keep the answer from being stored
+	const FString ContentHash = FGeminiSummaryStore::MakeContentHash(Graph, {});
+
+	const FString BlueprintPath = Blueprint->GetPathName();
+	const FString GraphName = Graph->GetName();
+
+	FString APIKey;
+	GConfig->GetString(TEXT("GeminiAssistant"), TEXT("APIKey"), APIKey, GEditorPerProjectIni);
+	if (APIKey.IsEmpty() && Client->GetBackendLimits().bRequiresAPIKey)
+	{
+		return false;
+	}
+
+	// Background work never spends past a budget, not even on the downgrade profile
+	const FString UsageSource = FGeminiUsageTracker::MakeSource(BlueprintPath, GraphName);
+	FString BudgetMessage;
+	bool bFirstWarning = false;
+	if (FGeminiUsageTracker::Get().CheckBudget(UsageSource, BudgetMessage, bFirstWarning) == EGeminiBudgetStatus::Exceeded)
+	{
+		UE_LOG(LogGeminiAssistant, Verbose, TEXT("GeminiAutoSummarizer: Skipped %s, %s"), *UsageSource, *BudgetMessage);
+		return false;
+	}
+
+	const FGeminiPromptTemplate Template = FGeminiPromptTemplate::Load(TEXT("GraphSummary"));
+	FStringFormatNamedArguments TaskArguments;
+	TaskArguments.Add(TEXT("Graph"), GraphName);
+	TaskArguments.Add(TEXT("Blueprint"), Blueprint->GetName());
+	const FString Prompt = Template.GetPrefix(false) + TEXT("Blueprint Graph Data: ") + NodesData + TEXT("\n") + Template.FormatTask(TaskArguments);
+
+	FGeminiRequestOptions Options;
+	Options.Priority = EGeminiRequestPriority::Low;
+	Options.SupersessionKey = FString::Printf(TEXT("Auto|%s"), *UsageSource);
+	Options.UsageSource = UsageSource;
+	const FGeminiRoute Route = FGeminiModelRouter(Client->GetBackendLimits()).Apply(FGeminiTokenEstimator::EstimateTokens(Prompt), FGeminiGenerationProfile::Load(ProfileName), Options);
+	if (Route.bNeedsChunking)
+	{
+		// Too large for one request; left to Summarize All Graphs, which the user starts on purpose
+		UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAutoSummarizer: %s is too large to summarize in the background"), *UsageSource);
+		return false;
+	}
+	Template.ApplyOutputCap(Options.GenerationConfig);
+
+	ActiveRequest = Client->GenerateContent(Prompt, APIKey,
+		FGeminiResponseDelegate::CreateRaw(this, &FGeminiAutoSummarizer::OnSummaryComplete, TWeakObjectPtr<UEdGraph>(Graph), BlueprintPath, ContentHash), Options);
+	return ActiveRequest.IsValid();
+}
+
+void FGeminiAutoSummarizer::OnSummaryComplete(FString ResponseContent, bool bSuccess, FString ErrorMessage, TWeakObjectPtr<UEdGraph> Graph, FString BlueprintPath, FString ContentHash)
+{
+	ActiveRequest.Invalidate();
+	if (!bSuccess)
+	{
+		UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiAutoSummarizer: %s not summarized: %s"), *BlueprintPath, *ErrorMessage);
+		return;
+	}
+	if (!Graph.IsValid())
+	{
+		return;
+	}
+
+	// Not stored if the graph changed while the request was out; the next compile or save of the edit queues it again
+	FGeminiSummaryStore::Get().Put(Graph.Get(), {}, ContentHash, FString(), ResponseContent.TrimStartAndEnd());
+	SummaryUpdatedEvent.Broadcast(BlueprintPath);
+}
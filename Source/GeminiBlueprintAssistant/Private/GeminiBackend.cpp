@@ -0,0 +1,476 @@
+// Private/GeminiBackend.cpp
+#include "GeminiBackend.h"
+#include "GeminiAPIClient.h"
+#include "GeminiAssistantTrace.h"
+#include "GeminiResponseParser.h"
+#include "GeminiJsonReader.h"
+#include "GeminiJsonWriter.h"
+#include "Misc/ConfigCacheIni.h"
+
+namespace GeminiBackend
+{
+	static const TCHAR* GeminiBaseURL = TEXT("https://generativelanguage.googleapis.com/v1beta");
+	static const TCHAR* GeminiModel = TEXT("gemini-3-flash-preview");
+	static const int32 GeminiContextTokens = 1048576;
+
+	// llama.cpp's server default; most local servers default to a port in this range
+	static const TCHAR* OpenAIBaseURL = TEXT("http://localhost:8080/v1");
+	static const TCHAR* OpenAIModel = TEXT("local-model");
+
+	// A single local GPU serves one request at a time with a modest window unless configured otherwise
+	static const int32 OpenAIMaxConcurrentRequests = 1;
+	static const int32 OpenAIContextTokens = 8192;
+
+	// Reads a string value, tolerating null
+	static bool ReadOptionalString(FGeminiJsonReader& Reader, FString& OutValue)
+	{
+		return Reader.Peek() == EGeminiJsonToken::String ? Reader.ReadString(OutValue) : Reader.SkipValue();
+	}
+
+	// Copies a Gemini schema as JSON Schema: lower-case type names, and no propertyOrdering, which is Gemini's own
+	static bool CopySchema(FGeminiJsonReader& Reader, FGeminiJsonWriter& Writer)
+	{
+		switch (Reader.Peek())
+		{
+		case EGeminiJsonToken::Object:
+		{
+			Writer.BeginObject();
+			const bool bCopied = Reader.ReadObject([&Reader, &Writer](const FString& Key)
+			{
+				if (Key == TEXT("propertyOrdering"))
+				{
+					return Reader.SkipValue();
+				}
+				Writer.WriteKey(TCHAR_TO_ANSI(*Key));
+				if (Key == TEXT("type") && Reader.Peek() == EGeminiJsonToken::String)
+				{
+					FString Type;
+					const bool bRead = Reader.ReadString(Type);
+					Writer.WriteString(Type.ToLower());
+					return bRead;
+				}
+				return CopySchema(Reader, Writer);
+			});
+			Writer.EndObject();
+			return bCopied;
+		}
+		case EGeminiJsonToken::Array:
+		{
+			Writer.BeginArray();
+			const bool bCopied = Reader.ReadArray([&Reader, &Writer](int32 Index)
+			{
+				return CopySchema(Reader, Writer);
+			});
+			Writer.EndArray();
+			return bCopied;
+		}
+		case EGeminiJsonToken::String:
+		{
+			FString Value;
+			const bool bRead = Reader.ReadString(Value);
+			Writer.WriteString(Value);
+			return bRead;
+		}
+		default:
+		{
+			const uint8* Start = nullptr;
+			int32 Num = 0;
+			if (!Reader.ReadRawValue(Start, Num))
+			{
+				return false;
+			}
+			Writer.WriteRawValue(Start, Num);
+			return true;
+		}
+		}
+	}
+
+	// Reads a token count, tolerating null
+	static bool ReadTokenCount(FGeminiJsonReader& Reader, int32& OutValue)
+	{
+		if (Reader.Peek() != EGeminiJsonToken::Number)
+		{
+			return Reader.SkipValue();
+		}
+		int64 Value = 0;
+		if (!Reader.ReadInt64(Value))
+		{
+			return false;
+		}
+		OutValue = static_cast<int32>(FMath::Clamp<int64>(Value, 0, MAX_int32));
+		return true;
+	}
+
+	// "usage": { "prompt_tokens": 10, "completion_tokens": 5, "prompt_tokens_details": { "cached_tokens": 8 },
+	//   "completion_tokens_details": { "reasoning_tokens": 3 } }
+	static bool ParseUsage(FGeminiJsonReader& Reader, FGeminiTokenUsage& OutUsage)
+	{
+		if (Reader.Peek() != EGeminiJsonToken::Object)
+		{
+			return Reader.SkipValue();
+		}
+
+		// Reasoning is part of completion_tokens here, while Gemini counts it apart from the answer
+		FGeminiTokenUsage Usage;
+		int32 CompletionTokens = 0;
+		const bool bParsed = Reader.ReadObject([&Reader, &Usage, &CompletionTokens](const FString& Key)
+		{
+			if (Key == TEXT("prompt_tokens"))
+			{
+				return ReadTokenCount(Reader, Usage.PromptTokens);
+			}
+			if (Key == TEXT("completion_tokens"))
+			{
+				return ReadTokenCount(Reader, CompletionTokens);
+			}
+			if ((Key == TEXT("prompt_tokens_details") || Key == TEXT("completion_tokens_details")) && Reader.Peek() == EGeminiJsonToken::Object)
+			{
+				return Reader.ReadObject([&Reader, &Usage](const FString& DetailKey)
+				{
+					if (DetailKey == TEXT("cached_tokens"))
+					{
+						return ReadTokenCount(Reader, Usage.CachedTokens);
+					}
+					if (DetailKey == TEXT("reasoning_tokens"))
+					{
+						return ReadTokenCount(Reader, Usage.ThoughtTokens);
+					}
+					return Reader.SkipValue();
+				});
+			}
+			return Reader.SkipValue();
+		});
+		Usage.OutputTokens = FMath::Max(0, CompletionTokens - Usage.ThoughtTokens);
+		if (Usage.IsSet())
+		{
+			OutUsage = Usage;
+		}
+		return bParsed;
+	}
+
+	// "message" of a non-streamed choice or "delta" of a streamed one: { "role": "assistant", "content": "..." }
+	static bool ParseChatMessage(FGeminiJsonReader& Reader, FString& OutText)
+	{
+		if (Reader.Peek() != EGeminiJsonToken::Object)
+		{
+			return Reader.SkipValue();
+		}
+		return Reader.ReadObject([&Reader, &OutText](const FString& Key)
+		{
+			return Key == TEXT("content") ? ReadOptionalString(Reader, OutText) : Reader.SkipValue();
+		});
+	}
+
+	// { "choices": [{ "message" | "delta": {...}, "finish_reason": "stop" }], "error": { "message": "..." } }
+	static bool ParseChatCompletion(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse)
+	{
+		FGeminiJsonReader Reader(Data, Num);
+		if (Reader.Peek() != EGeminiJsonToken::Object)
+		{
+			return false;
+		}
+
+		return Reader.ReadObject([&Reader, &OutResponse](const FString& Key)
+		{
+			if (Key == TEXT("choices") && Reader.Peek() == EGeminiJsonToken::Array)
+			{
+				return Reader.ReadArray([&Reader, &OutResponse](int32 ChoiceIndex)
+				{
+					if (Reader.Peek() != EGeminiJsonToken::Object)
+					{
+						return Reader.SkipValue();
+					}
+
+					FString ChoiceText;
+					FString FinishReason;
+					const bool bParsed = Reader.ReadObject([&Reader, &ChoiceText, &FinishReason](const FString& ChoiceKey)
+					{
+						if (ChoiceKey == TEXT("message") || ChoiceKey == TEXT("delta"))
+						{
+							return ParseChatMessage(Reader, ChoiceText);
+						}
+						if (ChoiceKey == TEXT("finish_reason"))
+						{
+							return ReadOptionalString(Reader, FinishReason);
+						}
+						return Reader.SkipValue();
+					});
+
+					OutResponse.NumCandidates = FMath::Max(OutResponse.NumCandidates, ChoiceIndex + 1);
+					if (ChoiceIndex == 0 && !FinishReason.IsEmpty())
+					{
+						OutResponse.FinishReason = FinishReason.ToUpper();
+					}
+					if (!ChoiceText.IsEmpty())
+					{
+						if (ChoiceIndex > 0 && !OutResponse.Text.IsEmpty())
+						{
+							OutResponse.Text += TEXT("\n\n");
+						}
+						OutResponse.Text += ChoiceText;
+					}
+					return bParsed;
+				});
+			}
+			if (Key == TEXT("usage"))
+			{
+				return ParseUsage(Reader, OutResponse.Usage);
+			}
+			if (Key == TEXT("error"))
+			{
+				// An object with "message" for OpenAI and most servers, a plain string for some
+				FString Message;
+				const bool bRead = Reader.Peek() == EGeminiJsonToken::Object
+					? Reader.ReadObject([&Reader, &Message](const FString& ErrorKey)
+						{
+							return ErrorKey == TEXT("message") ? ReadOptionalString(Reader, Message) : Reader.SkipValue();
+						})
+					: ReadOptionalString(Reader, Message);
+				OutResponse.ErrorMessage = FString::Printf(TEXT("Inference server error: %s"), *Message);
+				OutResponse.bApiError = true;
+				return bRead;
+			}
+			return Reader.SkipValue();
+		});
+	}
+}
+
+TSharedRef<IGeminiBackend, ESPMode::ThreadSafe> IGeminiBackend::CreateFromConfig()
+{
+	FString Name = TEXT("Gemini");
+	if (GConfig)
+	{
+		GConfig->GetString(TEXT("GeminiAssistant"), TEXT("Backend"), Name, GEditorPerProjectIni);
+	}
+
+	TSharedPtr<IGeminiBackend, ESPMode::ThreadSafe> Backend = Create(Name);
+	if (!Backend.IsValid())
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiBackend: Unknown backend '%s', using Gemini"), *Name);
+		Backend = MakeShared<FGeminiNativeBackend, ESPMode::ThreadSafe>();
+	}
+	return Backend.ToSharedRef();
+}
+
+TSharedPtr<IGeminiBackend, ESPMode::ThreadSafe> IGeminiBackend::Create(const FString& Name)
+{
+	if (Name == TEXT("Gemini"))
+	{
+		return MakeShared<FGeminiNativeBackend, ESPMode::ThreadSafe>();
+	}
+	if (Name == TEXT("OpenAI"))
+	{
+		return MakeShared<FGeminiOpenAIBackend, ESPMode::ThreadSafe>();
+	}
+	return nullptr;
+}
+
+void IGeminiBackend::LoadLimits(const FGeminiBackendLimits& Defaults)
+{
+	Limits = Defaults;
+	if (GConfig)
+	{
+		const FString Section = FString::Printf(TEXT("GeminiAssistant.Backend.%s"), GetName());
+		GConfig->GetInt(*Section, TEXT("MaxConcurrentRequests"), Limits.MaxConcurrentRequests, GEditorPerProjectIni);
+		GConfig->GetInt(*Section, TEXT("MaxContextTokens"), Limits.MaxContextTokens, GEditorPerProjectIni);
+	}
+	Limits.MaxConcurrentRequests = FMath::Max(0, Limits.MaxConcurrentRequests);
+	Limits.MaxContextTokens = FMath::Max(1024, Limits.MaxContextTokens);
+}
+
+FGeminiNativeBackend::FGeminiNativeBackend()
+{
+	FGeminiBackendLimits Defaults;
+	Defaults.MaxContextTokens = GeminiBackend::GeminiContextTokens;
+	Defaults.bSupportsContextCache = true;
+	Defaults.bSupportsBatchJobs = true;
+	Defaults.bSupportsModelTiers = true;
+	LoadLimits(Defaults);
+}
+
+const TCHAR* FGeminiNativeBackend::GetDefaultBaseURL() const
+{
+	return GeminiBackend::GeminiBaseURL;
+}
+
+const TCHAR* FGeminiNativeBackend::GetDefaultModel() const
+{
+	return GeminiBackend::GeminiModel;
+}
+
+FString FGeminiNativeBackend::GetGenerateURL(const FString& BaseURL, const FString& Model, bool bStream, const FString& APIKey) const
+{
+	// alt=sse makes the endpoint answer with server-sent events instead of one JSON array at the end
+	return bStream
+		? FString::Printf(TEXT("%s/models/%s:streamGenerateContent?alt=sse&key=%s"), *BaseURL, *Model, *APIKey)
+		: FString::Printf(TEXT("%s/models/%s:generateContent?key=%s"), *BaseURL, *Model, *APIKey);
+}
+
+FString FGeminiNativeBackend::GetPrewarmURL(const FString& BaseURL, const FString& Model, const FString& APIKey) const
+{
+	// Model metadata lookup
+	return FString::Printf(TEXT("%s/models/%s?key=%s"), *BaseURL, *Model, *APIKey);
+}
+
+void FGeminiNativeBackend::WriteRequestBody(FGeminiJsonWriter& Writer, const FGeminiBackendPrompt& Prompt) const
+{
+	FGeminiAPIClient::WriteGenerateContentRequest(Writer, Prompt.Prompt, Prompt.CachedContent, Prompt.GenerationConfig, Prompt.History);
+}
+
+bool FGeminiNativeBackend::ParseResponse(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse) const
+{
+	return FGeminiResponseParser::Parse(Data, Num, OutResponse);
+}
+
+bool FGeminiNativeBackend::ParseStreamEvent(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse) const
+{
+	if (FGeminiResponseParser::Parse(Data, Num, OutResponse))
+	{
+		return true;
+	}
+	// The last event of every stream holds only the finish reason and usage; no text is an error only for a whole response
+	if (!OutResponse.bApiError && OutResponse.BlockReason.IsEmpty())
+	{
+		OutResponse.ErrorMessage.Empty();
+	}
+	return false;
+}
+
+FGeminiOpenAIBackend::FGeminiOpenAIBackend()
+{
+	FGeminiBackendLimits Defaults;
+	Defaults.MaxConcurrentRequests = GeminiBackend::OpenAIMaxConcurrentRequests;
+	Defaults.MaxContextTokens = GeminiBackend::OpenAIContextTokens;
+	Defaults.bRequiresAPIKey = false;
+	LoadLimits(Defaults);
+}
+
+const TCHAR* FGeminiOpenAIBackend::GetDefaultBaseURL() const
+{
+	return GeminiBackend::OpenAIBaseURL;
+}
+
+const TCHAR* FGeminiOpenAIBackend::GetDefaultModel() const
+{
+	return GeminiBackend::OpenAIModel;
+}
+
+FString FGeminiOpenAIBackend::GetGenerateURL(const FString& BaseURL, const FString& Model, bool bStream, const FString& APIKey) const
+{
+	// Model, streaming and key all travel in the body and headers
+	return BaseURL + TEXT("/chat/completions");
+}
+
+FString FGeminiOpenAIBackend::GetPrewarmURL(const FString& BaseURL, const FString& Model, const FString& APIKey) const
+{
+	return BaseURL + TEXT("/models");
+}
+
+void FGeminiOpenAIBackend::SetRequestHeaders(IHttpRequest& Request, const FString& APIKey) const
+{
+	// Local servers usually run without authentication
+	if (!APIKey.IsEmpty())
+	{
+		Request.SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *APIKey));
+	}
+}
+
+void FGeminiOpenAIBackend::WriteRequestBody(FGeminiJsonWriter& Writer, const FGeminiBackendPrompt& Prompt) const
+{
+	// {"model":"...","messages":[{"role":"user","content":"..."},{"role":"assistant",...},...],"stream":true,...}
+	Writer.BeginObject();
+	Writer.WriteStringField("model", Prompt.Model);
+	Writer.WriteKey("messages");
+	Writer.BeginArray();
+	for (const FGeminiChatTurn& Turn : Prompt.History)
+	{
+		Writer.BeginObject();
+		Writer.WriteStringField("role", Turn.bFromModel ? TEXT("assistant") : TEXT("user"));
+		Writer.WriteStringField("content", Turn.Text);
+		Writer.EndObject();
+	}
+	Writer.BeginObject();
+	Writer.WriteStringField("role", TEXT("user"));
+	Writer.WriteStringField("content", Prompt.Prompt);
+	Writer.EndObject();
+	Writer.EndArray();
+	Writer.WriteBoolField("stream", Prompt.bStream);
+	if (Prompt.bStream)
+	{
+		// Token counts arrive in a last chunk without choices; servers that do not know the option ignore it
+		Writer.WriteKey("stream_options");
+		Writer.BeginObject();
+		Writer.WriteBoolField("include_usage", true);
+		Writer.EndObject();
+	}
+
+	// There is no thinking budget in this protocol; reasoning servers decide on their own
+	const FGeminiGenerationConfig& Config = Prompt.GenerationConfig;
+	if (Config.MaxOutputTokens > 0)
+	{
+		Writer.WriteIntegerField("max_tokens", Config.MaxOutputTokens);
+	}
+	if (Config.Temperature >= 0.0f)
+	{
+		Writer.WriteNumberField("temperature", Config.Temperature);
+	}
+	if (Config.ResponseMimeType == TEXT("application/json"))
+	{
+		// "response_format":{"type":"json_schema","json_schema":{"name":"response","schema":{...}}}
+		Writer.WriteKey("response_format");
+		Writer.BeginObject();
+		if (Config.ResponseSchema.IsEmpty())
+		{
+			Writer.WriteStringField("type", TEXT("json_object"));
+		}
+		else
+		{
+			Writer.WriteStringField("type", TEXT("json_schema"));
+			Writer.WriteKey("json_schema");
+			Writer.BeginObject();
+			Writer.WriteStringField("name", TEXT("response"));
+			Writer.WriteKey("schema");
+			FTCHARToUTF8 SchemaUtf8(*Config.ResponseSchema, Config.ResponseSchema.Len());
+			FGeminiJsonReader SchemaReader(reinterpret_cast<const uint8*>(SchemaUtf8.Get()), SchemaUtf8.Length());
+			if (!GeminiBackend::CopySchema(SchemaReader, Writer))
+			{
+				UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiBackend: Response schema is not valid JSON"));
+			}
+			Writer.EndObject();
+		}
+		Writer.EndObject();
+	}
+	Writer.EndObject();
+}
+
+bool FGeminiOpenAIBackend::ParseResponse(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse) const
+{
+	const bool bParsed = GeminiBackend::ParseChatCompletion(Data, Num, OutResponse);
+	if (!OutResponse.Text.IsEmpty())
+	{
+		return true;
+	}
+	if (OutResponse.ErrorMessage.IsEmpty())
+	{
+		if (!bParsed)
+		{
+			OutResponse.ErrorMessage = TEXT("Failed to parse JSON response.");
+		}
+		else if (!OutResponse.FinishReason.IsEmpty() && OutResponse.FinishReason != TEXT("STOP"))
+		{
+			OutResponse.ErrorMessage = FString::Printf(TEXT("The inference server returned no text (finish reason %s)."), *OutResponse.FinishReason);
+		}
+		else
+		{
+			OutResponse.ErrorMessage = TEXT("The inference server returned no text.");
+		}
+	}
+	return false;
+}
+
+bool FGeminiOpenAIBackend::ParseStreamEvent(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse) const
+{
+	// The stream ends with "data: [DONE]"; role-only and usage chunks carry no text either, but the client keeps their usage
+	GeminiBackend::ParseChatCompletion(Data, Num, OutResponse);
+	return !OutResponse.Text.IsEmpty();
+}
@@ -0,0 +1,518 @@
+// Private/GeminiBatch.cpp
+#include "GeminiBatch.h"
+#include "GeminiAPIClient.h"
+#include "GeminiAssistantTrace.h"
+#include "GeminiJsonReader.h"
+#include "GeminiJsonWriter.h"
+#include "GeminiResponseParser.h"
+#include "HttpModule.h"
+#include "Async/Async.h"
+
+namespace GeminiBatch
+{
+	// Inline batch requests are limited to 20 MB in total; larger runs would need a file upload
+	static const int32 MaxInlineRequestBytes = 20 * 1024 * 1024;
+
+	static FString MakeResultMarker(int32 TaskNumber)
+	{
+		return FString::Printf(TEXT("<<<RESULT %d>>>"), TaskNumber);
+	}
+
+	static FString MakeEndResultMarker(int32 TaskNumber)
+	{
+		return FString::Printf(TEXT("<<<END RESULT %d>>>"), TaskNumber);
+	}
+
+	/**
+	 * What one poll of a batch job told us.
+	 */
+	struct FJobStatus
+	{
+		FString Name;
+		FString State;
+		bool bDone = false;
+		FString ErrorMessage;
+		TMap<FString, FGeminiBatchTaskResult> Results;
+		bool bParsed = false;
+
+		bool IsFinished() const
+		{
+			return bDone || State.EndsWith(TEXT("SUCCEEDED")) || State.EndsWith(TEXT("FAILED")) || State.EndsWith(TEXT("CANCELLED")) || State.EndsWith(TEXT("EXPIRED"));
+		}
+	};
+
+	// error: { "code": 400, "message": "..." }
+	static bool ReadErrorMessage(FGeminiJsonReader& Reader, FString& OutMessage)
+	{
+		if (Reader.Peek() != EGeminiJsonToken::Object)
+		{
+			return Reader.SkipValue();
+		}
+		return Reader.ReadObject([&Reader, &OutMessage](const FString& Key)
+		{
+			return Key == TEXT("message") && Reader.Peek() == EGeminiJsonToken::String ? Reader.ReadString(OutMessage) : Reader.SkipValue();
+		});
+	}
+
+	// inlinedResponses[i]: { "response": GenerateContentResponse | "error": Status, "metadata": { "key": "..." } }
+	static bool ParseInlinedResponse(FGeminiJsonReader& Reader, FGeminiBatchTaskResult& OutResult)
+	{
+		return Reader.ReadObject([&Reader, &OutResult](const FString& Key)
+		{
+			if (Key == TEXT("response"))
+			{
+				const uint8* ResponseStart = nullptr;
+				int32 ResponseNum = 0;
+				if (!Reader.ReadRawValue(ResponseStart, ResponseNum))
+				{
+					return false;
+				}
+				FGeminiParsedResponse Parsed;
+				OutResult.bSuccess = FGeminiResponseParser::Parse(ResponseStart, ResponseNum, Parsed);
+				OutResult.Text = MoveTemp(Parsed.Text);
+				OutResult.ErrorMessage = MoveTemp(Parsed.ErrorMessage);
+				return true;
+			}
+			if (Key == TEXT("error"))
+			{
+				OutResult.bSuccess = false;
+				return ReadErrorMessage(Reader, OutResult.ErrorMessage);
+			}
+			if (Key == TEXT("metadata") && Reader.Peek() == EGeminiJsonToken::Object)
+			{
+				return Reader.ReadObject([&Reader, &OutResult](const FString& MetadataKey)
+				{
+					return MetadataKey == TEXT("key") && Reader.Peek() == EGeminiJsonToken::String ? Reader.ReadString(OutResult.Id) : Reader.SkipValue();
+				});
+			}
+			return Reader.SkipValue();
+		});
+	}
+
+	// The results sit in "inlinedResponses", either directly as an array or wrapped in an object of the same name
+	static bool ParseInlinedResponses(FGeminiJsonReader& Reader, FJobStatus& OutStatus)
+	{
+		switch (Reader.Peek())
+		{
+		case EGeminiJsonToken::Array:
+			return Reader.ReadArray([&Reader, &OutStatus](int32 Index)
+			{
+				FGeminiBatchTaskResult Result;
+				if (!ParseInlinedResponse(Reader, Result))
+				{
+					return false;
+				}
+				// Results without a key can only be matched by position
+				if (Result.Id.IsEmpty())
+				{
+					Result.Id = FString::Printf(TEXT("#%d"), Index);
+				}
+				OutStatus.Results.Add(Result.Id, MoveTemp(Result));
+				return true;
+			});
+		case EGeminiJsonToken::Object:
+			return Reader.ReadObject([&Reader, &OutStatus](const FString& Key)
+			{
+				return Key == TEXT("inlinedResponses") ? ParseInlinedResponses(Reader, OutStatus) : Reader.SkipValue();
+			});
+		default:
+			return Reader.SkipValue();
+		}
+	}
+
+	// "response" of the operation, or "output" of the batch resource
+	static bool ParseOutput(FGeminiJsonReader& Reader, FJobStatus& OutStatus)
+	{
+		if (Reader.Peek() != EGeminiJsonToken::Object)
+		{
+			return Reader.SkipValue();
+		}
+		return Reader.ReadObject([&Reader, &OutStatus](const FString& Key)
+		{
+			if (Key == TEXT("inlinedResponses"))
+			{
+				return ParseInlinedResponses(Reader, OutStatus);
+			}
+			if (Key == TEXT("output"))
+			{
+				return ParseOutput(Reader, OutStatus);
+			}
+			return Reader.SkipValue();
+		});
+	}
+
+	// Operation: { "name": "batches/...", "metadata": { "state": ..., "output": ... }, "done": true, "response": ..., "error": ... }
+	static void ParseJobStatus(const TArray<uint8>& Body, FJobStatus& OutStatus)
+	{
+		FGeminiJsonReader Reader(Body.GetData(), Body.Num());
+		if (Reader.Peek() != EGeminiJsonToken::Object)
+		{
+			return;
+		}
+
+		OutStatus.bParsed = Reader.ReadObject([&Reader, &OutStatus](const FString& Key)
+		{
+			if (Key == TEXT("name") && Reader.Peek() == EGeminiJsonToken::String)
+			{
+				return Reader.ReadString(OutStatus.Name);
+			}
+			if (Key == TEXT("done") && (Reader.Peek() == EGeminiJsonToken::True || Reader.Peek() == EGeminiJsonToken::False))
+			{
+				return Reader.ReadBool(OutStatus.bDone);
+			}
+			if (Key == TEXT("error"))
+			{
+				return ReadErrorMessage(Reader, OutStatus.ErrorMessage);
+			}
+			if (Key == TEXT("response"))
+			{
+				return ParseOutput(Reader, OutStatus);
+			}
+			if (Key == TEXT("metadata") && Reader.Peek() == EGeminiJsonToken::Object)
+			{
+				return Reader.ReadObject([&Reader, &OutStatus](const FString& MetadataKey)
+				{
+					if (MetadataKey == TEXT("state") && Reader.Peek() == EGeminiJsonToken::String)
+					{
+						return Reader.ReadString(OutStatus.State);
+					}
+					if (MetadataKey == TEXT("output"))
+					{
+						return ParseOutput(Reader, OutStatus);
+					}
+					return Reader.SkipValue();
+				});
+			}
+			return Reader.SkipValue();
+		});
+	}
+
+	// Error text for a failed job HTTP call
+	static FString DescribeHttpFailure(FHttpResponsePtr Response, bool bConnectedSuccessfully, const FJobStatus& Status)
+	{
+		if (!bConnectedSuccessfully || !Response.IsValid())
+		{
+			return TEXT("HTTP Request Failed: No connection or invalid response.");
+		}
+		return FString::Printf(TEXT("HTTP Request Failed: Response code %d - %s"), Response->GetResponseCode(),
+			Status.ErrorMessage.IsEmpty() ? *Response->GetContentAsString() : *Status.ErrorMessage);
+	}
+}
+
+FString FGeminiPromptBatcher::PackTasks(const TArray<FGeminiBatchTask>& Tasks)
+{
+	int32 TotalChars = 0;
+	for (const FGeminiBatchTask& Task : Tasks)
+	{
+		TotalChars += Task.Prompt.Len() + 64;
+	}
+
+	FString Packed;
+	Packed.Reserve(TotalChars + 512);
+	// The header does not depend on the tasks, so packed requests start with the same text; the count goes last
+	Packed += TEXT("You will receive independent tasks. Answer each one on its own, without referring to the others.\n");
+	Packed += TEXT("Write the answer to task N between a line <<<RESULT N>>> and a line <<<END RESULT N>>>, in task order, and write nothing outside these blocks.\n\n");
+
+	for (int32 Index = 0; Index < Tasks.Num(); ++Index)
+	{
+		Packed += FString::Printf(TEXT("<<<TASK %d>>>\n"), Index + 1);
+		Packed += Tasks[Index].Prompt;
+		Packed += FString::Printf(TEXT("\n<<<END TASK %d>>>\n\n"), Index + 1);
+	}
+	Packed += FString::Printf(TEXT("There are %d tasks; answer all of them."), Tasks.Num());
+	return Packed;
+}
+
+void FGeminiPromptBatcher::UnpackResponse(const FString& Response, int32 NumTasks, TArray<FString>& OutAnswers)
+{
+	OutAnswers.Reset();
+	OutAnswers.SetNum(NumTasks);
+
+	for (int32 Index = 0; Index < NumTasks; ++Index)
+	{
+		const FString StartMarker = GeminiBatch::MakeResultMarker(Index + 1);
+		const int32 StartIndex = Response.Find(StartMarker, ESearchCase::CaseSensitive);
+		if (StartIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		// Models sometimes drop the closing marker; the next block or the end of the answer closes it then
+		const int32 ContentStart = StartIndex + StartMarker.Len();
+		int32 ContentEnd = Response.Find(GeminiBatch::MakeEndResultMarker(Index + 1), ESearchCase::CaseSensitive, ESearchDir::FromStart, ContentStart);
+		if (ContentEnd == INDEX_NONE)
+		{
+			ContentEnd = Response.Find(TEXT("<<<RESULT "), ESearchCase::CaseSensitive, ESearchDir::FromStart, ContentStart);
+		}
+		if (ContentEnd == INDEX_NONE)
+		{
+			ContentEnd = Response.Len();
+		}
+
+		OutAnswers[Index] = Response.Mid(ContentStart, ContentEnd - ContentStart).TrimStartAndEnd();
+	}
+}
+
+void FGeminiPromptBatcher::SplitIntoGroups(const TArray<FGeminiBatchTask>& Tasks, int32 MaxTasksPerGroup, int32 MaxCharsPerGroup, TArray<TArray<int32>>& OutGroups)
+{
+	OutGroups.Reset();
+
+	int32 GroupChars = 0;
+	for (int32 Index = 0; Index < Tasks.Num(); ++Index)
+	{
+		const int32 TaskChars = Tasks[Index].Prompt.Len();
+		const bool bGroupFull = OutGroups.Num() > 0 &&
+			(OutGroups.Last().Num() >= FMath::Max(1, MaxTasksPerGroup) || (MaxCharsPerGroup > 0 && GroupChars + TaskChars > MaxCharsPerGroup));
+
+		// A task larger than the size limit still gets a request of its own
+		if (OutGroups.Num() == 0 || bGroupFull)
+		{
+			OutGroups.AddDefaulted();
+			GroupChars = 0;
+		}
+		OutGroups.Last().Add(Index);
+		GroupChars += TaskChars;
+	}
+}
+
+FGeminiBatchJob::FGeminiBatchJob(const FString& InAPIBaseURL, const FString& InModelURL, const FString& InAPIKey, const TArray<FGeminiBatchTask>& InTasks, double InPollInterval, FGeminiBatchDelegate InOnComplete)
+	: APIBaseURL(InAPIBaseURL)
+	, ModelURL(InModelURL)
+	, APIKey(InAPIKey)
+	, Tasks(InTasks)
+	, PollInterval(FMath::Max(1.0, InPollInterval))
+	, OnComplete(MoveTemp(InOnComplete))
+	, bFinished(false)
+{
+}
+
+FGeminiBatchJob::~FGeminiBatchJob()
+{
+	if (PollTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(PollTickerHandle);
+	}
+	if (HttpRequest.IsValid())
+	{
+		HttpRequest->OnProcessRequestComplete().Unbind();
+		HttpRequest->CancelRequest();
+	}
+}
+
+void FGeminiBatchJob::Submit()
+{
+	TArray<uint8> Body;
+	FGeminiJsonWriter Writer(Body);
+
+	// {"batch":{"displayName":...,"inputConfig":{"requests":{"requests":[{"request":{...},"metadata":{"key":...}}]}}}}
+	Writer.BeginObject();
+	Writer.WriteKey("batch");
+	Writer.BeginObject();
+	Writer.WriteStringField("displayName", FString::Printf(TEXT("GeminiBlueprintAssistant (%d tasks)"), Tasks.Num()));
+	Writer.WriteKey("inputConfig");
+	Writer.BeginObject();
+	Writer.WriteKey("requests");
+	Writer.BeginObject();
+	Writer.WriteKey("requests");
+	Writer.BeginArray();
+	for (const FGeminiBatchTask& Task : Tasks)
+	{
+		Writer.BeginObject();
+		Writer.WriteKey("request");
+		FGeminiAPIClient::WriteGenerateContentRequest(Writer, Task.Prompt);
+		Writer.WriteKey("metadata");
+		Writer.BeginObject();
+		Writer.WriteStringField("key", Task.Id);
+		Writer.EndObject();
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+	Writer.EndObject();
+	Writer.EndObject();
+	Writer.EndObject();
+
+	if (Body.Num() > GeminiBatch::MaxInlineRequestBytes)
+	{
+		Fail(FString::Printf(TEXT("Batch job is too large (%d bytes, inline requests are limited to %d)."), Body.Num(), GeminiBatch::MaxInlineRequestBytes));
+		return;
+	}
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(FString::Printf(TEXT("%s:batchGenerateContent?key=%s"), *ModelURL, *APIKey));
+	Request->SetVerb(TEXT("POST"));
+	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	Request->SetContent(MoveTemp(Body));
+	Request->OnProcessRequestComplete().BindSP(AsShared(), &FGeminiBatchJob::OnSubmitComplete);
+	HttpRequest = Request;
+	Request->ProcessRequest();
+
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiBatchJob: Submitting batch job with %d tasks..."), Tasks.Num());
+}
+
+void FGeminiBatchJob::OnSubmitComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully)
+{
+	HttpRequest.Reset();
+
+	GeminiBatch::FJobStatus Status;
+	if (Response.IsValid())
+	{
+		GeminiBatch::ParseJobStatus(Response->GetContent(), Status);
+	}
+
+	const bool bAccepted = bConnectedSuccessfully && Response.IsValid() && Response->GetResponseCode() >= 200 && Response->GetResponseCode() <= 299;
+	if (!bAccepted || Status.Name.IsEmpty())
+	{
+		Fail(bAccepted ? TEXT("Batch job was accepted without a name.") : GeminiBatch::DescribeHttpFailure(Response, bConnectedSuccessfully, Status));
+		return;
+	}
+
+	JobName = Status.Name;
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiBatchJob: Created %s, polling every %.0f s"), *JobName, PollInterval);
+	SchedulePoll();
+}
+
+void FGeminiBatchJob::SchedulePoll()
+{
+	PollTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FGeminiBatchJob::OnPollTicker), static_cast<float>(PollInterval));
+}
+
+bool FGeminiBatchJob::OnPollTicker(float DeltaTime)
+{
+	PollTickerHandle.Reset();
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(FString::Printf(TEXT("%s/%s?key=%s"), *APIBaseURL, *JobName, *APIKey));
+	Request->SetVerb(TEXT("GET"));
+	Request->OnProcessRequestComplete().BindSP(AsShared(), &FGeminiBatchJob::OnPollComplete);
+	HttpRequest = Request;
+	Request->ProcessRequest();
+
+	// One-shot; the next poll is scheduled when this one has been answered
+	return false;
+}
+
+void FGeminiBatchJob::OnPollComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully)
+{
+	HttpRequest.Reset();
+
+	// Temporary trouble while polling is not the job failing; simply ask again later
+	if (!bConnectedSuccessfully || !Response.IsValid() || FGeminiAPIClient::ClassifyFailure(true, Response->GetResponseCode()) == EGeminiErrorKind::Transient)
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiBatchJob: Polling %s failed (code %d), trying again"), *JobName, Response.IsValid() ? Response->GetResponseCode() : 0);
+		SchedulePoll();
+		return;
+	}
+
+	// The finished job carries every answer, so it is parsed off the game thread like any other response
+	TWeakPtr<FGeminiBatchJob> WeakJob = AsShared();
+	Async(EAsyncExecution::ThreadPool, [WeakJob, Response]()
+	{
+		GeminiBatch::FJobStatus Status;
+		GeminiBatch::ParseJobStatus(Response->GetContent(), Status);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakJob, Response, Status = MoveTemp(Status)]()
+		{
+			TSharedPtr<FGeminiBatchJob> Job = WeakJob.Pin();
+			if (!Job.IsValid() || Job->bFinished)
+			{
+				return;
+			}
+
+			if (Response->GetResponseCode() < 200 || Response->GetResponseCode() > 299)
+			{
+				Job->Fail(GeminiBatch::DescribeHttpFailure(Response, true, Status));
+			}
+			else if (!Status.IsFinished())
+			{
+				UE_LOG(LogGeminiAssistant, Verbose, TEXT("GeminiBatchJob: %s is %s"), *Job->JobName, *Status.State);
+				Job->SchedulePoll();
+			}
+			else if (Status.Results.Num() == 0)
+			{
+				Job->Fail(Status.ErrorMessage.IsEmpty() ? FString::Printf(TEXT("Batch job ended as %s without results."), *Status.State) : Status.ErrorMessage);
+			}
+			else
+			{
+				Job->Finish(Status.Results);
+			}
+		});
+	});
+}
+
+void FGeminiBatchJob::Cancel()
+{
+	if (bFinished)
+	{
+		return;
+	}
+	bFinished = true;
+
+	if (PollTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(PollTickerHandle);
+		PollTickerHandle.Reset();
+	}
+	if (HttpRequest.IsValid())
+	{
+		HttpRequest->OnProcessRequestComplete().Unbind();
+		HttpRequest->CancelRequest();
+		HttpRequest.Reset();
+	}
+
+	// The job keeps running (and billing) on the server unless it is told to stop
+	if (!JobName.IsEmpty())
+	{
+		TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+		Request->SetURL(FString::Printf(TEXT("%s/%s:cancel?key=%s"), *APIBaseURL, *JobName, *APIKey));
+		Request->SetVerb(TEXT("POST"));
+		Request->ProcessRequest();
+		UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiBatchJob: Cancelling %s"), *JobName);
+	}
+
+	OnFinished.ExecuteIfBound();
+}
+
+void FGeminiBatchJob::Finish(const TMap<FString, FGeminiBatchTaskResult>& ResultsById)
+{
+	TArray<FGeminiBatchTaskResult> Results;
+	Results.Reserve(Tasks.Num());
+	for (int32 Index = 0; Index < Tasks.Num(); ++Index)
+	{
+		const FGeminiBatchTaskResult* Found = ResultsById.Find(Tasks[Index].Id);
+		if (!Found)
+		{
+			Found = ResultsById.Find(FString::Printf(TEXT("#%d"), Index));
+		}
+
+		FGeminiBatchTaskResult& Result = Results.Add_GetRef(Found ? *Found : FGeminiBatchTaskResult());
+		Result.Id = Tasks[Index].Id;
+		if (!Found)
+		{
+			Result.ErrorMessage = TEXT("The batch job returned no result for this task.");
+		}
+	}
+
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiBatchJob: %s finished with %d results"), *JobName, ResultsById.Num());
+
+	bFinished = true;
+	OnComplete.ExecuteIfBound(Results);
+	OnFinished.ExecuteIfBound();
+}
+
+void FGeminiBatchJob::Fail(const FString& ErrorMessage)
+{
+	UE_LOG(LogGeminiAssistant, Error, TEXT("GeminiBatchJob: %s"), *ErrorMessage);
+
+	TArray<FGeminiBatchTaskResult> Results;
+	for (const FGeminiBatchTask& Task : Tasks)
+	{
+		FGeminiBatchTaskResult& Result = Results.AddDefaulted_GetRef();
+		Result.Id = Task.Id;
+		Result.ErrorMessage = ErrorMessage;
+	}
+
+	bFinished = true;
+	OnComplete.ExecuteIfBound(Results);
+	OnFinished.ExecuteIfBound();
+}
@@ -0,0 +1,326 @@
+// Private/GeminiBenchmarks.cpp
+// Editor console commands measuring the cost of the client's hot paths
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Containers/Ticker.h"
+#include "GeminiAPIClient.h"
+#include "GeminiMockServer.h"
+#include "GeminiAssistantTrace.h"
+#include "Serialization/JsonSerializer.h"
+#include "Dom/JsonObject.h"
+
+namespace GeminiBenchmarks
+{
+	// Prompt resembling the preprocessor output, with quotes, newlines and some non-ASCII text to escape
+	static FString MakeSyntheticPrompt(int32 TargetBytes)
+	{
+		FString Prompt;
+		Prompt.Reserve(TargetBytes + 128);
+		for (int32 Line = 1; Prompt.Len() < TargetBytes; ++Line)
+		{
+			Prompt += FString::Printf(TEXT("%d. CALL: PrintString(InString=\"Step %d\", Duration=2.0) // Gr\u00FC\u00DFe \u2192 \"quoted\"\n"), Line, Line);
+		}
+		return Prompt;
+	}
+
+	// The body as it was built before FGeminiJsonWriter: DOM, UTF-16 serialization, then UTF-8 conversion
+	static void BuildLegacyBody(const FString& Prompt, TArray<uint8>& OutBody, int64& OutEstimatedPeakBytes)
+	{
+		TSharedPtr<FJsonObject> RequestBody = MakeShareable(new FJsonObject());
+		TArray<TSharedPtr<FJsonValue>> ContentsArray;
+		TSharedPtr<FJsonObject> ContentObject = MakeShareable(new FJsonObject());
+		TArray<TSharedPtr<FJsonValue>> PartsArray;
+		TSharedPtr<FJsonObject> TextPartObject = MakeShareable(new FJsonObject());
+		TextPartObject->SetStringField(TEXT("text"), Prompt);
+		PartsArray.Add(MakeShareable(new FJsonValueObject(TextPartObject)));
+		ContentObject->SetArrayField(TEXT("parts"), PartsArray);
+		ContentsArray.Add(MakeShareable(new FJsonValueObject(ContentObject)));
+		RequestBody->SetArrayField(TEXT("contents"), ContentsArray);
+
+		FString RequestBodyString;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&RequestBodyString);
+		FJsonSerializer::Serialize(RequestBody.ToSharedRef(), Writer);
+
+		// What SetContentAsString does with the serialized string
+		FTCHARToUTF8 Converted(*RequestBodyString, RequestBodyString.Len());
+		OutBody.Reset();
+		OutBody.Append(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length());
+
+		// Not measured: the sizes of the prompt copy in the DOM, the serialized string, the converter's buffer and the
+		// payload, which are alive together. The DOM's own objects are left out.
+		OutEstimatedPeakBytes = Prompt.GetAllocatedSize() + RequestBodyString.GetAllocatedSize() + Converted.Length() + OutBody.GetAllocatedSize();
+	}
+
+	// Checks that the writer's output is valid JSON carrying the prompt unchanged
+	static bool VerifyBody(const TArray<uint8>& Body, const FString& Prompt)
+	{
+		FString BodyString;
+		auto Converted = StringCast<TCHAR>(reinterpret_cast<const UTF8CHAR*>(Body.GetData()), Body.Num());
+		BodyString.Append(Converted.Get(), Converted.Length());
+
+		TSharedPtr<FJsonObject> Parsed;
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(BodyString);
+		if (!FJsonSerializer::Deserialize(Reader, Parsed) || !Parsed.IsValid())
+		{
+			return false;
+		}
+
+		const TArray<TSharedPtr<FJsonValue>>* Contents;
+		const TArray<TSharedPtr<FJsonValue>>* Parts;
+		FString Text;
+		return Parsed->TryGetArrayField(TEXT("contents"), Contents) && Contents->Num() == 1
+			&& (*Contents)[0]->AsObject()->TryGetArrayField(TEXT("parts"), Parts) && Parts->Num() == 1
+			&& (*Parts)[0]->AsObject()->TryGetStringField(TEXT("text"), Text) && Text == Prompt;
+	}
+
+	// Gemini.BenchmarkRequestBody [PromptKB=1024] [Iterations=10]
+	static void BenchmarkRequestBody(const TArray<FString>& Args)
+	{
+		int32 PromptKB = 1024;
+		int32 Iterations = 10;
+		for (const FString& Arg : Args)
+		{
+			FParse::Value(*Arg, TEXT("PromptKB="), PromptKB);
+			FParse::Value(*Arg, TEXT("Iterations="), Iterations);
+		}
+		PromptKB = FMath::Max(1, PromptKB);
+		Iterations = FMath::Max(1, Iterations);
+		const FString Prompt = MakeSyntheticPrompt(PromptKB * 1024);
+
+		TArray<uint8> LegacyBody;
+		int64 LegacyEstimatedPeakBytes = 0;
+		double LegacySeconds = 0.0;
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			BuildLegacyBody(Prompt, LegacyBody, LegacyEstimatedPeakBytes);
+			LegacySeconds += FPlatformTime::Seconds() - StartTime;
+		}
+
+		TArray<uint8> Body;
+		double WriterSeconds = 0.0;
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			FGeminiAPIClient::WriteGenerateContentBody(Prompt, Body);
+			WriterSeconds += FPlatformTime::Seconds() - StartTime;
+		}
+		const int64 WriterEstimatedPeakBytes = Body.GetAllocatedSize();
+
+		TArray<uint8> CompressedBody;
+		double CompressSeconds = 0.0;
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			FGeminiAPIClient::CompressBody(Body, CompressedBody);
+			CompressSeconds += FPlatformTime::Seconds() - StartTime;
+		}
+
+		// Peak figures add up the buffers each path keeps alive at once; they are not read from the allocator
+		UE_LOG(LogGeminiAssistant, Display, TEXT("Gemini request body benchmark: prompt %d characters, %d iterations, writer output %s"),
+			Prompt.Len(), Iterations, VerifyBody(Body, Prompt) ? TEXT("valid") : TEXT("INVALID"));
+		UE_LOG(LogGeminiAssistant, Display, TEXT("  DOM + FString:  %8.3f ms/body, %8d bytes sent, %8lld bytes estimated peak"),
+			LegacySeconds * 1000.0 / Iterations, LegacyBody.Num(), LegacyEstimatedPeakBytes);
+		UE_LOG(LogGeminiAssistant, Display, TEXT("  UTF-8 writer:   %8.3f ms/body, %8d bytes sent, %8lld bytes estimated peak"),
+			WriterSeconds * 1000.0 / Iterations, Body.Num(), WriterEstimatedPeakBytes);
+		UE_LOG(LogGeminiAssistant, Display, TEXT("  + gzip:         %8.3f ms/body, %8d bytes sent, %8lld bytes estimated peak"),
+			CompressSeconds * 1000.0 / Iterations, CompressedBody.Num(), WriterEstimatedPeakBytes + CompressedBody.GetAllocatedSize());
+	}
+
+	// Value below which the given fraction of the sorted samples lies
+	static double Percentile(const TArray<double>& SortedSamples, double Fraction)
+	{
+		if (SortedSamples.Num() == 0)
+		{
+			return 0.0;
+		}
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+		return SortedSamples[Index];
+	}
+
+	/**
+	 * Closed-loop load test of the whole request pipeline against the mock server: at every concurrency level exactly
+	 * that many requests are kept in flight until the level's request count has completed.
+	 */
+	class FLoadBenchmark : public TSharedFromThis<FLoadBenchmark>
+	{
+	public:
+		FLoadBenchmark(TSharedPtr<FGeminiMockServer> InServer, bool bInOwnsServer, const TArray<int32>& InLevels, int32 InRequestsPerLevel, const FString& InPrompt, bool bInStream)
+			: Client(MakeShared<FGeminiAPIClient>())
+			, Server(InServer)
+			, bOwnsServer(bInOwnsServer)
+			, Levels(InLevels)
+			, RequestsPerLevel(InRequestsPerLevel)
+			, Prompt(InPrompt)
+			, bStream(bInStream)
+			, LevelIndex(-1)
+			, NumSubmitted(0)
+			, NumFailed(0)
+			, LevelStartTime(0.0)
+		{
+			// Measure the client, not the quota of whoever runs the benchmark
+			Client->SetEndpoint(Server->GetBaseURL(), TEXT("mock-model"));
+			Client->SetRateLimits(0, 0);
+
+			// Every benchmark request carries the same prompt and would otherwise share a single answer
+			Client->SetCoalesceRequests(false);
+		}
+
+		void Start()
+		{
+			const FGeminiMockServerSettings& Settings = Server->GetSettings();
+			UE_LOG(LogGeminiAssistant, Display, TEXT("Gemini pipeline benchmark: %d requests per level, %s, prompt %d characters, server latency %.0f+%.0f ms, error rate %.2f, answer %d characters"),
+				RequestsPerLevel, bStream ? TEXT("streamed") : TEXT("plain"), Prompt.Len(), Settings.LatencyMs, Settings.JitterMs, Settings.ErrorRate, Settings.ResponseChars);
+			StartNextLevel();
+		}
+
+		// Benchmark currently running, kept alive until it has reported its last level
+		static TSharedPtr<FLoadBenchmark> Active;
+
+	private:
+		void StartNextLevel()
+		{
+			if (++LevelIndex >= Levels.Num())
+			{
+				if (bOwnsServer)
+				{
+					Server->Stop();
+				}
+				UE_LOG(LogGeminiAssistant, Display, TEXT("Gemini pipeline benchmark: done"));
+
+				// Called from inside the client's completion path, so the client must outlive this frame
+				FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([](float DeltaTime)
+				{
+					Active.Reset();
+					return false;
+				}));
+				return;
+			}
+
+			NumSubmitted = 0;
+			NumFailed = 0;
+			Latencies.Reset();
+			LevelStartTime = FPlatformTime::Seconds();
+			Client->SetMaxConcurrentRequests(Levels[LevelIndex]);
+			for (int32 Slot = 0; Slot < Levels[LevelIndex] && NumSubmitted < RequestsPerLevel; ++Slot)
+			{
+				SubmitNext();
+			}
+		}
+
+		void SubmitNext()
+		{
+			++NumSubmitted;
+			const double SubmitTime = FPlatformTime::Seconds();
+			FGeminiResponseDelegate OnComplete = FGeminiResponseDelegate::CreateSP(this, &FLoadBenchmark::OnRequestComplete, SubmitTime);
+			if (bStream)
+			{
+				Client->GenerateContentStream(Prompt, TEXT("mock"), FGeminiChunkDelegate(), OnComplete);
+			}
+			else
+			{
+				Client->GenerateContent(Prompt, TEXT("mock"), OnComplete);
+			}
+		}
+
+		void OnRequestComplete(FString ResponseContent, bool bSuccess, FString ErrorMessage, double SubmitTime)
+		{
+			Latencies.Add((FPlatformTime::Seconds() - SubmitTime) * 1000.0);
+			if (!bSuccess)
+			{
+				++NumFailed;
+			}
+
+			if (Latencies.Num() >= RequestsPerLevel)
+			{
+				ReportLevel();
+				StartNextLevel();
+			}
+			else if (NumSubmitted < RequestsPerLevel)
+			{
+				SubmitNext();
+			}
+		}
+
+		void ReportLevel()
+		{
+			const double Seconds = FPlatformTime::Seconds() - LevelStartTime;
+			Latencies.Sort();
+			UE_LOG(LogGeminiAssistant, Display, TEXT("  concurrency %3d: %7.1f req/s, p50 %8.1f ms, p99 %8.1f ms, max %8.1f ms, %d/%d failed"),
+				Levels[LevelIndex], Latencies.Num() / FMath::Max(Seconds, SMALL_NUMBER), Percentile(Latencies, 0.50), Percentile(Latencies, 0.99),
+				Latencies.Last(), NumFailed, Latencies.Num());
+		}
+
+		TSharedRef<FGeminiAPIClient> Client;
+		TSharedPtr<FGeminiMockServer> Server;
+		bool bOwnsServer;
+		TArray<int32> Levels;
+		int32 RequestsPerLevel;
+		FString Prompt;
+		bool bStream;
+		int32 LevelIndex;
+		int32 NumSubmitted;
+		int32 NumFailed;
+		double LevelStartTime;
+		TArray<double> Latencies;
+	};
+
+	TSharedPtr<FLoadBenchmark> FLoadBenchmark::Active;
+
+	// Gemini.Benchmark [Requests=200] [Concurrency=1,4,16,32] [Stream=0] [PromptKB=16] [mock server settings]
+	static void BenchmarkPipeline(const TArray<FString>& Args)
+	{
+		if (FLoadBenchmark::Active.IsValid())
+		{
+			UE_LOG(LogGeminiAssistant, Warning, TEXT("Gemini pipeline benchmark: a run is still in progress"));
+			return;
+		}
+
+		int32 Requests = 200;
+		int32 PromptKB = 16;
+		bool bStream = false;
+		FString ConcurrencyList = TEXT("1,4,16,32");
+		for (const FString& Arg : Args)
+		{
+			FParse::Value(*Arg, TEXT("Requests="), Requests);
+			FParse::Value(*Arg, TEXT("PromptKB="), PromptKB);
+			FParse::Bool(*Arg, TEXT("Stream="), bStream);
+			FParse::Value(*Arg, TEXT("Concurrency="), ConcurrencyList, false);
+		}
+
+		TArray<FString> LevelStrings;
+		ConcurrencyList.ParseIntoArray(LevelStrings, TEXT(","));
+		TArray<int32> Levels;
+		for (const FString& LevelString : LevelStrings)
+		{
+			Levels.Add(FMath::Max(1, FCString::Atoi(*LevelString)));
+		}
+
+		// A mock server started from the console keeps its settings; otherwise run one just for the benchmark
+		TSharedPtr<FGeminiMockServer> Server = FGeminiMockServer::GetShared();
+		const bool bOwnsServer = !Server.IsValid() || !Server->IsRunning();
+		if (bOwnsServer)
+		{
+			FGeminiMockServerSettings Settings;
+			Settings.ParseArgs(Args);
+			Server = MakeShared<FGeminiMockServer>();
+			if (!Server->Start(Settings))
+			{
+				return;
+			}
+		}
+
+		FLoadBenchmark::Active = MakeShared<FLoadBenchmark>(Server, bOwnsServer, Levels, FMath::Max(1, Requests), MakeSyntheticPrompt(FMath::Max(1, PromptKB) * 1024), bStream);
+		FLoadBenchmark::Active->Start();
+	}
+
+	static FAutoConsoleCommand BenchmarkPipelineCommand(
+		TEXT("Gemini.Benchmark"),
+		TEXT("Measures throughput and p50/p99 latency of the request pipeline against the local mock server. Usage: Gemini.Benchmark [Requests=200] [Concurrency=1,4,16,32] [Stream=0] [PromptKB=16] [LatencyMs=200] [JitterMs=50] [ErrorRate=0] [ResponseChars=2000]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkPipeline));
+
+	static FAutoConsoleCommand BenchmarkRequestBodyCommand(
+		TEXT("Gemini.BenchmarkRequestBody"),
+		TEXT("Compares building a generateContent body through the JSON DOM with the UTF-8 writer. Usage: Gemini.BenchmarkRequestBody [PromptKB=1024] [Iterations=10]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkRequestBody));
+}
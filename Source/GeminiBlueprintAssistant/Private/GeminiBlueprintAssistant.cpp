@@ -2,10 +2,33 @@
 
 #include "GeminiBlueprintAssistant.h"
 #include "GeminiAssistantPanel.h" // Include our Slate panel
+#include "GeminiAPIClient.h" // Shared Gemini client
+#include "GeminiEditorTracker.h" // Active Blueprint editor
+#include "GeminiAutoSummarizer.h" // Background summaries
+#include "GeminiNodeTooltipFactory.h" // Stored summaries as node tooltips
+#include "GeminiSummaryStore.h" // Local summary database
+#include "EdGraphUtilities.h" // For registering visual node factories
+#include "Misc/ConfigCacheIni.h" // For reading the plugin settings
 #include "LevelEditor.h" // For accessing Level Editor menu
 #include "Widgets/Docking/SDockTab.h" // For creating a dockable tab
 #include "Framework/Application/SlateApplication.h" // For Slate application functions
 #include "ToolMenus.h" // For adding menu entries
+#include "GeminiAssistantTrace.h" // Log category, trace channel and stats
+
+DEFINE_LOG_CATEGORY(LogGeminiAssistant);
+UE_TRACE_CHANNEL_DEFINE(GeminiAssistantChannel);
+
+DEFINE_STAT(STAT_GeminiCollectNodes);
+DEFINE_STAT(STAT_GeminiPreprocessNodes);
+DEFINE_STAT(STAT_GeminiBuildPrompt);
+DEFINE_STAT(STAT_GeminiSerializeRequest);
+DEFINE_STAT(STAT_GeminiParseResponse);
+DEFINE_STAT(STAT_GeminiUpdateUI);
+DEFINE_STAT(STAT_GeminiWriteComments);
+DEFINE_STAT(STAT_GeminiRequestsInFlight);
+DEFINE_STAT(STAT_GeminiRequestsWaiting);
+DEFINE_STAT(STAT_GeminiRequestsSent);
+DEFINE_STAT(STAT_GeminiRetries);
 
 #define LOCTEXT_NAMESPACE "FGeminiBlueprintAssistantModule"
 
@@ -13,6 +36,20 @@ static const FName GeminiBlueprintAssistantTabID("GeminiBlueprintAssistant");
 
 void FGeminiBlueprintAssistantModule::StartupModule()
 {
+	APIClient = MakeShared<FGeminiAPIClient>();
+	EditorTracker = MakeShared<FGeminiEditorTracker>();
+	EditorTracker->Initialize();
+	AutoSummarizer = MakeShared<FGeminiAutoSummarizer>(APIClient.ToSharedRef());
+	AutoSummarizer->Initialize();
+
+	bool bNodeSummaryTooltips = true;
+	GConfig->GetBool(TEXT("GeminiAssistant"), TEXT("bNodeSummaryTooltips"), bNodeSummaryTooltips, GEditorPerProjectIni);
+	if (bNodeSummaryTooltips)
+	{
+		NodeTooltipFactory = MakeShared<FGeminiNodeTooltipFactory>();
+		FEdGraphUtilities::RegisterVisualNodeFactory(NodeTooltipFactory);
+	}
+
 	FGlobalTabmanager::Get()->RegisterNomadTabSpawner(GeminiBlueprintAssistantTabID, FOnSpawnTab::CreateRaw(this, &FGeminiBlueprintAssistantModule::OnSpawnTab))
 		.SetDisplayName(LOCTEXT("GeminiBlueprintAssistantTabTitle", "Gemini BP Assistant"))
 		.SetMenuType(ETabSpawnerMenuType::Enabled); // Blutility means it shows up in "Window -> Blutility" but we can also add it to "Window" directly
@@ -31,6 +68,45 @@ void FGeminiBlueprintAssistantModule::ShutdownModule()
 	//UToolMenus::UnregisterStartupCallback(this);
 	UToolMenus::UnregisterOwner(this); // Unregister any tool menus owned by this module
 
+	if (NodeTooltipFactory.IsValid())
+	{
+		FEdGraphUtilities::UnregisterVisualNodeFactory(NodeTooltipFactory);
+		NodeTooltipFactory.Reset();
+	}
+	if (AutoSummarizer.IsValid())
+	{
+		AutoSummarizer->Shutdown();
+		AutoSummarizer.Reset();
+	}
+	if (EditorTracker.IsValid())
+	{
+		EditorTracker->Shutdown();
+		EditorTracker.Reset();
+	}
+	APIClient.Reset();
+
+	// The store is a static that would otherwise be destroyed after SQLite, with its statements still prepared
+	FGeminiSummaryStore::Get().Shutdown();
+}
+
+FGeminiBlueprintAssistantModule& FGeminiBlueprintAssistantModule::Get()
+{
+	return FModuleManager::LoadModuleChecked<FGeminiBlueprintAssistantModule>("GeminiBlueprintAssistant");
+}
+
+TSharedRef<FGeminiAPIClient> FGeminiBlueprintAssistantModule::GetAPIClient() const
+{
+	return APIClient.ToSharedRef();
+}
+
+TSharedRef<FGeminiEditorTracker> FGeminiBlueprintAssistantModule::GetEditorTracker() const
+{
+	return EditorTracker.ToSharedRef();
+}
+
+TSharedRef<FGeminiAutoSummarizer> FGeminiBlueprintAssistantModule::GetAutoSummarizer() const
+{
+	return AutoSummarizer.ToSharedRef();
 }
 
 TSharedRef<SDockTab> FGeminiBlueprintAssistantModule::OnSpawnTab(const FSpawnTabArgs& SpawnTabArgs)
@@ -0,0 +1,150 @@
+// Private/GeminiCommentWriter.cpp
+#include "GeminiCommentWriter.h"
+#include "GeminiAssistantTrace.h"
+#include "GeminiBlueprintAssistant.h"
+#include "GeminiEditorTracker.h"
+#include "BlueprintEditor.h"
+#include "GraphEditor.h"
+#include "Engine/Blueprint.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "EdGraphNode_Comment.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "ScopedTransaction.h"
+
+namespace GeminiCommentWriter
+{
+	// Space between the nodes and the edge of the box, and the extra room for the comment's title bar
+	static const float Padding = 50.0f;
+	static const float TitleHeight = 30.0f;
+
+	// Rough node layout of the Blueprint editor, for nodes without a widget to measure
+	static const float NodeTitleHeight = 32.0f;
+	static const float PinRowHeight = 26.0f;
+	static const float MinNodeWidth = 120.0f;
+	static const float TitleCharWidth = 7.0f;
+}
+
+FGeminiCommentWriter::FGeminiCommentWriter(UBlueprint* InBlueprint, UEdGraph* InGraph)
+	: Blueprint(InBlueprint)
+	, Graph(InGraph)
+{
+}
+
+void FGeminiCommentWriter::Add(const FString& Text, const TArray<UEdGraphNode*>& Nodes, const FLinearColor& Color)
+{
+	if (Text.IsEmpty())
+	{
+		return;
+	}
+	FComment& Comment = Comments.AddDefaulted_GetRef();
+	Comment.Text = Text;
+	Comment.Color = Color;
+	for (UEdGraphNode* Node : Nodes)
+	{
+		Comment.Nodes.Add(Node);
+	}
+}
+
+TSharedPtr<SGraphEditor> FGeminiCommentWriter::FindGraphEditor() const
+{
+	TSharedPtr<FBlueprintEditor> BlueprintEditor = FGeminiBlueprintAssistantModule::Get().GetEditorTracker()->FindEditor(Blueprint.Get());
+	if (!BlueprintEditor.IsValid() || BlueprintEditor->GetFocusedGraph() != Graph.Get())
+	{
+		return nullptr;
+	}
+
+	// Already in front, so this only hands out its editor
+	return BlueprintEditor->OpenGraphAndBringToFront(Graph.Get(), false);
+}
+
+FBox2D FGeminiCommentWriter::GetNodeBounds(const UEdGraphNode* Node, const SGraphEditor* GraphEditor)
+{
+	FSlateRect Rect;
+	if (GraphEditor && GraphEditor->GetBoundsForNode(Node, Rect, 0.0f) && Rect.GetArea() > 0.0f)
+	{
+		return FBox2D(FVector2D(Rect.Left, Rect.Top), FVector2D(Rect.Right, Rect.Bottom));
+	}
+
+	int32 NumInputs = 0;
+	int32 NumOutputs = 0;
+	for (const UEdGraphPin* Pin : Node->Pins)
+	{
+		if (Pin && !Pin->bHidden)
+		{
+			(Pin->Direction == EGPD_Input ? NumInputs : NumOutputs)++;
+		}
+	}
+	const FString Title = Node->GetNodeTitle(ENodeTitleType::FullTitle).ToString();
+	const float Width = FMath::Max(GeminiCommentWriter::MinNodeWidth, Title.Len() * GeminiCommentWriter::TitleCharWidth + GeminiCommentWriter::Padding);
+	const float Height = GeminiCommentWriter::NodeTitleHeight + FMath::Max(NumInputs, NumOutputs) * GeminiCommentWriter::PinRowHeight;
+	const FVector2D Position(Node->NodePosX, Node->NodePosY);
+	return FBox2D(Position, Position + FVector2D(Width, Height));
+}
+
+TArray<UEdGraphNode_Comment*> FGeminiCommentWriter::Write(const FText& TransactionName)
+{
+	GEMINI_STAGE_SCOPE("Gemini.WriteComments", STAT_GeminiWriteComments);
+	TArray<UEdGraphNode_Comment*> Written;
+	UBlueprint* TargetBlueprint = Blueprint.Get();
+	UEdGraph* TargetGraph = Graph.Get();
+	if (!TargetBlueprint || !TargetGraph || Comments.Num() == 0)
+	{
+		return Written;
+	}
+
+	const TSharedPtr<SGraphEditor> GraphEditor = FindGraphEditor();
+	FScopedTransaction Transaction(TransactionName);
+	TargetGraph->Modify();
+
+	for (const FComment& Comment : Comments)
+	{
+		UEdGraphNode_Comment* NewCommentNode = NewObject<UEdGraphNode_Comment>(TargetGraph, NAME_None, RF_Transactional);
+		NewCommentNode->NodeComment = Comment.Text;
+		NewCommentNode->CommentColor = Comment.Color;
+		NewCommentNode->ErrorType = EMessageSeverity::Info;
+
+		FBox2D Bounds(ForceInit);
+		for (const TWeakObjectPtr<UEdGraphNode>& Node : Comment.Nodes)
+		{
+			if (Node.IsValid() && Node->GetGraph() == TargetGraph)
+			{
+				Bounds += GetNodeBounds(Node.Get(), GraphEditor.Get());
+			}
+		}
+		if (Bounds.bIsValid)
+		{
+			NewCommentNode->NodePosX = FMath::FloorToInt(Bounds.Min.X - GeminiCommentWriter::Padding);
+			NewCommentNode->NodePosY = FMath::FloorToInt(Bounds.Min.Y - GeminiCommentWriter::Padding - GeminiCommentWriter::TitleHeight);
+			NewCommentNode->NodeWidth = FMath::CeilToInt(Bounds.GetSize().X + 2.0f * GeminiCommentWriter::Padding);
+			NewCommentNode->NodeHeight = FMath::CeilToInt(Bounds.GetSize().Y + 2.0f * GeminiCommentWriter::Padding + GeminiCommentWriter::TitleHeight);
+		}
+		else
+		{
+			NewCommentNode->NodePosX = 0;
+			NewCommentNode->NodePosY = 0;
+			NewCommentNode->NodeWidth = FMath::Clamp(Comment.Text.Len() * 10 + 50, 200, 800);
+			NewCommentNode->NodeHeight = FMath::Clamp(Comment.Text.Len() / 30 * 20 + 80, 100, 400);
+		}
+
+		// Added without UEdGraph::AddNode, which would refresh the graph editors once per comment
+		TargetGraph->Nodes.Add(NewCommentNode);
+		NewCommentNode->CreateNewGuid();
+		NewCommentNode->PostPlacedNewNode();
+		for (const TWeakObjectPtr<UEdGraphNode>& Node : Comment.Nodes)
+		{
+			if (Node.IsValid())
+			{
+				NewCommentNode->AddNodeUnderComment(Node.Get());
+			}
+		}
+		Written.Add(NewCommentNode);
+	}
+	Comments.Empty();
+
+	// Comments are not compiled: the Blueprint is only marked dirty, and the editors rebuild the graph once
+	FBlueprintEditorUtils::MarkBlueprintAsModified(TargetBlueprint);
+	TargetGraph->NotifyGraphChanged();
+	UE_LOG(LogGeminiAssistant, Verbose, TEXT("GeminiCommentWriter: Wrote %d comments to %s"), Written.Num(), *TargetGraph->GetName());
+	return Written;
+}
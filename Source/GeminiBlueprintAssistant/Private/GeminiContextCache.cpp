@@ -0,0 +1,301 @@
+// Private/GeminiContextCache.cpp
+#include "GeminiContextCache.h"
+#include "GeminiJsonReader.h"
+#include "GeminiAssistantTrace.h"
+#include "GeminiJsonWriter.h"
+#include "HttpModule.h"
+#include "Hash/CityHash.h"
+
+namespace GeminiContextCache
+{
+	// Entries closer than this fraction of the TTL to expiring are renewed when they are used
+	static const double RenewFraction = 0.25;
+
+	// Entries about to expire are not handed out any more, the request could reach the server too late
+	static const double ExpiryMargin = 15.0;
+
+	static FString FormatTTL(double Seconds)
+	{
+		return FString::Printf(TEXT("%ds"), FMath::Max(60, FMath::RoundToInt(Seconds)));
+	}
+
+	// Reads "name" and the error message of a cachedContents answer
+	static void ParseCacheResponse(const TArray<uint8>& Body, FString& OutName, FString& OutError, int64& OutTokenCount)
+	{
+		FGeminiJsonReader Reader(Body.GetData(), Body.Num());
+		if (Reader.Peek() != EGeminiJsonToken::Object)
+		{
+			return;
+		}
+
+		Reader.ReadObject([&Reader, &OutName, &OutError, &OutTokenCount](const FString& Key)
+		{
+			if (Key == TEXT("name") && Reader.Peek() == EGeminiJsonToken::String)
+			{
+				return Reader.ReadString(OutName);
+			}
+			if ((Key == TEXT("error") || Key == TEXT("usageMetadata")) && Reader.Peek() == EGeminiJsonToken::Object)
+			{
+				return Reader.ReadObject([&Reader, &OutError, &OutTokenCount](const FString& InnerKey)
+				{
+					if (InnerKey == TEXT("message") && Reader.Peek() == EGeminiJsonToken::String)
+					{
+						return Reader.ReadString(OutError);
+					}
+					if (InnerKey == TEXT("totalTokenCount"))
+					{
+						return Reader.ReadInt64(OutTokenCount);
+					}
+					return Reader.SkipValue();
+				});
+			}
+			return Reader.SkipValue();
+		});
+	}
+}
+
+FGeminiContextCache::FGeminiContextCache()
+	: TTLSeconds(600.0)
+	, MinContextChars(0)
+	, TimeOffset(0.0)
+{
+}
+
+void FGeminiContextCache::Configure(const FString& InAPIBaseURL, const FString& InModelName, double InTTLSeconds, int32 InMinContextChars)
+{
+	APIBaseURL = InAPIBaseURL;
+	ModelName = InModelName;
+	TTLSeconds = FMath::Max(60.0, InTTLSeconds);
+	MinContextChars = FMath::Max(0, InMinContextChars);
+}
+
+void FGeminiContextCache::SetEndpoint(const FString& InAPIBaseURL, const FString& InModelName)
+{
+	if (InAPIBaseURL == APIBaseURL && InModelName == ModelName)
+	{
+		return;
+	}
+	APIBaseURL = InAPIBaseURL;
+	ModelName = InModelName;
+
+	// Uploads still running belong to the old endpoint; their waiters send the context inline
+	TMap<FString, FEntry> OldEntries = MoveTemp(Entries);
+	Entries.Reset();
+	OwnerHashes.Reset();
+	for (TPair<FString, FEntry>& Pair : OldEntries)
+	{
+		for (FGeminiCacheReadyDelegate& Waiter : Pair.Value.Waiters)
+		{
+			Waiter.ExecuteIfBound(FString());
+		}
+	}
+}
+
+FString FGeminiContextCache::HashContext(const FString& Context)
+{
+	const uint64 Hash = CityHash64(reinterpret_cast<const char*>(*Context), Context.Len() * sizeof(TCHAR));
+	return FString::Printf(TEXT("%016llx-%d"), Hash, Context.Len());
+}
+
+void FGeminiContextCache::Acquire(const FString& OwnerKey, const FString& Context, const FString& Model, const FString& APIKey, FGeminiCacheReadyDelegate OnReady)
+{
+	check(IsInGameThread());
+
+	// Too small to be accepted as cached content; sending it inline is cheaper anyway
+	if (Context.Len() < MinContextChars)
+	{
+		OnReady.ExecuteIfBound(FString());
+		return;
+	}
+
+	const double Now = GetTime();
+	PurgeExpired(Now);
+
+	const FString EntryModel = Model.IsEmpty() ? ModelName : Model;
+	const FString Hash = HashContext(Context) + TEXT("|") + EntryModel;
+
+	// The owner's graph changed since it was cached: the old entry will not be asked about again
+	const FString* PreviousHash = OwnerHashes.Find(OwnerKey);
+	if (PreviousHash && *PreviousHash != Hash)
+	{
+		const FString StaleHash = *PreviousHash;
+		OwnerHashes.Remove(OwnerKey);
+		if (FEntry* StaleEntry = Entries.Find(StaleHash))
+		{
+			if (StaleEntry->OwnerKey == OwnerKey && StaleEntry->Waiters.Num() == 0)
+			{
+				UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiContextCache: Context of '%s' changed, dropping %s"), *OwnerKey, *StaleEntry->Name);
+				DeleteEntry(StaleHash, APIKey);
+			}
+		}
+	}
+	OwnerHashes.Add(OwnerKey, Hash);
+
+	FEntry* Entry = Entries.Find(Hash);
+	if (!Entry)
+	{
+		Entry = &Entries.Add(Hash);
+		Entry->Hash = Hash;
+		Entry->OwnerKey = OwnerKey;
+		Entry->Model = EntryModel;
+		Entry->Waiters.Add(MoveTemp(OnReady));
+		CreateEntry(*Entry, Context, APIKey);
+		return;
+	}
+
+	switch (Entry->State)
+	{
+	case EEntryState::Creating:
+		Entry->Waiters.Add(MoveTemp(OnReady));
+		break;
+	case EEntryState::Ready:
+		if (Entry->ExpireTime - Now < TTLSeconds * GeminiContextCache::RenewFraction)
+		{
+			RenewEntry(*Entry, APIKey);
+		}
+		OnReady.ExecuteIfBound(Entry->Name);
+		break;
+	case EEntryState::Failed:
+		OnReady.ExecuteIfBound(FString());
+		break;
+	}
+}
+
+void FGeminiContextCache::CreateEntry(FEntry& Entry, const FString& Context, const FString& APIKey)
+{
+	TArray<uint8> Body;
+	FGeminiJsonWriter Writer(Body);
+
+	// {"model":"models/...","displayName":...,"ttl":"600s","contents":[{"role":"user","parts":[{"text":...}]}]}
+	Writer.BeginObject();
+	Writer.WriteStringField("model", FString::Printf(TEXT("models/%s"), *Entry.Model));
+	Writer.WriteStringField("displayName", Entry.OwnerKey.Right(120));
+	Writer.WriteStringField("ttl", GeminiContextCache::FormatTTL(TTLSeconds));
+	Writer.WriteKey("contents");
+	Writer.BeginArray();
+	Writer.BeginObject();
+	Writer.WriteStringField("role", TEXT("user"));
+	Writer.WriteKey("parts");
+	Writer.BeginArray();
+	Writer.BeginObject();
+	Writer.WriteStringField("text", Context);
+	Writer.EndObject();
+	Writer.EndArray();
+	Writer.EndObject();
+	Writer.EndArray();
+	Writer.EndObject();
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(FString::Printf(TEXT("%s/cachedContents?key=%s"), *APIBaseURL, *APIKey));
+	Request->SetVerb(TEXT("POST"));
+	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	Request->SetContent(MoveTemp(Body));
+	Request->OnProcessRequestComplete().BindSP(AsShared(), &FGeminiContextCache::OnCreateComplete, Entry.Hash);
+	Request->ProcessRequest();
+
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiContextCache: Uploading %d characters of context for '%s'..."), Context.Len(), *Entry.OwnerKey);
+}
+
+void FGeminiContextCache::OnCreateComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully, FString Hash)
+{
+	FEntry* Entry = Entries.Find(Hash);
+	if (!Entry)
+	{
+		return;
+	}
+
+	FString Name;
+	FString ErrorMessage;
+	int64 TokenCount = 0;
+	if (Response.IsValid())
+	{
+		GeminiContextCache::ParseCacheResponse(Response->GetContent(), Name, ErrorMessage, TokenCount);
+	}
+
+	const bool bCreated = bConnectedSuccessfully && Response.IsValid() && Response->GetResponseCode() >= 200 && Response->GetResponseCode() <= 299 && !Name.IsEmpty();
+	if (bCreated)
+	{
+		Entry->State = EEntryState::Ready;
+		Entry->Name = Name;
+		Entry->ExpireTime = GetTime() + TTLSeconds;
+		UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiContextCache: Cached '%s' as %s (%lld tokens)"), *Entry->OwnerKey, *Name, TokenCount);
+	}
+	else
+	{
+		// Remember the failure for one TTL so every follow-up does not try again
+		Entry->State = EEntryState::Failed;
+		Entry->ExpireTime = GetTime() + TTLSeconds;
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiContextCache: Could not cache '%s' (code %d): %s"), *Entry->OwnerKey,
+			Response.IsValid() ? Response->GetResponseCode() : 0, ErrorMessage.IsEmpty() ? TEXT("no connection") : *ErrorMessage);
+	}
+
+	// Waiters may acquire again and change the map, so take them out first
+	TArray<FGeminiCacheReadyDelegate> Waiters = MoveTemp(Entry->Waiters);
+	const FString ReadyName = bCreated ? Name : FString();
+	for (FGeminiCacheReadyDelegate& Waiter : Waiters)
+	{
+		Waiter.ExecuteIfBound(ReadyName);
+	}
+}
+
+void FGeminiContextCache::RenewEntry(FEntry& Entry, const FString& APIKey)
+{
+	TArray<uint8> Body;
+	FGeminiJsonWriter Writer(Body);
+	Writer.BeginObject();
+	Writer.WriteStringField("ttl", GeminiContextCache::FormatTTL(TTLSeconds));
+	Writer.EndObject();
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(FString::Printf(TEXT("%s/%s?updateMask=ttl&key=%s"), *APIBaseURL, *Entry.Name, *APIKey));
+	Request->SetVerb(TEXT("PATCH"));
+	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	Request->SetContent(MoveTemp(Body));
+	Request->ProcessRequest();
+
+	// Optimistic: if the renewal fails, the request using the entry is rejected and the entry invalidated
+	Entry.ExpireTime = GetTime() + TTLSeconds;
+	UE_LOG(LogGeminiAssistant, Verbose, TEXT("GeminiContextCache: Renewing %s"), *Entry.Name);
+}
+
+void FGeminiContextCache::DeleteEntry(const FString& Hash, const FString& APIKey)
+{
+	FEntry Entry;
+	if (!Entries.RemoveAndCopyValue(Hash, Entry))
+	{
+		return;
+	}
+
+	if (Entry.State == EEntryState::Ready && !Entry.Name.IsEmpty())
+	{
+		TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+		Request->SetURL(FString::Printf(TEXT("%s/%s?key=%s"), *APIBaseURL, *Entry.Name, *APIKey));
+		Request->SetVerb(TEXT("DELETE"));
+		Request->ProcessRequest();
+	}
+}
+
+void FGeminiContextCache::Invalidate(const FString& CachedContentName)
+{
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (It.Value().Name == CachedContentName)
+		{
+			UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiContextCache: %s is gone on the server, forgetting it"), *CachedContentName);
+			It.RemoveCurrent();
+			return;
+		}
+	}
+}
+
+void FGeminiContextCache::PurgeExpired(double Now)
+{
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		const FEntry& Entry = It.Value();
+		if (Entry.State != EEntryState::Creating && Entry.ExpireTime - GeminiContextCache::ExpiryMargin <= Now)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
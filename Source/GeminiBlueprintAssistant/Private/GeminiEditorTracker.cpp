@@ -0,0 +1,252 @@
+// Private/GeminiEditorTracker.cpp
+#include "GeminiEditorTracker.h"
+#include "GeminiAssistantTrace.h"
+#include "Editor.h"
+#include "Subsystems/AssetEditorSubsystem.h"
+#include "BlueprintEditorModule.h"
+#include "BlueprintEditor.h"
+#include "Engine/Blueprint.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Framework/Docking/TabManager.h"
+#include "Widgets/Docking/SDockTab.h"
+#include "Misc/CoreDelegates.h"
+
+namespace GeminiEditorTracker
+{
+	// Blueprint editor created for the asset; the Kismet module lists an editor only once it is fully initialized
+	static TSharedPtr<FBlueprintEditor> FindBlueprintEditor(UBlueprint* Blueprint)
+	{
+		FBlueprintEditorModule& BlueprintEditorModule = FModuleManager::LoadModuleChecked<FBlueprintEditorModule>("Kismet");
+		for (const TSharedRef<IBlueprintEditor>& EditorInstance : BlueprintEditorModule.GetBlueprintEditors())
+		{
+			TSharedRef<FBlueprintEditor> BlueprintEditor = StaticCastSharedRef<FBlueprintEditor>(EditorInstance);
+			if (BlueprintEditor->GetBlueprintObj() == Blueprint)
+			{
+				return BlueprintEditor;
+			}
+		}
+		return nullptr;
+	}
+}
+
+FGeminiEditorTracker::FGeminiEditorTracker()
+{
+}
+
+FGeminiEditorTracker::~FGeminiEditorTracker()
+{
+	Shutdown();
+}
+
+void FGeminiEditorTracker::Initialize()
+{
+	if (GEditor)
+	{
+		BindEditorEvents();
+		return;
+	}
+	PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddRaw(this, &FGeminiEditorTracker::BindEditorEvents);
+}
+
+void FGeminiEditorTracker::Shutdown()
+{
+	if (PostEngineInitHandle.IsValid())
+	{
+		FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+		PostEngineInitHandle.Reset();
+	}
+
+	UAssetEditorSubsystem* AssetEditorSubsystem = GEditor ? GEditor->GetEditorSubsystem<UAssetEditorSubsystem>() : nullptr;
+	if (AssetEditorSubsystem)
+	{
+		AssetEditorSubsystem->OnAssetEditorOpened().Remove(EditorOpenedHandle);
+		AssetEditorSubsystem->OnAssetClosedInEditor().Remove(EditorClosedHandle);
+	}
+	EditorOpenedHandle.Reset();
+	EditorClosedHandle.Reset();
+
+	if (ActiveTabChangedHandle.IsValid() || TabForegroundedHandle.IsValid())
+	{
+		FGlobalTabmanager::Get()->OnActiveTabChanged_Unsubscribe(ActiveTabChangedHandle);
+		FGlobalTabmanager::Get()->OnTabForegrounded_Unsubscribe(TabForegroundedHandle);
+		ActiveTabChangedHandle.Reset();
+		TabForegroundedHandle.Reset();
+	}
+
+	Editors.Empty();
+	ActivationOrder.Empty();
+}
+
+void FGeminiEditorTracker::BindEditorEvents()
+{
+	if (PostEngineInitHandle.IsValid())
+	{
+		FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+		PostEngineInitHandle.Reset();
+	}
+
+	UAssetEditorSubsystem* AssetEditorSubsystem = GEditor ? GEditor->GetEditorSubsystem<UAssetEditorSubsystem>() : nullptr;
+	if (!AssetEditorSubsystem)
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiEditorTracker: No asset editor subsystem, Blueprint editors are not tracked"));
+		return;
+	}
+	EditorOpenedHandle = AssetEditorSubsystem->OnAssetEditorOpened().AddRaw(this, &FGeminiEditorTracker::OnAssetEditorOpened);
+	EditorClosedHandle = AssetEditorSubsystem->OnAssetClosedInEditor().AddRaw(this, &FGeminiEditorTracker::OnAssetEditorClosed);
+
+	ActiveTabChangedHandle = FGlobalTabmanager::Get()->OnActiveTabChanged_Subscribe(FOnActiveTabChanged::FDelegate::CreateRaw(this, &FGeminiEditorTracker::OnActiveTabChanged));
+	TabForegroundedHandle = FGlobalTabmanager::Get()->OnTabForegrounded_Subscribe(FOnActiveTabChanged::FDelegate::CreateRaw(this, &FGeminiEditorTracker::OnTabForegrounded));
+
+	// Editors restored with the layout were opened before the plugin subscribed
+	for (UObject* Asset : AssetEditorSubsystem->GetAllEditedAssets())
+	{
+		if (UBlueprint* Blueprint = Cast<UBlueprint>(Asset))
+		{
+			AddEditor(Blueprint);
+		}
+	}
+}
+
+void FGeminiEditorTracker::OnAssetEditorOpened(UObject* Asset)
+{
+	if (UBlueprint* Blueprint = Cast<UBlueprint>(Asset))
+	{
+		AddEditor(Blueprint);
+		Activate(Blueprint);
+	}
+}
+
+void FGeminiEditorTracker::OnAssetEditorClosed(UObject* Asset, IAssetEditorInstance* EditorInstance)
+{
+	UBlueprint* Blueprint = Cast<UBlueprint>(Asset);
+	if (!Blueprint)
+	{
+		return;
+	}
+	Editors.Remove(Blueprint);
+	ActivationOrder.Remove(Blueprint);
+}
+
+void FGeminiEditorTracker::OnActiveTabChanged(TSharedPtr<SDockTab> PreviouslyActive, TSharedPtr<SDockTab> NewlyActive)
+{
+	ActivateEditorOfTab(NewlyActive);
+}
+
+void FGeminiEditorTracker::OnTabForegrounded(TSharedPtr<SDockTab> NewForegroundTab, TSharedPtr<SDockTab> BackgroundedTab)
+{
+	ActivateEditorOfTab(NewForegroundTab);
+}
+
+void FGeminiEditorTracker::ActivateEditorOfTab(const TSharedPtr<SDockTab>& Tab)
+{
+	if (!Tab.IsValid())
+	{
+		return;
+	}
+
+	// Graph and detail tabs live in the editor's own tab manager; the editor's major tab is owned by it
+	const TSharedPtr<FTabManager> TabManager = Tab->GetTabManagerPtr();
+	TArray<TWeakObjectPtr<UBlueprint>> Blueprints;
+	Editors.GetKeys(Blueprints);
+	for (const TWeakObjectPtr<UBlueprint>& Blueprint : Blueprints)
+	{
+		const TSharedPtr<FBlueprintEditor> BlueprintEditor = FindEditor(Blueprint.Get());
+		const TSharedPtr<FTabManager> EditorTabManager = BlueprintEditor.IsValid() ? BlueprintEditor->GetTabManager() : nullptr;
+		if (EditorTabManager.IsValid() && (EditorTabManager == TabManager || EditorTabManager->GetOwnerTab() == Tab))
+		{
+			Activate(Blueprint.Get());
+			return;
+		}
+	}
+}
+
+void FGeminiEditorTracker::Activate(UBlueprint* Blueprint)
+{
+	if (!Blueprint || (ActivationOrder.Num() > 0 && ActivationOrder.Last() == Blueprint))
+	{
+		return;
+	}
+	ActivationOrder.Remove(Blueprint);
+	ActivationOrder.Add(Blueprint);
+}
+
+void FGeminiEditorTracker::AddEditor(UBlueprint* Blueprint)
+{
+	// Resolved on first use if the editor is still being initialized
+	Editors.Add(Blueprint, GeminiEditorTracker::FindBlueprintEditor(Blueprint));
+	if (!ActivationOrder.Contains(Blueprint))
+	{
+		ActivationOrder.Insert(Blueprint, 0);
+	}
+}
+
+UBlueprint* FGeminiEditorTracker::GetActiveBlueprint() const
+{
+	for (int32 Index = ActivationOrder.Num() - 1; Index >= 0; --Index)
+	{
+		if (UBlueprint* Blueprint = ActivationOrder[Index].Get())
+		{
+			return Blueprint;
+		}
+	}
+	return nullptr;
+}
+
+TSharedPtr<FBlueprintEditor> FGeminiEditorTracker::GetActiveEditor() const
+{
+	return FindEditor(GetActiveBlueprint());
+}
+
+TSharedPtr<FBlueprintEditor> FGeminiEditorTracker::FindEditor(UBlueprint* Blueprint) const
+{
+	if (!Blueprint)
+	{
+		return nullptr;
+	}
+	const TWeakPtr<FBlueprintEditor>* Editor = Editors.Find(Blueprint);
+	if (!Editor)
+	{
+		return nullptr;
+	}
+	if (TSharedPtr<FBlueprintEditor> BlueprintEditor = Editor->Pin())
+	{
+		return BlueprintEditor;
+	}
+
+	// Opened while the editor was not yet listed; look it up once and keep it
+	TSharedPtr<FBlueprintEditor> BlueprintEditor = GeminiEditorTracker::FindBlueprintEditor(Blueprint);
+	Editors.Add(Blueprint, BlueprintEditor);
+	return BlueprintEditor;
+}
+
+UEdGraph* FGeminiEditorTracker::GetFocusedGraph(UBlueprint* Blueprint) const
+{
+	UBlueprint* TargetBlueprint = Blueprint ? Blueprint : GetActiveBlueprint();
+	const TSharedPtr<FBlueprintEditor> BlueprintEditor = FindEditor(TargetBlueprint);
+	if (!BlueprintEditor.IsValid())
+	{
+		return nullptr;
+	}
+	UEdGraph* FocusedGraph = BlueprintEditor->GetFocusedGraph();
+	return FocusedGraph && FBlueprintEditorUtils::FindBlueprintForGraph(FocusedGraph) == TargetBlueprint ? FocusedGraph : nullptr;
+}
+
+TArray<UEdGraphNode*> FGeminiEditorTracker::GetSelectedNodes(UBlueprint* Blueprint) const
+{
+	TArray<UEdGraphNode*> SelectedNodes;
+	const TSharedPtr<FBlueprintEditor> BlueprintEditor = FindEditor(Blueprint ? Blueprint : GetActiveBlueprint());
+	if (!BlueprintEditor.IsValid())
+	{
+		return SelectedNodes;
+	}
+	for (UObject* Object : BlueprintEditor->GetSelectedNodes())
+	{
+		if (UEdGraphNode* Node = Cast<UEdGraphNode>(Object))
+		{
+			SelectedNodes.Add(Node);
+		}
+	}
+	return SelectedNodes;
+}
@@ -0,0 +1,300 @@
+// Private/GeminiFixtures.cpp
+#include "GeminiFixtures.h"
+#include "GeminiAssistantTrace.h"
+#include "GeminiJsonReader.h"
+#include "GeminiJsonWriter.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Hash/CityHash.h"
+#include "HAL/IConsoleManager.h"
+#include "GeminiBackend.h"
+#include "GeminiSSEParser.h"
+#include "GeminiSummarySchema.h"
+#include "GeminiAPIClient.h"
+#include "GeminiBlueprintAssistant.h"
+
+namespace GeminiFixtures
+{
+	static const TCHAR* FileExtension = TEXT(".json");
+}
+
+FGeminiFixtureStore::FGeminiFixtureStore(const FString& InDirectory)
+	: Directory(InDirectory)
+{
+}
+
+FString FGeminiFixtureStore::MakeKey(const FString& Backend, const FString& Model, bool bStream, const TArray<uint8>& RequestBody)
+{
+	// The body is written by FGeminiJsonWriter in a fixed member order, so equal requests hash equally
+	const FString Header = FString::Printf(TEXT("%s|%s|%d|"), *Backend, *Model, bStream ? 1 : 0);
+	uint64 Hash = CityHash64(reinterpret_cast<const char*>(*Header), Header.Len() * sizeof(TCHAR));
+	Hash = CityHash64WithSeed(reinterpret_cast<const char*>(RequestBody.GetData()), RequestBody.Num(), Hash);
+	return FString::Printf(TEXT("%016llx"), Hash);
+}
+
+FString FGeminiFixtureStore::GetFilePath(const FString& Key) const
+{
+	return Directory / (Key + GeminiFixtures::FileExtension);
+}
+
+bool FGeminiFixtureStore::Save(const FGeminiFixture& Fixture) const
+{
+	// {"key":"...","backend":"Gemini","model":"...","stream":true,"code":200,"latencyMs":812,"request":{...},"response":"data: {...}\r\n\r\n..."}
+	TArray<uint8> Data;
+	FGeminiJsonWriter Writer(Data);
+	Writer.BeginObject();
+	Writer.WriteStringField("key", Fixture.Key);
+	Writer.WriteStringField("backend", Fixture.Backend);
+	Writer.WriteStringField("model", Fixture.Model);
+	Writer.WriteBoolField("stream", Fixture.bStream);
+	Writer.WriteIntegerField("code", Fixture.ResponseCode);
+	Writer.WriteIntegerField("latencyMs", FMath::RoundToInt(Fixture.LatencySeconds * 1000.0));
+	Writer.WriteKey("request");
+	Writer.WriteRawValue(Fixture.RequestBody.GetData(), Fixture.RequestBody.Num());
+	FString ResponseText;
+	FGeminiJsonReader::AppendUtf8(ResponseText, Fixture.ResponseBody.GetData(), Fixture.ResponseBody.Num());
+	Writer.WriteStringField("response", ResponseText);
+	Writer.EndObject();
+
+	if (!FFileHelper::SaveArrayToFile(Data, *GetFilePath(Fixture.Key)))
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiFixtures: Could not write fixture %s"), *GetFilePath(Fixture.Key));
+		return false;
+	}
+	return true;
+}
+
+bool FGeminiFixtureStore::Load(const FString& Key, FGeminiFixture& OutFixture) const
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *GetFilePath(Key), FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FGeminiJsonReader Reader(Data.GetData(), Data.Num());
+	const bool bParsed = Reader.Peek() == EGeminiJsonToken::Object && Reader.ReadObject([&Reader, &OutFixture](const FString& Field)
+	{
+		if (Field == TEXT("key"))
+		{
+			return Reader.ReadString(OutFixture.Key);
+		}
+		if (Field == TEXT("backend"))
+		{
+			return Reader.ReadString(OutFixture.Backend);
+		}
+		if (Field == TEXT("model"))
+		{
+			return Reader.ReadString(OutFixture.Model);
+		}
+		if (Field == TEXT("stream"))
+		{
+			return Reader.ReadBool(OutFixture.bStream);
+		}
+		if (Field == TEXT("code"))
+		{
+			int64 Code = 0;
+			const bool bRead = Reader.ReadInt64(Code);
+			OutFixture.ResponseCode = static_cast<int32>(Code);
+			return bRead;
+		}
+		if (Field == TEXT("latencyMs"))
+		{
+			double LatencyMs = 0.0;
+			const bool bRead = Reader.ReadNumber(LatencyMs);
+			OutFixture.LatencySeconds = LatencyMs / 1000.0;
+			return bRead;
+		}
+		if (Field == TEXT("request"))
+		{
+			const uint8* Start = nullptr;
+			int32 Num = 0;
+			if (!Reader.ReadRawValue(Start, Num))
+			{
+				return false;
+			}
+			OutFixture.RequestBody.Append(Start, Num);
+			return true;
+		}
+		if (Field == TEXT("response"))
+		{
+			FString ResponseText;
+			if (!Reader.ReadString(ResponseText))
+			{
+				return false;
+			}
+			FTCHARToUTF8 ResponseUtf8(*ResponseText, ResponseText.Len());
+			OutFixture.ResponseBody.Append(reinterpret_cast<const uint8*>(ResponseUtf8.Get()), ResponseUtf8.Length());
+			return true;
+		}
+		return Reader.SkipValue();
+	});
+
+	if (!bParsed)
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiFixtures: %s is not a valid fixture"), *GetFilePath(Key));
+		return false;
+	}
+	return true;
+}
+
+TArray<FString> FGeminiFixtureStore::FindAllKeys() const
+{
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *(Directory / (FString(TEXT("*")) + GeminiFixtures::FileExtension)), true, false);
+
+	TArray<FString> Keys;
+	for (const FString& File : Files)
+	{
+		Keys.Add(FPaths::GetBaseFilename(File));
+	}
+	Keys.Sort();
+	return Keys;
+}
+
+FString FGeminiFixtureStore::GetDefaultDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("GeminiAssistant") / TEXT("Fixtures");
+}
+
+EGeminiFixtureMode FGeminiFixtureStore::ParseMode(const FString& Name)
+{
+	if (Name.Equals(TEXT("Record"), ESearchCase::IgnoreCase))
+	{
+		return EGeminiFixtureMode::Record;
+	}
+	if (Name.Equals(TEXT("Replay"), ESearchCase::IgnoreCase))
+	{
+		return EGeminiFixtureMode::Replay;
+	}
+	return EGeminiFixtureMode::Off;
+}
+
+const TCHAR* FGeminiFixtureStore::GetModeName(EGeminiFixtureMode Mode)
+{
+	switch (Mode)
+	{
+	case EGeminiFixtureMode::Record: return TEXT("Record");
+	case EGeminiFixtureMode::Replay: return TEXT("Replay");
+	default: return TEXT("Off");
+	}
+}
+
+namespace GeminiFixtures
+{
+	// Gemini.Fixtures.Mode <Off|Record|Replay> [Dir] [Latency=0]
+	static void ModeCommand(const TArray<FString>& Args)
+	{
+		if (Args.Num() == 0)
+		{
+			UE_LOG(LogGeminiAssistant, Display, TEXT("GeminiFixtures: Mode is %s"), FGeminiFixtureStore::GetModeName(FGeminiBlueprintAssistantModule::Get().GetAPIClient()->GetFixtureMode()));
+			return;
+		}
+		const EGeminiFixtureMode Mode = FGeminiFixtureStore::ParseMode(Args[0]);
+
+		// Latency= may come with or without a directory before it
+		FString Directory;
+		bool bWithLatency = false;
+		for (int32 Index = 1; Index < Args.Num(); ++Index)
+		{
+			if (!FParse::Bool(*Args[Index], TEXT("Latency="), bWithLatency))
+			{
+				Directory = Args[Index];
+			}
+		}
+		FGeminiBlueprintAssistantModule::Get().GetAPIClient()->SetFixtureMode(Mode, Directory, bWithLatency);
+		UE_LOG(LogGeminiAssistant, Display, TEXT("GeminiFixtures: Mode is %s"), FGeminiFixtureStore::GetModeName(Mode));
+	}
+
+	// Parses one fixture the way the panel would receive it; false with a reason if the panel would show an error
+	static bool CheckFixture(const FGeminiFixture& Fixture, FString& OutProblem)
+	{
+		TSharedPtr<IGeminiBackend, ESPMode::ThreadSafe> Backend = IGeminiBackend::Create(Fixture.Backend);
+		if (!Backend.IsValid())
+		{
+			OutProblem = FString::Printf(TEXT("unknown backend %s"), *Fixture.Backend);
+			return false;
+		}
+
+		FString Text;
+		FGeminiParsedResponse Parsed;
+		if (Fixture.bStream)
+		{
+			FGeminiSSEParser Parser;
+			TArray<TArray<uint8>> Events;
+			Parser.Feed(Fixture.ResponseBody.GetData(), Fixture.ResponseBody.Num(), Events);
+			Parser.Finish(Events);
+			for (const TArray<uint8>& Event : Events)
+			{
+				FGeminiParsedResponse Chunk;
+				if (Backend->ParseStreamEvent(Event.GetData(), Event.Num(), Chunk))
+				{
+					Text += Chunk.Text;
+				}
+				else if (!Chunk.ErrorMessage.IsEmpty())
+				{
+					Parsed.ErrorMessage = Chunk.ErrorMessage;
+				}
+			}
+		}
+		else if (Backend->ParseResponse(Fixture.ResponseBody.GetData(), Fixture.ResponseBody.Num(), Parsed))
+		{
+			Text = MoveTemp(Parsed.Text);
+		}
+
+		if (Text.IsEmpty())
+		{
+			OutProblem = Parsed.ErrorMessage.IsEmpty() ? FString(TEXT("no text in the response")) : Parsed.ErrorMessage;
+			return false;
+		}
+
+		// Structured answers have to follow the schema; free text answers need the DETAILS marker
+		FGeminiStructuredSummary Summary;
+		if (!FGeminiSummarySchema::Parse(Text, Summary) && !Text.Contains(TEXT("DETAILS:")))
+		{
+			OutProblem = TEXT("answer is neither a structured summary nor DETAILS/SUMMARY text");
+			return false;
+		}
+		return true;
+	}
+
+	// Gemini.Fixtures.Check [Dir]
+	static void CheckCommand(const TArray<FString>& Args)
+	{
+		const FGeminiFixtureStore Store(Args.Num() > 0 ? Args[0] : FGeminiFixtureStore::GetDefaultDirectory());
+		const double StartTime = FPlatformTime::Seconds();
+
+		int32 Passed = 0;
+		int32 Failed = 0;
+		for (const FString& Key : Store.FindAllKeys())
+		{
+			FGeminiFixture Fixture;
+			FString Problem;
+			if (!Store.Load(Key, Fixture))
+			{
+				Problem = TEXT("could not be read");
+			}
+			else if (CheckFixture(Fixture, Problem))
+			{
+				++Passed;
+				continue;
+			}
+			++Failed;
+			UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiFixtures: %s: %s"), *Key, *Problem);
+		}
+
+		UE_LOG(LogGeminiAssistant, Display, TEXT("GeminiFixtures: %d of %d fixtures in %s parsed in %.3f s"),
+			Passed, Passed + Failed, *Store.GetDirectory(), FPlatformTime::Seconds() - StartTime);
+	}
+
+	static FAutoConsoleCommand FixtureModeCommand(
+		TEXT("Gemini.Fixtures.Mode"),
+		TEXT("Records responses as fixtures or answers requests from them without a server. Usage: Gemini.Fixtures.Mode <Off|Record|Replay> [Dir] [Latency=0]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&ModeCommand));
+
+	static FAutoConsoleCommand FixtureCheckCommand(
+		TEXT("Gemini.Fixtures.Check"),
+		TEXT("Parses every recorded fixture into a panel summary and reports the ones that fail. Usage: Gemini.Fixtures.Check [Dir]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&CheckCommand));
+}
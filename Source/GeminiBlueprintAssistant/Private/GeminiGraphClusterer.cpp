@@ -0,0 +1,298 @@
+// Private/GeminiGraphClusterer.cpp
+#include "GeminiGraphClusterer.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "EdGraph/EdGraphPin.h"
+#include "EdGraphNode_Comment.h"
+#include "EdGraphSchema_K2.h"
+#include "Misc/ConfigCacheIni.h"
+
+namespace GeminiGraphClusterer
+{
+	static const int32 DefaultMaxNodes = 40;
+	static const int32 DefaultMinNodes = 3;
+	static const float DefaultMergeDistance = 400.0f;
+
+	// Union-find over node indices, always keeping the smaller index as root so results do not depend on link order
+	struct FNodeSets
+	{
+		TArray<int32> Parents;
+
+		explicit FNodeSets(int32 Num)
+		{
+			Parents.SetNumUninitialized(Num);
+			for (int32 Index = 0; Index < Num; ++Index)
+			{
+				Parents[Index] = Index;
+			}
+		}
+
+		int32 Find(int32 Index)
+		{
+			while (Parents[Index] != Index)
+			{
+				Parents[Index] = Parents[Parents[Index]];
+				Index = Parents[Index];
+			}
+			return Index;
+		}
+
+		void Union(int32 A, int32 B)
+		{
+			A = Find(A);
+			B = Find(B);
+			if (A != B)
+			{
+				Parents[FMath::Max(A, B)] = FMath::Min(A, B);
+			}
+		}
+	};
+
+	static bool IsExecPin(const UEdGraphPin* Pin)
+	{
+		return Pin->PinType.PinCategory == UEdGraphSchema_K2::PC_Exec;
+	}
+
+	static FVector2D GetPosition(const UEdGraphNode* Node)
+	{
+		return FVector2D(Node->NodePosX, Node->NodePosY);
+	}
+
+	// Gap between two boxes, zero if they overlap
+	static float GetDistance(const FBox2D& A, const FBox2D& B)
+	{
+		const float DX = FMath::Max3(0.0f, A.Min.X - B.Max.X, B.Min.X - A.Max.X);
+		const float DY = FMath::Max3(0.0f, A.Min.Y - B.Max.Y, B.Min.Y - A.Max.Y);
+		return FMath::Sqrt(DX * DX + DY * DY);
+	}
+}
+
+FGeminiGraphClusterer::FGeminiGraphClusterer()
+	: MaxNodes(GeminiGraphClusterer::DefaultMaxNodes)
+	, MinNodes(GeminiGraphClusterer::DefaultMinNodes)
+	, MergeDistance(GeminiGraphClusterer::DefaultMergeDistance)
+{
+	if (GConfig)
+	{
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("ClusterMaxNodes"), MaxNodes, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("ClusterMinNodes"), MinNodes, GEditorPerProjectIni);
+		GConfig->GetFloat(TEXT("GeminiAssistant"), TEXT("ClusterMergeDistance"), MergeDistance, GEditorPerProjectIni);
+	}
+	MinNodes = FMath::Max(1, MinNodes);
+	MaxNodes = FMath::Max(MinNodes, MaxNodes);
+	MergeDistance = FMath::Max(0.0f, MergeDistance);
+}
+
+TArray<FGeminiNodeCluster> FGeminiGraphClusterer::Cluster(UEdGraph* Graph) const
+{
+	using namespace GeminiGraphClusterer;
+
+	TArray<FGeminiNodeCluster> Clusters;
+	if (!Graph)
+	{
+		return Clusters;
+	}
+
+	// Existing comment boxes mark parts that are documented already
+	TArray<FBox2D> CommentBounds;
+	for (const UEdGraphNode* Node : Graph->Nodes)
+	{
+		if (const UEdGraphNode_Comment* Comment = Cast<UEdGraphNode_Comment>(Node))
+		{
+			CommentBounds.Add(FBox2D(GetPosition(Comment), GetPosition(Comment) + FVector2D(Comment->NodeWidth, Comment->NodeHeight)));
+		}
+	}
+
+	TArray<UEdGraphNode*> Nodes;
+	TMap<const UEdGraphNode*, int32> NodeIndices;
+	TArray<bool> IsPure;
+	for (UEdGraphNode* Node : Graph->Nodes)
+	{
+		if (!Node || !IsValid(Node) || Node->IsA<UEdGraphNode_Comment>())
+		{
+			continue;
+		}
+		const FVector2D Position = GetPosition(Node);
+		if (CommentBounds.ContainsByPredicate([&Position](const FBox2D& Bounds) { return Bounds.IsInside(Position); }))
+		{
+			continue;
+		}
+		NodeIndices.Add(Node, Nodes.Num());
+		Nodes.Add(Node);
+		IsPure.Add(!Node->Pins.ContainsByPredicate([](const UEdGraphPin* Pin) { return Pin && IsExecPin(Pin); }));
+	}
+
+	// Exec wires make the chains; data wires join pure nodes into networks, but never two chains to each other
+	FNodeSets Sets(Nodes.Num());
+	for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+	{
+		for (const UEdGraphPin* Pin : Nodes[Index]->Pins)
+		{
+			if (!Pin)
+			{
+				continue;
+			}
+			for (const UEdGraphPin* LinkedPin : Pin->LinkedTo)
+			{
+				const int32* LinkedIndex = LinkedPin ? NodeIndices.Find(LinkedPin->GetOwningNode()) : nullptr;
+				if (LinkedIndex && (IsExecPin(Pin) || (IsPure[Index] && IsPure[*LinkedIndex])))
+				{
+					Sets.Union(Index, *LinkedIndex);
+				}
+			}
+		}
+	}
+
+	// A pure network joins the closest chain it is wired to, so a shared getter does not merge two chains
+	TMap<int32, TPair<int32, float>> ClosestChains;
+	for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+	{
+		if (!IsPure[Index])
+		{
+			continue;
+		}
+		for (const UEdGraphPin* Pin : Nodes[Index]->Pins)
+		{
+			if (!Pin)
+			{
+				continue;
+			}
+			for (const UEdGraphPin* LinkedPin : Pin->LinkedTo)
+			{
+				const int32* LinkedIndex = LinkedPin ? NodeIndices.Find(LinkedPin->GetOwningNode()) : nullptr;
+				if (!LinkedIndex || IsPure[*LinkedIndex])
+				{
+					continue;
+				}
+				const float Distance = FVector2D::Distance(GetPosition(Nodes[Index]), GetPosition(Nodes[*LinkedIndex]));
+				TPair<int32, float>* Closest = ClosestChains.Find(Sets.Find(Index));
+				if (!Closest || Distance < Closest->Value)
+				{
+					ClosestChains.Add(Sets.Find(Index), TPair<int32, float>(*LinkedIndex, Distance));
+				}
+			}
+		}
+	}
+	for (const TPair<int32, TPair<int32, float>>& Closest : ClosestChains)
+	{
+		Sets.Union(Closest.Key, Closest.Value.Key);
+	}
+
+	TMap<int32, int32> ClusterIndices;
+	for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+	{
+		const int32 Root = Sets.Find(Index);
+		int32* ClusterIndex = ClusterIndices.Find(Root);
+		if (!ClusterIndex)
+		{
+			ClusterIndex = &ClusterIndices.Add(Root, Clusters.Num());
+			Clusters.AddDefaulted();
+		}
+		Clusters[*ClusterIndex].Nodes.Add(Nodes[Index]);
+		Clusters[*ClusterIndex].Bounds += GetPosition(Nodes[Index]);
+	}
+
+	// Small groups join the nearest larger one if it is close enough, and are dropped otherwise
+	TArray<FGeminiNodeCluster> Merged;
+	TArray<FGeminiNodeCluster> Small;
+	for (FGeminiNodeCluster& Cluster : Clusters)
+	{
+		(Cluster.Nodes.Num() >= MinNodes ? Merged : Small).Add(MoveTemp(Cluster));
+	}
+	for (FGeminiNodeCluster& Cluster : Small)
+	{
+		FGeminiNodeCluster* Nearest = nullptr;
+		float NearestDistance = MergeDistance;
+		for (FGeminiNodeCluster& Candidate : Merged)
+		{
+			const float Distance = GetDistance(Cluster.Bounds, Candidate.Bounds);
+			if (Distance <= NearestDistance)
+			{
+				Nearest = &Candidate;
+				NearestDistance = Distance;
+			}
+		}
+		if (Nearest)
+		{
+			Nearest->Nodes.Append(Cluster.Nodes);
+			Nearest->Bounds += Cluster.Bounds;
+		}
+	}
+
+	// Long chains are cut into slices along the direction the graph reads in
+	Clusters.Reset();
+	for (FGeminiNodeCluster& Cluster : Merged)
+	{
+		if (Cluster.Nodes.Num() <= MaxNodes)
+		{
+			Clusters.Add(MoveTemp(Cluster));
+			continue;
+		}
+		Cluster.Nodes.Sort([](const UEdGraphNode& A, const UEdGraphNode& B)
+		{
+			return A.NodePosX != B.NodePosX ? A.NodePosX < B.NodePosX : A.NodePosY < B.NodePosY;
+		});
+		const int32 NumSlices = FMath::DivideAndRoundUp(Cluster.Nodes.Num(), MaxNodes);
+		const int32 NodesPerSlice = FMath::DivideAndRoundUp(Cluster.Nodes.Num(), NumSlices);
+		for (int32 Start = 0; Start < Cluster.Nodes.Num(); Start += NodesPerSlice)
+		{
+			FGeminiNodeCluster& Slice = Clusters.AddDefaulted_GetRef();
+			for (int32 Index = Start; Index < FMath::Min(Start + NodesPerSlice, Cluster.Nodes.Num()); ++Index)
+			{
+				Slice.Nodes.Add(Cluster.Nodes[Index]);
+				Slice.Bounds += GetPosition(Cluster.Nodes[Index]);
+			}
+		}
+	}
+
+	Clusters.Sort([](const FGeminiNodeCluster& A, const FGeminiNodeCluster& B)
+	{
+		return A.Bounds.Min.Y != B.Bounds.Min.Y ? A.Bounds.Min.Y < B.Bounds.Min.Y : A.Bounds.Min.X < B.Bounds.Min.X;
+	});
+	return Clusters;
+}
+
+TMap<int32, FString> FGeminiGraphClusterer::ParseClusterComments(const FString& Response)
+{
+	TMap<int32, FString> Comments;
+	TArray<FString> Lines;
+	Response.ParseIntoArrayLines(Lines);
+	for (const FString& RawLine : Lines)
+	{
+		// Models like to decorate the label, e.g. "**CLUSTER 3:**" or "- Cluster 3 -"
+		FString Line = RawLine.TrimStartAndEnd().Replace(TEXT("*"), TEXT(""));
+		Line.RemoveFromStart(TEXT("- "));
+		if (!Line.StartsWith(TEXT("CLUSTER"), ESearchCase::IgnoreCase))
+		{
+			continue;
+		}
+
+		int32 Index = 7;
+		while (Index < Line.Len() && FChar::IsWhitespace(Line[Index]))
+		{
+			++Index;
+		}
+		const int32 NumberStart = Index;
+		while (Index < Line.Len() && FChar::IsDigit(Line[Index]))
+		{
+			++Index;
+		}
+		if (Index == NumberStart)
+		{
+			continue;
+		}
+		const int32 Number = FCString::Atoi(*Line.Mid(NumberStart, Index - NumberStart));
+
+		FString Comment = Line.Mid(Index).TrimStart();
+		if (Comment.StartsWith(TEXT(":")) || Comment.StartsWith(TEXT("-")))
+		{
+			Comment.RightChopInline(1);
+		}
+		Comment.TrimStartAndEndInline();
+		if (!Comment.IsEmpty())
+		{
+			Comments.Add(Number, Comment);
+		}
+	}
+	return Comments;
+}
@@ -0,0 +1,497 @@
+// Private/GeminiJsonReader.cpp
+#include "GeminiJsonReader.h"
+
+namespace GeminiJsonReader
+{
+	static bool IsWhitespace(uint8 Char)
+	{
+		return Char == ' ' || Char == '\t' || Char == '\n' || Char == '\r';
+	}
+
+	static bool IsNumberChar(uint8 Char)
+	{
+		return (Char >= '0' && Char <= '9') || Char == '-' || Char == '+' || Char == '.' || Char == 'e' || Char == 'E';
+	}
+
+	// Encodes a code point as UTF-8; invalid code points become U+FFFD
+	static void AppendCodePoint(TArray<uint8>& Out, uint32 CodePoint)
+	{
+		if (CodePoint > 0x10FFFF || (CodePoint >= 0xD800 && CodePoint <= 0xDFFF))
+		{
+			CodePoint = 0xFFFD;
+		}
+
+		if (CodePoint < 0x80)
+		{
+			Out.Add(static_cast<uint8>(CodePoint));
+		}
+		else if (CodePoint < 0x800)
+		{
+			Out.Add(static_cast<uint8>(0xC0 | (CodePoint >> 6)));
+			Out.Add(static_cast<uint8>(0x80 | (CodePoint & 0x3F)));
+		}
+		else if (CodePoint < 0x10000)
+		{
+			Out.Add(static_cast<uint8>(0xE0 | (CodePoint >> 12)));
+			Out.Add(static_cast<uint8>(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Out.Add(static_cast<uint8>(0x80 | (CodePoint & 0x3F)));
+		}
+		else
+		{
+			Out.Add(static_cast<uint8>(0xF0 | (CodePoint >> 18)));
+			Out.Add(static_cast<uint8>(0x80 | ((CodePoint >> 12) & 0x3F)));
+			Out.Add(static_cast<uint8>(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Out.Add(static_cast<uint8>(0x80 | (CodePoint & 0x3F)));
+		}
+	}
+}
+
+FGeminiJsonReader::FGeminiJsonReader(const uint8* InData, int32 InNum)
+	: Data(InData)
+	, Num(InData ? InNum : 0)
+	, Pos(0)
+	, bError(false)
+{
+}
+
+void FGeminiJsonReader::AppendUtf8(FString& OutValue, const uint8* Bytes, int32 NumBytes)
+{
+	if (NumBytes > 0)
+	{
+		auto Converted = StringCast<TCHAR>(reinterpret_cast<const UTF8CHAR*>(Bytes), NumBytes);
+		OutValue.Append(Converted.Get(), Converted.Length());
+	}
+}
+
+void FGeminiJsonReader::SkipWhitespace()
+{
+	while (Pos < Num && GeminiJsonReader::IsWhitespace(Data[Pos]))
+	{
+		++Pos;
+	}
+}
+
+bool FGeminiJsonReader::Expect(uint8 Char)
+{
+	if (bError || Pos >= Num || Data[Pos] != Char)
+	{
+		return Fail();
+	}
+	++Pos;
+	return true;
+}
+
+bool FGeminiJsonReader::Fail()
+{
+	bError = true;
+	return false;
+}
+
+EGeminiJsonToken FGeminiJsonReader::Peek()
+{
+	SkipWhitespace();
+	if (bError || Pos >= Num)
+	{
+		return EGeminiJsonToken::Invalid;
+	}
+
+	switch (Data[Pos])
+	{
+	case '{': return EGeminiJsonToken::Object;
+	case '[': return EGeminiJsonToken::Array;
+	case '"': return EGeminiJsonToken::String;
+	case 't': return EGeminiJsonToken::True;
+	case 'f': return EGeminiJsonToken::False;
+	case 'n': return EGeminiJsonToken::Null;
+	default:
+		return (Data[Pos] == '-' || (Data[Pos] >= '0' && Data[Pos] <= '9')) ? EGeminiJsonToken::Number : EGeminiJsonToken::Invalid;
+	}
+}
+
+bool FGeminiJsonReader::IsAtEnd()
+{
+	SkipWhitespace();
+	return Pos >= Num;
+}
+
+bool FGeminiJsonReader::ReadObject(TFunctionRef<bool(const FString& Key)> OnMember)
+{
+	SkipWhitespace();
+	if (!Expect('{'))
+	{
+		return false;
+	}
+
+	SkipWhitespace();
+	if (Pos < Num && Data[Pos] == '}')
+	{
+		++Pos;
+		return true;
+	}
+
+	FString Key;
+	while (!bError)
+	{
+		Key.Reset();
+		if (!ReadString(Key))
+		{
+			return false;
+		}
+		SkipWhitespace();
+		if (!Expect(':'))
+		{
+			return false;
+		}
+		if (!OnMember(Key) || bError)
+		{
+			return Fail();
+		}
+
+		SkipWhitespace();
+		if (Pos >= Num)
+		{
+			return Fail();
+		}
+		if (Data[Pos] == ',')
+		{
+			++Pos;
+			continue;
+		}
+		if (Data[Pos] == '}')
+		{
+			++Pos;
+			return true;
+		}
+		return Fail();
+	}
+	return false;
+}
+
+bool FGeminiJsonReader::ReadArray(TFunctionRef<bool(int32 Index)> OnElement)
+{
+	SkipWhitespace();
+	if (!Expect('['))
+	{
+		return false;
+	}
+
+	SkipWhitespace();
+	if (Pos < Num && Data[Pos] == ']')
+	{
+		++Pos;
+		return true;
+	}
+
+	int32 Index = 0;
+	while (!bError)
+	{
+		if (!OnElement(Index++) || bError)
+		{
+			return Fail();
+		}
+
+		SkipWhitespace();
+		if (Pos >= Num)
+		{
+			return Fail();
+		}
+		if (Data[Pos] == ',')
+		{
+			++Pos;
+			continue;
+		}
+		if (Data[Pos] == ']')
+		{
+			++Pos;
+			return true;
+		}
+		return Fail();
+	}
+	return false;
+}
+
+bool FGeminiJsonReader::ReadString(FString& OutValue)
+{
+	OutValue.Reset();
+	return AppendString(OutValue);
+}
+
+bool FGeminiJsonReader::AppendString(FString& OutValue)
+{
+	SkipWhitespace();
+	if (!Expect('"'))
+	{
+		return false;
+	}
+
+	// Fast path: no escapes, the bytes can be converted in place
+	const int32 Start = Pos;
+	while (Pos < Num && Data[Pos] != '"' && Data[Pos] != '\\')
+	{
+		++Pos;
+	}
+	if (Pos >= Num)
+	{
+		return Fail();
+	}
+	if (Data[Pos] == '"')
+	{
+		AppendUtf8(OutValue, Data + Start, Pos - Start);
+		++Pos;
+		return true;
+	}
+
+	// Slow path: decode the escapes into the scratch buffer first
+	Scratch.Reset();
+	Scratch.Append(Data + Start, Pos - Start);
+	while (Pos < Num)
+	{
+		const uint8 Char = Data[Pos++];
+		if (Char == '"')
+		{
+			AppendUtf8(OutValue, Scratch.GetData(), Scratch.Num());
+			return true;
+		}
+		if (Char != '\\')
+		{
+			Scratch.Add(Char);
+			continue;
+		}
+		if (Pos >= Num)
+		{
+			return Fail();
+		}
+
+		const uint8 Escaped = Data[Pos++];
+		switch (Escaped)
+		{
+		case '"': Scratch.Add('"'); break;
+		case '\\': Scratch.Add('\\'); break;
+		case '/': Scratch.Add('/'); break;
+		case 'b': Scratch.Add('\b'); break;
+		case 'f': Scratch.Add('\f'); break;
+		case 'n': Scratch.Add('\n'); break;
+		case 'r': Scratch.Add('\r'); break;
+		case 't': Scratch.Add('\t'); break;
+		case 'u':
+		{
+			uint32 CodePoint = 0;
+			if (!ReadHex4(CodePoint))
+			{
+				return false;
+			}
+			// Characters outside the BMP arrive as a \uD8xx\uDCxx surrogate pair
+			if (CodePoint >= 0xD800 && CodePoint <= 0xDBFF && Pos + 1 < Num && Data[Pos] == '\\' && Data[Pos + 1] == 'u')
+			{
+				Pos += 2;
+				uint32 LowSurrogate = 0;
+				if (!ReadHex4(LowSurrogate))
+				{
+					return false;
+				}
+				if (LowSurrogate >= 0xDC00 && LowSurrogate <= 0xDFFF)
+				{
+					CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (LowSurrogate - 0xDC00);
+				}
+				else
+				{
+					GeminiJsonReader::AppendCodePoint(Scratch, 0xFFFD);
+					CodePoint = LowSurrogate;
+				}
+			}
+			GeminiJsonReader::AppendCodePoint(Scratch, CodePoint);
+			break;
+		}
+		default:
+			return Fail();
+		}
+	}
+	return Fail();
+}
+
+bool FGeminiJsonReader::ReadHex4(uint32& OutValue)
+{
+	if (Pos + 4 > Num)
+	{
+		return Fail();
+	}
+
+	OutValue = 0;
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		const uint8 Char = Data[Pos++];
+		OutValue <<= 4;
+		if (Char >= '0' && Char <= '9')
+		{
+			OutValue |= Char - '0';
+		}
+		else if (Char >= 'a' && Char <= 'f')
+		{
+			OutValue |= Char - 'a' + 10;
+		}
+		else if (Char >= 'A' && Char <= 'F')
+		{
+			OutValue |= Char - 'A' + 10;
+		}
+		else
+		{
+			return Fail();
+		}
+	}
+	return true;
+}
+
+bool FGeminiJsonReader::ReadNumberLiteral(TCHAR* OutBuffer, int32 BufferSize, bool& bOutIsInteger)
+{
+	SkipWhitespace();
+	bOutIsInteger = true;
+
+	int32 Length = 0;
+	while (Pos < Num && GeminiJsonReader::IsNumberChar(Data[Pos]))
+	{
+		if (Length >= BufferSize - 1)
+		{
+			return Fail();
+		}
+		if (Data[Pos] == '.' || Data[Pos] == 'e' || Data[Pos] == 'E')
+		{
+			bOutIsInteger = false;
+		}
+		OutBuffer[Length++] = static_cast<TCHAR>(Data[Pos++]);
+	}
+	OutBuffer[Length] = TEXT('\0');
+	return Length > 0 ? true : Fail();
+}
+
+bool FGeminiJsonReader::ReadNumber(double& OutValue)
+{
+	TCHAR Buffer[64];
+	bool bIsInteger = false;
+	if (Peek() != EGeminiJsonToken::Number || !ReadNumberLiteral(Buffer, UE_ARRAY_COUNT(Buffer), bIsInteger))
+	{
+		return Fail();
+	}
+	OutValue = FCString::Atod(Buffer);
+	return true;
+}
+
+bool FGeminiJsonReader::ReadInt64(int64& OutValue)
+{
+	const EGeminiJsonToken Token = Peek();
+	if (Token == EGeminiJsonToken::String)
+	{
+		FString Value;
+		if (!ReadString(Value))
+		{
+			return false;
+		}
+		OutValue = FCString::Atoi64(*Value);
+		return true;
+	}
+
+	TCHAR Buffer[64];
+	bool bIsInteger = false;
+	if (Token != EGeminiJsonToken::Number || !ReadNumberLiteral(Buffer, UE_ARRAY_COUNT(Buffer), bIsInteger))
+	{
+		return Fail();
+	}
+	OutValue = bIsInteger ? FCString::Atoi64(Buffer) : static_cast<int64>(FCString::Atod(Buffer));
+	return true;
+}
+
+bool FGeminiJsonReader::ReadBool(bool& OutValue)
+{
+	const EGeminiJsonToken Token = Peek();
+	if (Token != EGeminiJsonToken::True && Token != EGeminiJsonToken::False)
+	{
+		return Fail();
+	}
+	OutValue = Token == EGeminiJsonToken::True;
+	return SkipValue();
+}
+
+bool FGeminiJsonReader::SkipString()
+{
+	if (!Expect('"'))
+	{
+		return false;
+	}
+	while (Pos < Num)
+	{
+		const uint8 Char = Data[Pos++];
+		if (Char == '\\')
+		{
+			++Pos;
+		}
+		else if (Char == '"')
+		{
+			return true;
+		}
+	}
+	return Fail();
+}
+
+bool FGeminiJsonReader::SkipValue()
+{
+	SkipWhitespace();
+	if (bError || Pos >= Num)
+	{
+		return Fail();
+	}
+
+	const uint8 First = Data[Pos];
+	if (First == '"')
+	{
+		return SkipString();
+	}
+
+	// Containers are skipped by bracket counting, only strings need to be understood
+	if (First == '{' || First == '[')
+	{
+		int32 Depth = 0;
+		while (Pos < Num)
+		{
+			const uint8 Char = Data[Pos];
+			if (Char == '"')
+			{
+				if (!SkipString())
+				{
+					return false;
+				}
+				continue;
+			}
+
+			++Pos;
+			if (Char == '{' || Char == '[')
+			{
+				++Depth;
+			}
+			else if ((Char == '}' || Char == ']') && --Depth == 0)
+			{
+				return true;
+			}
+		}
+		return Fail();
+	}
+
+	// Numbers and literals run until the next delimiter
+	const int32 Start = Pos;
+	while (Pos < Num && Data[Pos] != ',' && Data[Pos] != '}' && Data[Pos] != ']' && !GeminiJsonReader::IsWhitespace(Data[Pos]))
+	{
+		++Pos;
+	}
+	return Pos > Start ? true : Fail();
+}
+
+bool FGeminiJsonReader::ReadRawValue(const uint8*& OutStart, int32& OutNum)
+{
+	SkipWhitespace();
+	const int32 Start = Pos;
+	if (!SkipValue())
+	{
+		return false;
+	}
+	OutStart = Data + Start;
+	OutNum = Pos - Start;
+	return true;
+}
@@ -0,0 +1,205 @@
+// Private/GeminiJsonWriter.cpp
+#include "GeminiJsonWriter.h"
+
+namespace GeminiJsonWriter
+{
+	static const ANSICHAR HexDigits[] = "0123456789abcdef";
+
+	static void AppendUtf8CodePoint(TArray<uint8>& Out, uint32 CodePoint)
+	{
+		if (CodePoint < 0x800)
+		{
+			Out.Add(static_cast<uint8>(0xC0 | (CodePoint >> 6)));
+			Out.Add(static_cast<uint8>(0x80 | (CodePoint & 0x3F)));
+		}
+		else if (CodePoint < 0x10000)
+		{
+			Out.Add(static_cast<uint8>(0xE0 | (CodePoint >> 12)));
+			Out.Add(static_cast<uint8>(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Out.Add(static_cast<uint8>(0x80 | (CodePoint & 0x3F)));
+		}
+		else
+		{
+			Out.Add(static_cast<uint8>(0xF0 | (CodePoint >> 18)));
+			Out.Add(static_cast<uint8>(0x80 | ((CodePoint >> 12) & 0x3F)));
+			Out.Add(static_cast<uint8>(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Out.Add(static_cast<uint8>(0x80 | (CodePoint & 0x3F)));
+		}
+	}
+}
+
+FGeminiJsonWriter::FGeminiJsonWriter(TArray<uint8>& InOutput)
+	: Output(InOutput)
+	, bAfterKey(false)
+{
+}
+
+void FGeminiJsonWriter::BeginValue()
+{
+	if (bAfterKey)
+	{
+		bAfterKey = false;
+		return;
+	}
+	if (ContainerHasValue.Num() > 0)
+	{
+		if (ContainerHasValue.Last())
+		{
+			Output.Add(',');
+		}
+		ContainerHasValue.Last() = true;
+	}
+}
+
+void FGeminiJsonWriter::BeginObject()
+{
+	BeginValue();
+	Output.Add('{');
+	ContainerHasValue.Add(false);
+}
+
+void FGeminiJsonWriter::EndObject()
+{
+	check(ContainerHasValue.Num() > 0 && !bAfterKey);
+	ContainerHasValue.Pop();
+	Output.Add('}');
+}
+
+void FGeminiJsonWriter::BeginArray()
+{
+	BeginValue();
+	Output.Add('[');
+	ContainerHasValue.Add(false);
+}
+
+void FGeminiJsonWriter::EndArray()
+{
+	check(ContainerHasValue.Num() > 0 && !bAfterKey);
+	ContainerHasValue.Pop();
+	Output.Add(']');
+}
+
+void FGeminiJsonWriter::WriteKey(const ANSICHAR* Key)
+{
+	check(!bAfterKey);
+	BeginValue();
+	Output.Add('"');
+	AppendAscii(Key);
+	Output.Add('"');
+	Output.Add(':');
+	bAfterKey = true;
+}
+
+void FGeminiJsonWriter::WriteString(FStringView Value)
+{
+	BeginValue();
+
+	// Most prompts are ASCII, so one byte per character plus some escapes is the usual size
+	Output.Reserve(Output.Num() + Value.Len() + Value.Len() / 16 + 2);
+	Output.Add('"');
+	AppendEscaped(Value);
+	Output.Add('"');
+}
+
+void FGeminiJsonWriter::WriteNumber(double Value)
+{
+	BeginValue();
+	if (!FMath::IsFinite(Value))
+	{
+		AppendAscii("null");
+		return;
+	}
+
+	ANSICHAR Buffer[64];
+	FCStringAnsi::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), "%.17g", Value);
+	AppendAscii(Buffer);
+}
+
+void FGeminiJsonWriter::WriteInteger(int64 Value)
+{
+	BeginValue();
+	ANSICHAR Buffer[32];
+	FCStringAnsi::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), "%lld", static_cast<long long>(Value));
+	AppendAscii(Buffer);
+}
+
+void FGeminiJsonWriter::WriteBool(bool bValue)
+{
+	BeginValue();
+	AppendAscii(bValue ? "true" : "false");
+}
+
+void FGeminiJsonWriter::WriteNull()
+{
+	BeginValue();
+	AppendAscii("null");
+}
+
+void FGeminiJsonWriter::WriteRawValue(const uint8* Data, int32 Num)
+{
+	BeginValue();
+	Output.Append(Data, Num);
+}
+
+void FGeminiJsonWriter::AppendAscii(const ANSICHAR* Text)
+{
+	Output.Append(reinterpret_cast<const uint8*>(Text), FCStringAnsi::Strlen(Text));
+}
+
+void FGeminiJsonWriter::AppendEscaped(FStringView Value)
+{
+	const TCHAR* Chars = Value.GetData();
+	const int32 Len = Value.Len();
+
+	for (int32 Index = 0; Index < Len; ++Index)
+	{
+		uint32 CodePoint = static_cast<uint32>(Chars[Index]);
+
+		if (CodePoint < 0x80)
+		{
+			switch (CodePoint)
+			{
+			case '"': Output.Add('\\'); Output.Add('"'); break;
+			case '\\': Output.Add('\\'); Output.Add('\\'); break;
+			case '\n': Output.Add('\\'); Output.Add('n'); break;
+			case '\r': Output.Add('\\'); Output.Add('r'); break;
+			case '\t': Output.Add('\\'); Output.Add('t'); break;
+			case '\b': Output.Add('\\'); Output.Add('b'); break;
+			case '\f': Output.Add('\\'); Output.Add('f'); break;
+			default:
+				if (CodePoint < 0x20)
+				{
+					const uint8 Escape[] = { '\\', 'u', '0', '0', static_cast<uint8>(GeminiJsonWriter::HexDigits[CodePoint >> 4]), static_cast<uint8>(GeminiJsonWriter::HexDigits[CodePoint & 0xF]) };
+					Output.Append(Escape, UE_ARRAY_COUNT(Escape));
+				}
+				else
+				{
+					Output.Add(static_cast<uint8>(CodePoint));
+				}
+				break;
+			}
+			continue;
+		}
+
+		// UTF-16 platforms store characters outside the BMP as surrogate pairs
+		if (CodePoint >= 0xD800 && CodePoint <= 0xDBFF)
+		{
+			const uint32 Next = Index + 1 < Len ? static_cast<uint32>(Chars[Index + 1]) : 0;
+			if (Next >= 0xDC00 && Next <= 0xDFFF)
+			{
+				CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Next - 0xDC00);
+				++Index;
+			}
+			else
+			{
+				CodePoint = 0xFFFD;
+			}
+		}
+		else if ((CodePoint >= 0xDC00 && CodePoint <= 0xDFFF) || CodePoint > 0x10FFFF)
+		{
+			CodePoint = 0xFFFD;
+		}
+
+		GeminiJsonWriter::AppendUtf8CodePoint(Output, CodePoint);
+	}
+}
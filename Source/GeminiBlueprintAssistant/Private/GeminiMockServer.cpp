@@ -0,0 +1,530 @@
+// Private/GeminiMockServer.cpp
+#include "GeminiMockServer.h"
+#include "GeminiJsonWriter.h"
+#include "GeminiAssistantTrace.h"
+#include "Common/TcpListener.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "Misc/Compression.h"
+#include "HAL/IConsoleManager.h"
+
+namespace GeminiMockServer
+{
+	static TSharedPtr<FGeminiMockServer> SharedServer;
+
+	// Filler the answers are made of; plain text like the panel asks for
+	static const TCHAR* AnswerFiller = TEXT("This graph handles the event, checks the condition and calls the function with the value. ");
+
+	// How often the listener thread looks for new connections
+	static const double AcceptIntervalSeconds = 0.01;
+
+	static void AppendUTF8(TArray<uint8>& OutBytes, const FString& Text)
+	{
+		FTCHARToUTF8 Converter(*Text, Text.Len());
+		OutBytes.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+	}
+
+	// Index of the blank line ending the request header, INDEX_NONE while it has not all arrived
+	static int32 FindHeaderEnd(const TArray<uint8>& Received)
+	{
+		for (int32 Index = 0; Index + 3 < Received.Num(); ++Index)
+		{
+			if (Received[Index] == '\r' && Received[Index + 1] == '\n' && Received[Index + 2] == '\r' && Received[Index + 3] == '\n')
+			{
+				return Index;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	static bool Gunzip(const uint8* Data, int32 Num, TArray<uint8>& OutBody)
+	{
+		if (Num < 18)
+		{
+			return false;
+		}
+
+		// The last four bytes of a gzip stream hold its uncompressed size
+		const int32 Size = Data[Num - 4] | (Data[Num - 3] << 8) | (Data[Num - 2] << 16) | (Data[Num - 1] << 24);
+		OutBody.SetNumUninitialized(Size);
+		return FCompression::UncompressMemory(NAME_Gzip, OutBody.GetData(), Size, Data, Num);
+	}
+
+	static const TCHAR* GetReasonPhrase(int32 Code)
+	{
+		switch (Code)
+		{
+		case 200: return TEXT("OK");
+		case 404: return TEXT("Not Found");
+		case 429: return TEXT("Too Many Requests");
+		case 503: return TEXT("Service Unavailable");
+		default: return Code < 400 ? TEXT("OK") : TEXT("Error");
+		}
+	}
+}
+
+FString FGeminiMockRequest::GetBodyString() const
+{
+	FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Body.GetData()), Body.Num());
+	return FString(Converter.Length(), Converter.Get());
+}
+
+void FGeminiMockServerSettings::ParseArgs(const TArray<FString>& Args)
+{
+	for (const FString& Arg : Args)
+	{
+		const TCHAR* Stream = *Arg;
+		FParse::Value(Stream, TEXT("Port="), Port);
+		FParse::Value(Stream, TEXT("LatencyMs="), LatencyMs);
+		FParse::Value(Stream, TEXT("JitterMs="), JitterMs);
+		FParse::Value(Stream, TEXT("ErrorRate="), ErrorRate);
+		FParse::Value(Stream, TEXT("ErrorCode="), ErrorCode);
+		FParse::Value(Stream, TEXT("ResponseChars="), ResponseChars);
+		FParse::Value(Stream, TEXT("StreamChunks="), StreamChunks);
+		FParse::Value(Stream, TEXT("StreamIntervalMs="), StreamIntervalMs);
+	}
+	ErrorRate = FMath::Clamp(ErrorRate, 0.0f, 1.0f);
+	StreamChunks = FMath::Max(1, StreamChunks);
+	StreamIntervalMs = FMath::Max(0.0f, StreamIntervalMs);
+}
+
+FGeminiMockServer::FGeminiMockServer()
+	: NumRequests(0)
+	, NextCacheId(1)
+{
+}
+
+FGeminiMockServer::~FGeminiMockServer()
+{
+	Stop();
+}
+
+TSharedPtr<FGeminiMockServer> FGeminiMockServer::GetShared()
+{
+	return GeminiMockServer::SharedServer;
+}
+
+void FGeminiMockServer::SetShared(TSharedPtr<FGeminiMockServer> Server)
+{
+	GeminiMockServer::SharedServer = Server;
+}
+
+bool FGeminiMockServer::Start(const FGeminiMockServerSettings& InSettings)
+{
+	Stop();
+	Settings = InSettings;
+	NumRequests = 0;
+	Requests.Reset();
+
+	// Loopback only; the stand-in has no business being reachable from other machines
+	Listener = MakeUnique<FTcpListener>(FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), Settings.Port), FTimespan::FromSeconds(GeminiMockServer::AcceptIntervalSeconds), false);
+	if (!Listener->IsActive())
+	{
+		Listener.Reset();
+		UE_LOG(LogGeminiAssistant, Error, TEXT("GeminiMockServer: Could not listen on port %d"), Settings.Port);
+		return false;
+	}
+	Listener->OnConnectionAccepted().BindSP(this, &FGeminiMockServer::OnConnectionAccepted);
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FGeminiMockServer::Tick));
+
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiMockServer: Listening at %s (latency %.0f+%.0f ms, error rate %.2f, %d characters per answer)"),
+		*GetBaseURL(), Settings.LatencyMs, Settings.JitterMs, Settings.ErrorRate, Settings.ResponseChars);
+	return true;
+}
+
+void FGeminiMockServer::Stop()
+{
+	if (!Listener.IsValid())
+	{
+		return;
+	}
+
+	// Stops the listener thread, so nothing is added to AcceptedSockets any more
+	Listener.Reset();
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	FSocket* Socket = nullptr;
+	while (AcceptedSockets.Dequeue(Socket))
+	{
+		CloseSocket(Socket);
+	}
+	for (const TUniquePtr<FConnection>& Connection : Connections)
+	{
+		CloseSocket(Connection->Socket);
+	}
+	Connections.Reset();
+
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiMockServer: Stopped after %d requests"), NumRequests);
+}
+
+FString FGeminiMockServer::GetBaseURL() const
+{
+	return FString::Printf(TEXT("http://127.0.0.1:%d/v1beta"), Settings.Port);
+}
+
+bool FGeminiMockServer::OnConnectionAccepted(FSocket* Socket, const FIPv4Endpoint& Endpoint)
+{
+	AcceptedSockets.Enqueue(Socket);
+	return true;
+}
+
+void FGeminiMockServer::CloseSocket(FSocket* Socket)
+{
+	Socket->Close();
+	ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+}
+
+bool FGeminiMockServer::Tick(float DeltaTime)
+{
+	FSocket* Socket = nullptr;
+	while (AcceptedSockets.Dequeue(Socket))
+	{
+		Socket->SetNonBlocking(true);
+		TUniquePtr<FConnection> Connection = MakeUnique<FConnection>();
+		Connection->Socket = Socket;
+		Connections.Add(MoveTemp(Connection));
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < Connections.Num();)
+	{
+		FConnection& Connection = *Connections[Index];
+		if (ReceiveRequest(Connection) && SendOutgoing(Connection, Now))
+		{
+			++Index;
+			continue;
+		}
+		CloseSocket(Connection.Socket);
+		Connections.RemoveAt(Index);
+	}
+	return true;
+}
+
+bool FGeminiMockServer::ReceiveRequest(FConnection& Connection)
+{
+	if (Connection.bAnswered)
+	{
+		return true;
+	}
+
+	uint8 Buffer[16 * 1024];
+	for (;;)
+	{
+		// A closed connection fails, one with nothing to read yet succeeds with no bytes
+		int32 BytesRead = 0;
+		if (!Connection.Socket->Recv(Buffer, sizeof(Buffer), BytesRead))
+		{
+			return false;
+		}
+		if (BytesRead == 0)
+		{
+			break;
+		}
+		Connection.Received.Append(Buffer, BytesRead);
+	}
+
+	FGeminiMockRequest Request;
+	if (ParseRequest(Connection, Request))
+	{
+		Connection.bAnswered = true;
+		Connection.Received.Empty();
+		HandleRequest(Connection, Request);
+	}
+	return true;
+}
+
+bool FGeminiMockServer::SendOutgoing(FConnection& Connection, double Now)
+{
+	while (Connection.Outgoing.Num() > 0 && Connection.Outgoing[0].SendTime <= Now)
+	{
+		FOutgoing& Outgoing = Connection.Outgoing[0];
+		int32 BytesSent = 0;
+		if (!Connection.Socket->Send(Outgoing.Bytes.GetData() + Outgoing.BytesSent, Outgoing.Bytes.Num() - Outgoing.BytesSent, BytesSent))
+		{
+			// A full send buffer is not an error; the rest goes out on a later tick
+			return ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode() == SE_EWOULDBLOCK;
+		}
+		Outgoing.BytesSent += BytesSent;
+		if (Outgoing.BytesSent < Outgoing.Bytes.Num())
+		{
+			return true;
+		}
+		Connection.Outgoing.RemoveAt(0);
+	}
+
+	// Every answer ends with the connection, which is also how a streamed one tells the client it is complete
+	return !Connection.bAnswered || Connection.Outgoing.Num() > 0;
+}
+
+bool FGeminiMockServer::ParseRequest(FConnection& Connection, FGeminiMockRequest& OutRequest) const
+{
+	const int32 HeaderEnd = GeminiMockServer::FindHeaderEnd(Connection.Received);
+	if (HeaderEnd == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FUTF8ToTCHAR HeaderConverter(reinterpret_cast<const ANSICHAR*>(Connection.Received.GetData()), HeaderEnd);
+	TArray<FString> Lines;
+	FString(HeaderConverter.Length(), HeaderConverter.Get()).ParseIntoArray(Lines, TEXT("\r\n"));
+	TArray<FString> RequestLine;
+	if (Lines.Num() == 0 || Lines[0].ParseIntoArrayWS(RequestLine) < 2)
+	{
+		return false;
+	}
+
+	int32 ContentLength = 0;
+	bool bGzip = false;
+	bool bExpectContinue = false;
+	for (int32 Index = 1; Index < Lines.Num(); ++Index)
+	{
+		FString Name;
+		FString Value;
+		if (!Lines[Index].Split(TEXT(":"), &Name, &Value))
+		{
+			continue;
+		}
+		Value.TrimStartAndEndInline();
+		if (Name.Equals(TEXT("Content-Length"), ESearchCase::IgnoreCase))
+		{
+			ContentLength = FCString::Atoi(*Value);
+		}
+		else if (Name.Equals(TEXT("Content-Encoding"), ESearchCase::IgnoreCase))
+		{
+			bGzip = Value.Equals(TEXT("gzip"), ESearchCase::IgnoreCase);
+		}
+		else if (Name.Equals(TEXT("Expect"), ESearchCase::IgnoreCase))
+		{
+			bExpectContinue = Value.Equals(TEXT("100-continue"), ESearchCase::IgnoreCase);
+		}
+	}
+
+	const int32 BodyStart = HeaderEnd + 4;
+	if (Connection.Received.Num() - BodyStart < ContentLength)
+	{
+		// Large uploads wait for the go-ahead before sending their body
+		if (bExpectContinue && Connection.Outgoing.Num() == 0 && Connection.Received.Num() == BodyStart)
+		{
+			FOutgoing& Continue = Connection.Outgoing.AddDefaulted_GetRef();
+			GeminiMockServer::AppendUTF8(Continue.Bytes, TEXT("HTTP/1.1 100 Continue\r\n\r\n"));
+		}
+		return false;
+	}
+
+	OutRequest.Verb = RequestLine[0];
+	RequestLine[1].Split(TEXT("?"), &OutRequest.Path, nullptr);
+	if (OutRequest.Path.IsEmpty())
+	{
+		OutRequest.Path = RequestLine[1];
+	}
+	OutRequest.Path.RemoveFromStart(TEXT("/v1beta"));
+	OutRequest.Path.RemoveFromStart(TEXT("/"));
+
+	const uint8* Body = Connection.Received.GetData() + BodyStart;
+	if (!bGzip || !GeminiMockServer::Gunzip(Body, ContentLength, OutRequest.Body))
+	{
+		UE_CLOG(bGzip, LogGeminiAssistant, Warning, TEXT("GeminiMockServer: Could not decompress the body of %s"), *OutRequest.Path);
+		OutRequest.Body = TArray<uint8>(Body, ContentLength);
+	}
+	return true;
+}
+
+double FGeminiMockServer::GetLatencySeconds() const
+{
+	return FMath::Max(0.0f, Settings.LatencyMs + FMath::FRandRange(0.0f, Settings.JitterMs)) / 1000.0;
+}
+
+void FGeminiMockServer::Respond(FConnection& Connection, int32 Code, const TArray<uint8>& Body, const TCHAR* ContentType)
+{
+	FOutgoing& Outgoing = Connection.Outgoing.AddDefaulted_GetRef();
+	Outgoing.SendTime = FPlatformTime::Seconds() + GetLatencySeconds();
+	GeminiMockServer::AppendUTF8(Outgoing.Bytes, FString::Printf(TEXT("HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %d\r\nConnection: close\r\n\r\n"),
+		Code, GeminiMockServer::GetReasonPhrase(Code), ContentType, Body.Num()));
+	Outgoing.Bytes.Append(Body);
+}
+
+void FGeminiMockServer::RespondStream(FConnection& Connection, const TArray<TArray<uint8>>& Events)
+{
+	// No Content-Length: the stream ends when the connection is closed after the last event
+	const double Now = FPlatformTime::Seconds();
+	FOutgoing& Header = Connection.Outgoing.AddDefaulted_GetRef();
+	Header.SendTime = Now;
+	GeminiMockServer::AppendUTF8(Header.Bytes, TEXT("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n"));
+
+	double SendTime = Now + GetLatencySeconds();
+	for (const TArray<uint8>& Event : Events)
+	{
+		FOutgoing& Outgoing = Connection.Outgoing.AddDefaulted_GetRef();
+		Outgoing.SendTime = SendTime;
+		Outgoing.Bytes = Event;
+		SendTime += Settings.StreamIntervalMs / 1000.0;
+	}
+}
+
+FString FGeminiMockServer::MakeAnswerText() const
+{
+	FString Text = TEXT("DETAILS: ");
+	Text.Reserve(Settings.ResponseChars + 128);
+	while (Text.Len() < Settings.ResponseChars)
+	{
+		Text += GeminiMockServer::AnswerFiller;
+	}
+	Text.LeftInline(FMath::Max(Settings.ResponseChars, 9));
+	return Text;
+}
+
+void FGeminiMockServer::WriteGenerateResponse(TArray<uint8>& OutBody, const FString& Text, bool bFinal) const
+{
+	// {"candidates":[{"content":{"role":"model","parts":[{"text":"..."}]},"finishReason":"STOP"}],"usageMetadata":{...}}
+	FGeminiJsonWriter Writer(OutBody);
+	Writer.BeginObject();
+	Writer.WriteKey("candidates");
+	Writer.BeginArray();
+	Writer.BeginObject();
+	Writer.WriteKey("content");
+	Writer.BeginObject();
+	Writer.WriteStringField("role", TEXT("model"));
+	Writer.WriteKey("parts");
+	Writer.BeginArray();
+	Writer.BeginObject();
+	Writer.WriteStringField("text", Text);
+	Writer.EndObject();
+	Writer.EndArray();
+	Writer.EndObject();
+	if (bFinal)
+	{
+		Writer.WriteStringField("finishReason", TEXT("STOP"));
+	}
+	Writer.EndObject();
+	Writer.EndArray();
+	if (bFinal)
+	{
+		Writer.WriteKey("usageMetadata");
+		Writer.BeginObject();
+		Writer.WriteIntegerField("candidatesTokenCount", Settings.ResponseChars / 4);
+		Writer.EndObject();
+	}
+	Writer.EndObject();
+}
+
+void FGeminiMockServer::HandleRequest(FConnection& Connection, const FGeminiMockRequest& Request)
+{
+	++NumRequests;
+	if (Settings.bRecordRequests)
+	{
+		Requests.Add(Request);
+	}
+
+	const FString& Path = Request.Path;
+	const bool bGenerate = Path.EndsWith(TEXT(":generateContent"));
+	const bool bStream = Path.EndsWith(TEXT(":streamGenerateContent"));
+
+	TArray<uint8> Body;
+	if ((bGenerate || bStream) && Settings.ErrorRate > 0.0f && FMath::FRand() < Settings.ErrorRate)
+	{
+		// Same shape as a real API error, so the client's retry logic sees what it would in production
+		FGeminiJsonWriter Writer(Body);
+		Writer.BeginObject();
+		Writer.WriteKey("error");
+		Writer.BeginObject();
+		Writer.WriteIntegerField("code", Settings.ErrorCode);
+		Writer.WriteStringField("message", TEXT("Injected by the mock server."));
+		Writer.WriteStringField("status", Settings.ErrorCode == 429 ? TEXT("RESOURCE_EXHAUSTED") : TEXT("UNAVAILABLE"));
+		Writer.EndObject();
+		Writer.EndObject();
+		Respond(Connection, Settings.ErrorCode, Body, TEXT("application/json"));
+		return;
+	}
+
+	if (bGenerate)
+	{
+		WriteGenerateResponse(Body, MakeAnswerText(), true);
+		Respond(Connection, 200, Body, TEXT("application/json"));
+	}
+	else if (bStream)
+	{
+		const FString Text = MakeAnswerText();
+		const int32 ChunkChars = FMath::DivideAndRoundUp(Text.Len(), Settings.StreamChunks);
+		TArray<TArray<uint8>> Events;
+		for (int32 Offset = 0; Offset < Text.Len(); Offset += ChunkChars)
+		{
+			static const ANSICHAR DataPrefix[] = "data: ";
+			TArray<uint8>& Event = Events.AddDefaulted_GetRef();
+			Event.Append(reinterpret_cast<const uint8*>(DataPrefix), sizeof(DataPrefix) - 1);
+			WriteGenerateResponse(Event, Text.Mid(Offset, ChunkChars), Offset + ChunkChars >= Text.Len());
+			Event.Append(reinterpret_cast<const uint8*>("\r\n\r\n"), 4);
+		}
+		RespondStream(Connection, Events);
+	}
+	else if (Path == TEXT("cachedContents") && Request.Verb == TEXT("POST"))
+	{
+		FGeminiJsonWriter Writer(Body);
+		Writer.BeginObject();
+		Writer.WriteStringField("name", FString::Printf(TEXT("cachedContents/mock-%d"), NextCacheId++));
+		Writer.EndObject();
+		Respond(Connection, 200, Body, TEXT("application/json"));
+	}
+	else if (Path.StartsWith(TEXT("cachedContents/")) || (Path.StartsWith(TEXT("models/")) && Request.Verb == TEXT("GET")))
+	{
+		// Renewals, deletions and the connection prewarm only need to succeed
+		FGeminiJsonWriter Writer(Body);
+		Writer.BeginObject();
+		Writer.WriteStringField("name", Path);
+		Writer.EndObject();
+		Respond(Connection, 200, Body, TEXT("application/json"));
+	}
+	else
+	{
+		FGeminiJsonWriter Writer(Body);
+		Writer.BeginObject();
+		Writer.WriteKey("error");
+		Writer.BeginObject();
+		Writer.WriteIntegerField("code", 404);
+		Writer.WriteStringField("message", FString::Printf(TEXT("The mock server does not implement '%s'."), *Path));
+		Writer.EndObject();
+		Writer.EndObject();
+		Respond(Connection, 404, Body, TEXT("application/json"));
+	}
+}
+
+namespace GeminiMockServer
+{
+	// Gemini.MockServer.Start [Port=8089] [LatencyMs=200] [JitterMs=50] [ErrorRate=0] [ErrorCode=503] [ResponseChars=2000] [StreamChunks=8] [StreamIntervalMs=50]
+	static void StartCommand(const TArray<FString>& Args)
+	{
+		FGeminiMockServerSettings Settings;
+		Settings.ParseArgs(Args);
+
+		TSharedPtr<FGeminiMockServer> Server = FGeminiMockServer::GetShared();
+		if (!Server.IsValid())
+		{
+			Server = MakeShared<FGeminiMockServer>();
+			FGeminiMockServer::SetShared(Server);
+		}
+		if (Server->Start(Settings))
+		{
+			UE_LOG(LogGeminiAssistant, Display, TEXT("GeminiMockServer: Set APIBaseURL=%s in [GeminiAssistant] and restart the editor to point the plugin at it"), *Server->GetBaseURL());
+		}
+	}
+
+	static void StopCommand()
+	{
+		if (TSharedPtr<FGeminiMockServer> Server = FGeminiMockServer::GetShared())
+		{
+			Server->Stop();
+			FGeminiMockServer::SetShared(nullptr);
+		}
+	}
+
+	static FAutoConsoleCommand StartMockServerCommand(
+		TEXT("Gemini.MockServer.Start"),
+		TEXT("Starts a local stand-in for the Gemini API. Usage: Gemini.MockServer.Start [Port=8089] [LatencyMs=200] [JitterMs=50] [ErrorRate=0] [ErrorCode=503] [ResponseChars=2000] [StreamChunks=8] [StreamIntervalMs=50]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&StartCommand));
+
+	static FAutoConsoleCommand StopMockServerCommand(
+		TEXT("Gemini.MockServer.Stop"),
+		TEXT("Stops the local stand-in for the Gemini API."),
+		FConsoleCommandDelegate::CreateStatic(&StopCommand));
+}
@@ -0,0 +1,168 @@
+// Private/GeminiModelRouter.cpp
+#include "GeminiModelRouter.h"
+#include "GeminiAssistantTrace.h"
+#include "GeminiBackend.h"
+#include "Misc/ConfigCacheIni.h"
+
+namespace GeminiModelRouter
+{
+	static const TCHAR* DefaultFastModel = TEXT("gemini-2.5-flash-lite");
+	static const TCHAR* DefaultModel = TEXT("gemini-3-flash-preview");
+	static const TCHAR* DefaultLongContextModel = TEXT("gemini-2.5-pro");
+	static const int32 DefaultFastModelMaxTokens = 4000;
+	static const int32 DefaultLongContextMinTokens = 200000;
+	static const int32 DefaultMaxPromptTokens = 900000;
+
+	// Characters of a word piece per token
+	static const int32 CharsPerToken = 4;
+}
+
+int32 FGeminiTokenEstimator::EstimateTokens(const FString& Text)
+{
+	int32 Tokens = 0;
+	int32 WordChars = 0;
+	for (const TCHAR Char : Text)
+	{
+		if (Char < 128 && (FChar::IsAlnum(Char) || Char == TEXT('_')))
+		{
+			++WordChars;
+			continue;
+		}
+
+		Tokens += (WordChars + GeminiModelRouter::CharsPerToken - 1) / GeminiModelRouter::CharsPerToken;
+		WordChars = 0;
+
+		// Whitespace mostly merges into the following token; everything else is a token of its own
+		if (!FChar::IsWhitespace(Char))
+		{
+			++Tokens;
+		}
+	}
+	Tokens += (WordChars + GeminiModelRouter::CharsPerToken - 1) / GeminiModelRouter::CharsPerToken;
+	return Tokens;
+}
+
+FGeminiGenerationProfile FGeminiGenerationProfile::Load(const FString& InName)
+{
+	FGeminiGenerationProfile Profile;
+	Profile.Name = InName.IsEmpty() ? TEXT("fast") : InName;
+
+	if (Profile.Name == TEXT("fast"))
+	{
+		// Short answers without thinking: a selection summary should be back in a second or two
+		Profile.GenerationConfig.MaxOutputTokens = 1024;
+		Profile.GenerationConfig.ThinkingBudget = 0;
+		Profile.GenerationConfig.Temperature = 0.2f;
+	}
+	else if (Profile.Name == TEXT("economy"))
+	{
+		// What the panel falls back to once a token budget is used up: the cheapest model and short answers
+		Profile.GenerationConfig.MaxOutputTokens = 512;
+		Profile.GenerationConfig.ThinkingBudget = 0;
+		Profile.GenerationConfig.Temperature = 0.2f;
+		Profile.bPreferFastModel = true;
+	}
+	else if (Profile.Name == TEXT("thorough"))
+	{
+		Profile.GenerationConfig.MaxOutputTokens = 8192;
+		Profile.GenerationConfig.ThinkingBudget = -1;
+		Profile.GenerationConfig.Temperature = 0.7f;
+	}
+
+	if (GConfig)
+	{
+		const FString Section = FString::Printf(TEXT("GeminiAssistant.Profile.%s"), *Profile.Name);
+		GConfig->GetString(*Section, TEXT("Model"), Profile.Model, GEditorPerProjectIni);
+		GConfig->GetInt(*Section, TEXT("MaxOutputTokens"), Profile.GenerationConfig.MaxOutputTokens, GEditorPerProjectIni);
+		GConfig->GetInt(*Section, TEXT("ThinkingBudget"), Profile.GenerationConfig.ThinkingBudget, GEditorPerProjectIni);
+		GConfig->GetFloat(*Section, TEXT("Temperature"), Profile.GenerationConfig.Temperature, GEditorPerProjectIni);
+		GConfig->GetBool(*Section, TEXT("bPreferFastModel"), Profile.bPreferFastModel, GEditorPerProjectIni);
+	}
+	return Profile;
+}
+
+FGeminiModelRouter::FGeminiModelRouter()
+	: FastModel(GeminiModelRouter::DefaultFastModel)
+	, DefaultModel(GeminiModelRouter::DefaultModel)
+	, LongContextModel(GeminiModelRouter::DefaultLongContextModel)
+	, FastModelMaxTokens(GeminiModelRouter::DefaultFastModelMaxTokens)
+	, LongContextMinTokens(GeminiModelRouter::DefaultLongContextMinTokens)
+	, MaxPromptTokens(GeminiModelRouter::DefaultMaxPromptTokens)
+{
+	if (GConfig)
+	{
+		GConfig->GetString(TEXT("GeminiAssistant"), TEXT("Model"), DefaultModel, GEditorPerProjectIni);
+		GConfig->GetString(TEXT("GeminiAssistant"), TEXT("FastModel"), FastModel, GEditorPerProjectIni);
+		GConfig->GetString(TEXT("GeminiAssistant"), TEXT("LongContextModel"), LongContextModel, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("FastModelMaxTokens"), FastModelMaxTokens, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("LongContextMinTokens"), LongContextMinTokens, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("MaxPromptTokens"), MaxPromptTokens, GEditorPerProjectIni);
+	}
+	MaxPromptTokens = FMath::Max(1000, MaxPromptTokens);
+}
+
+FGeminiModelRouter::FGeminiModelRouter(const FGeminiBackendLimits& Limits)
+	: FGeminiModelRouter()
+{
+	// Leave a quarter of the window for instructions and the answer
+	MaxPromptTokens = FMath::Max(1000, FMath::Min(MaxPromptTokens, static_cast<int32>(static_cast<int64>(Limits.MaxContextTokens) * 3 / 4)));
+
+	// The tier models are Gemini names; other servers get whatever model the client is configured with
+	if (!Limits.bSupportsModelTiers)
+	{
+		FastModel.Empty();
+		DefaultModel.Empty();
+		LongContextModel.Empty();
+	}
+}
+
+FGeminiRoute FGeminiModelRouter::Route(int32 EstimatedTokens, const FGeminiGenerationProfile& Profile) const
+{
+	FGeminiRoute Result;
+	if (EstimatedTokens > MaxPromptTokens)
+	{
+		Result.bNeedsChunking = true;
+		Result.NumChunks = FMath::DivideAndRoundUp(EstimatedTokens, MaxPromptTokens);
+	}
+
+	if (!Profile.Model.IsEmpty())
+	{
+		Result.Model = Profile.Model;
+	}
+	else if (Result.bNeedsChunking)
+	{
+		// Parts are filled up to the limit, so they need the long window too
+		Result.Model = LongContextModel;
+	}
+	else if ((EstimatedTokens <= FastModelMaxTokens || Profile.bPreferFastModel) && !FastModel.IsEmpty())
+	{
+		Result.Model = FastModel;
+	}
+	else if (EstimatedTokens >= LongContextMinTokens && !LongContextModel.IsEmpty())
+	{
+		Result.Model = LongContextModel;
+	}
+	else
+	{
+		Result.Model = DefaultModel;
+	}
+	return Result;
+}
+
+FGeminiRoute FGeminiModelRouter::Apply(int32 EstimatedTokens, const FGeminiGenerationProfile& Profile, FGeminiRequestOptions& InOutOptions) const
+{
+	const FGeminiRoute Result = Route(EstimatedTokens, Profile);
+	InOutOptions.Model = Result.Model;
+	InOutOptions.GenerationConfig = Profile.GenerationConfig;
+
+	// Long-context (pro) models always think; a budget of 0 would be rejected
+	if (!LongContextModel.IsEmpty() && Result.Model == LongContextModel && InOutOptions.GenerationConfig.ThinkingBudget == 0)
+	{
+		InOutOptions.GenerationConfig.ThinkingBudget = -1;
+	}
+
+	UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiModelRouter: ~%d prompt tokens, profile '%s' -> %s%s"), EstimatedTokens, *Profile.Name,
+		Result.Model.IsEmpty() ? TEXT("default model") : *Result.Model,
+		Result.bNeedsChunking ? *FString::Printf(TEXT(" (needs %d chunks)"), Result.NumChunks) : TEXT(""));
+	return Result;
+}
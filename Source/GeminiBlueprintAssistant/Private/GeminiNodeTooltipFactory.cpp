@@ -0,0 +1,154 @@
+// Private/GeminiNodeTooltipFactory.cpp
+#include "GeminiNodeTooltipFactory.h"
+#include "GeminiSummaryStore.h"
+#include "NodeFactory.h"
+#include "SGraphNode.h"
+#include "EdGraphNode_Comment.h"
+#include "EdGraph/EdGraph.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Widgets/SToolTip.h"
+
+#define LOCTEXT_NAMESPACE "FGeminiBlueprintAssistantModule"
+
+namespace GeminiNodeTooltipFactory
+{
+	// A tooltip stays open for many frames; the store is asked again only after this long
+	static const double LookupInterval = 1.0;
+
+	// How deep below the node widget the widget carrying the node's tooltip is looked for
+	static const int32 MaxSearchDepth = 6;
+
+	struct FTooltipState
+	{
+		TWeakObjectPtr<UEdGraphNode> Node;
+		double LookupTime = -1.0;
+		FText Text;
+	};
+
+	// Nodes inside the comment box, as the comment widget would pick them when moved
+	static TArray<UEdGraphNode*> GetNodesInsideComment(const UEdGraphNode_Comment* Comment)
+	{
+		TArray<UEdGraphNode*> Nodes;
+		const FBox2D Bounds(FVector2D(Comment->NodePosX, Comment->NodePosY), FVector2D(Comment->NodePosX + Comment->NodeWidth, Comment->NodePosY + Comment->NodeHeight));
+		for (UEdGraphNode* Node : Comment->GetGraph()->Nodes)
+		{
+			if (Node && Node != Comment && !Node->IsA<UEdGraphNode_Comment>() && Bounds.IsInside(FVector2D(Node->NodePosX, Node->NodePosY)))
+			{
+				Nodes.Add(Node);
+			}
+		}
+		return Nodes;
+	}
+
+	static FText GetTooltipText(FTooltipState& State)
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (Now - State.LookupTime < LookupInterval)
+		{
+			return State.Text;
+		}
+		State.LookupTime = Now;
+
+		UEdGraphNode* Node = State.Node.Get();
+		if (!Node)
+		{
+			State.Text = FText::GetEmpty();
+			return State.Text;
+		}
+
+		FGeminiStoredSummary Summary;
+		bool bFound = false;
+		if (const UEdGraphNode_Comment* Comment = Cast<UEdGraphNode_Comment>(Node))
+		{
+			const TArray<UEdGraphNode*> Nodes = GetNodesInsideComment(Comment);
+			bFound = Nodes.Num() > 0 && FGeminiSummaryStore::Get().Find(Node->GetGraph(), Nodes, Summary);
+		}
+		else
+		{
+			bFound = FGeminiSummaryStore::Get().FindForNode(Node, Summary);
+		}
+
+		const FText NodeTooltip = Node->GetTooltipText();
+		if (!bFound)
+		{
+			State.Text = NodeTooltip;
+		}
+		else if (NodeTooltip.IsEmpty())
+		{
+			State.Text = FText::FromString(Summary.GetText());
+		}
+		else
+		{
+			State.Text = FText::Format(LOCTEXT("NodeSummaryTooltip", "Gemini: {0}\n\n{1}"), FText::FromString(Summary.GetText()), NodeTooltip);
+		}
+		return State.Text;
+	}
+
+	// The shallowest widget of the node that has a tooltip, leaving out pins, which keep their own
+	static TSharedPtr<SWidget> FindTooltipOwner(const TSharedRef<SWidget>& NodeWidget)
+	{
+		TArray<TSharedRef<SWidget>> Level = { NodeWidget };
+		for (int32 Depth = 0; Depth <= MaxSearchDepth && Level.Num() > 0; ++Depth)
+		{
+			TArray<TSharedRef<SWidget>> NextLevel;
+			for (const TSharedRef<SWidget>& Widget : Level)
+			{
+				if (Widget->GetToolTip().IsValid())
+				{
+					return Widget;
+				}
+				FChildren* Children = Widget->GetChildren();
+				for (int32 Index = 0; Children && Index < Children->Num(); ++Index)
+				{
+					TSharedRef<SWidget> Child = Children->GetChildAt(Index);
+					if (!Child->GetTypeAsString().StartsWith(TEXT("SGraphPin")))
+					{
+						NextLevel.Add(Child);
+					}
+				}
+			}
+			Level = MoveTemp(NextLevel);
+		}
+		return nullptr;
+	}
+}
+
+TSharedPtr<SGraphNode> FGeminiNodeTooltipFactory::CreateNode(UEdGraphNode* Node) const
+{
+	if (bCreatingNode || !Node || !Node->GetGraph() || !FBlueprintEditorUtils::FindBlueprintForNode(Node))
+	{
+		return nullptr;
+	}
+
+	// Nodes no summary mentions keep the editor's widget untouched, documentation tooltip included
+	const bool bIsComment = Node->IsA<UEdGraphNode_Comment>();
+	if (!bIsComment && !FGeminiSummaryStore::Get().HasAnyForNode(Node))
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<SGraphNode> NodeWidget;
+	{
+		TGuardValue<bool> CreatingNodeGuard(bCreatingNode, true);
+		NodeWidget = FNodeFactory::CreateNodeWidget(Node);
+	}
+	if (!NodeWidget.IsValid())
+	{
+		return nullptr;
+	}
+
+	TSharedRef<GeminiNodeTooltipFactory::FTooltipState> State = MakeShared<GeminiNodeTooltipFactory::FTooltipState>();
+	State->Node = Node;
+	TSharedRef<SToolTip> ToolTip = SNew(SToolTip)
+		.Text_Lambda([State]() { return GeminiNodeTooltipFactory::GetTooltipText(*State); });
+
+	TSharedPtr<SWidget> Owner = GeminiNodeTooltipFactory::FindTooltipOwner(NodeWidget.ToSharedRef());
+	if (!Owner.IsValid())
+	{
+		Owner = NodeWidget;
+	}
+	Owner->SetToolTip(ToolTip);
+	return NodeWidget;
+}
+
+#undef LOCTEXT_NAMESPACE
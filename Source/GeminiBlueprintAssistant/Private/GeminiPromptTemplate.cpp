@@ -0,0 +1,121 @@
+// Private/GeminiPromptTemplate.cpp
+#include "GeminiPromptTemplate.h"
+#include "GeminiSummarySchema.h"
+#include "GeminiAPIClient.h"
+#include "Misc/ConfigCacheIni.h"
+
+namespace GeminiPromptTemplate
+{
+	static const TCHAR* PlainTextRule = TEXT("Respond as if you're writing for a basic text display that cannot render formatting - use only letters, numbers, basic punctuation, and spaces.");
+
+	static void ReadOverride(const FString& Section, const TCHAR* Key, FString& InOutValue)
+	{
+		FString Value;
+		if (GConfig->GetString(*Section, Key, Value, GEditorPerProjectIni))
+		{
+			// Config values are single lines
+			InOutValue = Value.Replace(TEXT("\\n"), TEXT("\n"));
+		}
+	}
+}
+
+FGeminiPromptTemplate FGeminiPromptTemplate::Load(const FString& InName)
+{
+	FGeminiPromptTemplate Template;
+	Template.Name = InName;
+	Template.Query = TEXT("User Query: {Query}");
+
+	if (Template.Name == TEXT("Graph"))
+	{
+		Template.Instructions = FString::Printf(TEXT("You summarize Unreal Engine Blueprint graphs for developers who have not seen them. You are given the graph data and then asked about it. %s"), GeminiPromptTemplate::PlainTextRule);
+		Template.Format = TEXT("Please respond in this exact format :  DETAILS: [summarise the nodes in user-friendly manner]\nSUMMARY:[keep empty].");
+		Template.StructuredFormat = TEXT("Put a summary of the nodes in user-friendly manner into details, notes on the important nodes into nodeNotes, your confidence into confidence, and leave summary empty.");
+		Template.Task = TEXT("Given the Unreal Engine Blueprint graph above from Blueprint '{Blueprint}', summarize the entire graph's purpose and functionality.");
+		// Details plus a note per important node; the 1024 of the fast profile cuts larger graphs off
+		Template.MaxOutputTokens = 2048;
+	}
+	else if (Template.Name == TEXT("EmptyGraph"))
+	{
+		Template.Instructions = FString::Printf(TEXT("You summarize Unreal Engine Blueprints for developers who have not seen them. %s"), GeminiPromptTemplate::PlainTextRule);
+		Template.Format = TEXT("Please respond in this exact format :  DETAILS: [summarise the blueprint in a user-friendly manner with available information].");
+		Template.StructuredFormat = TEXT("Put a summary of the blueprint in a user-friendly manner with available information into details and leave summary empty.");
+		Template.Task = TEXT("Summarize the main purpose of the Blueprint named '{Blueprint}'. The graph appears to be empty or has no processable nodes.");
+	}
+	else if (Template.Name == TEXT("Selection"))
+	{
+		Template.Instructions = FString::Printf(TEXT("You summarize selected nodes of Unreal Engine Blueprint graphs for developers. You are given the data of the nodes and then asked about them. %s"), GeminiPromptTemplate::PlainTextRule);
+		Template.Format = TEXT("Please respond in this exact format :  DETAILS: [summarise the selected nodes in user-friendly manner] \nSUMMARY: [concise one-line summary].");
+		Template.StructuredFormat = FGeminiSummarySchema::GetFieldInstructions();
+		Template.Task = TEXT("Given the Unreal Engine Blueprint nodes above from Blueprint '{Blueprint}', summarize their collective purpose.");
+	}
+	else if (Template.Name == TEXT("GraphSummary"))
+	{
+		Template.Instructions = TEXT("Summarize the purpose of the Unreal Engine Blueprint graph below in two or three sentences. Use only letters, numbers, basic punctuation, and spaces.");
+		Template.Task = TEXT("The graph above is '{Graph}' of the Blueprint '{Blueprint}'.");
+		Template.MaxOutputTokens = 256;
+	}
+	else if (Template.Name == TEXT("GraphPart"))
+	{
+		Template.Instructions = TEXT("Summarize what the nodes of the part of a large Unreal Engine Blueprint graph below do in a few sentences. Use only letters, numbers, basic punctuation, and spaces.");
+		Template.Task = TEXT("The nodes above are part {Part} of {NumParts} of a graph from Blueprint '{Blueprint}'.");
+	}
+	else if (Template.Name == TEXT("Clusters"))
+	{
+		Template.Instructions = TEXT("You write comment boxes for Unreal Engine Blueprint graphs. Each numbered cluster below is a group of connected nodes of one graph; say in one short sentence what the nodes of every cluster do. Use only letters, numbers, basic punctuation, and spaces.");
+		Template.Format = TEXT("Answer with one line per cluster in the form CLUSTER <number>: <comment>, in cluster order, and write nothing else.");
+		Template.Task = TEXT("The clusters above are from '{Graph}' of the Blueprint '{Blueprint}'; write a comment for each of the {NumClusters} clusters.");
+	}
+
+	if (GConfig)
+	{
+		const FString Section = FString::Printf(TEXT("GeminiAssistant.Prompt.%s"), *Template.Name);
+		GeminiPromptTemplate::ReadOverride(Section, TEXT("Instructions"), Template.Instructions);
+		GeminiPromptTemplate::ReadOverride(Section, TEXT("Format"), Template.Format);
+		GeminiPromptTemplate::ReadOverride(Section, TEXT("StructuredFormat"), Template.StructuredFormat);
+		GeminiPromptTemplate::ReadOverride(Section, TEXT("Task"), Template.Task);
+		GeminiPromptTemplate::ReadOverride(Section, TEXT("Query"), Template.Query);
+		GConfig->GetInt(*Section, TEXT("MaxOutputTokens"), Template.MaxOutputTokens, GEditorPerProjectIni);
+	}
+	return Template;
+}
+
+FString FGeminiPromptTemplate::GetPrefix(bool bStructured) const
+{
+	const FString& AnswerFormat = bStructured ? StructuredFormat : Format;
+	return AnswerFormat.IsEmpty() ? Instructions + TEXT("\n") : Instructions + TEXT(" ") + AnswerFormat + TEXT("\n");
+}
+
+FString FGeminiPromptTemplate::FormatTask(const FStringFormatNamedArguments& Arguments, const FString& UserQuery) const
+{
+	FString Result = FString::Format(*Task, Arguments);
+	if (!UserQuery.IsEmpty())
+	{
+		FStringFormatNamedArguments QueryArguments;
+		QueryArguments.Add(TEXT("Query"), UserQuery);
+		Result += TEXT("\n") + FString::Format(*Query, QueryArguments);
+	}
+	return Result;
+}
+
+void FGeminiPromptTemplate::ApplyOutputCap(FGeminiGenerationConfig& InOutConfig) const
+{
+	if (MaxOutputTokens <= 0)
+	{
+		return;
+	}
+
+	// Thinking is billed against the same cap
+	if (InOutConfig.ThinkingBudget == 0)
+	{
+		InOutConfig.MaxOutputTokens = MaxOutputTokens;
+	}
+	else if (InOutConfig.ThinkingBudget > 0)
+	{
+		InOutConfig.MaxOutputTokens = MaxOutputTokens + InOutConfig.ThinkingBudget;
+	}
+	else if (InOutConfig.MaxOutputTokens > 0)
+	{
+		// The model decides how long it thinks, so the profile's cap can only grow
+		InOutConfig.MaxOutputTokens = FMath::Max(InOutConfig.MaxOutputTokens, MaxOutputTokens);
+	}
+}
@@ -0,0 +1,103 @@
+// Private/GeminiRateLimiter.cpp
+#include "GeminiRateLimiter.h"
+
+FGeminiRateLimiter::FGeminiRateLimiter()
+	: LastRefillTime(0.0)
+	, BlockedUntilTime(0.0)
+{
+}
+
+void FGeminiRateLimiter::Configure(int32 InRequestsPerMinute, int32 InTokensPerMinute)
+{
+	RequestBucket.Configure(InRequestsPerMinute);
+	TokenBucket.Configure(InTokensPerMinute);
+	LastRefillTime = FPlatformTime::Seconds();
+}
+
+bool FGeminiRateLimiter::TryAcquire(int32 EstimatedTokens, double Now)
+{
+	if (Now < BlockedUntilTime)
+	{
+		return false;
+	}
+	if (!IsEnabled())
+	{
+		return true;
+	}
+
+	Refill(Now);
+
+	const double RequestCost = RequestBucket.Clamp(1.0);
+	const double TokenCost = TokenBucket.Clamp(EstimatedTokens);
+	if ((RequestBucket.IsEnabled() && RequestBucket.Available < RequestCost) ||
+		(TokenBucket.IsEnabled() && TokenBucket.Available < TokenCost))
+	{
+		return false;
+	}
+
+	RequestBucket.Available -= RequestCost;
+	TokenBucket.Available -= TokenCost;
+	return true;
+}
+
+double FGeminiRateLimiter::GetWaitTime(int32 EstimatedTokens, double Now)
+{
+	double WaitTime = FMath::Max(0.0, BlockedUntilTime - Now);
+	if (IsEnabled())
+	{
+		Refill(Now);
+		WaitTime = FMath::Max(WaitTime, RequestBucket.GetWaitTime(1.0));
+		WaitTime = FMath::Max(WaitTime, TokenBucket.GetWaitTime(EstimatedTokens));
+	}
+	return WaitTime;
+}
+
+void FGeminiRateLimiter::Refund(int32 EstimatedTokens)
+{
+	if (RequestBucket.IsEnabled())
+	{
+		RequestBucket.Available = FMath::Min(RequestBucket.Capacity, RequestBucket.Available + RequestBucket.Clamp(1.0));
+	}
+	if (TokenBucket.IsEnabled())
+	{
+		TokenBucket.Available = FMath::Min(TokenBucket.Capacity, TokenBucket.Available + TokenBucket.Clamp(EstimatedTokens));
+	}
+}
+
+void FGeminiRateLimiter::BlockUntil(double Time)
+{
+	BlockedUntilTime = FMath::Max(BlockedUntilTime, Time);
+}
+
+void FGeminiRateLimiter::Refill(double Now)
+{
+	const double Elapsed = FMath::Max(0.0, Now - LastRefillTime);
+	LastRefillTime = Now;
+	RequestBucket.Refill(Elapsed);
+	TokenBucket.Refill(Elapsed);
+}
+
+void FGeminiRateLimiter::FBucket::Configure(int32 PerMinute)
+{
+	Capacity = FMath::Max(0, PerMinute);
+	Available = Capacity;
+	RefillPerSecond = Capacity / 60.0;
+}
+
+void FGeminiRateLimiter::FBucket::Refill(double Elapsed)
+{
+	if (IsEnabled())
+	{
+		Available = FMath::Min(Capacity, Available + Elapsed * RefillPerSecond);
+	}
+}
+
+double FGeminiRateLimiter::FBucket::GetWaitTime(double Amount) const
+{
+	if (!IsEnabled())
+	{
+		return 0.0;
+	}
+	const double Missing = Clamp(Amount) - Available;
+	return Missing > 0.0 ? Missing / RefillPerSecond : 0.0;
+}
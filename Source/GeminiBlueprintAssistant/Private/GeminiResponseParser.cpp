@@ -0,0 +1,241 @@
+// Private/GeminiResponseParser.cpp
+#include "GeminiResponseParser.h"
+#include "GeminiJsonReader.h"
+
+namespace GeminiResponseParser
+{
+	// Reads a string value, tolerating null
+	static bool ReadOptionalString(FGeminiJsonReader& Reader, FString& OutValue)
+	{
+		return Reader.Peek() == EGeminiJsonToken::String ? Reader.ReadString(OutValue) : Reader.SkipValue();
+	}
+
+	// parts[i]: { "text": "...", "thought": true }
+	static bool ParsePart(FGeminiJsonReader& Reader, FString& OutText)
+	{
+		if (Reader.Peek() != EGeminiJsonToken::Object)
+		{
+			return Reader.SkipValue();
+		}
+
+		FString PartText;
+		bool bThought = false;
+		const bool bParsed = Reader.ReadObject([&Reader, &PartText, &bThought](const FString& Key)
+		{
+			if (Key == TEXT("text"))
+			{
+				return ReadOptionalString(Reader, PartText);
+			}
+			if (Key == TEXT("thought") && Reader.Peek() == EGeminiJsonToken::True)
+			{
+				bThought = true;
+			}
+			return Reader.SkipValue();
+		});
+
+		// Thinking models return their reasoning as separate parts, which are not part of the answer
+		if (bParsed && !bThought)
+		{
+			OutText += PartText;
+		}
+		return bParsed;
+	}
+
+	// candidates[i]: { "content": { "parts": [...] }, "finishReason": "STOP" }
+	static bool ParseCandidate(FGeminiJsonReader& Reader, FString& OutText, FString& OutFinishReason)
+	{
+		if (Reader.Peek() != EGeminiJsonToken::Object)
+		{
+			return Reader.SkipValue();
+		}
+
+		return Reader.ReadObject([&Reader, &OutText, &OutFinishReason](const FString& Key)
+		{
+			if (Key == TEXT("finishReason"))
+			{
+				return ReadOptionalString(Reader, OutFinishReason);
+			}
+			if (Key != TEXT("content") || Reader.Peek() != EGeminiJsonToken::Object)
+			{
+				return Reader.SkipValue();
+			}
+
+			return Reader.ReadObject([&Reader, &OutText](const FString& ContentKey)
+			{
+				if (ContentKey != TEXT("parts") || Reader.Peek() != EGeminiJsonToken::Array)
+				{
+					return Reader.SkipValue();
+				}
+				return Reader.ReadArray([&Reader, &OutText](int32 PartIndex)
+				{
+					return ParsePart(Reader, OutText);
+				});
+			});
+		});
+	}
+
+	// Reads a token count, which proto JSON may send as a string
+	static bool ReadTokenCount(FGeminiJsonReader& Reader, int32& OutValue)
+	{
+		int64 Value = 0;
+		if (!Reader.ReadInt64(Value))
+		{
+			return false;
+		}
+		OutValue = static_cast<int32>(FMath::Clamp<int64>(Value, 0, MAX_int32));
+		return true;
+	}
+
+	// usageMetadata: { "promptTokenCount": 10, "cachedContentTokenCount": 8, "candidatesTokenCount": 5, "thoughtsTokenCount": 3 }
+	static bool ParseUsageMetadata(FGeminiJsonReader& Reader, FGeminiTokenUsage& OutUsage)
+	{
+		FGeminiTokenUsage Usage;
+		const bool bParsed = Reader.ReadObject([&Reader, &Usage](const FString& Key)
+		{
+			if (Key == TEXT("promptTokenCount"))
+			{
+				return ReadTokenCount(Reader, Usage.PromptTokens);
+			}
+			if (Key == TEXT("cachedContentTokenCount"))
+			{
+				return ReadTokenCount(Reader, Usage.CachedTokens);
+			}
+			if (Key == TEXT("candidatesTokenCount"))
+			{
+				return ReadTokenCount(Reader, Usage.OutputTokens);
+			}
+			if (Key == TEXT("thoughtsTokenCount"))
+			{
+				return ReadTokenCount(Reader, Usage.ThoughtTokens);
+			}
+			return Reader.SkipValue();
+		});
+		if (Usage.IsSet())
+		{
+			OutUsage = Usage;
+		}
+		return bParsed;
+	}
+
+	static bool ParseResponseObject(FGeminiJsonReader& Reader, FGeminiParsedResponse& OutResponse)
+	{
+		return Reader.ReadObject([&Reader, &OutResponse](const FString& Key)
+		{
+			if (Key == TEXT("candidates") && Reader.Peek() == EGeminiJsonToken::Array)
+			{
+				return Reader.ReadArray([&Reader, &OutResponse](int32 CandidateIndex)
+				{
+					FString CandidateText;
+					FString FinishReason;
+					if (!ParseCandidate(Reader, CandidateText, FinishReason))
+					{
+						return false;
+					}
+
+					OutResponse.NumCandidates = FMath::Max(OutResponse.NumCandidates, CandidateIndex + 1);
+					if (CandidateIndex == 0 && !FinishReason.IsEmpty())
+					{
+						OutResponse.FinishReason = FinishReason;
+					}
+					if (!CandidateText.IsEmpty())
+					{
+						if (CandidateIndex > 0 && !OutResponse.Text.IsEmpty())
+						{
+							OutResponse.Text += TEXT("\n\n");
+						}
+						OutResponse.Text += CandidateText;
+					}
+					return true;
+				});
+			}
+			if (Key == TEXT("error") && Reader.Peek() == EGeminiJsonToken::Object)
+			{
+				return Reader.ReadObject([&Reader, &OutResponse](const FString& ErrorKey)
+				{
+					if (ErrorKey == TEXT("message"))
+					{
+						FString Message;
+						if (!ReadOptionalString(Reader, Message))
+						{
+							return false;
+						}
+						OutResponse.ErrorMessage = FString::Printf(TEXT("Gemini API Error: %s"), *Message);
+						OutResponse.bApiError = true;
+						return true;
+					}
+					return Reader.SkipValue();
+				});
+			}
+			if (Key == TEXT("usageMetadata") && Reader.Peek() == EGeminiJsonToken::Object)
+			{
+				return ParseUsageMetadata(Reader, OutResponse.Usage);
+			}
+			if (Key == TEXT("promptFeedback") && Reader.Peek() == EGeminiJsonToken::Object)
+			{
+				return Reader.ReadObject([&Reader, &OutResponse](const FString& FeedbackKey)
+				{
+					return FeedbackKey == TEXT("blockReason") ? ReadOptionalString(Reader, OutResponse.BlockReason) : Reader.SkipValue();
+				});
+			}
+			return Reader.SkipValue();
+		});
+	}
+}
+
+bool FGeminiResponseParser::Parse(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse)
+{
+	FGeminiJsonReader Reader(Data, Num);
+
+	bool bParsed = false;
+	switch (Reader.Peek())
+	{
+	case EGeminiJsonToken::Object:
+		bParsed = GeminiResponseParser::ParseResponseObject(Reader, OutResponse);
+		break;
+	case EGeminiJsonToken::Array:
+		bParsed = Reader.ReadArray([&Reader, &OutResponse](int32 ChunkIndex)
+		{
+			return GeminiResponseParser::ParseResponseObject(Reader, OutResponse);
+		});
+		break;
+	default:
+		break;
+	}
+
+	if (!OutResponse.Text.IsEmpty())
+	{
+		return true;
+	}
+
+	if (OutResponse.ErrorMessage.IsEmpty())
+	{
+		if (!bParsed)
+		{
+			OutResponse.ErrorMessage = TEXT("Failed to parse JSON response.");
+		}
+		else if (!OutResponse.BlockReason.IsEmpty())
+		{
+			OutResponse.ErrorMessage = FString::Printf(TEXT("Gemini blocked the prompt (%s)."), *OutResponse.BlockReason);
+		}
+		else if (!OutResponse.FinishReason.IsEmpty() && OutResponse.FinishReason != TEXT("STOP"))
+		{
+			OutResponse.ErrorMessage = FString::Printf(TEXT("Gemini returned no text (finish reason %s)."), *OutResponse.FinishReason);
+		}
+		else
+		{
+			OutResponse.ErrorMessage = TEXT("Gemini returned no text.");
+		}
+	}
+	return false;
+}
+
+bool FGeminiResponseParser::Parse(const TArray<uint8>& Body, FGeminiParsedResponse& OutResponse)
+{
+	return Parse(Body.GetData(), Body.Num(), OutResponse);
+}
+
+bool FGeminiResponseParser::Parse(const FString& Body, FGeminiParsedResponse& OutResponse)
+{
+	FTCHARToUTF8 Utf8Body(*Body, Body.Len());
+	return Parse(reinterpret_cast<const uint8*>(Utf8Body.Get()), Utf8Body.Length(), OutResponse);
+}
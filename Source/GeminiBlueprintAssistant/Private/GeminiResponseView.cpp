@@ -0,0 +1,140 @@
+// Private/GeminiResponseView.cpp
+#include "GeminiResponseView.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Views/STableRow.h"
+
+namespace GeminiResponseView
+{
+	// Longer paragraphs are split into rows of at most this many characters, at a line break or space if there is one
+	static const int32 MaxRowChars = 2000;
+
+	// A line break or space this early would leave a short row; the row is cut at MaxRowChars instead
+	static const int32 MinRowChars = MaxRowChars / 2;
+}
+
+void SGeminiResponseView::Construct(const FArguments& InArgs)
+{
+	ChildSlot
+	[
+		SAssignNew(ListView, SListView<TSharedPtr<FGeminiResponseParagraph>>)
+			.ListItemsSource(&Paragraphs)
+			.SelectionMode(ESelectionMode::None)
+			.OnGenerateRow(this, &SGeminiResponseView::OnGenerateRow)
+			.OnListViewScrolled(this, &SGeminiResponseView::OnScrolled)
+	];
+	SetText(InArgs._Text);
+}
+
+void SGeminiResponseView::SetText(const FString& InText)
+{
+	if (InText.Len() == Text.Len() && InText.Equals(Text, ESearchCase::CaseSensitive))
+	{
+		return;
+	}
+
+	if (Paragraphs.Num() > 0 && InText.Len() > Text.Len() && FCString::Strncmp(*InText, *Text, Text.Len()) == 0)
+	{
+		AppendText(InText.RightChop(Text.Len()));
+		return;
+	}
+
+	Paragraphs.Reset();
+	Text = InText;
+	AddParagraphs(0);
+	ListView->RequestListRefresh();
+	bFollowEnd = true;
+	ListView->ScrollToTop();
+}
+
+void SGeminiResponseView::AppendText(const FString& Delta)
+{
+	if (Delta.IsEmpty())
+	{
+		return;
+	}
+
+	// The last row may have been cut off mid-paragraph, so it is split again together with the new text
+	int32 Start = 0;
+	if (Paragraphs.Num() > 0)
+	{
+		Start = Paragraphs.Last()->Start;
+		Paragraphs.Pop();
+	}
+
+	Text += Delta;
+	AddParagraphs(Start);
+	ListView->RequestListRefresh();
+	if (bFollowEnd)
+	{
+		ListView->ScrollToBottom();
+	}
+}
+
+void SGeminiResponseView::AddParagraphs(int32 Start)
+{
+	const TCHAR* Chars = *Text;
+	const int32 Len = Text.Len();
+	while (Start < Len)
+	{
+		// A paragraph ends at a blank line, or earlier if it runs past MaxRowChars
+		const int32 Limit = FMath::Min(Len, Start + GeminiResponseView::MaxRowChars);
+		int32 End = Limit;
+		int32 Next = Limit;
+		int32 LastLineBreak = INDEX_NONE;
+		int32 LastSpace = INDEX_NONE;
+		for (int32 Index = Start; Index < Limit; ++Index)
+		{
+			if (Chars[Index] == TEXT('\n'))
+			{
+				if (Index + 1 < Len && Chars[Index + 1] == TEXT('\n'))
+				{
+					End = Index;
+					Next = Index + 2;
+					break;
+				}
+				LastLineBreak = Index;
+			}
+			else if (Chars[Index] == TEXT(' '))
+			{
+				LastSpace = Index;
+			}
+		}
+		if (End == Limit && Limit < Len)
+		{
+			const int32 Split = LastLineBreak >= Start + GeminiResponseView::MinRowChars ? LastLineBreak : LastSpace >= Start + GeminiResponseView::MinRowChars ? LastSpace : INDEX_NONE;
+			if (Split != INDEX_NONE)
+			{
+				End = Split;
+				Next = Split + 1;
+			}
+		}
+
+		TSharedPtr<FGeminiResponseParagraph> Paragraph = MakeShared<FGeminiResponseParagraph>();
+		Paragraph->Start = Start;
+		Paragraph->Text = FText::FromString(Text.Mid(Start, End - Start).TrimEnd());
+		Paragraphs.Add(Paragraph);
+
+		// Further blank lines between paragraphs do not make empty rows
+		Start = Next;
+		while (Start < Len && Chars[Start] == TEXT('\n'))
+		{
+			++Start;
+		}
+	}
+}
+
+TSharedRef<ITableRow> SGeminiResponseView::OnGenerateRow(TSharedPtr<FGeminiResponseParagraph> Paragraph, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	return SNew(STableRow<TSharedPtr<FGeminiResponseParagraph>>, OwnerTable)
+		.Padding(FMargin(0, 0, 0, 8))
+		[
+			SNew(STextBlock)
+				.Text(Paragraph->Text)
+				.AutoWrapText(true)
+		];
+}
+
+void SGeminiResponseView::OnScrolled(double ScrollOffset)
+{
+	bFollowEnd = ListView->GetScrollDistanceRemaining().Y <= 1.0f;
+}
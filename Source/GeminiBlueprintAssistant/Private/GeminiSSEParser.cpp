@@ -0,0 +1,107 @@
+// Private/GeminiSSEParser.cpp
+#include "GeminiSSEParser.h"
+
+namespace GeminiSSE
+{
+	static bool LineStartsWith(const uint8* Line, int32 Len, const char* Prefix)
+	{
+		int32 Index = 0;
+		for (; Prefix[Index] != '\0'; ++Index)
+		{
+			if (Index >= Len || Line[Index] != static_cast<uint8>(Prefix[Index]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+FGeminiSSEParser::FGeminiSSEParser()
+{
+}
+
+void FGeminiSSEParser::Feed(const uint8* Data, int64 Num, TArray<TArray<uint8>>& OutEvents)
+{
+	if (!Data || Num <= 0)
+	{
+		return;
+	}
+
+	PendingBytes.Append(Data, static_cast<int32>(Num));
+
+	int32 LineStart = 0;
+	for (int32 Index = 0; Index < PendingBytes.Num(); ++Index)
+	{
+		if (PendingBytes[Index] == '\n')
+		{
+			int32 LineEnd = Index;
+			// Events are separated by CRLF on some servers
+			if (LineEnd > LineStart && PendingBytes[LineEnd - 1] == '\r')
+			{
+				--LineEnd;
+			}
+			ProcessLine(PendingBytes.GetData() + LineStart, LineEnd - LineStart, OutEvents);
+			LineStart = Index + 1;
+		}
+	}
+
+	if (LineStart > 0)
+	{
+		PendingBytes.RemoveAt(0, LineStart);
+	}
+}
+
+void FGeminiSSEParser::Finish(TArray<TArray<uint8>>& OutEvents)
+{
+	if (PendingBytes.Num() > 0)
+	{
+		ProcessLine(PendingBytes.GetData(), PendingBytes.Num(), OutEvents);
+		PendingBytes.Reset();
+	}
+	DispatchEvent(OutEvents);
+}
+
+void FGeminiSSEParser::Reset()
+{
+	PendingBytes.Reset();
+	EventData.Reset();
+}
+
+void FGeminiSSEParser::ProcessLine(const uint8* Line, int32 Len, TArray<TArray<uint8>>& OutEvents)
+{
+	// A blank line terminates the current event
+	if (Len == 0)
+	{
+		DispatchEvent(OutEvents);
+		return;
+	}
+
+	// Lines starting with ':' are comments / keep-alives, other fields (event, id, retry) are not used by Gemini
+	if (!GeminiSSE::LineStartsWith(Line, Len, "data:"))
+	{
+		return;
+	}
+
+	int32 ValueStart = 5;
+	if (ValueStart < Len && Line[ValueStart] == ' ')
+	{
+		++ValueStart;
+	}
+
+	// Multiple data lines belong to the same event and are joined with a newline
+	if (EventData.Num() > 0)
+	{
+		EventData.Add('\n');
+	}
+	EventData.Append(Line + ValueStart, Len - ValueStart);
+}
+
+void FGeminiSSEParser::DispatchEvent(TArray<TArray<uint8>>& OutEvents)
+{
+	if (EventData.Num() > 0)
+	{
+		OutEvents.Add(MoveTemp(EventData));
+		EventData.Reset();
+	}
+}
@@ -0,0 +1,155 @@
+// Private/GeminiSession.cpp
+#include "GeminiSession.h"
+#include "BlueprintNodePreprocessor.h"
+#include "GeminiModelRouter.h"
+#include "K2Node.h"
+
+FGeminiGraphSnapshot FGeminiGraphSnapshot::Capture(const TArray<UEdGraphNode*>& InNodes)
+{
+	FGeminiGraphSnapshot Snapshot;
+	FBlueprintNodePreprocessor NodePreprocessor;
+	for (UEdGraphNode* Node : InNodes)
+	{
+		if (UK2Node* K2Node = Cast<UK2Node>(Node))
+		{
+			FNode& SnapshotNode = Snapshot.Nodes.AddDefaulted_GetRef();
+			SnapshotNode.NodeGuid = K2Node->NodeGuid;
+			SnapshotNode.Line = NodePreprocessor.FormatNodeLine(NodePreprocessor.ProcessSingleNode(K2Node));
+		}
+	}
+	return Snapshot;
+}
+
+FGeminiSession::FGeminiSession(int32 InMaxHistoryTokens)
+	: NextNodeNumber(1)
+	, MaxHistoryTokens(InMaxHistoryTokens)
+{
+}
+
+FGeminiSessionTurn FGeminiSession::BeginTurn(const FGeminiGraphSnapshot& Snapshot, const FString& ContextHeader)
+{
+	FGeminiSessionTurn Turn;
+	Turn.Snapshot = Snapshot;
+	if (BaseContext.IsEmpty())
+	{
+		// First turn, or the turns the changes were spread over have been trimmed: start from the whole graph
+		Turn.Context = ContextHeader + FormatGraph(Snapshot) + TEXT("\n");
+	}
+	else
+	{
+		Turn.Context = BaseContext;
+		Turn.GraphChanges = FormatChanges(Snapshot);
+	}
+	Turn.History = History;
+	return Turn;
+}
+
+void FGeminiSession::CompleteTurn(const FGeminiSessionTurn& Turn, const FString& UserMessage, const FString& Answer)
+{
+	// Later turns send the very same context text, so its cache entry keeps matching
+	BaseContext = Turn.Context;
+	FGeminiChatTurn& Question = History.AddDefaulted_GetRef();
+	Question.Text = UserMessage;
+	FGeminiChatTurn& Reply = History.AddDefaulted_GetRef();
+	Reply.bFromModel = true;
+	Reply.Text = Answer;
+	LastSnapshot = Turn.Snapshot;
+	TrimHistory();
+}
+
+FString FGeminiSession::FormatGraph(const FGeminiGraphSnapshot& Snapshot)
+{
+	TArray<FString> Lines;
+	Lines.Reserve(Snapshot.Nodes.Num());
+	for (const FGeminiGraphSnapshot::FNode& Node : Snapshot.Nodes)
+	{
+		Lines.Add(FString::Printf(TEXT("%d. %s"), GetNodeNumber(Node.NodeGuid), *Node.Line));
+	}
+	return FString::Join(Lines, TEXT("\n"));
+}
+
+FString FGeminiSession::FormatChanges(const FGeminiGraphSnapshot& Snapshot)
+{
+	TMap<FGuid, const FString*> PreviousLines;
+	for (const FGeminiGraphSnapshot::FNode& Node : LastSnapshot.Nodes)
+	{
+		PreviousLines.Add(Node.NodeGuid, &Node.Line);
+	}
+
+	TArray<FString> Added;
+	TArray<FString> Changed;
+	for (const FGeminiGraphSnapshot::FNode& Node : Snapshot.Nodes)
+	{
+		const FString* PreviousLine = nullptr;
+		if (!PreviousLines.RemoveAndCopyValue(Node.NodeGuid, PreviousLine))
+		{
+			Added.Add(FString::Printf(TEXT("%d. %s"), GetNodeNumber(Node.NodeGuid), *Node.Line));
+		}
+		else if (*PreviousLine != Node.Line)
+		{
+			Changed.Add(FString::Printf(TEXT("%d. %s (was: %s)"), GetNodeNumber(Node.NodeGuid), *Node.Line, **PreviousLine));
+		}
+	}
+
+	// Whatever was not matched by a current node is gone
+	TArray<FString> Removed;
+	for (const FGeminiGraphSnapshot::FNode& Node : LastSnapshot.Nodes)
+	{
+		if (PreviousLines.Contains(Node.NodeGuid))
+		{
+			Removed.Add(FString::Printf(TEXT("%d. %s"), GetNodeNumber(Node.NodeGuid), *Node.Line));
+		}
+	}
+
+	FString Changes;
+	if (Added.Num() > 0)
+	{
+		Changes += TEXT("Added nodes:\n") + FString::Join(Added, TEXT("\n")) + TEXT("\n");
+	}
+	if (Removed.Num() > 0)
+	{
+		Changes += TEXT("Removed nodes:\n") + FString::Join(Removed, TEXT("\n")) + TEXT("\n");
+	}
+	if (Changed.Num() > 0)
+	{
+		Changes += TEXT("Changed nodes:\n") + FString::Join(Changed, TEXT("\n")) + TEXT("\n");
+	}
+	return Changes;
+}
+
+int32 FGeminiSession::GetNodeNumber(const FGuid& NodeGuid)
+{
+	if (const int32* Number = NodeNumbers.Find(NodeGuid))
+	{
+		return *Number;
+	}
+	return NodeNumbers.Add(NodeGuid, NextNodeNumber++);
+}
+
+void FGeminiSession::TrimHistory()
+{
+	if (MaxHistoryTokens <= 0)
+	{
+		return;
+	}
+
+	int32 HistoryTokens = 0;
+	for (const FGeminiChatTurn& Turn : History)
+	{
+		HistoryTokens += FGeminiTokenEstimator::EstimateTokens(Turn.Text);
+	}
+
+	int32 NumDropped = 0;
+	while (HistoryTokens > MaxHistoryTokens && NumDropped + 2 <= History.Num())
+	{
+		HistoryTokens -= FGeminiTokenEstimator::EstimateTokens(History[NumDropped].Text) + FGeminiTokenEstimator::EstimateTokens(History[NumDropped + 1].Text);
+		NumDropped += 2;
+	}
+	if (NumDropped > 0)
+	{
+		History.RemoveAt(0, NumDropped);
+
+		// The dropped turns carried changes the base does not show, so the next turn sends the whole graph again
+		BaseContext.Empty();
+	}
+}
@@ -0,0 +1,325 @@
+// Private/GeminiSummarySchema.cpp
+#include "GeminiSummarySchema.h"
+#include "GeminiJsonReader.h"
+#include "Misc/ScopeExit.h"
+
+namespace GeminiSummarySchema
+{
+	// propertyOrdering makes details come first, so it can be shown while the rest is still streaming
+	static const TCHAR* SchemaJson = TEXT(
+		"{\"type\":\"OBJECT\",\"properties\":{"
+		"\"details\":{\"type\":\"STRING\",\"description\":\"User-friendly explanation of what the nodes do\"},"
+		"\"summary\":{\"type\":\"STRING\",\"description\":\"Concise one-line summary\"},"
+		"\"nodeNotes\":{\"type\":\"ARRAY\",\"items\":{\"type\":\"OBJECT\",\"properties\":{"
+			"\"node\":{\"type\":\"INTEGER\",\"description\":\"Number of the node in the node list\"},"
+			"\"note\":{\"type\":\"STRING\"}},\"required\":[\"node\",\"note\"]}},"
+		"\"confidence\":{\"type\":\"NUMBER\",\"description\":\"Confidence in the explanation from 0 to 1\"}},"
+		"\"required\":[\"details\",\"summary\",\"confidence\"],"
+		"\"propertyOrdering\":[\"details\",\"summary\",\"nodeNotes\",\"confidence\"]}");
+
+	static bool ParseNodeNote(FGeminiJsonReader& Reader, TArray<FGeminiNodeNote>& OutNotes)
+	{
+		if (Reader.Peek() != EGeminiJsonToken::Object)
+		{
+			return Reader.SkipValue();
+		}
+
+		FGeminiNodeNote NodeNote;
+		const bool bParsed = Reader.ReadObject([&Reader, &NodeNote](const FString& Key)
+		{
+			if (Key == TEXT("node"))
+			{
+				int64 NodeIndex = 0;
+				const bool bRead = Reader.ReadInt64(NodeIndex);
+				NodeNote.NodeIndex = static_cast<int32>(NodeIndex);
+				return bRead;
+			}
+			if (Key == TEXT("note") && Reader.Peek() == EGeminiJsonToken::String)
+			{
+				return Reader.ReadString(NodeNote.Note);
+			}
+			return Reader.SkipValue();
+		});
+
+		if (bParsed && NodeNote.NodeIndex > 0 && !NodeNote.Note.IsEmpty())
+		{
+			OutNotes.Add(MoveTemp(NodeNote));
+		}
+		return bParsed;
+	}
+
+	// Decodes a JSON string value from Index up to its closing quote or the end of what has arrived; an escape cut in
+	// half is left for the next chunk. Returns true once the closing quote was reached, with Index past it.
+	static bool DecodePartialString(const FString& Text, int32& InOutIndex, FString& OutDecoded)
+	{
+		int32 Index = InOutIndex;
+		ON_SCOPE_EXIT
+		{
+			InOutIndex = Index;
+		};
+		while (Index < Text.Len())
+		{
+			const TCHAR Char = Text[Index];
+			if (Char == TEXT('"'))
+			{
+				++Index;
+				return true;
+			}
+			if (Char != TEXT('\\'))
+			{
+				OutDecoded.AppendChar(Char);
+				++Index;
+				continue;
+			}
+			if (Index + 1 >= Text.Len())
+			{
+				return false;
+			}
+
+			const TCHAR Escaped = Text[Index + 1];
+			switch (Escaped)
+			{
+			case TEXT('n'): OutDecoded.AppendChar(TEXT('\n')); break;
+			case TEXT('t'): OutDecoded.AppendChar(TEXT('\t')); break;
+			case TEXT('r'): break;
+			case TEXT('b'): case TEXT('f'): break;
+			case TEXT('u'):
+				if (Index + 6 > Text.Len())
+				{
+					return false;
+				}
+				OutDecoded.AppendChar(static_cast<TCHAR>(FParse::HexNumber(*Text.Mid(Index + 2, 4))));
+				Index += 4;
+				break;
+			default: OutDecoded.AppendChar(Escaped); break;
+			}
+			Index += 2;
+		}
+		return false;
+	}
+
+	static const TCHAR* DetailsKey = TEXT("\"details\"");
+	static const TCHAR* DetailsMarker = TEXT("DETAILS:");
+	static const TCHAR* SummaryMarker = TEXT("SUMMARY:");
+
+	// Both markers are this long; a marker cut off at the end of what has arrived starts in the last MarkerLen - 1 characters
+	static const int32 MarkerLen = 8;
+}
+
+const FString& FGeminiSummarySchema::GetSchemaJson()
+{
+	static const FString Schema(GeminiSummarySchema::SchemaJson);
+	return Schema;
+}
+
+const TCHAR* FGeminiSummarySchema::GetFieldInstructions()
+{
+	return TEXT("Put a user-friendly explanation into details, a concise one-line summary into summary, short notes on the important nodes into nodeNotes using their numbers from the node list, and how confident you are from 0 to 1 into confidence.");
+}
+
+bool FGeminiSummarySchema::Parse(const FString& ResponseText, FGeminiStructuredSummary& OutSummary)
+{
+	OutSummary = FGeminiStructuredSummary();
+
+	FTCHARToUTF8 Utf8(*ResponseText, ResponseText.Len());
+	FGeminiJsonReader Reader(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	if (Reader.Peek() != EGeminiJsonToken::Object)
+	{
+		return false;
+	}
+
+	const bool bParsed = Reader.ReadObject([&Reader, &OutSummary](const FString& Key)
+	{
+		if (Key == TEXT("details") && Reader.Peek() == EGeminiJsonToken::String)
+		{
+			return Reader.ReadString(OutSummary.Details);
+		}
+		if (Key == TEXT("summary") && Reader.Peek() == EGeminiJsonToken::String)
+		{
+			return Reader.ReadString(OutSummary.Summary);
+		}
+		if (Key == TEXT("confidence") && Reader.Peek() == EGeminiJsonToken::Number)
+		{
+			double Confidence = 0.0;
+			const bool bRead = Reader.ReadNumber(Confidence);
+			OutSummary.Confidence = FMath::Clamp(static_cast<float>(Confidence), 0.0f, 1.0f);
+			return bRead;
+		}
+		if (Key == TEXT("nodeNotes") && Reader.Peek() == EGeminiJsonToken::Array)
+		{
+			return Reader.ReadArray([&Reader, &OutSummary](int32 Index)
+			{
+				return GeminiSummarySchema::ParseNodeNote(Reader, OutSummary.NodeNotes);
+			});
+		}
+		return Reader.SkipValue();
+	});
+
+	return bParsed && !OutSummary.Details.IsEmpty();
+}
+
+FString FGeminiSummarySchema::ExtractPartialDetails(const FString& PartialResponse)
+{
+	const int32 KeyIndex = PartialResponse.Find(GeminiSummarySchema::DetailsKey, ESearchCase::CaseSensitive);
+	if (KeyIndex == INDEX_NONE)
+	{
+		return FString();
+	}
+
+	// Skip to the opening quote of the value
+	int32 Index = KeyIndex + 9;
+	while (Index < PartialResponse.Len() && (FChar::IsWhitespace(PartialResponse[Index]) || PartialResponse[Index] == TEXT(':')))
+	{
+		++Index;
+	}
+	if (Index >= PartialResponse.Len() || PartialResponse[Index] != TEXT('"'))
+	{
+		return FString();
+	}
+	++Index;
+
+	FString Details;
+	Details.Reserve(PartialResponse.Len() - Index);
+	GeminiSummarySchema::DecodePartialString(PartialResponse, Index, Details);
+	return Details;
+}
+
+bool FGeminiStreamingDetails::Update(const FString& Response, FString& OutAppended)
+{
+	OutAppended.Reset();
+	if (Mode == EMode::Undecided)
+	{
+		while (ScanIndex < Response.Len() && FChar::IsWhitespace(Response[ScanIndex]))
+		{
+			++ScanIndex;
+		}
+		if (ScanIndex >= Response.Len())
+		{
+			return true;
+		}
+		Mode = Response[ScanIndex] == TEXT('{') ? EMode::Json : EMode::Text;
+	}
+
+	if (Mode == EMode::Json)
+	{
+		ScanJson(Response, OutAppended);
+		return true;
+	}
+	return ScanText(Response, OutAppended);
+}
+
+void FGeminiStreamingDetails::ScanJson(const FString& Response, FString& OutAppended)
+{
+	if (bEnded)
+	{
+		return;
+	}
+
+	if (!bFoundKey)
+	{
+		// The key may have been cut off by the previous chunk
+		const int32 KeyIndex = Response.Find(GeminiSummarySchema::DetailsKey, ESearchCase::CaseSensitive, ESearchDir::FromStart, FMath::Max(0, ScanIndex - 8));
+		if (KeyIndex == INDEX_NONE)
+		{
+			ScanIndex = Response.Len();
+			return;
+		}
+		bFoundKey = true;
+		ScanIndex = KeyIndex + 9;
+	}
+
+	if (!bInValue)
+	{
+		while (ScanIndex < Response.Len() && (FChar::IsWhitespace(Response[ScanIndex]) || Response[ScanIndex] == TEXT(':')))
+		{
+			++ScanIndex;
+		}
+		if (ScanIndex >= Response.Len())
+		{
+			return;
+		}
+		if (Response[ScanIndex] != TEXT('"'))
+		{
+			// Not a string; the complete answer is parsed properly once it is there
+			bEnded = true;
+			return;
+		}
+		bInValue = true;
+		++ScanIndex;
+	}
+
+	bEnded = GeminiSummarySchema::DecodePartialString(Response, ScanIndex, OutAppended);
+	Details += OutAppended;
+}
+
+bool FGeminiStreamingDetails::ScanText(const FString& Response, FString& OutAppended)
+{
+	using namespace GeminiSummarySchema;
+
+	// Markers are only looked for where they are complete; the tail that may start one waits for the next chunk
+	const int32 SafeEnd = FMath::Max(ScanIndex, Response.Len() - (MarkerLen - 1));
+	bool bContinued = true;
+
+	// Text ahead of a late DETAILS: marker was only shown for want of anything better
+	if (!bFoundDetailsMarker)
+	{
+		const int32 MarkerIndex = Response.Find(DetailsMarker, ESearchCase::IgnoreCase, ESearchDir::FromStart, ScanIndex);
+		if (MarkerIndex != INDEX_NONE)
+		{
+			bContinued = Details.IsEmpty();
+			Details.Reset();
+			PendingWhitespace.Reset();
+			bFoundDetailsMarker = true;
+			bAtStart = true;
+			bEnded = false;
+			ScanIndex = MarkerIndex + MarkerLen;
+		}
+	}
+
+	if (bEnded)
+	{
+		// Nothing more to show, but a DETAILS: marker could still come
+		ScanIndex = bFoundDetailsMarker ? Response.Len() : SafeEnd;
+		return bContinued;
+	}
+
+	const int32 SummaryIndex = Response.Find(SummaryMarker, ESearchCase::IgnoreCase, ESearchDir::FromStart, ScanIndex);
+	const int32 End = SummaryIndex != INDEX_NONE ? SummaryIndex : FMath::Max(ScanIndex, SafeEnd);
+	AppendTrimmed(Response, ScanIndex, End, OutAppended);
+	ScanIndex = End;
+	if (SummaryIndex != INDEX_NONE)
+	{
+		// Whitespace ahead of the marker ends the details
+		PendingWhitespace.Reset();
+		bEnded = true;
+		ScanIndex = SummaryIndex + MarkerLen;
+	}
+
+	if (!bContinued)
+	{
+		OutAppended = Details;
+	}
+	return bContinued;
+}
+
+void FGeminiStreamingDetails::AppendTrimmed(const FString& Response, int32 From, int32 To, FString& OutAppended)
+{
+	const int32 AppendedStart = OutAppended.Len();
+	for (int32 Index = From; Index < To; ++Index)
+	{
+		const TCHAR Char = Response[Index];
+		if (FChar::IsWhitespace(Char))
+		{
+			if (!bAtStart)
+			{
+				PendingWhitespace.AppendChar(Char);
+			}
+			continue;
+		}
+		bAtStart = false;
+		OutAppended += PendingWhitespace;
+		PendingWhitespace.Reset();
+		OutAppended.AppendChar(Char);
+	}
+	Details.Append(*OutAppended + AppendedStart, OutAppended.Len() - AppendedStart);
+}
@@ -0,0 +1,547 @@
+// Private/GeminiSummaryStore.cpp
+#include "GeminiSummaryStore.h"
+#include "GeminiAssistantTrace.h"
+#include "GeminiSession.h"
+#include "SQLiteDatabase.h"
+#include "Engine/Blueprint.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Editor.h"
+#include "UObject/UObjectGlobals.h"
+#include "HAL/FileManager.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Paths.h"
+#include "Hash/CityHash.h"
+
+namespace GeminiSummaryStore
+{
+	static const TCHAR* WholeGraphKey = TEXT("*");
+
+	static const TCHAR* Schema[] =
+	{
+		TEXT("CREATE TABLE IF NOT EXISTS Summaries (Id INTEGER PRIMARY KEY, BlueprintPath TEXT NOT NULL, GraphName TEXT NOT NULL, NodeSet TEXT NOT NULL, ")
+		TEXT("ContentHash TEXT NOT NULL, NumNodes INTEGER NOT NULL, WholeGraph INTEGER NOT NULL, Summary TEXT NOT NULL, Details TEXT NOT NULL, Time INTEGER NOT NULL, ")
+		TEXT("UNIQUE (BlueprintPath, GraphName, NodeSet))"),
+		TEXT("CREATE TABLE IF NOT EXISTS SummaryNodes (NodeGuid TEXT NOT NULL, SummaryId INTEGER NOT NULL, PRIMARY KEY (NodeGuid, SummaryId)) WITHOUT ROWID"),
+		TEXT("CREATE INDEX IF NOT EXISTS SummaryNodesBySummary ON SummaryNodes (SummaryId)")
+	};
+
+	// Columns read by ReadSummary, in order
+	static const TCHAR* SummaryColumns = TEXT("s.Id, s.BlueprintPath, s.GraphName, s.Summary, s.Details, s.NumNodes, s.WholeGraph, s.Time, s.ContentHash");
+
+	static void ReadSummary(const FSQLitePreparedStatement& Statement, FGeminiStoredSummary& OutSummary, FString& OutContentHash)
+	{
+		int64 NumNodes = 0;
+		int64 WholeGraph = 0;
+		int64 Ticks = 0;
+		Statement.GetColumnValueByIndex(0, OutSummary.Id);
+		Statement.GetColumnValueByIndex(1, OutSummary.BlueprintPath);
+		Statement.GetColumnValueByIndex(2, OutSummary.GraphName);
+		Statement.GetColumnValueByIndex(3, OutSummary.Summary);
+		Statement.GetColumnValueByIndex(4, OutSummary.Details);
+		Statement.GetColumnValueByIndex(5, NumNodes);
+		Statement.GetColumnValueByIndex(6, WholeGraph);
+		Statement.GetColumnValueByIndex(7, Ticks);
+		Statement.GetColumnValueByIndex(8, OutContentHash);
+		OutSummary.NumNodes = static_cast<int32>(NumNodes);
+		OutSummary.bWholeGraph = WholeGraph != 0;
+		OutSummary.Time = FDateTime(Ticks);
+	}
+
+	static FString HashToString(const FString& Text)
+	{
+		FTCHARToUTF8 TextUtf8(*Text, Text.Len());
+		return FString::Printf(TEXT("%016llx"), CityHash64(TextUtf8.Get(), TextUtf8.Length()));
+	}
+
+	static TArray<UEdGraphNode*> GetGraphNodes(UEdGraph* Graph)
+	{
+		TArray<UEdGraphNode*> Nodes;
+		for (UEdGraphNode* Node : Graph->Nodes)
+		{
+			if (Node && IsValid(Node))
+			{
+				Nodes.Add(Node);
+			}
+		}
+		return Nodes;
+	}
+
+	// The nodes a summary is stored for: the given ones that still exist, or the whole graph
+	static TArray<UEdGraphNode*> GetSetNodes(UEdGraph* Graph, const TArray<UEdGraphNode*>& Nodes)
+	{
+		return Nodes.Num() == 0 ? GetGraphNodes(Graph) : Nodes.FilterByPredicate([](const UEdGraphNode* Node) { return Node && IsValid(Node); });
+	}
+}
+
+FGeminiSummaryStore& FGeminiSummaryStore::Get()
+{
+	static FGeminiSummaryStore Instance;
+	return Instance;
+}
+
+FGeminiSummaryStore::FGeminiSummaryStore()
+	: FilePath(FPaths::ProjectSavedDir() / TEXT("GeminiAssistant") / TEXT("Summaries.db"))
+{
+	if (GConfig)
+	{
+		GConfig->GetString(TEXT("GeminiAssistant"), TEXT("SummaryStorePath"), FilePath, GEditorPerProjectIni);
+	}
+}
+
+FGeminiSummaryStore::FGeminiSummaryStore(const FString& InFilePath)
+	: FilePath(InFilePath)
+{
+}
+
+FGeminiSummaryStore::~FGeminiSummaryStore()
+{
+	// Normally closed by Shutdown already; by now the editor may be gone, so only the database is left to close
+	HasNodeStatement.Reset();
+	if (IsOpen())
+	{
+		Database->Close();
+	}
+}
+
+void FGeminiSummaryStore::Shutdown()
+{
+	if (ObjectModifiedHandle.IsValid())
+	{
+		FCoreUObjectDelegates::OnObjectModified.Remove(ObjectModifiedHandle);
+		ObjectModifiedHandle.Reset();
+	}
+	if (BlueprintCompiledHandle.IsValid() && GEditor)
+	{
+		GEditor->OnBlueprintCompiled().Remove(BlueprintCompiledHandle);
+	}
+	BlueprintCompiledHandle.Reset();
+	for (const TPair<TObjectKey<UEdGraph>, FGraphValidation>& Pair : Validations)
+	{
+		if (UEdGraph* Graph = Pair.Value.Graph.Get())
+		{
+			Graph->RemoveOnGraphChangedHandler(Pair.Value.GraphChangedHandle);
+		}
+	}
+	Validations.Empty();
+
+	// A statement still prepared keeps the database from closing
+	if (HasNodeStatement.IsValid())
+	{
+		HasNodeStatement->Destroy();
+		HasNodeStatement.Reset();
+	}
+	if (IsOpen())
+	{
+		Database->Close();
+	}
+
+	// Open() sees the closed database and does not open it again
+	if (!Database.IsValid())
+	{
+		Database = MakeUnique<FSQLiteDatabase>();
+	}
+}
+
+bool FGeminiSummaryStore::IsOpen() const
+{
+	return Database.IsValid() && Database->IsValid();
+}
+
+bool FGeminiSummaryStore::Open()
+{
+	// Opened once; a database that failed to open is not retried on every lookup
+	if (Database.IsValid())
+	{
+		return Database->IsValid();
+	}
+
+	Database = MakeUnique<FSQLiteDatabase>();
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(FilePath), true);
+	if (!Database->Open(*FilePath, ESQLiteDatabaseOpenMode::ReadWriteCreate))
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiSummaryStore: Could not open %s: %s"), *FilePath, *Database->GetLastError());
+		return false;
+	}
+	for (const TCHAR* Statement : GeminiSummaryStore::Schema)
+	{
+		if (!Database->Execute(Statement))
+		{
+			UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiSummaryStore: Could not set up %s: %s"), *FilePath, *Database->GetLastError());
+			Database->Close();
+			return false;
+		}
+	}
+	HasNodeStatement = MakeUnique<FSQLitePreparedStatement>(Database->PrepareStatement(TEXT("SELECT 1 FROM SummaryNodes WHERE NodeGuid = ?1 LIMIT 1"), ESQLitePreparedStatementFlags::Persistent));
+
+	// Edits call Modify on the node, which covers pin values that never reach the graph's change notification;
+	// a compile can change how nodes calling into another Blueprint are described
+	ObjectModifiedHandle = FCoreUObjectDelegates::OnObjectModified.AddRaw(this, &FGeminiSummaryStore::OnObjectModified);
+	if (GEditor)
+	{
+		BlueprintCompiledHandle = GEditor->OnBlueprintCompiled().AddRaw(this, &FGeminiSummaryStore::OnBlueprintCompiled);
+	}
+	return true;
+}
+
+FString FGeminiSummaryStore::MakeNodeSetKey(const TArray<UEdGraphNode*>& Nodes, bool bWholeGraph)
+{
+	if (bWholeGraph)
+	{
+		return GeminiSummaryStore::WholeGraphKey;
+	}
+
+	TArray<FGuid> Guids;
+	for (const UEdGraphNode* Node : Nodes)
+	{
+		Guids.Add(Node->NodeGuid);
+	}
+	Guids.Sort();
+
+	FString Key;
+	for (const FGuid& Guid : Guids)
+	{
+		Key += Guid.ToString(EGuidFormats::Digits);
+	}
+	return GeminiSummaryStore::HashToString(Key);
+}
+
+FString FGeminiSummaryStore::MakeContentHash(UEdGraph* Graph, const TArray<UEdGraphNode*>& Nodes)
+{
+	return Graph ? HashNodes(GeminiSummaryStore::GetSetNodes(Graph, Nodes)) : FString();
+}
+
+FString FGeminiSummaryStore::HashNodes(const TArray<UEdGraphNode*>& Nodes)
+{
+	FGeminiGraphSnapshot Snapshot = FGeminiGraphSnapshot::Capture(Nodes);
+	Snapshot.Nodes.Sort([](const FGeminiGraphSnapshot::FNode& A, const FGeminiGraphSnapshot::FNode& B) { return A.NodeGuid < B.NodeGuid; });
+
+	FString Content;
+	for (const FGeminiGraphSnapshot::FNode& Node : Snapshot.Nodes)
+	{
+		Content += Node.Line;
+		Content += TEXT("\n");
+	}
+	return GeminiSummaryStore::HashToString(Content);
+}
+
+void FGeminiSummaryStore::Put(UEdGraph* Graph, const TArray<UEdGraphNode*>& Nodes, const FString& ContentHash, const FString& Summary, const FString& Details)
+{
+	UBlueprint* Blueprint = Graph ? FBlueprintEditorUtils::FindBlueprintForGraph(Graph) : nullptr;
+	if (!Blueprint || ContentHash.IsEmpty() || (Summary.IsEmpty() && Details.IsEmpty()) || !Open())
+	{
+		return;
+	}
+
+	const bool bWholeGraph = Nodes.Num() == 0;
+	TArray<UEdGraphNode*> SetNodes = GeminiSummaryStore::GetSetNodes(Graph, Nodes);
+	if (SetNodes.Num() == 0)
+	{
+		return;
+	}
+
+	const FString BlueprintPath = Blueprint->GetPathName();
+	const FString GraphName = Graph->GetName();
+
+	// Stored, the summary would pass every lookup as long as the nodes stay as they are now
+	if (HashNodes(SetNodes) != ContentHash)
+	{
+		UE_LOG(LogGeminiAssistant, Log, TEXT("GeminiSummaryStore: Not storing the summary of %s:%s, the nodes changed while it was written"), *BlueprintPath, *GraphName);
+		return;
+	}
+	const FString NodeSet = MakeNodeSetKey(SetNodes, bWholeGraph);
+
+	Database->Execute(TEXT("BEGIN"));
+
+	// Replaces the summary of the same nodes along with its node list
+	FSQLitePreparedStatement DeleteNodes = Database->PrepareStatement(TEXT("DELETE FROM SummaryNodes WHERE SummaryId IN (SELECT Id FROM Summaries WHERE BlueprintPath = ?1 AND GraphName = ?2 AND NodeSet = ?3)"));
+	FSQLitePreparedStatement DeleteSummary = Database->PrepareStatement(TEXT("DELETE FROM Summaries WHERE BlueprintPath = ?1 AND GraphName = ?2 AND NodeSet = ?3"));
+	for (FSQLitePreparedStatement* Statement : { &DeleteNodes, &DeleteSummary })
+	{
+		Statement->SetBindingValueByIndex(1, BlueprintPath);
+		Statement->SetBindingValueByIndex(2, GraphName);
+		Statement->SetBindingValueByIndex(3, NodeSet);
+		Statement->Execute();
+	}
+
+	FSQLitePreparedStatement Insert = Database->PrepareStatement(TEXT("INSERT INTO Summaries (BlueprintPath, GraphName, NodeSet, ContentHash, NumNodes, WholeGraph, Summary, Details, Time) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9)"));
+	Insert.SetBindingValueByIndex(1, BlueprintPath);
+	Insert.SetBindingValueByIndex(2, GraphName);
+	Insert.SetBindingValueByIndex(3, NodeSet);
+	Insert.SetBindingValueByIndex(4, ContentHash);
+	Insert.SetBindingValueByIndex(5, static_cast<int64>(SetNodes.Num()));
+	Insert.SetBindingValueByIndex(6, static_cast<int64>(bWholeGraph ? 1 : 0));
+	Insert.SetBindingValueByIndex(7, Summary);
+	Insert.SetBindingValueByIndex(8, Details);
+	Insert.SetBindingValueByIndex(9, FDateTime::UtcNow().GetTicks());
+	if (!Insert.Execute())
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiSummaryStore: Could not store the summary of %s:%s: %s"), *BlueprintPath, *GraphName, *Database->GetLastError());
+		Database->Execute(TEXT("ROLLBACK"));
+		return;
+	}
+
+	const int64 SummaryId = Database->GetLastInsertRowId();
+	FSQLitePreparedStatement InsertNode = Database->PrepareStatement(TEXT("INSERT OR IGNORE INTO SummaryNodes (NodeGuid, SummaryId) VALUES (?1, ?2)"));
+	for (const UEdGraphNode* Node : SetNodes)
+	{
+		InsertNode.Reset();
+		InsertNode.ClearBindings();
+		InsertNode.SetBindingValueByIndex(1, Node->NodeGuid.ToString(EGuidFormats::Digits));
+		InsertNode.SetBindingValueByIndex(2, SummaryId);
+		InsertNode.Execute();
+	}
+	Database->Execute(TEXT("COMMIT"));
+
+	// Node widgets are rebuilt, and with them the tooltips
+	Graph->NotifyGraphChanged();
+
+	// The nodes were just checked to hash as they did for the prompt
+	FindOrAddValidation(Graph).CurrentSummaryIds.Add(SummaryId);
+}
+
+bool FGeminiSummaryStore::Find(UEdGraph* Graph, const TArray<UEdGraphNode*>& Nodes, FGeminiStoredSummary& OutSummary)
+{
+	UBlueprint* Blueprint = Graph ? FBlueprintEditorUtils::FindBlueprintForGraph(Graph) : nullptr;
+	if (!Blueprint || !Open())
+	{
+		return false;
+	}
+
+	const bool bWholeGraph = Nodes.Num() == 0;
+	FSQLitePreparedStatement Select = Database->PrepareStatement(*FString::Printf(TEXT("SELECT %s FROM Summaries s WHERE s.BlueprintPath = ?1 AND s.GraphName = ?2 AND s.NodeSet = ?3"), GeminiSummaryStore::SummaryColumns));
+	Select.SetBindingValueByIndex(1, Blueprint->GetPathName());
+	Select.SetBindingValueByIndex(2, Graph->GetName());
+	Select.SetBindingValueByIndex(3, MakeNodeSetKey(Nodes, bWholeGraph));
+
+	FString ContentHash;
+	if (Select.Step() != ESQLitePreparedStatementStepResult::Row)
+	{
+		return false;
+	}
+	GeminiSummaryStore::ReadSummary(Select, OutSummary, ContentHash);
+	Select.Reset();
+	return Validate(OutSummary, Graph, ContentHash);
+}
+
+bool FGeminiSummaryStore::FindForNode(UEdGraphNode* Node, FGeminiStoredSummary& OutSummary)
+{
+	UEdGraph* Graph = Node ? Node->GetGraph() : nullptr;
+	UBlueprint* Blueprint = Graph ? FBlueprintEditorUtils::FindBlueprintForGraph(Graph) : nullptr;
+	if (!Blueprint || !Open())
+	{
+		return false;
+	}
+
+	// Smallest node sets first: a summary of the selection says more about a node than one of the whole graph
+	FSQLitePreparedStatement Select = Database->PrepareStatement(*FString::Printf(
+		TEXT("SELECT %s FROM SummaryNodes n JOIN Summaries s ON s.Id = n.SummaryId WHERE n.NodeGuid = ?1 AND s.BlueprintPath = ?2 AND s.GraphName = ?3 ORDER BY s.NumNodes"),
+		GeminiSummaryStore::SummaryColumns));
+	Select.SetBindingValueByIndex(1, Node->NodeGuid.ToString(EGuidFormats::Digits));
+	Select.SetBindingValueByIndex(2, Blueprint->GetPathName());
+	Select.SetBindingValueByIndex(3, Graph->GetName());
+
+	TArray<TPair<FGeminiStoredSummary, FString>> Candidates;
+	while (Select.Step() == ESQLitePreparedStatementStepResult::Row)
+	{
+		TPair<FGeminiStoredSummary, FString>& Candidate = Candidates.AddDefaulted_GetRef();
+		GeminiSummaryStore::ReadSummary(Select, Candidate.Key, Candidate.Value);
+	}
+	Select.Reset();
+
+	for (const TPair<FGeminiStoredSummary, FString>& Candidate : Candidates)
+	{
+		if (Validate(Candidate.Key, Graph, Candidate.Value))
+		{
+			OutSummary = Candidate.Key;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FGeminiSummaryStore::HasAnyForNode(const UEdGraphNode* Node)
+{
+	if (!Node || !Open())
+	{
+		return false;
+	}
+	HasNodeStatement->Reset();
+	HasNodeStatement->ClearBindings();
+	HasNodeStatement->SetBindingValueByIndex(1, Node->NodeGuid.ToString(EGuidFormats::Digits));
+	return HasNodeStatement->Step() == ESQLitePreparedStatementStepResult::Row;
+}
+
+TArray<FGeminiStoredSummary> FGeminiSummaryStore::GetGraphSummaries(UBlueprint* Blueprint)
+{
+	int32 NumDropped = 0;
+	return ReadGraphSummaries(Blueprint, NumDropped);
+}
+
+bool FGeminiSummaryStore::HasStaleGraphSummaries(UBlueprint* Blueprint)
+{
+	int32 NumDropped = 0;
+	ReadGraphSummaries(Blueprint, NumDropped);
+	return NumDropped > 0;
+}
+
+TArray<FGeminiStoredSummary> FGeminiSummaryStore::ReadGraphSummaries(UBlueprint* Blueprint, int32& OutNumDropped)
+{
+	OutNumDropped = 0;
+	TArray<FGeminiStoredSummary> Result;
+	if (!Blueprint || !Open())
+	{
+		return Result;
+	}
+
+	TMap<FString, UEdGraph*> GraphsByName;
+	TArray<UEdGraph*> Graphs;
+	Blueprint->GetAllGraphs(Graphs);
+	for (UEdGraph* Graph : Graphs)
+	{
+		GraphsByName.Add(Graph->GetName(), Graph);
+	}
+
+	FSQLitePreparedStatement Select = Database->PrepareStatement(*FString::Printf(TEXT("SELECT %s FROM Summaries s WHERE s.BlueprintPath = ?1 AND s.WholeGraph = 1 ORDER BY s.GraphName"), GeminiSummaryStore::SummaryColumns));
+	Select.SetBindingValueByIndex(1, Blueprint->GetPathName());
+	TArray<TPair<FGeminiStoredSummary, FString>> Candidates;
+	while (Select.Step() == ESQLitePreparedStatementStepResult::Row)
+	{
+		TPair<FGeminiStoredSummary, FString>& Candidate = Candidates.AddDefaulted_GetRef();
+		GeminiSummaryStore::ReadSummary(Select, Candidate.Key, Candidate.Value);
+	}
+	Select.Reset();
+
+	for (const TPair<FGeminiStoredSummary, FString>& Candidate : Candidates)
+	{
+		UEdGraph** Graph = GraphsByName.Find(Candidate.Key.GraphName);
+		if (!Graph)
+		{
+			// The graph was renamed or removed
+			Delete(Candidate.Key.Id);
+			++OutNumDropped;
+		}
+		else if (Validate(Candidate.Key, *Graph, Candidate.Value))
+		{
+			Result.Add(Candidate.Key);
+		}
+		else
+		{
+			++OutNumDropped;
+		}
+	}
+	return Result;
+}
+
+bool FGeminiSummaryStore::Validate(const FGeminiStoredSummary& Summary, UEdGraph* Graph, const FString& ContentHash)
+{
+	FGraphValidation& Validation = FindOrAddValidation(Graph);
+	if (Validation.CurrentSummaryIds.Contains(Summary.Id))
+	{
+		return true;
+	}
+
+	TArray<UEdGraphNode*> Nodes;
+	bool bNodesExist = true;
+	if (Summary.bWholeGraph)
+	{
+		Nodes = GeminiSummaryStore::GetGraphNodes(Graph);
+	}
+	else
+	{
+		TMap<FGuid, UEdGraphNode*> GraphNodes;
+		for (UEdGraphNode* Node : GeminiSummaryStore::GetGraphNodes(Graph))
+		{
+			GraphNodes.Add(Node->NodeGuid, Node);
+		}
+
+		FSQLitePreparedStatement Select = Database->PrepareStatement(TEXT("SELECT NodeGuid FROM SummaryNodes WHERE SummaryId = ?1"));
+		Select.SetBindingValueByIndex(1, Summary.Id);
+		while (bNodesExist && Select.Step() == ESQLitePreparedStatementStepResult::Row)
+		{
+			FString GuidString;
+			FGuid Guid;
+			Select.GetColumnValueByIndex(0, GuidString);
+			UEdGraphNode** Node = FGuid::Parse(GuidString, Guid) ? GraphNodes.Find(Guid) : nullptr;
+			if (Node)
+			{
+				Nodes.Add(*Node);
+			}
+			bNodesExist = Node != nullptr;
+		}
+	}
+
+	if (bNodesExist && HashNodes(Nodes) == ContentHash)
+	{
+		Validation.CurrentSummaryIds.Add(Summary.Id);
+		return true;
+	}
+	Delete(Summary.Id);
+	return false;
+}
+
+FGeminiSummaryStore::FGraphValidation& FGeminiSummaryStore::FindOrAddValidation(UEdGraph* Graph)
+{
+	FGraphValidation& Validation = Validations.FindOrAdd(Graph);
+	if (!Validation.Graph.IsValid())
+	{
+		Validation.Graph = Graph;
+		Validation.GraphChangedHandle = Graph->AddOnGraphChangedHandler(FOnGraphChanged::FDelegate::CreateRaw(this, &FGeminiSummaryStore::OnGraphChanged));
+	}
+	return Validation;
+}
+
+void FGeminiSummaryStore::ForgetValidation(const UEdGraph* Graph)
+{
+	if (FGraphValidation* Validation = Graph ? Validations.Find(Graph) : nullptr)
+	{
+		// The handler stays registered; it may be the one broadcasting right now
+		Validation->CurrentSummaryIds.Empty();
+	}
+}
+
+void FGeminiSummaryStore::OnGraphChanged(const FEdGraphEditAction& Action)
+{
+	ForgetValidation(Action.Graph);
+}
+
+void FGeminiSummaryStore::OnObjectModified(UObject* Object)
+{
+	if (Validations.Num() == 0)
+	{
+		return;
+	}
+	if (const UEdGraphNode* Node = Cast<UEdGraphNode>(Object))
+	{
+		ForgetValidation(Node->GetGraph());
+	}
+	else if (const UEdGraph* Graph = Cast<UEdGraph>(Object))
+	{
+		ForgetValidation(Graph);
+	}
+}
+
+void FGeminiSummaryStore::OnBlueprintCompiled()
+{
+	for (auto It = Validations.CreateIterator(); It; ++It)
+	{
+		// Graphs that were deleted or unloaded took their handler with them
+		if (!It->Value.Graph.IsValid())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+		It->Value.CurrentSummaryIds.Empty();
+	}
+}
+
+void FGeminiSummaryStore::Delete(int64 SummaryId)
+{
+	FSQLitePreparedStatement DeleteNodes = Database->PrepareStatement(TEXT("DELETE FROM SummaryNodes WHERE SummaryId = ?1"));
+	DeleteNodes.SetBindingValueByIndex(1, SummaryId);
+	DeleteNodes.Execute();
+	FSQLitePreparedStatement DeleteSummary = Database->PrepareStatement(TEXT("DELETE FROM Summaries WHERE Id = ?1"));
+	DeleteSummary.SetBindingValueByIndex(1, SummaryId);
+	DeleteSummary.Execute();
+}
@@ -0,0 +1,130 @@
+// Private/GeminiTimingLog.cpp
+#include "GeminiTimingLog.h"
+#include "GeminiAssistantTrace.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ConfigCacheIni.h"
+
+namespace GeminiTimingLog
+{
+	static const int32 DefaultMaxRecords = 1000;
+}
+
+FGeminiTimingLog& FGeminiTimingLog::Get()
+{
+	static FGeminiTimingLog Instance;
+	return Instance;
+}
+
+FGeminiTimingLog::FGeminiTimingLog()
+	: MaxRecords(GeminiTimingLog::DefaultMaxRecords)
+{
+	if (GConfig)
+	{
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("MaxTimingRecords"), MaxRecords, GEditorPerProjectIni);
+	}
+	MaxRecords = FMath::Max(1, MaxRecords);
+}
+
+FGeminiRequestTiming* FGeminiTimingLog::Find(uint64 RequestId)
+{
+	// Recent requests are at the end and are the ones still being recorded
+	for (int32 Index = Records.Num() - 1; Index >= 0; --Index)
+	{
+		if (Records[Index].RequestId == RequestId)
+		{
+			return &Records[Index];
+		}
+	}
+	return nullptr;
+}
+
+FGeminiRequestTiming& FGeminiTimingLog::FindOrAdd(uint64 RequestId)
+{
+	if (FGeminiRequestTiming* Existing = Find(RequestId))
+	{
+		return *Existing;
+	}
+
+	if (Records.Num() >= MaxRecords)
+	{
+		Records.RemoveAt(0, Records.Num() - MaxRecords + 1);
+	}
+
+	FGeminiRequestTiming& Record = Records.AddDefaulted_GetRef();
+	Record.RequestId = RequestId;
+	Record.Timestamp = FDateTime::Now();
+	Record.SubmitTime = FPlatformTime::Seconds();
+	return Record;
+}
+
+void FGeminiTimingLog::AddStageTime(uint64 RequestId, EGeminiTimingStage Stage, double Seconds)
+{
+	if (RequestId != 0)
+	{
+		FindOrAdd(RequestId).StageSeconds[static_cast<int32>(Stage)] += Seconds;
+	}
+}
+
+const TCHAR* FGeminiTimingLog::GetStageName(EGeminiTimingStage Stage)
+{
+	switch (Stage)
+	{
+	case EGeminiTimingStage::CollectNodes: return TEXT("CollectNodes");
+	case EGeminiTimingStage::PreprocessNodes: return TEXT("PreprocessNodes");
+	case EGeminiTimingStage::BuildPrompt: return TEXT("BuildPrompt");
+	case EGeminiTimingStage::SerializeRequest: return TEXT("SerializeRequest");
+	case EGeminiTimingStage::Wait: return TEXT("Wait");
+	case EGeminiTimingStage::Network: return TEXT("Network");
+	case EGeminiTimingStage::ParseResponse: return TEXT("ParseResponse");
+	case EGeminiTimingStage::UpdateUI: return TEXT("UpdateUI");
+	case EGeminiTimingStage::WriteComments: return TEXT("WriteComments");
+	default: return TEXT("Unknown");
+	}
+}
+
+bool FGeminiTimingLog::DumpToCsv(const FString& FilePath) const
+{
+	FString Csv = TEXT("RequestId,Timestamp,Model,PromptChars,ResponseChars,Attempts,Success");
+	for (int32 Stage = 0; Stage < static_cast<int32>(EGeminiTimingStage::Num); ++Stage)
+	{
+		Csv += FString::Printf(TEXT(",%sMs"), GetStageName(static_cast<EGeminiTimingStage>(Stage)));
+	}
+	Csv += TEXT(",TimeToFirstTextMs,TotalMs\n");
+
+	for (const FGeminiRequestTiming& Record : Records)
+	{
+		Csv += FString::Printf(TEXT("%llu,%s,%s,%d,%d,%d,%d"), Record.RequestId, *Record.Timestamp.ToIso8601(), *Record.Model,
+			Record.PromptChars, Record.ResponseChars, Record.Attempts, Record.bSuccess ? 1 : 0);
+		for (int32 Stage = 0; Stage < static_cast<int32>(EGeminiTimingStage::Num); ++Stage)
+		{
+			Csv += FString::Printf(TEXT(",%.3f"), Record.StageSeconds[Stage] * 1000.0);
+		}
+		Csv += FString::Printf(TEXT(",%.3f,%.3f\n"), Record.TimeToFirstText * 1000.0, Record.TotalSeconds * 1000.0);
+	}
+
+	return FFileHelper::SaveStringToFile(Csv, *FilePath);
+}
+
+namespace GeminiTimingLog
+{
+	// Gemini.DumpTimings [Path]
+	static void DumpTimings(const TArray<FString>& Args)
+	{
+		const FString FilePath = Args.Num() > 0 ? Args[0] : FPaths::ProfilingDir() / TEXT("GeminiTimings.csv");
+		if (FGeminiTimingLog::Get().DumpToCsv(FilePath))
+		{
+			UE_LOG(LogGeminiAssistant, Display, TEXT("Wrote %d request timings to %s"), FGeminiTimingLog::Get().Num(), *FPaths::ConvertRelativePathToFull(FilePath));
+		}
+		else
+		{
+			UE_LOG(LogGeminiAssistant, Error, TEXT("Could not write request timings to %s"), *FilePath);
+		}
+	}
+
+	static FAutoConsoleCommand DumpTimingsCommand(
+		TEXT("Gemini.DumpTimings"),
+		TEXT("Writes the per-stage timings of recent Gemini requests to a CSV file. Usage: Gemini.DumpTimings [Path=Saved/Profiling/GeminiTimings.csv]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&DumpTimings));
+}
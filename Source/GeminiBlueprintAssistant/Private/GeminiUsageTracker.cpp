@@ -0,0 +1,411 @@
+// Private/GeminiUsageTracker.cpp
+#include "GeminiUsageTracker.h"
+#include "GeminiAssistantTrace.h"
+#include "GeminiJsonReader.h"
+#include "GeminiJsonWriter.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ConfigCacheIni.h"
+
+namespace GeminiUsageTracker
+{
+	static const int32 DefaultRetentionDays = 90;
+	static const float DefaultBudgetWarningFraction = 0.8f;
+	static const TCHAR* DefaultDowngradeProfile = TEXT("economy");
+	static const int32 FileVersion = 1;
+
+	static FString MakeRecordKey(const FString& Day, const FString& User, const FString& Source)
+	{
+		return FString::Printf(TEXT("%s|%s|%s"), *Day, *User, *Source);
+	}
+
+	// One line of the report: "     12345 tokens  (4 requests, 2100 cached = 21% of prompts, 800 out)  /Game/BP_Door.BP_Door:EventGraph"
+	static FString FormatTotalsLine(const FString& Name, const FGeminiUsageTotals& Totals)
+	{
+		const int32 CachedPercent = Totals.PromptTokens > 0 ? static_cast<int32>(Totals.CachedTokens * 100 / Totals.PromptTokens) : 0;
+		return FString::Printf(TEXT("%10lld tokens  (%d requests, %lld cached = %d%% of prompts, %lld out)  %s\n"),
+			Totals.GetTotal(), Totals.Requests, Totals.CachedTokens, CachedPercent, Totals.OutputTokens + Totals.ThoughtTokens, *Name);
+	}
+
+	// A budget of 0 is off
+	static EGeminiBudgetStatus GetStatus(int64 Used, int64 Budget, float WarningFraction)
+	{
+		if (Budget <= 0)
+		{
+			return EGeminiBudgetStatus::WithinBudget;
+		}
+		if (Used >= Budget)
+		{
+			return EGeminiBudgetStatus::Exceeded;
+		}
+		return Used >= static_cast<int64>(Budget * WarningFraction) ? EGeminiBudgetStatus::Warning : EGeminiBudgetStatus::WithinBudget;
+	}
+}
+
+void FGeminiUsageTotals::Add(const FGeminiTokenUsage& Usage)
+{
+	++Requests;
+	PromptTokens += Usage.PromptTokens;
+	CachedTokens += Usage.CachedTokens;
+	OutputTokens += Usage.OutputTokens;
+	ThoughtTokens += Usage.ThoughtTokens;
+}
+
+void FGeminiUsageTotals::Add(const FGeminiUsageTotals& Other)
+{
+	Requests += Other.Requests;
+	PromptTokens += Other.PromptTokens;
+	CachedTokens += Other.CachedTokens;
+	OutputTokens += Other.OutputTokens;
+	ThoughtTokens += Other.ThoughtTokens;
+}
+
+FGeminiUsageTracker& FGeminiUsageTracker::Get()
+{
+	static FGeminiUsageTracker Instance;
+	return Instance;
+}
+
+FGeminiUsageTracker::FGeminiUsageTracker()
+	: FilePath(FPaths::ProjectSavedDir() / TEXT("GeminiAssistant") / TEXT("Usage.json"))
+	, UserName(FPlatformProcess::UserName())
+	, RetentionDays(GeminiUsageTracker::DefaultRetentionDays)
+	, DailyTokenBudget(0)
+	, MonthlyTokenBudget(0)
+	, BlueprintDailyTokenBudget(0)
+	, BudgetWarningFraction(GeminiUsageTracker::DefaultBudgetWarningFraction)
+	, BudgetAction(EGeminiBudgetAction::Downgrade)
+	, DowngradeProfile(GeminiUsageTracker::DefaultDowngradeProfile)
+{
+	if (GConfig)
+	{
+		GConfig->GetString(TEXT("GeminiAssistant"), TEXT("UsageLogPath"), FilePath, GEditorPerProjectIni);
+		GConfig->GetInt(TEXT("GeminiAssistant"), TEXT("UsageRetentionDays"), RetentionDays, GEditorPerProjectIni);
+		GConfig->GetInt64(TEXT("GeminiAssistant"), TEXT("DailyTokenBudget"), DailyTokenBudget, GEditorPerProjectIni);
+		GConfig->GetInt64(TEXT("GeminiAssistant"), TEXT("MonthlyTokenBudget"), MonthlyTokenBudget, GEditorPerProjectIni);
+		GConfig->GetInt64(TEXT("GeminiAssistant"), TEXT("BlueprintDailyTokenBudget"), BlueprintDailyTokenBudget, GEditorPerProjectIni);
+		GConfig->GetFloat(TEXT("GeminiAssistant"), TEXT("BudgetWarningFraction"), BudgetWarningFraction, GEditorPerProjectIni);
+		GConfig->GetString(TEXT("GeminiAssistant"), TEXT("BudgetDowngradeProfile"), DowngradeProfile, GEditorPerProjectIni);
+
+		FString Action;
+		if (GConfig->GetString(TEXT("GeminiAssistant"), TEXT("BudgetExceededAction"), Action, GEditorPerProjectIni))
+		{
+			BudgetAction = Action.Equals(TEXT("Block"), ESearchCase::IgnoreCase) ? EGeminiBudgetAction::Block : EGeminiBudgetAction::Downgrade;
+		}
+	}
+	RetentionDays = FMath::Max(1, RetentionDays);
+	BudgetWarningFraction = FMath::Clamp(BudgetWarningFraction, 0.0f, 1.0f);
+	Load();
+}
+
+FString FGeminiUsageTracker::GetDayString(const FDateTime& Time)
+{
+	return Time.ToString(TEXT("%Y-%m-%d"));
+}
+
+FString FGeminiUsageTracker::MakeSource(const FString& BlueprintPath, const FString& GraphName)
+{
+	return FString::Printf(TEXT("%s:%s"), *BlueprintPath, *GraphName);
+}
+
+FString FGeminiUsageTracker::GetBlueprintOfSource(const FString& Source)
+{
+	// Paths of Level Blueprints contain ':' themselves, object names never do
+	int32 GraphSeparator = INDEX_NONE;
+	return Source.FindLastChar(TEXT(':'), GraphSeparator) ? Source.Left(GraphSeparator) : Source;
+}
+
+void FGeminiUsageTracker::Record(const FString& Source, const FGeminiTokenUsage& Usage)
+{
+	const FString Day = GetDayString(FDateTime::Now());
+	const FString SourceName = Source.IsEmpty() ? TEXT("(other)") : Source;
+	const FString Key = GeminiUsageTracker::MakeRecordKey(Day, UserName, SourceName);
+
+	int32* Index = RecordIndex.Find(Key);
+	if (!Index)
+	{
+		FGeminiUsageRecord& NewRecord = Records.AddDefaulted_GetRef();
+		NewRecord.Day = Day;
+		NewRecord.User = UserName;
+		NewRecord.Source = SourceName;
+		Index = &RecordIndex.Add(Key, Records.Num() - 1);
+	}
+	Records[*Index].Totals.Add(Usage);
+
+	UE_LOG(LogGeminiAssistant, Verbose, TEXT("GeminiUsageTracker: %s used %d prompt (%d cached), %d output, %d thought tokens"),
+		*SourceName, Usage.PromptTokens, Usage.CachedTokens, Usage.OutputTokens, Usage.ThoughtTokens);
+
+	// The log is small and requests take seconds, so writing it every time costs nothing and survives crashes
+	Save();
+}
+
+TArray<TPair<FString, FGeminiUsageTotals>> FGeminiUsageTracker::GetTop(EGeminiUsageGrouping Grouping, int32 Days, int32 MaxEntries) const
+{
+	// Days compare as strings since they are zero-padded
+	const FString FirstDay = GetDayString(FDateTime::Now() - FTimespan::FromDays(FMath::Max(1, Days) - 1));
+
+	TMap<FString, FGeminiUsageTotals> Groups;
+	for (const FGeminiUsageRecord& Record : Records)
+	{
+		if (Record.Day < FirstDay)
+		{
+			continue;
+		}
+
+		FString GroupName;
+		switch (Grouping)
+		{
+		case EGeminiUsageGrouping::Source: GroupName = Record.Source; break;
+		case EGeminiUsageGrouping::Blueprint: GroupName = GetBlueprintOfSource(Record.Source); break;
+		case EGeminiUsageGrouping::User: GroupName = Record.User; break;
+		case EGeminiUsageGrouping::Day: GroupName = Record.Day; break;
+		}
+		Groups.FindOrAdd(GroupName).Add(Record.Totals);
+	}
+
+	TArray<TPair<FString, FGeminiUsageTotals>> Result = Groups.Array();
+	Result.Sort([](const TPair<FString, FGeminiUsageTotals>& A, const TPair<FString, FGeminiUsageTotals>& B)
+	{
+		return A.Value.GetTotal() > B.Value.GetTotal();
+	});
+	if (MaxEntries > 0 && Result.Num() > MaxEntries)
+	{
+		Result.SetNum(MaxEntries);
+	}
+	return Result;
+}
+
+EGeminiBudgetStatus FGeminiUsageTracker::CheckBudget(const FString& Source, FString& OutMessage, bool& bOutFirstWarning)
+{
+	bOutFirstWarning = false;
+	OutMessage.Empty();
+
+	const FString Today = GetDayString(FDateTime::Now());
+	const FString Month = Today.Left(7);
+	const FString Blueprint = GetBlueprintOfSource(Source);
+
+	int64 UserToday = 0;
+	int64 UserMonth = 0;
+	int64 BlueprintToday = 0;
+	for (const FGeminiUsageRecord& Record : Records)
+	{
+		if (!Record.Day.StartsWith(Month))
+		{
+			continue;
+		}
+		if (Record.User == UserName)
+		{
+			UserMonth += Record.Totals.GetTotal();
+			if (Record.Day == Today)
+			{
+				UserToday += Record.Totals.GetTotal();
+			}
+		}
+		// Every user counts towards a Blueprint's budget
+		if (Record.Day == Today && !Blueprint.IsEmpty() && GetBlueprintOfSource(Record.Source) == Blueprint)
+		{
+			BlueprintToday += Record.Totals.GetTotal();
+		}
+	}
+
+	// The worst of the three budgets decides
+	EGeminiBudgetStatus Status = EGeminiBudgetStatus::WithinBudget;
+	auto Check = [this, &Status, &OutMessage](int64 Used, int64 Budget, const TCHAR* Name)
+	{
+		const EGeminiBudgetStatus BudgetStatus = GeminiUsageTracker::GetStatus(Used, Budget, BudgetWarningFraction);
+		if (BudgetStatus > Status)
+		{
+			Status = BudgetStatus;
+			OutMessage = FString::Printf(TEXT("%s: %lld of %lld tokens used"), Name, Used, Budget);
+		}
+	};
+	Check(UserToday, DailyTokenBudget, TEXT("Daily token budget"));
+	Check(UserMonth, MonthlyTokenBudget, TEXT("Monthly token budget"));
+	Check(BlueprintToday, BlueprintDailyTokenBudget, TEXT("Daily token budget of this Blueprint"));
+
+	if (Status == EGeminiBudgetStatus::Warning && WarnedDay != Today)
+	{
+		WarnedDay = Today;
+		bOutFirstWarning = true;
+	}
+	return Status;
+}
+
+FString FGeminiUsageTracker::FormatReport(int32 Days, int32 MaxEntries) const
+{
+	const FString Today = GetDayString(FDateTime::Now());
+	FGeminiUsageTotals TodayTotals;
+	FGeminiUsageTotals MonthTotals;
+	for (const FGeminiUsageRecord& Record : Records)
+	{
+		if (Record.User != UserName || !Record.Day.StartsWith(Today.Left(7)))
+		{
+			continue;
+		}
+		MonthTotals.Add(Record.Totals);
+		if (Record.Day == Today)
+		{
+			TodayTotals.Add(Record.Totals);
+		}
+	}
+
+	FString Report = FString::Printf(TEXT("Token usage of %s\n"), *UserName);
+	Report += GeminiUsageTracker::FormatTotalsLine(DailyTokenBudget > 0 ? FString::Printf(TEXT("today (budget %lld)"), DailyTokenBudget) : TEXT("today"), TodayTotals);
+	Report += GeminiUsageTracker::FormatTotalsLine(MonthlyTokenBudget > 0 ? FString::Printf(TEXT("this month (budget %lld)"), MonthlyTokenBudget) : TEXT("this month"), MonthTotals);
+
+	auto AppendSection = [this, &Report, Days, MaxEntries](const TCHAR* Title, EGeminiUsageGrouping Grouping)
+	{
+		Report += FString::Printf(TEXT("\n%s, last %d days:\n"), Title, Days);
+		const TArray<TPair<FString, FGeminiUsageTotals>> Top = GetTop(Grouping, Days, MaxEntries);
+		if (Top.Num() == 0)
+		{
+			Report += TEXT("  (none)\n");
+		}
+		for (const TPair<FString, FGeminiUsageTotals>& Entry : Top)
+		{
+			Report += GeminiUsageTracker::FormatTotalsLine(Entry.Key, Entry.Value);
+		}
+	};
+	AppendSection(TEXT("Most expensive graphs"), EGeminiUsageGrouping::Source);
+	AppendSection(TEXT("Most expensive Blueprints"), EGeminiUsageGrouping::Blueprint);
+	AppendSection(TEXT("Users"), EGeminiUsageGrouping::User);
+	return Report;
+}
+
+void FGeminiUsageTracker::Load()
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *FilePath, FILEREAD_Silent))
+	{
+		return;
+	}
+
+	// {"version":1,"records":[{"day":"2025-01-31","user":"...","source":"...","requests":1,"promptTokens":...},...]}
+	FGeminiJsonReader Reader(Data.GetData(), Data.Num());
+	const bool bParsed = Reader.Peek() == EGeminiJsonToken::Object && Reader.ReadObject([this, &Reader](const FString& Key)
+	{
+		if (Key != TEXT("records") || Reader.Peek() != EGeminiJsonToken::Array)
+		{
+			return Reader.SkipValue();
+		}
+		return Reader.ReadArray([this, &Reader](int32 Index)
+		{
+			if (Reader.Peek() != EGeminiJsonToken::Object)
+			{
+				return Reader.SkipValue();
+			}
+
+			FGeminiUsageRecord Record;
+			int64 Requests = 0;
+			const bool bRecordParsed = Reader.ReadObject([&Reader, &Record, &Requests](const FString& Field)
+			{
+				if (Field == TEXT("day") || Field == TEXT("user") || Field == TEXT("source"))
+				{
+					return Reader.ReadString(Field == TEXT("day") ? Record.Day : Field == TEXT("user") ? Record.User : Record.Source);
+				}
+				int64* Count = Field == TEXT("requests") ? &Requests
+					: Field == TEXT("promptTokens") ? &Record.Totals.PromptTokens
+					: Field == TEXT("cachedTokens") ? &Record.Totals.CachedTokens
+					: Field == TEXT("outputTokens") ? &Record.Totals.OutputTokens
+					: Field == TEXT("thoughtTokens") ? &Record.Totals.ThoughtTokens
+					: nullptr;
+				return Count ? Reader.ReadInt64(*Count) : Reader.SkipValue();
+			});
+			Record.Totals.Requests = static_cast<int32>(Requests);
+
+			const FString RecordKey = GeminiUsageTracker::MakeRecordKey(Record.Day, Record.User, Record.Source);
+			if (bRecordParsed && !Record.Day.IsEmpty() && !RecordIndex.Contains(RecordKey))
+			{
+				RecordIndex.Add(RecordKey, Records.Num());
+				Records.Add(MoveTemp(Record));
+			}
+			return bRecordParsed;
+		});
+	});
+
+	if (!bParsed)
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiUsageTracker: %s is not a valid usage log, keeping the %d records read before the error"), *FilePath, Records.Num());
+	}
+	Prune();
+}
+
+void FGeminiUsageTracker::Prune()
+{
+	const FString FirstDay = GetDayString(FDateTime::Now() - FTimespan::FromDays(RetentionDays));
+	const int32 NumRemoved = Records.RemoveAll([&FirstDay](const FGeminiUsageRecord& Record)
+	{
+		return Record.Day < FirstDay;
+	});
+	if (NumRemoved > 0)
+	{
+		RecordIndex.Reset();
+		for (int32 Index = 0; Index < Records.Num(); ++Index)
+		{
+			RecordIndex.Add(GeminiUsageTracker::MakeRecordKey(Records[Index].Day, Records[Index].User, Records[Index].Source), Index);
+		}
+	}
+}
+
+bool FGeminiUsageTracker::Save() const
+{
+	TArray<uint8> Data;
+	FGeminiJsonWriter Writer(Data);
+	Writer.BeginObject();
+	Writer.WriteIntegerField("version", GeminiUsageTracker::FileVersion);
+	Writer.WriteKey("records");
+	Writer.BeginArray();
+	for (const FGeminiUsageRecord& Record : Records)
+	{
+		Writer.BeginObject();
+		Writer.WriteStringField("day", Record.Day);
+		Writer.WriteStringField("user", Record.User);
+		Writer.WriteStringField("source", Record.Source);
+		Writer.WriteIntegerField("requests", Record.Totals.Requests);
+		Writer.WriteIntegerField("promptTokens", Record.Totals.PromptTokens);
+		Writer.WriteIntegerField("cachedTokens", Record.Totals.CachedTokens);
+		Writer.WriteIntegerField("outputTokens", Record.Totals.OutputTokens);
+		Writer.WriteIntegerField("thoughtTokens", Record.Totals.ThoughtTokens);
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+
+	if (!FFileHelper::SaveArrayToFile(Data, *FilePath))
+	{
+		UE_LOG(LogGeminiAssistant, Warning, TEXT("GeminiUsageTracker: Could not write %s"), *FilePath);
+		return false;
+	}
+	return true;
+}
+
+namespace GeminiUsageTracker
+{
+	// Gemini.Usage [Days=30] [Top=10]
+	static void PrintUsage(const TArray<FString>& Args)
+	{
+		int32 Days = 30;
+		int32 Top = 10;
+		for (const FString& Arg : Args)
+		{
+			FParse::Value(*Arg, TEXT("Days="), Days);
+			FParse::Value(*Arg, TEXT("Top="), Top);
+		}
+		Days = FMath::Max(1, Days);
+		Top = FMath::Max(1, Top);
+
+		TArray<FString> Lines;
+		FGeminiUsageTracker::Get().FormatReport(Days, Top).ParseIntoArrayLines(Lines, false);
+		for (const FString& Line : Lines)
+		{
+			UE_LOG(LogGeminiAssistant, Display, TEXT("%s"), *Line);
+		}
+	}
+
+	static FAutoConsoleCommand UsageCommand(
+		TEXT("Gemini.Usage"),
+		TEXT("Logs token usage and budgets, and the graphs, Blueprints and users that used the most tokens. Usage: Gemini.Usage [Days=30] [Top=10]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&PrintUsage));
+}
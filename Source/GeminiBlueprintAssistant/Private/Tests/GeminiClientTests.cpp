@@ -0,0 +1,311 @@
+// Private/Tests/GeminiClientTests.cpp
+#include "Misc/AutomationTest.h"
+#include "GeminiAPIClient.h"
+#include "GeminiBackend.h"
+#include "GeminiMockServer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GeminiClientTests
+{
+	// Away from the default port, so a mock server started from the console is left alone
+	static const int32 MockServerPort = 18089;
+
+	// Longest a test waits for the client before it gives up
+	static const double TimeoutSeconds = 30.0;
+
+	// Client pointed at the mock server; null if the configured backend does not speak the Gemini API the mock does
+	static TSharedPtr<FGeminiAPIClient> MakeClient(FAutomationTestBase& Test, const FGeminiMockServer& Server)
+	{
+		TSharedRef<FGeminiAPIClient> Client = MakeShared<FGeminiAPIClient>();
+		if (FCString::Strcmp(Client->GetBackend().GetName(), TEXT("Gemini")) != 0)
+		{
+			Test.AddWarning(FString::Printf(TEXT("Skipped: the mock server only speaks the Gemini API, Backend=%s is configured"), Client->GetBackend().GetName()));
+			return nullptr;
+		}
+		Client->SetEndpoint(Server.GetBaseURL(), TEXT("mock-model"));
+		Client->SetFixtureMode(EGeminiFixtureMode::Off, FString());
+		Client->SetRateLimits(0, 0);
+		return Client;
+	}
+
+	struct FStreamRun
+	{
+		double SubmitTime = 0.0;
+		double FirstChunkTime = 0.0;
+		double CompleteTime = 0.0;
+		int32 NumChunks = 0;
+		int32 NumChunksAfterComplete = 0;
+		FString StreamedText;
+		FString ResponseContent;
+		bool bSuccess = false;
+		FString ErrorMessage;
+	};
+
+	// One question of the context cache test and the requests it should cause
+	struct FCacheStep
+	{
+		FString Question;
+		FString Context;
+
+		// Cache clock skipped before the question is asked
+		double SkipSeconds = 0.0;
+
+		// Cached content the question should reference, and whether it is uploaded for it
+		FString ExpectedCache;
+		bool bExpectUpload = false;
+
+		// Cached content renewed or deleted on the way, if any
+		FString ExpectedRenewal;
+		FString ExpectedDeletion;
+	};
+
+	static int32 CountRequests(const TArray<FGeminiMockRequest>& Requests, const TCHAR* Verb, const FString& Path)
+	{
+		return Requests.FilterByPredicate([Verb, &Path](const FGeminiMockRequest& Request) { return Request.Verb == Verb && Request.Path == Path; }).Num();
+	}
+
+	static void AddCacheStep(FAutomationTestBase& Test, TSharedRef<FGeminiAPIClient> Client, TSharedRef<FGeminiMockServer> Server, const FString& ContextKey, const FCacheStep& Step)
+	{
+		TSharedRef<FStreamRun> Run = MakeShared<FStreamRun>();
+		ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([Client, Server, Run, ContextKey, Step]()
+		{
+			Server->ResetRequests();
+			Client->GetContextCache().SkipTime(Step.SkipSeconds);
+			Run->SubmitTime = FPlatformTime::Seconds();
+			Client->GenerateContentWithContext(ContextKey, Step.Context, Step.Question, TEXT("mock"), FGeminiChunkDelegate(),
+				FGeminiResponseDelegate::CreateLambda([Run](FString ResponseContent, bool bSuccess, FString ErrorMessage)
+				{
+					Run->CompleteTime = FPlatformTime::Seconds();
+					Run->bSuccess = bSuccess;
+					Run->ErrorMessage = ErrorMessage;
+				}));
+			return true;
+		}));
+
+		ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([&Test, Server, Run, Step]()
+		{
+			// Renewals and deletions are sent alongside the question and may reach the server after its answer is out
+			const TArray<FGeminiMockRequest>& Requests = Server->GetRequests();
+			const bool bSideRequestsDone = (Step.ExpectedRenewal.IsEmpty() || CountRequests(Requests, TEXT("PATCH"), Step.ExpectedRenewal) > 0)
+				&& (Step.ExpectedDeletion.IsEmpty() || CountRequests(Requests, TEXT("DELETE"), Step.ExpectedDeletion) > 0);
+			if ((Run->CompleteTime == 0.0 || !bSideRequestsDone) && FPlatformTime::Seconds() - Run->SubmitTime < TimeoutSeconds)
+			{
+				return false;
+			}
+
+			const FString What = FString::Printf(TEXT("'%s':"), *Step.Question);
+			if (!Test.TestTrue(FString::Printf(TEXT("%s answered (%s)"), *What, *Run->ErrorMessage), Run->CompleteTime > 0.0 && Run->bSuccess))
+			{
+				return true;
+			}
+
+			const TArray<FGeminiMockRequest> Uploads = Requests.FilterByPredicate([](const FGeminiMockRequest& Request) { return Request.Verb == TEXT("POST") && Request.Path == TEXT("cachedContents"); });
+			Test.TestEqual(FString::Printf(TEXT("%s context uploads"), *What), Uploads.Num(), Step.bExpectUpload ? 1 : 0);
+			if (Uploads.Num() == 1)
+			{
+				Test.TestTrue(FString::Printf(TEXT("%s upload carries the context"), *What), Uploads[0].GetBodyString().Contains(Step.Context));
+			}
+			if (!Step.ExpectedRenewal.IsEmpty())
+			{
+				Test.TestEqual(FString::Printf(TEXT("%s renewals of %s"), *What, *Step.ExpectedRenewal), CountRequests(Requests, TEXT("PATCH"), Step.ExpectedRenewal), 1);
+			}
+			if (!Step.ExpectedDeletion.IsEmpty())
+			{
+				Test.TestEqual(FString::Printf(TEXT("%s deletions of %s"), *What, *Step.ExpectedDeletion), CountRequests(Requests, TEXT("DELETE"), Step.ExpectedDeletion), 1);
+			}
+
+			const TArray<FGeminiMockRequest> Questions = Requests.FilterByPredicate([](const FGeminiMockRequest& Request) { return Request.Path.EndsWith(TEXT(":generateContent")); });
+			if (!Test.TestEqual(FString::Printf(TEXT("%s generate requests"), *What), Questions.Num(), 1))
+			{
+				return true;
+			}
+			const FString Body = Questions[0].GetBodyString();
+			Test.TestTrue(FString::Printf(TEXT("%s request references %s"), *What, *Step.ExpectedCache),
+				Body.Contains(TEXT("\"cachedContent\"")) && Body.Contains(FString::Printf(TEXT("\"%s\""), *Step.ExpectedCache)));
+			Test.TestTrue(FString::Printf(TEXT("%s request carries the question"), *What), Body.Contains(Step.Question));
+			Test.TestFalse(FString::Printf(TEXT("%s request carries the context again"), *What), Body.Contains(Step.Context));
+			return true;
+		}));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGeminiClientStreamTest, "GeminiAssistant.Client.StreamsTextBeforeCompletion",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FGeminiClientStreamTest::RunTest(const FString& Parameters)
+{
+	using namespace GeminiClientTests;
+
+	FGeminiMockServerSettings Settings;
+	Settings.Port = MockServerPort;
+	Settings.LatencyMs = 100.0f;
+	Settings.JitterMs = 0.0f;
+	Settings.StreamChunks = 8;
+	Settings.StreamIntervalMs = 100.0f;
+	TSharedRef<FGeminiMockServer> Server = MakeShared<FGeminiMockServer>();
+	if (!TestTrue(TEXT("Mock server started"), Server->Start(Settings)))
+	{
+		return false;
+	}
+	TSharedPtr<FGeminiAPIClient> Client = MakeClient(*this, *Server);
+	if (!Client.IsValid())
+	{
+		Server->Stop();
+		return true;
+	}
+
+	TSharedRef<FStreamRun> Run = MakeShared<FStreamRun>();
+	Run->SubmitTime = FPlatformTime::Seconds();
+	Client->GenerateContentStream(TEXT("Describe the graph."), TEXT("mock"),
+		FGeminiChunkDelegate::CreateLambda([Run](FString ChunkText)
+		{
+			if (Run->CompleteTime > 0.0)
+			{
+				++Run->NumChunksAfterComplete;
+				return;
+			}
+			if (Run->NumChunks++ == 0)
+			{
+				Run->FirstChunkTime = FPlatformTime::Seconds();
+			}
+			Run->StreamedText += ChunkText;
+		}),
+		FGeminiResponseDelegate::CreateLambda([Run](FString ResponseContent, bool bSuccess, FString ErrorMessage)
+		{
+			Run->CompleteTime = FPlatformTime::Seconds();
+			Run->ResponseContent = ResponseContent;
+			Run->bSuccess = bSuccess;
+			Run->ErrorMessage = ErrorMessage;
+		}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Server, Client, Run, Settings]()
+	{
+		if (Run->CompleteTime == 0.0 && FPlatformTime::Seconds() - Run->SubmitTime < TimeoutSeconds)
+		{
+			return false;
+		}
+		Server->Stop();
+
+		if (!TestTrue(TEXT("Request completed"), Run->CompleteTime > 0.0) || !TestTrue(FString::Printf(TEXT("Request succeeded (%s)"), *Run->ErrorMessage), Run->bSuccess))
+		{
+			return true;
+		}
+		TestTrue(FString::Printf(TEXT("Answer arrived in several chunks (%d)"), Run->NumChunks), Run->NumChunks > 1);
+		TestTrue(TEXT("First chunk arrived before completion"), Run->FirstChunkTime > 0.0 && Run->FirstChunkTime < Run->CompleteTime);
+		TestEqual(TEXT("Chunks after completion"), Run->NumChunksAfterComplete, 0);
+		TestEqual(TEXT("Streamed text adds up to the answer"), Run->StreamedText, Run->ResponseContent);
+
+		// The events go out StreamIntervalMs apart, so text that only shows at the end is far behind the first event
+		const double TimeToFirstText = Run->FirstChunkTime - Run->SubmitTime;
+		const double TotalTime = Run->CompleteTime - Run->SubmitTime;
+		const double StreamSpread = (Settings.StreamChunks - 1) * Settings.StreamIntervalMs / 1000.0;
+		TestTrue(FString::Printf(TEXT("Time to first text (%.0f ms) is well below the total time (%.0f ms)"), TimeToFirstText * 1000.0, TotalTime * 1000.0),
+			TimeToFirstText < TotalTime - StreamSpread * 0.5);
+		return true;
+	}));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGeminiClientContextCacheTest, "GeminiAssistant.Client.ContextCacheLifecycle",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FGeminiClientContextCacheTest::RunTest(const FString& Parameters)
+{
+	using namespace GeminiClientTests;
+
+	FGeminiMockServerSettings Settings;
+	Settings.Port = MockServerPort;
+	Settings.LatencyMs = 20.0f;
+	Settings.JitterMs = 0.0f;
+	Settings.bRecordRequests = true;
+	TSharedRef<FGeminiMockServer> Server = MakeShared<FGeminiMockServer>();
+	if (!TestTrue(TEXT("Mock server started"), Server->Start(Settings)))
+	{
+		return false;
+	}
+	TSharedPtr<FGeminiAPIClient> Client = MakeClient(*this, *Server);
+	if (!Client.IsValid())
+	{
+		Server->Stop();
+		return true;
+	}
+
+	// Whatever the project's settings, every context is cached, for the TTL the steps below are timed against
+	const double TTLSeconds = 600.0;
+	Client->SetUseContextCache(true);
+	Client->GetContextCache().Configure(Server->GetBaseURL(), TEXT("mock-model"), TTLSeconds, 0);
+
+	// Distinct text the question requests must not contain once the graph is cached
+	auto MakeContext = [](const TCHAR* Marker)
+	{
+		FString Context;
+		for (int32 Index = 0; Index < 200; ++Index)
+		{
+			Context += FString::Printf(TEXT("%s node %d calls node %d. "), Marker, Index, Index + 1);
+		}
+		return Context;
+	};
+	const FString GraphContext = MakeContext(TEXT("EventGraph"));
+	const FString ChangedGraphContext = MakeContext(TEXT("ChangedEventGraph"));
+	const FString ContextKey = TEXT("/Game/Test/BP_Test:EventGraph");
+
+	TArray<FCacheStep> Steps;
+
+	// First question uploads the graph
+	FCacheStep& Create = Steps.AddDefaulted_GetRef();
+	Create.Question = TEXT("What does this graph do?");
+	Create.Context = GraphContext;
+	Create.ExpectedCache = TEXT("cachedContents/mock-1");
+	Create.bExpectUpload = true;
+
+	// A follow-up only sends the question
+	FCacheStep& Reuse = Steps.AddDefaulted_GetRef();
+	Reuse.Question = TEXT("Which node runs first?");
+	Reuse.Context = GraphContext;
+	Reuse.ExpectedCache = TEXT("cachedContents/mock-1");
+
+	// Close to the end of the TTL, using the entry renews it
+	FCacheStep& Renew = Steps.AddDefaulted_GetRef();
+	Renew.Question = TEXT("Where is the loop?");
+	Renew.Context = GraphContext;
+	Renew.SkipSeconds = TTLSeconds * 0.8;
+	Renew.ExpectedCache = TEXT("cachedContents/mock-1");
+	Renew.ExpectedRenewal = TEXT("cachedContents/mock-1");
+
+	// Past the original TTL the renewed entry is still in use
+	FCacheStep& Renewed = Steps.AddDefaulted_GetRef();
+	Renewed.Question = TEXT("What does the loop change?");
+	Renewed.Context = GraphContext;
+	Renewed.SkipSeconds = TTLSeconds * 0.5;
+	Renewed.ExpectedCache = TEXT("cachedContents/mock-1");
+
+	// An entry left unused past its TTL is gone on the server and uploaded again
+	FCacheStep& Expired = Steps.AddDefaulted_GetRef();
+	Expired.Question = TEXT("Is anything left unconnected?");
+	Expired.Context = GraphContext;
+	Expired.SkipSeconds = TTLSeconds * 2.0;
+	Expired.ExpectedCache = TEXT("cachedContents/mock-2");
+	Expired.bExpectUpload = true;
+
+	// A changed graph replaces the entry of its owner
+	FCacheStep& Changed = Steps.AddDefaulted_GetRef();
+	Changed.Question = TEXT("What changed?");
+	Changed.Context = ChangedGraphContext;
+	Changed.ExpectedCache = TEXT("cachedContents/mock-3");
+	Changed.bExpectUpload = true;
+	Changed.ExpectedDeletion = TEXT("cachedContents/mock-2");
+
+	for (const FCacheStep& Step : Steps)
+	{
+		AddCacheStep(*this, Client.ToSharedRef(), Server, ContextKey, Step);
+	}
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([Server, Client]()
+	{
+		Server->Stop();
+		return true;
+	}));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
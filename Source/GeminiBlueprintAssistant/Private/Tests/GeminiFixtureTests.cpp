@@ -0,0 +1,235 @@
+// Private/Tests/GeminiFixtureTests.cpp
+#include "Misc/AutomationTest.h"
+#include "GeminiAPIClient.h"
+#include "GeminiAssistantPanel.h"
+#include "GeminiBackend.h"
+#include "GeminiFixtures.h"
+#include "GeminiResponseView.h"
+#include "GeminiSummarySchema.h"
+#include "GeminiSummaryStore.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraphNode_Comment.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "GameFramework/Actor.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GeminiFixtureTests
+{
+	// Longest a replayed answer may take; replays without recorded latency arrive on the next tick
+	static const double TimeoutSeconds = 10.0;
+
+	// One fixture on its way through the client and the panel's display
+	struct FReplay
+	{
+		FString Key;
+		double StartTime = 0.0;
+		FGeminiPanelJob Job;
+		FString StreamProblem;
+		bool bComplete = false;
+		bool bSuccess = false;
+		FString ResponseContent;
+		FString ErrorMessage;
+	};
+
+	struct FReplayRun
+	{
+		TArray<FString> Keys;
+		int32 Index = -1;
+		int32 NumReplayed = 0;
+		int32 NumFailed = 0;
+		int32 NumSkipped = 0;
+		TSharedPtr<FReplay> Current;
+	};
+
+	// Recorded answers committed with the plugin, so the test has something to replay on every checkout
+	static FString GetCorpusDirectory()
+	{
+		TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("GeminiBlueprintAssistant"));
+		return Plugin.IsValid() ? Plugin->GetBaseDir() / TEXT("Resources") / TEXT("Fixtures") : FString();
+	}
+
+	// Shows a streamed chunk through the panel's own handling, as for the job of the tab on display
+	static void ShowChunk(FReplay& Replay, SGeminiResponseView& View, const FString& ChunkText)
+	{
+		GeminiAssistantPanel::AddStreamedChunk(Replay.Job, ChunkText, &View);
+		if (Replay.StreamProblem.IsEmpty() && (View.GetText() != Replay.Job.DisplayText || Replay.Job.DisplayText != Replay.Job.StreamingDetails.GetDetails()))
+		{
+			Replay.StreamProblem = TEXT("the streamed text shown differs from the details received");
+		}
+	}
+
+	// Takes a completed replay through the panel's parse, display and store steps; returns why the panel could not
+	// show it, or an empty string if it could
+	static FString CheckAnswer(const FReplay& Replay, SGeminiResponseView& View, FGeminiSummaryStore& Store, UEdGraph* Graph, const TArray<UEdGraphNode*>& Nodes)
+	{
+		if (!Replay.bSuccess)
+		{
+			return FString::Printf(TEXT("the request failed: %s"), *Replay.ErrorMessage);
+		}
+		if (!Replay.StreamProblem.IsEmpty())
+		{
+			return Replay.StreamProblem;
+		}
+
+		const LLMResponseParts Parts = GeminiAssistantPanel::ParseLLMResponse(Replay.ResponseContent);
+		if (Parts.Details.IsEmpty())
+		{
+			return TEXT("the answer has no text to show");
+		}
+		if (Parts.Details.StartsWith(TEXT("{")))
+		{
+			return TEXT("the answer does not follow the summary schema, the panel would show the raw JSON");
+		}
+
+		View.SetText(Parts.Details);
+		if (View.GetText() != Parts.Details)
+		{
+			return TEXT("the response view does not show the details");
+		}
+
+		Store.Put(Graph, Nodes, FGeminiSummaryStore::MakeContentHash(Graph, Nodes), Parts.Summary, Parts.Details);
+		FGeminiStoredSummary Stored;
+		if (!Store.Find(Graph, Nodes, Stored))
+		{
+			return TEXT("the summary could not be stored");
+		}
+		if (Stored.Summary != Parts.Summary || Stored.Details != Parts.Details)
+		{
+			return TEXT("the stored summary differs from the answer");
+		}
+		return FString();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGeminiFixtureReplayTest, "GeminiAssistant.Fixtures.ReplayThroughPanel",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FGeminiFixtureReplayTest::RunTest(const FString& Parameters)
+{
+	using namespace GeminiFixtureTests;
+
+	const FString Directory = GetCorpusDirectory();
+	TSharedRef<FGeminiFixtureStore> Fixtures = MakeShared<FGeminiFixtureStore>(Directory);
+
+	TSharedRef<FReplayRun> Run = MakeShared<FReplayRun>();
+	Run->Keys = Fixtures->FindAllKeys();
+	if (Run->Keys.Num() == 0)
+	{
+		AddError(FString::Printf(TEXT("No fixtures in %s"), *Directory));
+		return false;
+	}
+
+	TSharedRef<FGeminiAPIClient> Client = MakeShared<FGeminiAPIClient>();
+	Client->SetFixtureMode(EGeminiFixtureMode::Replay, Directory);
+	Client->SetRateLimits(0, 0);
+	Client->SetCoalesceRequests(false);
+
+	// Summaries are stored for a throwaway Blueprint, as the panel stores them for the graph a question was about
+	UBlueprint* Blueprint = FKismetEditorUtilities::CreateBlueprint(AActor::StaticClass(), GetTransientPackage(),
+		MakeUniqueObjectName(GetTransientPackage(), UBlueprint::StaticClass(), TEXT("BP_GeminiFixtureReplay")), BPTYPE_Normal,
+		UBlueprint::StaticClass(), UBlueprintGeneratedClass::StaticClass());
+	UEdGraph* Graph = Blueprint ? FBlueprintEditorUtils::FindEventGraph(Blueprint) : nullptr;
+	if (!TestNotNull(TEXT("Event graph of the test Blueprint"), Graph))
+	{
+		return false;
+	}
+	Blueprint->AddToRoot();
+	if (Graph->Nodes.Num() == 0)
+	{
+		FGraphNodeCreator<UEdGraphNode_Comment> NodeCreator(*Graph);
+		NodeCreator.CreateNode(false);
+		NodeCreator.Finalize();
+	}
+	const TArray<UEdGraphNode*> Nodes = Graph->Nodes;
+
+	TSharedRef<SGeminiResponseView> View = SNew(SGeminiResponseView);
+
+	// The editor's own summaries are left alone
+	const FString StorePath = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("GeminiFixtureReplay"), TEXT(".db"));
+	TSharedRef<FGeminiSummaryStore> Store = MakeShared<FGeminiSummaryStore>(StorePath);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Client, Fixtures, Run, View, Store, StorePath, Blueprint, Graph, Nodes]()
+	{
+		if (Run->Current.IsValid())
+		{
+			const FReplay& Replay = *Run->Current;
+			if (!Replay.bComplete && FPlatformTime::Seconds() - Replay.StartTime < TimeoutSeconds)
+			{
+				return false;
+			}
+
+			const FString Problem = Replay.bComplete ? CheckAnswer(Replay, *View, *Store, Graph, Nodes) : FString(TEXT("no answer"));
+			if (!Problem.IsEmpty())
+			{
+				AddError(FString::Printf(TEXT("Fixture %s: %s"), *Replay.Key, *Problem));
+				++Run->NumFailed;
+			}
+			++Run->NumReplayed;
+			Run->Current.Reset();
+		}
+
+		while (++Run->Index < Run->Keys.Num())
+		{
+			const FString& Key = Run->Keys[Run->Index];
+			FGeminiFixture Fixture;
+			if (!Fixtures->Load(Key, Fixture))
+			{
+				AddError(FString::Printf(TEXT("Fixture %s could not be read"), *Key));
+				++Run->NumFailed;
+				continue;
+			}
+			if (Fixture.Backend != Client->GetBackend().GetName())
+			{
+				++Run->NumSkipped;
+				continue;
+			}
+
+			// Each job starts out with a placeholder that the first chunk or the answer replaces
+			TSharedRef<FReplay> Replay = MakeShared<FReplay>();
+			Replay->Key = Key;
+			Replay->StartTime = FPlatformTime::Seconds();
+			Replay->Job.DisplayText = TEXT("Summarizing...");
+			Run->Current = Replay;
+			View->SetText(Replay->Job.DisplayText);
+			Client->ResendRecordedRequest(Fixture, TEXT("replay"),
+				FGeminiChunkDelegate::CreateLambda([Replay, View](FString ChunkText)
+				{
+					ShowChunk(*Replay, *View, ChunkText);
+				}),
+				FGeminiResponseDelegate::CreateLambda([Replay](FString ResponseContent, bool bSuccess, FString ErrorMessage)
+				{
+					Replay->bComplete = true;
+					Replay->bSuccess = bSuccess;
+					Replay->ResponseContent = ResponseContent;
+					Replay->ErrorMessage = ErrorMessage;
+				}));
+			return false;
+		}
+
+		if (Run->NumReplayed == 0)
+		{
+			AddWarning(FString::Printf(TEXT("Skipped: the fixtures in %s were recorded with another backend than %s"), *Fixtures->GetDirectory(), Client->GetBackend().GetName()));
+		}
+		else if (Run->NumSkipped > 0)
+		{
+			AddWarning(FString::Printf(TEXT("%d fixtures were recorded with another backend than %s and not replayed"), Run->NumSkipped, Client->GetBackend().GetName()));
+		}
+		AddInfo(FString::Printf(TEXT("%d of %d fixtures in %s replayed through the panel"), Run->NumReplayed - Run->NumFailed, Run->NumReplayed, *Fixtures->GetDirectory()));
+
+		Store->Shutdown();
+		IFileManager::Get().Delete(*StorePath, false, false, true);
+		Blueprint->RemoveFromRoot();
+		Blueprint->MarkAsGarbage();
+		return true;
+	}));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
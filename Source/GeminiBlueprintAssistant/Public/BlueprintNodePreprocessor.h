@@ -48,6 +48,9 @@ public:
     // Process single node
     FProcessedNodeData ProcessSingleNode(UK2Node* Node);
 
+    // One node in the output format, without its number
+    FString FormatNodeLine(const FProcessedNodeData& NodeData) const;
+
 private:
     // Node type extractors
     FProcessedNodeData ExtractEventNode(class UK2Node_Event* EventNode);
@@ -3,30 +3,367 @@
 #include "CoreMinimal.h"
 #include "Interfaces/IHttpRequest.h" // For FHttpRequestRef
 #include "Interfaces/IHttpResponse.h" // For FHttpResponsePtr
+#include "Containers/Ticker.h" // For FTSTicker
+#include "GeminiRateLimiter.h"
+#include "GeminiBatch.h"
+#include "GeminiContextCache.h"
+#include "GeminiFixtures.h"
 
 // Declare a delegate for when the Gemini request is complete
-// FString response content, bool success, FString error message
+// FString response content, bool success, FString error message (on success, a note that the answer was cut off)
 DECLARE_DELEGATE_ThreeParams(FGeminiResponseDelegate, FString /* ResponseContent */, bool /* bSuccess */, FString /* ErrorMessage */);
 
+// Declare a delegate fired for every text chunk of a streamed response
+DECLARE_DELEGATE_OneParam(FGeminiChunkDelegate, FString /* ChunkText */);
+
+// Order in which queued requests are dispatched once a concurrency slot frees up
+enum class EGeminiRequestPriority : uint8
+{
+	Low,
+	Normal,
+	High
+};
+
+// How a failed request is treated by the retry logic
+enum class EGeminiErrorKind : uint8
+{
+	None,
+	// Rate limits, server overload and dropped connections; worth retrying after a delay
+	Transient,
+	// Bad requests, authentication and unusable answers; a retry would fail the same way
+	Permanent
+};
+
+/**
+ * Identifies a single request submitted to FGeminiAPIClient.
+ */
+struct FGeminiRequestHandle
+{
+	FGeminiRequestHandle()
+		: Id(0)
+	{
+	}
+
+	explicit FGeminiRequestHandle(uint64 InId)
+		: Id(InId)
+	{
+	}
+
+	bool IsValid() const { return Id != 0; }
+	void Invalidate() { Id = 0; }
+
+	bool operator==(const FGeminiRequestHandle& Other) const { return Id == Other.Id; }
+	bool operator!=(const FGeminiRequestHandle& Other) const { return Id != Other.Id; }
+
+	friend uint32 GetTypeHash(const FGeminiRequestHandle& Handle) { return ::GetTypeHash(Handle.Id); }
+
+	uint64 Id;
+};
+
+/**
+ * Sampling settings sent as generationConfig; unset fields keep the model's defaults.
+ */
+struct FGeminiGenerationConfig
+{
+	// Upper bound on the answer length; 0 leaves it to the model
+	int32 MaxOutputTokens = 0;
+
+	// Tokens the model may spend thinking before it answers; 0 disables thinking, -1 leaves it to the model
+	int32 ThinkingBudget = -1;
+
+	// Sampling temperature; negative leaves it to the model
+	float Temperature = -1.0f;
+
+	// Structured output: MIME type of the answer, e.g. "application/json", and the schema it must follow as raw JSON
+	FString ResponseMimeType;
+	FString ResponseSchema;
+
+	bool IsSet() const { return MaxOutputTokens > 0 || ThinkingBudget >= 0 || Temperature >= 0.0f || !ResponseMimeType.IsEmpty(); }
+};
+
+/**
+ * One earlier message of a conversation, sent ahead of the prompt.
+ */
+struct FGeminiChatTurn
+{
+	// False for the user's messages, true for the model's answers
+	bool bFromModel = false;
+	FString Text;
+};
+
+/**
+ * Per-request settings for FGeminiAPIClient.
+ */
+struct FGeminiRequestOptions
+{
+	// Dispatch priority while the request waits for a free concurrency slot
+	EGeminiRequestPriority Priority = EGeminiRequestPriority::Normal;
+
+	// Seconds from submission (queueing and retries included) after which the request is abandoned; 0 uses the configured default
+	float TimeoutSeconds = 0.0f;
+
+	// "Latest wins": submitting a request with the same non-empty key cancels the previous one and drops its answer
+	FString SupersessionKey;
+
+	// Model to send the request to, e.g. as chosen by FGeminiModelRouter; empty uses the configured model
+	FString Model;
+
+	FGeminiGenerationConfig GenerationConfig;
+
+	// Earlier turns of the conversation the prompt continues, oldest first
+	TArray<FGeminiChatTurn> History;
+
+	// What the request is about, as made by FGeminiUsageTracker::MakeSource; its token usage is recorded under this name
+	FString UsageSource;
+};
+
+class FGeminiStreamState;
+struct FGeminiPendingRequest;
+struct FGeminiRequestResult;
+struct FGeminiBatchRun;
+class FGeminiJsonWriter;
+class IGeminiBackend;
+struct FGeminiBackendLimits;
+
 /**
  * C++ class to handle communication with the Google Gemini API.
+ * One instance is shared by every tool in the plugin: each call returns its own handle and completion callback,
+ * and at most MaxConcurrentRequests are in flight while the rest wait in a priority queue. Game thread only.
+ * Dispatch is throttled by a requests/tokens per minute budget and transient failures are retried with backoff.
+ * A request identical to one still pending is not sent again; its caller waits for the same answer, within the
+ * deadline of the first request.
  */
 class GEMINIBLUEPRINTASSISTANT_API FGeminiAPIClient : public TSharedFromThis<FGeminiAPIClient>
 {
 public:
 	// Constructor
 	FGeminiAPIClient();
+	~FGeminiAPIClient();
+
+	// Function to send a text prompt to Gemini; OnComplete fires once for this request only
+	FGeminiRequestHandle GenerateContent(const FString& InPrompt, const FString& APIKey, FGeminiResponseDelegate OnComplete, const FGeminiRequestOptions& Options = FGeminiRequestOptions());
+
+	// Function to send a text prompt to Gemini and receive the answer incrementally over server-sent events.
+	// OnChunk fires for every piece of text, OnComplete then delivers the full answer.
+	FGeminiRequestHandle GenerateContentStream(const FString& InPrompt, const FString& APIKey, FGeminiChunkDelegate OnChunk, FGeminiResponseDelegate OnComplete, const FGeminiRequestOptions& Options = FGeminiRequestOptions());
+
+	// Sends many independent tasks packed into as few requests as the batching limits allow; OnComplete fires once
+	// with one result per task. The output cap in Options is per task. Returns the handles of the requests that were queued.
+	TArray<FGeminiRequestHandle> GenerateContentBatch(const TArray<FGeminiBatchTask>& Tasks, const FString& APIKey, FGeminiBatchDelegate OnComplete, const FGeminiRequestOptions& Options = FGeminiRequestOptions());
+
+	// Submits the tasks as an offline job on the Gemini Batch API and polls until it is done; for very large runs
+	// where a lower price matters more than latency. The handle can be cancelled like any other request.
+	FGeminiRequestHandle SubmitBatchJob(const TArray<FGeminiBatchTask>& Tasks, const FString& APIKey, FGeminiBatchDelegate OnComplete);
+
+	// Asks a question about a large context (e.g. a preprocessed graph) that is uploaded once as cached content and only
+	// referenced by follow-up questions with the same context. ContextKey names what the context describes, so a changed
+	// context replaces its old cache entry. Streams when OnChunk is bound; falls back to sending the context inline.
+	FGeminiRequestHandle GenerateContentWithContext(const FString& ContextKey, const FString& Context, const FString& Question, const FString& APIKey,
+		FGeminiChunkDelegate OnChunk, FGeminiResponseDelegate OnComplete, const FGeminiRequestOptions& Options = FGeminiRequestOptions());
+
+	// Sends a recorded request again with exactly the body it had, streamed if it was, e.g. to replay a fixture corpus
+	// through the whole pipeline. Fixtures recorded with another backend are rejected with an invalid handle.
+	FGeminiRequestHandle ResendRecordedRequest(const FGeminiFixture& Fixture, const FString& APIKey, FGeminiChunkDelegate OnChunk, FGeminiResponseDelegate OnComplete);
+
+	// Opens a connection to the API ahead of the first real request so it does not pay for DNS and TLS setup
+	void PrewarmConnection(const FString& APIKey);
+
+	// Changes how many requests may be in flight at once; queued requests start right away if slots open up
+	void SetMaxConcurrentRequests(int32 InMaxConcurrentRequests);
+	int32 GetMaxConcurrentRequests() const { return MaxConcurrentRequests; }
+
+	int32 GetNumActiveRequests() const { return ActiveRequests.Num(); }
+	int32 GetNumQueuedRequests() const { return QueuedRequests.Num() + DelayedRequests.Num() + AwaitingContextRequests.Num(); }
+
+	// True while the request is queued or in flight
+	bool IsRequestPending(FGeminiRequestHandle Handle) const;
+
+	// True once the request has been sent and until its answer is in, i.e. not while it waits in the queue
+	bool IsRequestInFlight(FGeminiRequestHandle Handle) const;
+
+	// Stops a queued or in-flight request; none of its callbacks fire afterwards
+	bool CancelRequest(FGeminiRequestHandle Handle);
 
-	// Function to send a text prompt to Gemini
-	void GenerateContent(const FString& InPrompt, const FString& APIKey);
+	// Cancels every pending request submitted with the given supersession key, returns how many were cancelled
+	int32 CancelRequestsWithKey(const FString& SupersessionKey);
 
-	// Delegate to be called when the Gemini response is received
-	FGeminiResponseDelegate OnGeminiResponseReceived;
+	// Decides whether a failed request is worth retrying
+	static EGeminiErrorKind ClassifyFailure(bool bConnectedSuccessfully, int32 ResponseCode);
+
+	// Writes the generateContent request body for a prompt as UTF-8 JSON, optionally referencing cached content
+	// and continuing a conversation
+	static void WriteGenerateContentBody(const FString& InPrompt, TArray<uint8>& OutBody, const FString& CachedContent = FString(),
+		const FGeminiGenerationConfig& GenerationConfig = FGeminiGenerationConfig(), TArrayView<const FGeminiChatTurn> History = TArrayView<const FGeminiChatTurn>());
+
+	// Writes the GenerateContentRequest object for a prompt, e.g. as one entry of a batch job
+	static void WriteGenerateContentRequest(FGeminiJsonWriter& Writer, const FString& InPrompt, const FString& CachedContent = FString(),
+		const FGeminiGenerationConfig& GenerationConfig = FGeminiGenerationConfig(), TArrayView<const FGeminiChatTurn> History = TArrayView<const FGeminiChatTurn>());
+
+	// Endpoint requests are sent to; configurable so the client can be pointed at a local stand-in server
+	const FString& GetAPIBaseURL() const { return APIBaseURL; }
+	const FString& GetModelName() const { return ModelName; }
+
+	// URL of the given model, or of the configured one if InModelName is empty
+	FString GetModelURL(const FString& InModelName = FString()) const;
+	void SetEndpoint(const FString& InAPIBaseURL, const FString& InModelName);
+
+	// Overrides the configured requests/tokens per minute quota; zero disables the respective limit
+	void SetRateLimits(int32 RequestsPerMinute, int32 TokensPerMinute);
+
+	// Server requests are sent to, chosen by the Backend setting, and what it can take
+	const IGeminiBackend& GetBackend() const { return *Backend; }
+	const FGeminiBackendLimits& GetBackendLimits() const;
+
+	// Whether a request identical to one still pending shares its answer instead of being sent again
+	void SetCoalesceRequests(bool bInCoalesceRequests) { bCoalesceRequests = bInCoalesceRequests; }
+
+	// Whether GenerateContentWithContext uploads contexts as cached content; only takes effect if the backend supports it
+	void SetUseContextCache(bool bInUseContextCache);
+	FGeminiContextCache& GetContextCache() { return *ContextCache; }
+
+	// Records responses into, or answers requests from, the fixtures in Directory; bReplayWithLatency keeps the
+	// recorded response times, otherwise replayed answers arrive on the next tick. Contexts are sent inline while
+	// fixtures are in use, since cached content names differ between runs.
+	void SetFixtureMode(EGeminiFixtureMode InMode, const FString& Directory, bool bInReplayWithLatency = false);
+	EGeminiFixtureMode GetFixtureMode() const { return FixtureMode; }
+
+	// Gzip-compresses a request body; returns false if compression failed or did not make it smaller
+	static bool CompressBody(const TArray<uint8>& Body, TArray<uint8>& OutCompressed);
 
 private:
-	// Callback for when the HTTP request completes
-	void OnRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully);
+	// Validates the request, assigns its handle unless it already has one and queues it; bSupersede cancels earlier requests with the same key
+	FGeminiRequestHandle EnqueueRequest(TSharedRef<FGeminiPendingRequest> PendingRequest, bool bSupersede = true);
+
+	// Queues one request for the given tasks of a batch run, packed into one prompt if there are several
+	FGeminiRequestHandle SubmitBatchGroup(TSharedRef<FGeminiBatchRun> Run, const TArray<int32>& TaskIndices, const FString& APIKey, const FGeminiRequestOptions& Options);
+	void OnBatchGroupComplete(FString ResponseContent, bool bSuccess, FString ErrorMessage, TSharedRef<FGeminiBatchRun> Run, TArray<int32> TaskIndices, FString APIKey, FGeminiRequestOptions Options);
+
+	// Attaches the request as a waiter to a pending request asking exactly the same, or registers it as the one
+	// later identical requests attach to; true if it was attached and must not be queued
+	bool AttachToIdenticalRequest(TSharedRef<FGeminiPendingRequest> PendingRequest);
+
+	// Cancels a caller sharing a coalesced request without stopping the request for the others; false if the
+	// handle does not share a request with anyone
+	bool DetachCoalescedCaller(FGeminiRequestHandle Handle);
+
+	// Stops later identical requests from attaching to this one
+	void ReleaseCoalescingKey(FGeminiPendingRequest& PendingRequest);
+
+	// Delivers the outcome of a request to its caller and every waiter attached to it
+	void CompleteRequest(TSharedRef<FGeminiPendingRequest> PendingRequest, const FString& Content, bool bSuccess, const FString& ErrorMessage);
+
+	// Queues a request parked by GenerateContentWithContext once its context is cached (or could not be)
+	void OnContextReady(const FString& CachedContentName, uint64 RequestId);
+
+	// Starts queued requests in priority order while concurrency slots and rate limit budget are free
+	void PumpQueue();
+
+	// Makes sure PumpQueue runs again after the given delay (rate limit refill or retry backoff)
+	void SchedulePump(double Delay);
+	bool OnPumpTicker(float DeltaTime);
+
+	// Removes a request from the queue, the backoff list or the in-flight set and aborts its HTTP request
+	bool RemovePendingRequest(FGeminiRequestHandle Handle, TSharedPtr<FGeminiPendingRequest>& OutRemoved);
+
+	// Reports every request past its deadline as timed out; returns the earliest deadline still ahead
+	double ExpireTimedOutRequests(double Now);
+
+	// Puts a transiently failed request aside until its backoff has elapsed
+	void ScheduleRetry(TSharedRef<FGeminiPendingRequest> PendingRequest, double RetryAfterSeconds, int32 ResponseCode);
+
+	// Reads the server's suggested delay from the Retry-After header or Gemini's RetryInfo, -1 if none
+	static double GetRetryAfterSeconds(const FString& RetryAfterHeader, const FString& ErrorBody);
+
+	// Builds and sends the HTTP request for a dequeued request
+	void StartRequest(TSharedRef<FGeminiPendingRequest> PendingRequest);
+
+	// Creates a POST request carrying the prompt as a generateContent body
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateGenerateRequest(const FString& Url, const FGeminiPendingRequest& PendingRequest) const;
+
+	// Writes the body of the request to send, as the backend wants it
+	void WriteRequestBody(const FGeminiPendingRequest& PendingRequest, TArray<uint8>& OutBody) const;
+
+	// Answers a dequeued request from its fixture instead of the server
+	void ReplayFixture(TSharedRef<FGeminiPendingRequest> PendingRequest);
+	void FinishReplay(uint64 RequestId, bool bFound, const FGeminiFixture& Fixture);
+
+	// Stores the response of a request that was sent while recording
+	void RecordFixture(const FGeminiPendingRequest& PendingRequest, int32 ResponseCode, const TArray<uint8>& ResponseBody) const;
+
+	// Callback for when the HTTP request completes; plain responses are handed to a worker thread for parsing
+	void OnRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully, uint64 RequestId);
+
+	// Retries or reports the outcome of a request once its response has been parsed (game thread)
+	void FinishRequest(uint64 RequestId, const FGeminiRequestResult& Result);
+
+	// Turns the HTTP result of a finished stream into the final response
+	static void CompleteStreamedRequest(FGeminiStreamState& Stream, FHttpResponsePtr Response, bool bConnectedSuccessfully, FGeminiRequestResult& OutResult);
+
+	// Forwards one streamed chunk to the chunk callback of its request (game thread)
+	void HandleStreamChunk(uint64 RequestId, const FString& ChunkText);
+
+	// Wire format and limits of the inference server; immutable, shared with parsing threads
+	TSharedRef<IGeminiBackend, ESPMode::ThreadSafe> Backend;
+
+	// Requests waiting for a concurrency slot, kept as a heap ordered by priority and submission order
+	TArray<TSharedRef<FGeminiPendingRequest>> QueuedRequests;
+
+	// Requests currently in flight, by handle id
+	TMap<uint64, TSharedRef<FGeminiPendingRequest>> ActiveRequests;
+
+	// Requests waiting out a retry backoff
+	TArray<TSharedRef<FGeminiPendingRequest>> DelayedRequests;
+
+	// Requests waiting for their context to be uploaded, by handle id
+	TMap<uint64, TSharedRef<FGeminiPendingRequest>> AwaitingContextRequests;
+
+	// Pending requests later identical requests can attach to, by content hash, and the hash each attached caller waits on
+	TMap<FString, TSharedRef<FGeminiPendingRequest>> CoalescedRequests;
+	TMap<uint64, FString> WaiterKeys;
+
+	// Recorded request/response pairs, while recording or replaying
+	TSharedPtr<FGeminiFixtureStore> Fixtures;
+	EGeminiFixtureMode FixtureMode;
+	bool bReplayWithLatency;
+
+	// Offline jobs on the Batch API, by handle id
+	TMap<uint64, TSharedRef<FGeminiBatchJob>> BatchJobs;
+
+	// Contexts uploaded as cachedContents, by content hash
+	TSharedRef<FGeminiContextCache> ContextCache;
+	bool bUseContextCache;
+	bool bCoalesceRequests;
+
+	// Requests/tokens per minute budget applied before a request is dispatched
+	FGeminiRateLimiter RateLimiter;
+
+	// Pending wake-up of PumpQueue, if any
+	FTSTicker::FDelegateHandle PumpTickerHandle;
+	double ScheduledPumpTime;
+
+	FString APIBaseURL;
+	FString ModelName;
+
+	int32 MaxConcurrentRequests;
+	int32 MaxRetries;
+	double DefaultTimeout;
+	double RetryBaseDelay;
+	double RetryMaxDelay;
+
+	// Largest part of a response body written to LogGeminiRaw
+	int32 RawLogMaxBytes;
+
+	// Request bodies of at least this many bytes are sent gzip-compressed; 0 disables compression
+	int32 CompressRequestsAboveBytes;
+
+	// Limits for packing batch tasks into one request
+	int32 MaxTasksPerBatchRequest;
+	int32 MaxBatchRequestChars;
+	double BatchJobPollInterval;
+
+	// Largest output cap a request cut off at its own cap is asked again with
+	int32 MaxRaisedOutputTokens;
 
-	// The current API key (for internal use during a request)
-	FString CurrentAPIKey;
-};
\ No newline at end of file
+	uint64 NextRequestId;
+	uint64 NextSequence;
+};
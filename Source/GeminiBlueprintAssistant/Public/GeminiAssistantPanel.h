@@ -5,7 +5,11 @@
 #include "Widgets/SCompoundWidget.h"
 #include "Widgets/Input/SMultiLineEditableTextBox.h"
 #include "Widgets/Input/SButton.h"
+#include "Widgets/Views/SListView.h"
 #include "GeminiAPIClient.h" // Your Gemini API client header
+#include "GeminiSummarySchema.h"
+#include "GeminiSession.h"
+#include "GeminiTimingLog.h"
 
 // Forward declarations for necessary Unreal Engine classes/interfaces
 class UBlueprint;
@@ -13,10 +17,75 @@ class UEdGraph;
 class UEdGraphNode;
 class IBlueprintEditor; // Interface for Blueprint editor instance (exposed via FBlueprintEditorModule.h)
 class SGraphEditor;     // The actual graph editor widget (contains selection/view methods)
+class SHorizontalBox;
+class SGeminiResponseView;
 
 struct LLMResponseParts {
 	FString Details;
 	FString Summary;
+	TArray<FGeminiNodeNote> NodeNotes;
+	float Confidence = -1.0f;
+};
+
+enum class EGeminiPanelJobState : uint8
+{
+	Running,
+	Succeeded,
+	Failed,
+	Cancelled
+};
+
+/**
+ * One analysis started from the panel: what it is about, the requests it waits for and what came back.
+ * Jobs run side by side and each keeps its own state; the result is shown in the job's tab.
+ */
+struct FGeminiPanelJob
+{
+	int32 Id = 0;
+	FString Title;
+	EGeminiPanelJobState State = EGeminiPanelJobState::Running;
+	double StartTime = 0.0;
+	double EndTime = 0.0;
+
+	// What the question was about; nodes may be deleted while the answer is on its way
+	TWeakObjectPtr<UBlueprint> Blueprint;
+	TWeakObjectPtr<UEdGraph> Graph;
+	TArray<TWeakObjectPtr<UEdGraphNode>> Nodes;
+	bool bWriteComments = false;
+
+	// Plain summaries (no question asked) are kept in FGeminiSummaryStore for the node tooltips
+	bool bStoreSummary = false;
+
+	// FGeminiSummaryStore::MakeContentHash of the nodes as the prompt described them; for a pass over all graphs,
+	// one per graph name
+	FString ContentHash;
+	TMap<FString, FString> GraphContentHashes;
+
+	// Node clusters of an Annotate Clusters job, numbered from 1 in the prompt
+	TArray<TArray<TWeakObjectPtr<UEdGraphNode>>> Clusters;
+
+	// Same key means the same question; a newer job replaces a running one with the same key
+	FString SupersessionKey;
+
+	// The single request of a question, or the requests (or the offline job) of a batched pass
+	FGeminiRequestHandle Request;
+	TArray<FGeminiRequestHandle> BatchRequests;
+	int32 NumBatchRequests = 0;
+
+	// Turn recorded in the graph's conversation once answered; no key if the job is not part of one
+	FString SessionKey;
+	FGeminiSessionTurn SessionTurn;
+	FString SessionPrompt;
+
+	FString StreamedText;
+	FString DisplayText;
+
+	// Details found in StreamedText so far, scanned a chunk at a time
+	FGeminiStreamingDetails StreamingDetails;
+	LLMResponseParts Results;
+
+	bool IsRunning() const { return State == EGeminiPanelJobState::Running; }
+	double GetElapsedSeconds() const { return (IsRunning() ? FPlatformTime::Seconds() : EndTime) - StartTime; }
 };
 /**
  * Implements the main Gemini Blueprint Assistant panel.
@@ -30,14 +99,63 @@ public:
 	/** Constructs this widget with InArgs */
 	void Construct(const FArguments& InArgs);
 
+	/** Cancels the jobs still running when the panel closes */
+	virtual ~GeminiAssistantPanel();
+
+	// Splits a complete answer into the details shown in the job's tab and the summary written to the graph; never
+	// leaves the details empty for an answer with text
+	static LLMResponseParts ParseLLMResponse(const FString& FullResponse);
+
+	// Adds a streamed chunk to the job's answer and shows only its details: all of them on the first chunk or when
+	// they started over, otherwise what was added. View is the response view if the job's tab is shown, or null.
+	static void AddStreamedChunk(FGeminiPanelJob& Job, const FString& ChunkText, SGeminiResponseView* View);
+
 private:
 	// --- UI Callbacks ---
 	FReply OnProcessButtonClicked();
 	void OnPromptTextChanged(const FText& InText);
 	void OnPromptTextCommitted(const FText& InText, ETextCommit::Type InCommitType);
-	void OnGeminiResponse(FString ResponseContent, bool bSuccess, FString ErrorMessage);
+	void OnGeminiResponse(FString ResponseContent, bool bSuccess, FString ErrorMessage, int32 JobId);
+	void OnGeminiChunk(FString ChunkText, int32 JobId);
 	FReply OnCopyResponseClicked();
 	FReply OnClearClicked();
+	FReply OnSummarizeAllGraphsClicked();
+	void OnGraphSummariesComplete(const TArray<FGeminiBatchTaskResult>& Results, int32 JobId);
+	FReply OnAnnotateClustersClicked();
+	void OnClustersAnnotated(const TArray<FGeminiBatchTaskResult>& Results, int32 JobId);
+	FReply OnUsageClicked();
+
+	// Shows the stored graph summaries of the Blueprint as a finished job, replacing the one shown before
+	void ShowAutoSummaries(const FString& BlueprintPath);
+	void OnAutoSummaryUpdated(const FString& BlueprintPath);
+
+	// --- Jobs ---
+	// Adds a running job and shows its tab
+	TSharedRef<FGeminiPanelJob> AddJob(const FString& Title);
+	TSharedPtr<FGeminiPanelJob> FindJob(int32 JobId) const;
+	void CancelJob(const TSharedRef<FGeminiPanelJob>& Job, const FText& Reason);
+	void FinishJob(const TSharedRef<FGeminiPanelJob>& Job, EGeminiPanelJobState State, const FString& Text);
+	void RemoveJob(const TSharedRef<FGeminiPanelJob>& Job);
+
+	// Sets the text of the job's tab, refreshing the response view if the tab is shown
+	void SetJobText(FGeminiPanelJob& Job, const FString& Text);
+
+	void ShowJob(const TSharedPtr<FGeminiPanelJob>& Job);
+
+	// Records a stage of the job in FGeminiTimingLog under its request, or under the requests of a batched job
+	void AddJobStageTime(const FGeminiPanelJob& Job, EGeminiTimingStage Stage, double Seconds) const;
+
+	FText GetJobStageText(const FGeminiPanelJob& Job) const;
+	TSharedRef<ITableRow> OnGenerateJobRow(TSharedPtr<FGeminiPanelJob> Job, const TSharedRef<STableViewBase>& OwnerTable);
+	void OnJobSelectionChanged(TSharedPtr<FGeminiPanelJob> Job, ESelectInfo::Type SelectInfo);
+	void RefreshJobViews();
+
+	// Applies the token budgets to a request about the source: warns once a day when one is nearly used up, and once
+	// one is used up either returns false or switches the profile to the configured downgrade profile
+	bool CheckUsageBudget(const FString& UsageSource, FString& InOutProfileName);
+
+	// Summarizes nodes too large for one request as separate parts, shown like "Summarize All Graphs" results
+	void SubmitChunkedSummary(const TSharedRef<FGeminiPanelJob>& Job, UBlueprint* InBlueprint, const TArray<UEdGraphNode*>& InNodes, int32 NumChunks, const FString& APIKey, const FGeminiRequestOptions& Options);
 
 	// --- Blueprint Interaction Functions ---
 	UBlueprint* GetActiveBlueprint() const;
@@ -45,16 +163,18 @@ private:
 	TArray<UEdGraphNode*> GetSelectedBlueprintNodes(UBlueprint* InBlueprint) const;
 	TArray<UEdGraphNode*> GetAllNodesFromActiveGraph(UBlueprint* InBlueprint) const;
 	FString ExtractNodeDataForGemini(const TArray<UEdGraphNode*>& InNodes) const;
-	void AddCommentNodeToBlueprint(UBlueprint* InBlueprint, UEdGraph* TargetGraph, const FString& CommentText) const;
-	LLMResponseParts ParseLLMResponse(const FString& FullResponse);
+	void AddCommentNodeToBlueprint(UBlueprint* InBlueprint, UEdGraph* TargetGraph, const FString& CommentText, const TArray<UEdGraphNode*>& InNodes) const;
+	FString MakeSupersessionKey(UBlueprint* InBlueprint, UEdGraph* InGraph, const TArray<UEdGraphNode*>& InNodes) const;
 
 	// --- UI Members ---
 	TSharedPtr<SWidgetSwitcher> ContentSwitcher;
 	TSharedPtr<SMultiLineEditableTextBox> PromptTextBox;
-	TSharedPtr<SMultiLineEditableText> ResponseTextBlock;
+	TSharedPtr<SGeminiResponseView> ResponseView;
 	TSharedPtr<SCheckBox> WriteCommentsCheckBox;
+	TSharedPtr<STextBlock> StatusTextBlock;
+	TSharedPtr<SListView<TSharedPtr<FGeminiPanelJob>>> JobListView;
+	TSharedPtr<SHorizontalBox> ResultTabBox;
 	FText CurrentPromptText;
-	LLMResponseParts Results;
 
 	// --- API UI Memebers ---
 	bool bHasValidApiKey;
@@ -63,6 +183,7 @@ private:
 	TSharedPtr<SButton> ProcessButton;
 	TSharedPtr<SButton> CopyButton;
 	TSharedPtr<SButton> ClearButton;
+	TSharedPtr<SButton> SummarizeAllButton;
 	TSharedRef<SWidget> CreateApiKeySetupWidget();
 	TSharedRef<SWidget> CreateMainInterfaceWidget();
 	bool CheckApiKeyExists();
@@ -71,9 +192,14 @@ private:
 
 	// --- API Client Member ---
 	TSharedPtr<FGeminiAPIClient> GeminiClient;
-	
-	//Other Members
-	UBlueprint* CachedBlueprint;
-	UEdGraph* CachedFocusedGraph;
-	TArray<UEdGraphNode*> SelectedNodes;
+
+	// Conversations about whole graphs, by Blueprint path and graph name
+	TMap<FString, TSharedRef<FGeminiSession>> Sessions;
+
+	// Running and finished jobs in the order they were started; the list view and the result tabs show this array
+	TArray<TSharedPtr<FGeminiPanelJob>> Jobs;
+
+	// Job whose tab is shown in the response view
+	TSharedPtr<FGeminiPanelJob> ShownJob;
+	int32 NextJobId = 1;
 };
\ No newline at end of file
@@ -0,0 +1,32 @@
+// Public/GeminiAssistantTrace.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+GEMINIBLUEPRINTASSISTANT_API DECLARE_LOG_CATEGORY_EXTERN(LogGeminiAssistant, Log, All);
+
+// Unreal Insights channel of the plugin's trace scopes; record with -trace=cpu,GeminiAssistant
+UE_TRACE_CHANNEL_EXTERN(GeminiAssistantChannel, GEMINIBLUEPRINTASSISTANT_API);
+
+DECLARE_STATS_GROUP(TEXT("Gemini Assistant"), STATGROUP_GeminiAssistant, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Collect Nodes"), STAT_GeminiCollectNodes, STATGROUP_GeminiAssistant, GEMINIBLUEPRINTASSISTANT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Preprocess Nodes"), STAT_GeminiPreprocessNodes, STATGROUP_GeminiAssistant, GEMINIBLUEPRINTASSISTANT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Prompt"), STAT_GeminiBuildPrompt, STATGROUP_GeminiAssistant, GEMINIBLUEPRINTASSISTANT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Serialize Request"), STAT_GeminiSerializeRequest, STATGROUP_GeminiAssistant, GEMINIBLUEPRINTASSISTANT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse Response"), STAT_GeminiParseResponse, STATGROUP_GeminiAssistant, GEMINIBLUEPRINTASSISTANT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update UI"), STAT_GeminiUpdateUI, STATGROUP_GeminiAssistant, GEMINIBLUEPRINTASSISTANT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Write Comments"), STAT_GeminiWriteComments, STATGROUP_GeminiAssistant, GEMINIBLUEPRINTASSISTANT_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Requests In Flight"), STAT_GeminiRequestsInFlight, STATGROUP_GeminiAssistant, GEMINIBLUEPRINTASSISTANT_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Requests Waiting"), STAT_GeminiRequestsWaiting, STATGROUP_GeminiAssistant, GEMINIBLUEPRINTASSISTANT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Requests Sent"), STAT_GeminiRequestsSent, STATGROUP_GeminiAssistant, GEMINIBLUEPRINTASSISTANT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Retries"), STAT_GeminiRetries, STATGROUP_GeminiAssistant, GEMINIBLUEPRINTASSISTANT_API);
+
+// Trace scope on the plugin's channel plus the cycle stat of one pipeline stage
+#define GEMINI_STAGE_SCOPE(Name, Stat) \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(Name, GeminiAssistantChannel); \
+	SCOPE_CYCLE_COUNTER(Stat)
@@ -0,0 +1,78 @@
+// Public/GeminiAutoSummarizer.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+#include "GeminiAPIClient.h"
+
+class UBlueprint;
+class UEdGraph;
+class UPackage;
+class FObjectPostSaveContext;
+
+// Broadcast with the path of a Blueprint whose summaries were updated
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnGeminiAutoSummaryUpdated, const FString& /* BlueprintPath */);
+
+/**
+ * Opt-in background summaries (bAutoSummarize): Blueprints that are saved, or compiled with unsaved edits or stale
+ * summaries, are queued, and while the editor is idle their changed graphs are preprocessed one per tick and
+ * summarized one request at a time, at low priority and only when no other request is waiting. Summaries go to
+ * FGeminiSummaryStore, so the panel and node tooltips can show them as soon as they open. Game thread only.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiAutoSummarizer
+{
+public:
+	explicit FGeminiAutoSummarizer(TSharedRef<FGeminiAPIClient> InClient);
+	~FGeminiAutoSummarizer();
+
+	// Reads the settings and, if enabled, subscribes to compile and save events
+	void Initialize();
+	void Shutdown();
+
+	bool IsEnabled() const { return bEnabled; }
+
+	// Summarizes the Blueprint's changed graphs the next time the editor is idle
+	void QueueBlueprint(UBlueprint* Blueprint);
+
+	FOnGeminiAutoSummaryUpdated& OnSummaryUpdated() { return SummaryUpdatedEvent; }
+
+	int32 GetNumQueuedGraphs() const { return QueuedGraphs.Num(); }
+
+private:
+	void BindEditorEvents();
+
+	void OnBlueprintPreCompile(UBlueprint* Blueprint);
+	void OnPackageSaved(const FString& PackageFileName, UPackage* Package, FObjectPostSaveContext SaveContext);
+
+	// Moves the queue on by one step if the editor is idle and the client has nothing else to do
+	bool Tick(float DeltaTime);
+
+	// No input for IdleSeconds, no play session and no slow task running
+	bool IsEditorIdle() const;
+
+	// Preprocesses the graph and sends it if it changed since its last summary; true if a request went out
+	bool SummarizeGraph(UEdGraph* Graph);
+
+	void OnSummaryComplete(FString ResponseContent, bool bSuccess, FString ErrorMessage, TWeakObjectPtr<UEdGraph> Graph, FString BlueprintPath, FString ContentHash);
+
+	TSharedRef<FGeminiAPIClient> Client;
+
+	// Blueprints compiled or saved since they were last looked at, and graphs of them still to be checked
+	TArray<TWeakObjectPtr<UBlueprint>> QueuedBlueprints;
+	TArray<TWeakObjectPtr<UEdGraph>> QueuedGraphs;
+
+	// The one background request allowed in flight
+	FGeminiRequestHandle ActiveRequest;
+
+	FOnGeminiAutoSummaryUpdated SummaryUpdatedEvent;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+	FDelegateHandle PostEngineInitHandle;
+	FDelegateHandle PreCompileHandle;
+	FDelegateHandle PackageSavedHandle;
+
+	FString ProfileName;
+	bool bEnabled;
+	float IdleSeconds;
+};
@@ -0,0 +1,124 @@
+// Public/GeminiBackend.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h" // For IHttpRequest
+
+struct FGeminiGenerationConfig;
+struct FGeminiChatTurn;
+struct FGeminiParsedResponse;
+class FGeminiJsonWriter;
+
+/**
+ * What an inference server can take, so queueing, batching and chunking can adapt to it.
+ */
+struct FGeminiBackendLimits
+{
+	// Requests the server handles at once; 0 leaves it to MaxConcurrentRequests alone
+	int32 MaxConcurrentRequests = 0;
+
+	// Context window of the model in tokens, prompt and answer together
+	int32 MaxContextTokens = 0;
+
+	bool bRequiresAPIKey = true;
+
+	// Gemini-only features: cachedContents, the Batch API, and FastModel/LongContextModel naming models of this server
+	bool bSupportsContextCache = false;
+	bool bSupportsBatchJobs = false;
+	bool bSupportsModelTiers = false;
+};
+
+// Everything a backend needs to write one generate request
+struct FGeminiBackendPrompt
+{
+	const FString& Model;
+	const FString& Prompt;
+	const FString& CachedContent;
+	const FGeminiGenerationConfig& GenerationConfig;
+	TArrayView<const FGeminiChatTurn> History;
+	bool bStream;
+};
+
+/**
+ * Wire format and endpoint of one kind of inference server. FGeminiAPIClient keeps queueing, retries and
+ * callbacks and asks the backend for URLs, request bodies and the text in responses. Backends are stateless
+ * after construction; parsing runs on worker and HTTP threads.
+ */
+class GEMINIBLUEPRINTASSISTANT_API IGeminiBackend
+{
+public:
+	virtual ~IGeminiBackend() {}
+
+	// Name used by the Backend setting and the [GeminiAssistant.Backend.<Name>] section
+	virtual const TCHAR* GetName() const = 0;
+
+	// Endpoint and model used when APIBaseURL and Model are not configured
+	virtual const TCHAR* GetDefaultBaseURL() const = 0;
+	virtual const TCHAR* GetDefaultModel() const = 0;
+
+	const FGeminiBackendLimits& GetLimits() const { return Limits; }
+
+	virtual FString GetGenerateURL(const FString& BaseURL, const FString& Model, bool bStream, const FString& APIKey) const = 0;
+
+	// Cheap GET that opens the connection ahead of the first real request
+	virtual FString GetPrewarmURL(const FString& BaseURL, const FString& Model, const FString& APIKey) const = 0;
+
+	// Authentication and other headers on top of the JSON content type
+	virtual void SetRequestHeaders(IHttpRequest& Request, const FString& APIKey) const {}
+
+	virtual void WriteRequestBody(FGeminiJsonWriter& Writer, const FGeminiBackendPrompt& Prompt) const = 0;
+
+	// Parses a complete response body; returns true if it holds text, otherwise OutResponse.ErrorMessage says why not
+	virtual bool ParseResponse(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse) const = 0;
+
+	// Parses the data of one server-sent event; events without text and without error leave ErrorMessage empty
+	virtual bool ParseStreamEvent(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse) const = 0;
+
+	// Backend named by the Backend setting, Gemini if unset or unknown
+	static TSharedRef<IGeminiBackend, ESPMode::ThreadSafe> CreateFromConfig();
+	static TSharedPtr<IGeminiBackend, ESPMode::ThreadSafe> Create(const FString& Name);
+
+protected:
+	// Reads MaxConcurrentRequests and MaxContextTokens overrides from [GeminiAssistant.Backend.<Name>]
+	void LoadLimits(const FGeminiBackendLimits& Defaults);
+
+	FGeminiBackendLimits Limits;
+};
+
+/**
+ * Google's Gemini API (generateContent / streamGenerateContent).
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiNativeBackend : public IGeminiBackend
+{
+public:
+	FGeminiNativeBackend();
+
+	virtual const TCHAR* GetName() const override { return TEXT("Gemini"); }
+	virtual const TCHAR* GetDefaultBaseURL() const override;
+	virtual const TCHAR* GetDefaultModel() const override;
+	virtual FString GetGenerateURL(const FString& BaseURL, const FString& Model, bool bStream, const FString& APIKey) const override;
+	virtual FString GetPrewarmURL(const FString& BaseURL, const FString& Model, const FString& APIKey) const override;
+	virtual void WriteRequestBody(FGeminiJsonWriter& Writer, const FGeminiBackendPrompt& Prompt) const override;
+	virtual bool ParseResponse(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse) const override;
+	virtual bool ParseStreamEvent(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse) const override;
+};
+
+/**
+ * Any server speaking the OpenAI chat/completions protocol, e.g. a local llama.cpp, vLLM or Ollama instance,
+ * so graphs never leave the studio network.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiOpenAIBackend : public IGeminiBackend
+{
+public:
+	FGeminiOpenAIBackend();
+
+	virtual const TCHAR* GetName() const override { return TEXT("OpenAI"); }
+	virtual const TCHAR* GetDefaultBaseURL() const override;
+	virtual const TCHAR* GetDefaultModel() const override;
+	virtual FString GetGenerateURL(const FString& BaseURL, const FString& Model, bool bStream, const FString& APIKey) const override;
+	virtual FString GetPrewarmURL(const FString& BaseURL, const FString& Model, const FString& APIKey) const override;
+	virtual void SetRequestHeaders(IHttpRequest& Request, const FString& APIKey) const override;
+	virtual void WriteRequestBody(FGeminiJsonWriter& Writer, const FGeminiBackendPrompt& Prompt) const override;
+	virtual bool ParseResponse(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse) const override;
+	virtual bool ParseStreamEvent(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse) const override;
+};
@@ -0,0 +1,92 @@
+// Public/GeminiBatch.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h" // For FHttpRequestPtr
+#include "Interfaces/IHttpResponse.h" // For FHttpResponsePtr
+#include "Containers/Ticker.h" // For FTSTicker
+
+/**
+ * One independent prompt of a bulk run, e.g. the summary of a single function graph.
+ */
+struct FGeminiBatchTask
+{
+	// Caller-chosen identifier, handed back with the result
+	FString Id;
+	FString Prompt;
+};
+
+struct FGeminiBatchTaskResult
+{
+	FString Id;
+	FString Text;
+	bool bSuccess = false;
+	FString ErrorMessage;
+};
+
+// Fired once every task of a batch has an answer or has failed; results are in task order
+DECLARE_DELEGATE_OneParam(FGeminiBatchDelegate, const TArray<FGeminiBatchTaskResult>& /* Results */);
+
+/**
+ * Packs several tasks into one prompt with numbered delimiters and splits the answer back up,
+ * so a bulk run pays the request overhead once per group instead of once per task.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiPromptBatcher
+{
+public:
+	// Builds a single prompt asking for every task to be answered in its own marked block
+	static FString PackTasks(const TArray<FGeminiBatchTask>& Tasks);
+
+	// Extracts the answer to each task of a packed prompt; tasks the model skipped get an empty string
+	static void UnpackResponse(const FString& Response, int32 NumTasks, TArray<FString>& OutAnswers);
+
+	// Splits tasks, in order, into groups that respect the per-request task count and prompt size limits
+	static void SplitIntoGroups(const TArray<FGeminiBatchTask>& Tasks, int32 MaxTasksPerGroup, int32 MaxCharsPerGroup, TArray<TArray<int32>>& OutGroups);
+};
+
+/**
+ * Job on the Gemini Batch API (batchGenerateContent). The tasks run offline at a lower price and without
+ * counting against the interactive quota; the job is polled until it finishes, which can take hours.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiBatchJob : public TSharedFromThis<FGeminiBatchJob>
+{
+public:
+	FGeminiBatchJob(const FString& InAPIBaseURL, const FString& InModelURL, const FString& InAPIKey, const TArray<FGeminiBatchTask>& InTasks, double InPollInterval, FGeminiBatchDelegate InOnComplete);
+	~FGeminiBatchJob();
+
+	// Uploads the tasks as inline requests and starts polling for the result
+	void Submit();
+
+	// Asks the server to stop the job; OnComplete does not fire afterwards
+	void Cancel();
+
+	bool IsFinished() const { return bFinished; }
+
+	// Server-side name of the job ("batches/..."), empty until it was created
+	const FString& GetJobName() const { return JobName; }
+
+	// Fired when the job is over, however it ended, so the owner can let go of it
+	FSimpleDelegate OnFinished;
+
+private:
+	void OnSubmitComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully);
+	void SchedulePoll();
+	bool OnPollTicker(float DeltaTime);
+	void OnPollComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully);
+
+	// Hands the results to the caller in task order
+	void Finish(const TMap<FString, FGeminiBatchTaskResult>& ResultsById);
+	void Fail(const FString& ErrorMessage);
+
+	FString APIBaseURL;
+	FString ModelURL;
+	FString APIKey;
+	TArray<FGeminiBatchTask> Tasks;
+	double PollInterval;
+	FGeminiBatchDelegate OnComplete;
+
+	FString JobName;
+	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> HttpRequest;
+	FTSTicker::FDelegateHandle PollTickerHandle;
+	bool bFinished;
+};
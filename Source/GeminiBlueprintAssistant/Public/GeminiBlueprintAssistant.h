@@ -5,6 +5,11 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
+class FGeminiAPIClient;
+class FGeminiEditorTracker;
+class FGeminiAutoSummarizer;
+class FGeminiNodeTooltipFactory;
+
 class FGeminiBlueprintAssistantModule : public IModuleInterface
 {
 public:
@@ -13,10 +18,34 @@ public:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
 
+	/** Returns the loaded module instance. */
+	static FGeminiBlueprintAssistantModule& Get();
+
+	/** Gemini client shared by the panel and every other tool of the plugin. */
+	TSharedRef<FGeminiAPIClient> GetAPIClient() const;
+
+	/** Open Blueprint editors and the one the user is working in. */
+	TSharedRef<FGeminiEditorTracker> GetEditorTracker() const;
+
+	/** Background summaries of compiled and saved Blueprints. */
+	TSharedRef<FGeminiAutoSummarizer> GetAutoSummarizer() const;
+
 private:
 	/** Handles spawning the tab. */
 	TSharedRef<SDockTab> OnSpawnTab(const FSpawnTabArgs& SpawnTabArgs);
 
 	/** Registers menu extensions. */
 	void RegisterMenus();
+
+	/** Shared Gemini client, alive for the lifetime of the module. */
+	TSharedPtr<FGeminiAPIClient> APIClient;
+
+	/** Follows editor open, close and focus events for the lifetime of the module. */
+	TSharedPtr<FGeminiEditorTracker> EditorTracker;
+
+	/** Uses the shared client, so it is created after it and destroyed before it. */
+	TSharedPtr<FGeminiAutoSummarizer> AutoSummarizer;
+
+	/** Registered with the graph editor while bNodeSummaryTooltips is set. */
+	TSharedPtr<FGeminiNodeTooltipFactory> NodeTooltipFactory;
 };
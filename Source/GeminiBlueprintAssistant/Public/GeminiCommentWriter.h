@@ -0,0 +1,48 @@
+// Public/GeminiCommentWriter.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UBlueprint;
+class UEdGraph;
+class UEdGraphNode;
+class UEdGraphNode_Comment;
+class SGraphEditor;
+
+/**
+ * Writes generated comment boxes into one graph. Comments are queued with Add and written together by Write: one
+ * undo transaction, one non-structural modification of the Blueprint (comments change nothing that is compiled) and
+ * one refresh of the graph editors, however many comments there are. Boxes are fitted around the nodes' widgets
+ * when the graph is open in the Blueprint editor, and around an estimate from the node's pins otherwise.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiCommentWriter
+{
+public:
+	FGeminiCommentWriter(UBlueprint* InBlueprint, UEdGraph* InGraph);
+
+	// Queues a comment around the nodes; without nodes it is placed at the origin of the graph
+	void Add(const FString& Text, const TArray<UEdGraphNode*>& Nodes, const FLinearColor& Color = FLinearColor::White);
+
+	// Writes the queued comments and returns them
+	TArray<UEdGraphNode_Comment*> Write(const FText& TransactionName);
+
+	int32 Num() const { return Comments.Num(); }
+
+private:
+	struct FComment
+	{
+		FString Text;
+		TArray<TWeakObjectPtr<UEdGraphNode>> Nodes;
+		FLinearColor Color;
+	};
+
+	// Graph-space bounds of the node: its widget's if GraphEditor shows it, an estimate otherwise
+	static FBox2D GetNodeBounds(const UEdGraphNode* Node, const SGraphEditor* GraphEditor);
+
+	// Graph editor of the Blueprint editor, if the graph is the one in front
+	TSharedPtr<SGraphEditor> FindGraphEditor() const;
+
+	TWeakObjectPtr<UBlueprint> Blueprint;
+	TWeakObjectPtr<UEdGraph> Graph;
+	TArray<FComment> Comments;
+};
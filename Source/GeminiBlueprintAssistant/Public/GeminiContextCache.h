@@ -0,0 +1,88 @@
+// Public/GeminiContextCache.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h" // For FHttpRequestPtr
+#include "Interfaces/IHttpResponse.h" // For FHttpResponsePtr
+
+// Receives the name of the cached content ("cachedContents/...") holding a context, or an empty string if the
+// context could not be cached and has to be sent inline
+DECLARE_DELEGATE_OneParam(FGeminiCacheReadyDelegate, const FString& /* CachedContentName */);
+
+/**
+ * Local bookkeeping for Gemini's explicit context caching (cachedContents). A large context such as a
+ * preprocessed graph is uploaded once, keyed by its content hash, and follow-up questions only reference it.
+ * Entries are renewed while they are in use, and replaced when the context of their owner changes. Game thread only.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiContextCache : public TSharedFromThis<FGeminiContextCache>
+{
+public:
+	FGeminiContextCache();
+
+	void Configure(const FString& InAPIBaseURL, const FString& InModelName, double InTTLSeconds, int32 InMinContextChars);
+
+	// Entries live on one server for one model, so switching either forgets them
+	void SetEndpoint(const FString& InAPIBaseURL, const FString& InModelName);
+
+	// Hands the cached content holding Context to OnReady, uploading it first if needed; may call OnReady right away.
+	// OwnerKey names what the context describes (e.g. a graph); a new context for the same owner replaces the old entry.
+	// Cached content only serves the model it was created for; an empty Model uses the configured one.
+	void Acquire(const FString& OwnerKey, const FString& Context, const FString& Model, const FString& APIKey, FGeminiCacheReadyDelegate OnReady);
+
+	// Forgets an entry the server no longer knows, e.g. after a request referencing it was rejected
+	void Invalidate(const FString& CachedContentName);
+
+	int32 GetNumEntries() const { return Entries.Num(); }
+
+	// Moves the cache's clock ahead, so renewal and expiry can be exercised without waiting for them
+	void SkipTime(double Seconds) { TimeOffset += Seconds; }
+
+	// Identifies a context by content, independent of who asked
+	static FString HashContext(const FString& Context);
+
+private:
+	enum class EEntryState : uint8
+	{
+		Creating,
+		Ready,
+		// Creation was rejected (e.g. context below the model's minimum); not retried until it expires
+		Failed
+	};
+
+	struct FEntry
+	{
+		FString Hash;
+		FString OwnerKey;
+		FString Model;
+		FString Name;
+		EEntryState State = EEntryState::Creating;
+		double ExpireTime = 0.0;
+		TArray<FGeminiCacheReadyDelegate> Waiters;
+	};
+
+	void CreateEntry(FEntry& Entry, const FString& Context, const FString& APIKey);
+	void OnCreateComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully, FString Hash);
+
+	// Extends the TTL of an entry that is about to expire but still in use
+	void RenewEntry(FEntry& Entry, const FString& APIKey);
+
+	// Removes an entry locally and on the server
+	void DeleteEntry(const FString& Hash, const FString& APIKey);
+
+	// Drops entries whose TTL has run out; the server has already deleted them
+	void PurgeExpired(double Now);
+
+	double GetTime() const { return FPlatformTime::Seconds() + TimeOffset; }
+
+	// Entries by content hash
+	TMap<FString, FEntry> Entries;
+
+	// Current content hash of every owner
+	TMap<FString, FString> OwnerHashes;
+
+	FString APIBaseURL;
+	FString ModelName;
+	double TTLSeconds;
+	int32 MinContextChars;
+	double TimeOffset;
+};
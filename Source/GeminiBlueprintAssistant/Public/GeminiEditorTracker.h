@@ -0,0 +1,72 @@
+// Public/GeminiEditorTracker.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class UBlueprint;
+class UEdGraph;
+class UEdGraphNode;
+class FBlueprintEditor;
+class SDockTab;
+class IAssetEditorInstance;
+
+/**
+ * Keeps track of the open Blueprint editors and of the one the user is looking at, updated from asset editor
+ * open and close events and from tab activation instead of scanning every editor on each lookup. The focused
+ * graph and the selection are read from the active editor only. Game thread only.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiEditorTracker
+{
+public:
+	FGeminiEditorTracker();
+	~FGeminiEditorTracker();
+
+	// Subscribes to the editor events; waits for the engine if the editor is not up yet
+	void Initialize();
+	void Shutdown();
+
+	// Blueprint of the editor that was focused last, null if no Blueprint editor is open
+	UBlueprint* GetActiveBlueprint() const;
+	TSharedPtr<FBlueprintEditor> GetActiveEditor() const;
+
+	// Editor of the given Blueprint, if it is open
+	TSharedPtr<FBlueprintEditor> FindEditor(UBlueprint* Blueprint) const;
+
+	// Graph open in the Blueprint's editor, or in the active editor if Blueprint is null
+	UEdGraph* GetFocusedGraph(UBlueprint* Blueprint = nullptr) const;
+
+	// Nodes selected in the focused graph of the Blueprint's editor, or of the active editor if Blueprint is null
+	TArray<UEdGraphNode*> GetSelectedNodes(UBlueprint* Blueprint = nullptr) const;
+
+	int32 GetNumOpenEditors() const { return Editors.Num(); }
+
+private:
+	void BindEditorEvents();
+
+	void OnAssetEditorOpened(UObject* Asset);
+	void OnAssetEditorClosed(UObject* Asset, IAssetEditorInstance* EditorInstance);
+
+	// A document tab of a Blueprint editor (a graph) or the editor's own major tab became active
+	void OnActiveTabChanged(TSharedPtr<SDockTab> PreviouslyActive, TSharedPtr<SDockTab> NewlyActive);
+	void OnTabForegrounded(TSharedPtr<SDockTab> NewForegroundTab, TSharedPtr<SDockTab> BackgroundedTab);
+
+	// Records the editor whose tabs the tab belongs to as the active one
+	void ActivateEditorOfTab(const TSharedPtr<SDockTab>& Tab);
+	void Activate(UBlueprint* Blueprint);
+
+	// Adds the editor of a Blueprint just opened
+	void AddEditor(UBlueprint* Blueprint);
+
+	// Editors by Blueprint
+	mutable TMap<TWeakObjectPtr<UBlueprint>, TWeakPtr<FBlueprintEditor>> Editors;
+
+	// Blueprint whose editor was focused last; falls back to the one before it when that editor closes
+	TArray<TWeakObjectPtr<UBlueprint>> ActivationOrder;
+
+	FDelegateHandle PostEngineInitHandle;
+	FDelegateHandle EditorOpenedHandle;
+	FDelegateHandle EditorClosedHandle;
+	FDelegateHandle ActiveTabChangedHandle;
+	FDelegateHandle TabForegroundedHandle;
+};
@@ -0,0 +1,69 @@
+// Public/GeminiFixtures.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+// What FGeminiAPIClient does with request/response fixtures
+enum class EGeminiFixtureMode : uint8
+{
+	// Requests go to the server as usual
+	Off,
+	// Requests go to the server and every successful response is stored as a fixture
+	Record,
+	// Requests never leave the editor; they are answered from stored fixtures
+	Replay
+};
+
+/**
+ * One recorded request and the server's answer to it.
+ */
+struct FGeminiFixture
+{
+	FString Key;
+	FString Backend;
+	FString Model;
+	bool bStream = false;
+	int32 ResponseCode = 200;
+
+	// From sending the request to the complete response, for replays with the original timing
+	double LatencySeconds = 0.0;
+
+	// Body as sent, kept so fixtures can be read and diffed; replay matches on Key only
+	TArray<uint8> RequestBody;
+
+	// Body as received; the raw server-sent events for streamed requests
+	TArray<uint8> ResponseBody;
+};
+
+/**
+ * Directory of fixtures, one JSON file per request named after the hash of what was asked: backend, model,
+ * streaming and the request body. API keys are not part of the hash, so fixtures recorded with one key replay
+ * with any other, or with none. Files are small and read on demand; game thread only.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiFixtureStore
+{
+public:
+	explicit FGeminiFixtureStore(const FString& InDirectory);
+
+	static FString MakeKey(const FString& Backend, const FString& Model, bool bStream, const TArray<uint8>& RequestBody);
+
+	bool Save(const FGeminiFixture& Fixture) const;
+	bool Load(const FString& Key, FGeminiFixture& OutFixture) const;
+
+	// Keys of every fixture in the directory
+	TArray<FString> FindAllKeys() const;
+
+	const FString& GetDirectory() const { return Directory; }
+
+	// Saved/GeminiAssistant/Fixtures
+	static FString GetDefaultDirectory();
+
+	// "Record", "Replay" or anything else for Off
+	static EGeminiFixtureMode ParseMode(const FString& Name);
+	static const TCHAR* GetModeName(EGeminiFixtureMode Mode);
+
+private:
+	FString GetFilePath(const FString& Key) const;
+
+	FString Directory;
+};
@@ -0,0 +1,42 @@
+// Public/GeminiGraphClusterer.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UEdGraph;
+class UEdGraphNode;
+
+/**
+ * Group of nodes of one graph that belong together and get one comment.
+ */
+struct FGeminiNodeCluster
+{
+	TArray<UEdGraphNode*> Nodes;
+
+	// Node positions only; node sizes are not known without their widgets
+	FBox2D Bounds = FBox2D(ForceInit);
+};
+
+/**
+ * Splits a graph into clusters without asking Gemini: nodes joined by exec wires form one chain, pure nodes join
+ * the chain they feed, and leftovers join the nearest cluster within ClusterMergeDistance. Clusters larger than
+ * ClusterMaxNodes are cut into left-to-right slices, smaller than ClusterMinNodes are dropped. Nodes that are
+ * already inside a comment box are left out.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiGraphClusterer
+{
+public:
+	// Reads ClusterMaxNodes, ClusterMinNodes and ClusterMergeDistance from [GeminiAssistant]
+	FGeminiGraphClusterer();
+
+	// Clusters in reading order, top to bottom and left to right
+	TArray<FGeminiNodeCluster> Cluster(UEdGraph* Graph) const;
+
+	// Comment per cluster number from an answer with one "CLUSTER <number>: <comment>" line per cluster
+	static TMap<int32, FString> ParseClusterComments(const FString& Response);
+
+private:
+	int32 MaxNodes;
+	int32 MinNodes;
+	float MergeDistance;
+};
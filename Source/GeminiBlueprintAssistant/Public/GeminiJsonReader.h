@@ -0,0 +1,83 @@
+// Public/GeminiJsonReader.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Kind of JSON value found at the reader position
+enum class EGeminiJsonToken : uint8
+{
+	Invalid,
+	Object,
+	Array,
+	String,
+	Number,
+	True,
+	False,
+	Null
+};
+
+/**
+ * Forward-only pull reader over UTF-8 JSON bytes. Callers walk down to the fields they need and skip
+ * everything else, so no DOM is built and no intermediate UTF-16 copy of the document is made.
+ * Safe to use from any thread; it only reads the buffer it was given.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiJsonReader
+{
+public:
+	FGeminiJsonReader(const uint8* InData, int32 InNum);
+
+	// Type of the value at the current position (leading whitespace is skipped)
+	EGeminiJsonToken Peek();
+
+	// Iterates the members of the object at the current position. The visitor must consume the
+	// member's value with one of the Read/Skip functions and return false to abort with an error.
+	bool ReadObject(TFunctionRef<bool(const FString& Key)> OnMember);
+
+	// Iterates the elements of the array at the current position; the visitor consumes each element
+	bool ReadArray(TFunctionRef<bool(int32 Index)> OnElement);
+
+	// Reads a string value, decoding escapes and UTF-8
+	bool ReadString(FString& OutValue);
+
+	// Reads a string value and appends it to an existing string
+	bool AppendString(FString& OutValue);
+
+	bool ReadNumber(double& OutValue);
+	bool ReadBool(bool& OutValue);
+
+	// Reads a number into an integer, accepting numbers sent as strings (int64 fields in proto JSON)
+	bool ReadInt64(int64& OutValue);
+
+	// Skips the value at the current position, whatever it is
+	bool SkipValue();
+
+	// True once a syntax error was met; every further call fails
+	bool HasError() const { return bError; }
+
+	// True when only whitespace is left after the last value
+	bool IsAtEnd();
+
+	// Returns the raw bytes of the value at the current position and skips it
+	bool ReadRawValue(const uint8*& OutStart, int32& OutNum);
+
+	// Decodes UTF-8 bytes and appends them to a string
+	static void AppendUtf8(FString& OutValue, const uint8* Bytes, int32 NumBytes);
+
+private:
+	void SkipWhitespace();
+	bool Expect(uint8 Char);
+	bool Fail();
+	bool SkipString();
+	bool ReadHex4(uint32& OutValue);
+
+	// Copies the characters of a number literal so it can be converted
+	bool ReadNumberLiteral(TCHAR* OutBuffer, int32 BufferSize, bool& bOutIsInteger);
+
+	const uint8* Data;
+	int32 Num;
+	int32 Pos;
+	bool bError;
+
+	// Scratch buffer reused for strings containing escapes
+	TArray<uint8> Scratch;
+};
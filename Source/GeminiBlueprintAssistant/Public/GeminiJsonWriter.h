@@ -0,0 +1,52 @@
+// Public/GeminiJsonWriter.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+/**
+ * Minimal JSON writer that appends UTF-8 straight into a byte buffer. Strings are escaped and
+ * transcoded in one pass, so a large prompt is copied exactly once into the request body.
+ * Commas are inserted automatically; keys are expected to be plain ASCII literals.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiJsonWriter
+{
+public:
+	explicit FGeminiJsonWriter(TArray<uint8>& InOutput);
+
+	void BeginObject();
+	void EndObject();
+	void BeginArray();
+	void EndArray();
+
+	// Starts an object member; the next Write/Begin call provides its value
+	void WriteKey(const ANSICHAR* Key);
+
+	void WriteString(FStringView Value);
+	void WriteNumber(double Value);
+	void WriteInteger(int64 Value);
+	void WriteBool(bool bValue);
+	void WriteNull();
+
+	// Appends already encoded JSON as the next value
+	void WriteRawValue(const uint8* Data, int32 Num);
+
+	void WriteStringField(const ANSICHAR* Key, FStringView Value) { WriteKey(Key); WriteString(Value); }
+	void WriteNumberField(const ANSICHAR* Key, double Value) { WriteKey(Key); WriteNumber(Value); }
+	void WriteIntegerField(const ANSICHAR* Key, int64 Value) { WriteKey(Key); WriteInteger(Value); }
+	void WriteBoolField(const ANSICHAR* Key, bool bValue) { WriteKey(Key); WriteBool(bValue); }
+
+private:
+	// Emits the separating comma if the current container already holds a value
+	void BeginValue();
+	void AppendAscii(const ANSICHAR* Text);
+	void AppendEscaped(FStringView Value);
+
+	TArray<uint8>& Output;
+
+	// One entry per open container, true once it holds a value
+	TArray<bool, TInlineAllocator<16>> ContainerHasValue;
+
+	// Set between WriteKey and the member's value, which needs no comma of its own
+	bool bAfterKey;
+};
@@ -0,0 +1,143 @@
+// Public/GeminiMockServer.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
+
+class FSocket;
+class FTcpListener;
+struct FIPv4Endpoint;
+
+/**
+ * Behaviour of the local stand-in for the Gemini API.
+ */
+struct FGeminiMockServerSettings
+{
+	int32 Port = 8089;
+
+	// Time before an answer (or the first event of a streamed one) is sent, plus a uniformly random extra of up to JitterMs
+	float LatencyMs = 200.0f;
+	float JitterMs = 50.0f;
+
+	// Fraction of generate requests answered with ErrorCode instead of a response
+	float ErrorRate = 0.0f;
+	int32 ErrorCode = 503;
+
+	// Length of the generated answer text and the number of events a streamed answer is split into
+	int32 ResponseChars = 2000;
+	int32 StreamChunks = 8;
+
+	// Time between two events of a streamed answer
+	float StreamIntervalMs = 50.0f;
+
+	// Keeps every request received for GetRequests(); off for load runs, whose bodies would pile up
+	bool bRecordRequests = false;
+
+	// Reads "Key=Value" pairs as given to the console commands, e.g. "LatencyMs=50 ErrorRate=0.1"
+	void ParseArgs(const TArray<FString>& Args);
+};
+
+/**
+ * A request as received by the mock server.
+ */
+struct FGeminiMockRequest
+{
+	FString Verb;
+
+	// Path below the base URL without the query, e.g. "models/mock-model:generateContent" or "cachedContents/mock-1"
+	FString Path;
+
+	// Body as the client meant it, i.e. decompressed if it was sent gzip-compressed
+	TArray<uint8> Body;
+
+	FString GetBodyString() const;
+};
+
+/**
+ * Local HTTP server answering generateContent, streamGenerateContent (SSE), cachedContents and model lookups
+ * like the Gemini API, so the client can be measured and exercised without the live API or a key. It serves plain
+ * sockets itself so a streamed answer goes out one event at a time, like the real server's, and the time to first
+ * text can be measured. Point the plugin at it with APIBaseURL=http://localhost:<Port>/v1beta. Game thread only.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiMockServer : public TSharedFromThis<FGeminiMockServer>
+{
+public:
+	FGeminiMockServer();
+	~FGeminiMockServer();
+
+	// Starts listening; returns false if the port could not be bound
+	bool Start(const FGeminiMockServerSettings& InSettings);
+	void Stop();
+
+	bool IsRunning() const { return Listener.IsValid(); }
+	FString GetBaseURL() const;
+
+	const FGeminiMockServerSettings& GetSettings() const { return Settings; }
+	void SetSettings(const FGeminiMockServerSettings& InSettings) { Settings = InSettings; }
+
+	// Requests answered since the server was started
+	int32 GetNumRequests() const { return NumRequests; }
+
+	// Requests received since the server was started or ResetRequests(), oldest first, if bRecordRequests is set
+	const TArray<FGeminiMockRequest>& GetRequests() const { return Requests; }
+	void ResetRequests() { Requests.Reset(); }
+
+	// Server started by the Gemini.MockServer console commands, if any
+	static TSharedPtr<FGeminiMockServer> GetShared();
+	static void SetShared(TSharedPtr<FGeminiMockServer> Server);
+
+private:
+	// Bytes to send on a connection once their time has come
+	struct FOutgoing
+	{
+		double SendTime = 0.0;
+		TArray<uint8> Bytes;
+		int32 BytesSent = 0;
+	};
+
+	struct FConnection
+	{
+		FSocket* Socket = nullptr;
+		TArray<uint8> Received;
+		TArray<FOutgoing> Outgoing;
+
+		// The request was read and answered; the connection closes once the answer is out
+		bool bAnswered = false;
+	};
+
+	// Runs on the listener thread; the connection is picked up by the next tick
+	bool OnConnectionAccepted(FSocket* Socket, const FIPv4Endpoint& Endpoint);
+
+	bool Tick(float DeltaTime);
+
+	// Reads what has arrived; false once the connection is done with
+	bool ReceiveRequest(FConnection& Connection);
+	bool SendOutgoing(FConnection& Connection, double Now);
+
+	// Parses a complete request out of what was received; false while it is still arriving
+	bool ParseRequest(FConnection& Connection, FGeminiMockRequest& OutRequest) const;
+
+	void HandleRequest(FConnection& Connection, const FGeminiMockRequest& Request);
+
+	// Queues the response after the configured latency
+	void Respond(FConnection& Connection, int32 Code, const TArray<uint8>& Body, const TCHAR* ContentType);
+
+	// Queues the header right away and the events one at a time, the first after the configured latency
+	void RespondStream(FConnection& Connection, const TArray<TArray<uint8>>& Events);
+
+	double GetLatencySeconds() const;
+	static void CloseSocket(FSocket* Socket);
+
+	void WriteGenerateResponse(TArray<uint8>& OutBody, const FString& Text, bool bFinal) const;
+	FString MakeAnswerText() const;
+
+	FGeminiMockServerSettings Settings;
+	TUniquePtr<FTcpListener> Listener;
+	TQueue<FSocket*, EQueueMode::Mpsc> AcceptedSockets;
+	TArray<TUniquePtr<FConnection>> Connections;
+	FTSTicker::FDelegateHandle TickerHandle;
+	TArray<FGeminiMockRequest> Requests;
+	int32 NumRequests;
+	int32 NextCacheId;
+};
@@ -0,0 +1,78 @@
+// Public/GeminiModelRouter.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GeminiAPIClient.h"
+
+struct FGeminiBackendLimits;
+
+/**
+ * Local estimate of how many tokens Gemini will count for a text, made before anything is sent.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiTokenEstimator
+{
+public:
+	// Word pieces count about one token per four characters, punctuation and symbols one each, so the
+	// JSON-like graph dumps are not underestimated the way a plain length / 4 would
+	static int32 EstimateTokens(const FString& Text);
+};
+
+/**
+ * Named set of generation settings, read from the [GeminiAssistant.Profile.<Name>] config section
+ * on top of built-in defaults for "fast" and "thorough".
+ */
+struct GEMINIBLUEPRINTASSISTANT_API FGeminiGenerationProfile
+{
+	FString Name;
+
+	// Fixed model for this profile; empty lets the router pick by prompt size
+	FString Model;
+
+	// Sends every prompt that fits to FastModel, whatever its size
+	bool bPreferFastModel = false;
+
+	FGeminiGenerationConfig GenerationConfig;
+
+	static FGeminiGenerationProfile Load(const FString& InName);
+};
+
+// Where a prompt of a given size should go
+struct FGeminiRoute
+{
+	FString Model;
+
+	// Too large for any model; the caller should split the input and ask about the parts
+	bool bNeedsChunking = false;
+
+	// Number of parts of at most MaxPromptTokens the input should be split into
+	int32 NumChunks = 1;
+};
+
+/**
+ * Picks the model for a prompt from its estimated size: small prompts go to the fast model, large ones to a
+ * long-context model, and prompts beyond every context window are flagged for chunking.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiModelRouter
+{
+public:
+	// Reads FastModel, LongContextModel and the token thresholds from [GeminiAssistant]
+	FGeminiModelRouter();
+
+	// Same, with the prompt limit capped to the backend's context window and size tiers only where the backend has them
+	explicit FGeminiModelRouter(const FGeminiBackendLimits& Limits);
+
+	FGeminiRoute Route(int32 EstimatedTokens, const FGeminiGenerationProfile& Profile) const;
+
+	// Fills the options with the routed model and the profile's generation settings
+	FGeminiRoute Apply(int32 EstimatedTokens, const FGeminiGenerationProfile& Profile, FGeminiRequestOptions& InOutOptions) const;
+
+	int32 GetMaxPromptTokens() const { return MaxPromptTokens; }
+
+private:
+	FString FastModel;
+	FString DefaultModel;
+	FString LongContextModel;
+	int32 FastModelMaxTokens;
+	int32 LongContextMinTokens;
+	int32 MaxPromptTokens;
+};
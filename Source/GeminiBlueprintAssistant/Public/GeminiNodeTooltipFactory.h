@@ -0,0 +1,24 @@
+// Public/GeminiNodeTooltipFactory.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EdGraphUtilities.h"
+
+class SGraphNode;
+class UEdGraphNode;
+
+/**
+ * Visual node factory that leaves building the widgets of Blueprint nodes to the editor and only gives nodes with a
+ * stored summary, and comment boxes, a tooltip showing it ahead of their usual one. The summary comes from
+ * FGeminiSummaryStore when the tooltip opens; nothing is sent to Gemini. Registered by the module when
+ * bNodeSummaryTooltips is set.
+ */
+class FGeminiNodeTooltipFactory : public FGraphPanelNodeFactory
+{
+public:
+	virtual TSharedPtr<SGraphNode> CreateNode(UEdGraphNode* Node) const override;
+
+private:
+	// FNodeFactory asks every registered factory, this one included, while it builds the default widget
+	mutable bool bCreatingNode = false;
+};
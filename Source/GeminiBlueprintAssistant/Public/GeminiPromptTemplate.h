@@ -0,0 +1,46 @@
+// Public/GeminiPromptTemplate.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FGeminiGenerationConfig;
+
+/**
+ * Prompt of one panel action, laid out so every request with the same template starts with the same text:
+ * the instructions and answer format come first, then the graph data, then the task naming the Blueprint and
+ * the user's question. Identical leading text lets the server reuse its implicit prefix cache across graphs.
+ * Built-in templates can be replaced in [GeminiAssistant.Prompt.<Name>] (Instructions, Format, StructuredFormat,
+ * Task, Query; "\n" for line breaks; MaxOutputTokens).
+ */
+struct GEMINIBLUEPRINTASSISTANT_API FGeminiPromptTemplate
+{
+	FString Name;
+
+	// Static part, sent first; must not mention anything that changes between requests
+	FString Instructions;
+
+	// How to answer: as DETAILS/SUMMARY text, or into the fields of FGeminiSummarySchema
+	FString Format;
+	FString StructuredFormat;
+
+	// Sent after the graph data; {Blueprint}, {Graph}, {Part}, {NumParts} and {NumClusters} are filled in
+	FString Task;
+
+	// Appended after the task when the user typed a question; {Query} is filled in
+	FString Query;
+
+	// Tokens the answer itself needs; 0 leaves the output cap to the generation profile
+	int32 MaxOutputTokens = 0;
+
+	// Built-in template "Graph", "EmptyGraph", "Selection", "GraphSummary", "GraphPart" or "Clusters", with config overrides
+	static FGeminiPromptTemplate Load(const FString& InName);
+
+	// Instructions and format; the same string for every request with this template
+	FString GetPrefix(bool bStructured) const;
+
+	// Task with its arguments, followed by the user's question if there is one
+	FString FormatTask(const FStringFormatNamedArguments& Arguments, const FString& UserQuery = FString()) const;
+
+	// Sizes the output cap of a profile for this template's answer, keeping room for thinking the profile allows
+	void ApplyOutputCap(FGeminiGenerationConfig& InOutConfig) const;
+};
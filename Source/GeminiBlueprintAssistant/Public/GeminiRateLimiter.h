@@ -0,0 +1,55 @@
+// Public/GeminiRateLimiter.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Client-side token buckets keeping the outgoing traffic within the per-minute request and token quota,
+ * so bursts wait locally instead of being rejected by the API with 429s.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiRateLimiter
+{
+public:
+	FGeminiRateLimiter();
+
+	// Sets the quota; a limit of zero disables the respective bucket
+	void Configure(int32 InRequestsPerMinute, int32 InTokensPerMinute);
+
+	// Takes one request and the estimated tokens out of the buckets if both have enough left
+	bool TryAcquire(int32 EstimatedTokens, double Now);
+
+	// Seconds until TryAcquire could succeed for the given token count
+	double GetWaitTime(int32 EstimatedTokens, double Now);
+
+	// Returns capacity reserved for a request the server rejected before billing it
+	void Refund(int32 EstimatedTokens);
+
+	// Holds every request back until the given time, e.g. after the server asked us to back off
+	void BlockUntil(double Time);
+
+	bool IsEnabled() const { return RequestBucket.IsEnabled() || TokenBucket.IsEnabled(); }
+
+private:
+	struct FBucket
+	{
+		double Capacity = 0.0;
+		double Available = 0.0;
+		double RefillPerSecond = 0.0;
+
+		bool IsEnabled() const { return Capacity > 0.0; }
+		void Configure(int32 PerMinute);
+		void Refill(double Elapsed);
+
+		// Amount one acquisition takes; requests larger than the whole bucket only wait for a full bucket
+		double Clamp(double Amount) const { return FMath::Min(Amount, Capacity); }
+		double GetWaitTime(double Amount) const;
+	};
+
+	// Tops up both buckets for the time passed since the last call
+	void Refill(double Now);
+
+	FBucket RequestBucket;
+	FBucket TokenBucket;
+	double LastRefillTime;
+	double BlockedUntilTime;
+};
@@ -0,0 +1,64 @@
+// Public/GeminiResponseParser.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Tokens the server counted for one response, as reported in its usage metadata.
+ */
+struct FGeminiTokenUsage
+{
+	// Everything sent, cached content and conversation history included
+	int32 PromptTokens = 0;
+
+	// Part of PromptTokens that was read from cached content at a lower price
+	int32 CachedTokens = 0;
+
+	int32 OutputTokens = 0;
+
+	// Reasoning of thinking models, billed like output
+	int32 ThoughtTokens = 0;
+
+	bool IsSet() const { return PromptTokens > 0 || OutputTokens > 0 || ThoughtTokens > 0; }
+	int64 GetTotal() const { return static_cast<int64>(PromptTokens) + OutputTokens + ThoughtTokens; }
+};
+
+/**
+ * The fields of a generateContent response the plugin actually uses.
+ */
+struct FGeminiParsedResponse
+{
+	// Text of every non-thought part; the answers of several candidates are separated by a blank line
+	FString Text;
+
+	// Set when the response carries no text: API error, blocked prompt or unparsable body
+	FString ErrorMessage;
+
+	// Finish reason of the first candidate, e.g. STOP, MAX_TOKENS or SAFETY
+	FString FinishReason;
+
+	int32 NumCandidates = 0;
+
+	// True when the body was an API error object; ErrorMessage then carries its message
+	bool bApiError = false;
+
+	// promptFeedback.blockReason when Gemini refused the prompt
+	FString BlockReason;
+
+	// Token counts of usageMetadata; streams report running totals, so the last event holding them wins
+	FGeminiTokenUsage Usage;
+};
+
+/**
+ * Extracts text and errors from generateContent responses and streamGenerateContent events with a pull
+ * reader over the raw UTF-8 body, skipping everything else. Has no state, so it can run on any thread.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiResponseParser
+{
+public:
+	// Parses one response object, or the array of response chunks streamGenerateContent returns without alt=sse.
+	// Returns true if any text was found; otherwise OutResponse.ErrorMessage says why not.
+	static bool Parse(const uint8* Data, int32 Num, FGeminiParsedResponse& OutResponse);
+	static bool Parse(const TArray<uint8>& Body, FGeminiParsedResponse& OutResponse);
+	static bool Parse(const FString& Body, FGeminiParsedResponse& OutResponse);
+};
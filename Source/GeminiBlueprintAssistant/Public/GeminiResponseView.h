@@ -0,0 +1,52 @@
+// Public/GeminiResponseView.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/SListView.h"
+
+/**
+ * One row of the response view: a paragraph of the response, or a piece of one too long for a single row.
+ */
+struct FGeminiResponseParagraph
+{
+	// Where the paragraph starts in the response text
+	int32 Start = 0;
+	FText Text;
+};
+
+/**
+ * Read-only view of a response that lays out one row per paragraph in a virtualized list, so only the visible rows
+ * are laid out however long the response gets. Text that extends the previous text, as a streamed answer does, only
+ * rebuilds the last row and adds the new ones; the rows before it keep their layout.
+ */
+class GEMINIBLUEPRINTASSISTANT_API SGeminiResponseView : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SGeminiResponseView) {}
+		SLATE_ARGUMENT(FString, Text)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+
+	// Shows the text, appending to the rows shown if it starts with the text shown before
+	void SetText(const FString& InText);
+
+	// Appends to the text shown, as a streamed answer does, without comparing it to the text shown before
+	void AppendText(const FString& Delta);
+	const FString& GetText() const { return Text; }
+
+private:
+	// Splits the text from Start on into rows
+	void AddParagraphs(int32 Start);
+
+	TSharedRef<ITableRow> OnGenerateRow(TSharedPtr<FGeminiResponseParagraph> Paragraph, const TSharedRef<STableViewBase>& OwnerTable);
+	void OnScrolled(double ScrollOffset);
+
+	TSharedPtr<SListView<TSharedPtr<FGeminiResponseParagraph>>> ListView;
+	TArray<TSharedPtr<FGeminiResponseParagraph>> Paragraphs;
+	FString Text;
+
+	// Appended text scrolls into view unless the user scrolled away from the end
+	bool bFollowEnd = true;
+};
@@ -0,0 +1,37 @@
+// Public/GeminiSSEParser.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Incremental parser for the server-sent-event stream returned by streamGenerateContent?alt=sse.
+ * Bytes can be fed in arbitrary slices as they arrive from the socket; every completed event
+ * is handed back as the raw UTF-8 bytes of its "data:" field(s), ready for FGeminiResponseParser.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiSSEParser
+{
+public:
+	FGeminiSSEParser();
+
+	// Appends raw UTF-8 bytes and collects the data payload of every event they complete
+	void Feed(const uint8* Data, int64 Num, TArray<TArray<uint8>>& OutEvents);
+
+	// Flushes a trailing event that was not terminated by a blank line (end of stream)
+	void Finish(TArray<TArray<uint8>>& OutEvents);
+
+	// Drops any buffered state so the parser can be reused for a new stream
+	void Reset();
+
+private:
+	// Handles one complete line (without its line terminator)
+	void ProcessLine(const uint8* Line, int32 Len, TArray<TArray<uint8>>& OutEvents);
+
+	// Emits the buffered event data, if any
+	void DispatchEvent(TArray<TArray<uint8>>& OutEvents);
+
+	// Bytes received but not yet terminated by a newline
+	TArray<uint8> PendingBytes;
+
+	// Data lines of the event currently being assembled
+	TArray<uint8> EventData;
+};
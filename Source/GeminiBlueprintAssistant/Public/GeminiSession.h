@@ -0,0 +1,85 @@
+// Public/GeminiSession.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GeminiAPIClient.h"
+
+class UEdGraphNode;
+
+/**
+ * Preprocessed lines of a graph's nodes, keyed by node GUID so two snapshots of the same graph can be compared.
+ */
+struct GEMINIBLUEPRINTASSISTANT_API FGeminiGraphSnapshot
+{
+	struct FNode
+	{
+		FGuid NodeGuid;
+		// The node in FBlueprintNodePreprocessor's format, without its number
+		FString Line;
+	};
+
+	TArray<FNode> Nodes;
+
+	// Runs the nodes through the preprocessor; nodes it cannot handle are left out like in its own output
+	static FGeminiGraphSnapshot Capture(const TArray<UEdGraphNode*>& InNodes);
+};
+
+// What to send for one turn of a session
+struct FGeminiSessionTurn
+{
+	// The graph as of the session's base, sent as (cacheable) context; unchanged from turn to turn until the base moves
+	FString Context;
+
+	// Added, removed and changed nodes since the last answered turn, empty on the first turn or if nothing changed
+	FString GraphChanges;
+
+	// Earlier questions and answers, oldest first
+	TArray<FGeminiChatTurn> History;
+
+	// The graph the turn describes
+	FGeminiGraphSnapshot Snapshot;
+};
+
+/**
+ * Conversation about one graph. The first turn sends the whole graph, later turns only the nodes that were
+ * added, removed or changed since the previous answer, together with the earlier questions and answers.
+ * Nodes keep their number for the whole session, so answers and deltas can refer to them. When the history
+ * grows past its token budget the oldest turns are dropped and the next turn sends the whole graph again.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiSession
+{
+public:
+	explicit FGeminiSession(int32 InMaxHistoryTokens);
+
+	// Prepares the next turn for the graph as it is now; ContextHeader introduces the graph in the context
+	FGeminiSessionTurn BeginTurn(const FGeminiGraphSnapshot& Snapshot, const FString& ContextHeader);
+
+	// Records an answered turn; turns that failed or were cancelled are simply never completed
+	void CompleteTurn(const FGeminiSessionTurn& Turn, const FString& UserMessage, const FString& Answer);
+
+	int32 GetNumTurns() const { return History.Num() / 2; }
+
+private:
+	// The graph with every node under its session number
+	FString FormatGraph(const FGeminiGraphSnapshot& Snapshot);
+
+	// Nodes added, removed and changed from LastSnapshot to Snapshot
+	FString FormatChanges(const FGeminiGraphSnapshot& Snapshot);
+
+	int32 GetNodeNumber(const FGuid& NodeGuid);
+
+	// Drops the oldest question/answer pairs until the history fits its budget
+	void TrimHistory();
+
+	TArray<FGeminiChatTurn> History;
+
+	// Context of the session's base, empty until the first turn or after the history was trimmed
+	FString BaseContext;
+
+	// The graph as of the last answered turn
+	FGeminiGraphSnapshot LastSnapshot;
+
+	TMap<FGuid, int32> NodeNumbers;
+	int32 NextNodeNumber;
+	int32 MaxHistoryTokens;
+};
@@ -0,0 +1,99 @@
+// Public/GeminiSummarySchema.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Remark the model attached to one node of the numbered node list it was given
+struct FGeminiNodeNote
+{
+	// 1-based position of the node in the prompt's node list
+	int32 NodeIndex = 0;
+	FString Note;
+};
+
+/**
+ * Typed answer of a summary request made with FGeminiSummarySchema.
+ */
+struct FGeminiStructuredSummary
+{
+	// User-facing explanation shown in the panel
+	FString Details;
+
+	// One line, written into the comment node
+	FString Summary;
+
+	TArray<FGeminiNodeNote> NodeNotes;
+
+	// The model's own confidence from 0 to 1, negative if it gave none
+	float Confidence = -1.0f;
+};
+
+/**
+ * Response schema for Blueprint summaries. Requests declaring it get a JSON object back instead of free text
+ * with DETAILS/SUMMARY markers, which is parsed straight into FGeminiStructuredSummary.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiSummarySchema
+{
+public:
+	// The schema as sent in generationConfig.responseSchema
+	static const FString& GetSchemaJson();
+
+	// Prompt sentence explaining what goes into each field
+	static const TCHAR* GetFieldInstructions();
+
+	// Parses a complete answer; false if it is not a JSON object with details
+	static bool Parse(const FString& ResponseText, FGeminiStructuredSummary& OutSummary);
+
+	// Decoded text of the "details" field of a partial answer, as far as it has arrived; empty until it starts
+	static FString ExtractPartialDetails(const FString& PartialResponse);
+};
+
+/**
+ * Details of an answer that is still streaming: the "details" field of a JSON answer, or the text between DETAILS:
+ * and SUMMARY: of a plain one (all of it until DETAILS: shows up). Fed the growing answer after every chunk, it only
+ * scans what was added since, holding back the few characters that may start a marker or end the details.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiStreamingDetails
+{
+public:
+	// Scans what was appended to Response since the last call. Returns true with the details it added in
+	// OutAppended, or false if the details started over (a late DETAILS: marker) and GetDetails() replaces them.
+	bool Update(const FString& Response, FString& OutAppended);
+
+	const FString& GetDetails() const { return Details; }
+
+private:
+	enum class EMode : uint8
+	{
+		Undecided,
+		Json,
+		Text
+	};
+
+	void ScanJson(const FString& Response, FString& OutAppended);
+	bool ScanText(const FString& Response, FString& OutAppended);
+
+	// Appends Response[From, To) to the details, leaving out leading whitespace and holding back trailing whitespace
+	void AppendTrimmed(const FString& Response, int32 From, int32 To, FString& OutAppended);
+
+	FString Details;
+
+	// Whitespace that only becomes part of the details once more text follows it
+	FString PendingWhitespace;
+
+	// Response up to here has been scanned
+	int32 ScanIndex = 0;
+
+	EMode Mode = EMode::Undecided;
+
+	// JSON: the "details" key and the opening quote of its value were found
+	bool bFoundKey = false;
+	bool bInValue = false;
+
+	// Text: the DETAILS: marker was found, and nothing was added since it or the start but whitespace
+	bool bFoundDetailsMarker = false;
+	bool bAtStart = true;
+
+	// The details are complete: closing quote or SUMMARY: marker
+	bool bEnded = false;
+};
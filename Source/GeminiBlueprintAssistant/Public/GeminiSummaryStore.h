@@ -0,0 +1,125 @@
+// Public/GeminiSummaryStore.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class FSQLiteDatabase;
+class FSQLitePreparedStatement;
+class UBlueprint;
+class UEdGraph;
+class UEdGraphNode;
+struct FEdGraphEditAction;
+
+/**
+ * Summary kept in FGeminiSummaryStore.
+ */
+struct FGeminiStoredSummary
+{
+	int64 Id = 0;
+	FString BlueprintPath;
+	FString GraphName;
+	FString Summary;
+	FString Details;
+	int32 NumNodes = 0;
+	bool bWholeGraph = false;
+	FDateTime Time;
+
+	// The one-line summary if there is one, otherwise the details
+	const FString& GetText() const { return Summary.IsEmpty() ? Details : Summary; }
+};
+
+/**
+ * Summaries of node sets and whole graphs, kept in a local SQLite database (SummaryStorePath) so they outlive the
+ * panel and the editor session. A summary is keyed by Blueprint path, graph and the GUIDs of its nodes, and stores a
+ * hash of the preprocessed nodes: once they change, or one of them is deleted, the summary is dropped the next time
+ * it is looked up. Lookups never leave the editor; a summary found current stays so, without hashing its nodes
+ * again, until its graph or one of the graph's nodes changes or a Blueprint is compiled. Game thread only.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiSummaryStore
+{
+public:
+	static FGeminiSummaryStore& Get();
+
+	// Store in a database of its own, apart from the editor's, e.g. for tests; Shutdown before destroying it
+	explicit FGeminiSummaryStore(const FString& InFilePath);
+	~FGeminiSummaryStore();
+
+	bool IsOpen() const;
+
+	// Finalizes the prepared statements and closes the database while SQLite and the editor are still up; the store
+	// stays closed afterwards. Called by the module on shutdown.
+	void Shutdown();
+
+	// Hash of the nodes (the whole graph if Nodes is empty) as they are now. Taken when the prompt is built and
+	// handed to Put with the answer.
+	static FString MakeContentHash(UEdGraph* Graph, const TArray<UEdGraphNode*>& Nodes);
+
+	// Stores the summary of the nodes, or of the whole graph if Nodes is empty, replacing the one stored for the same
+	// nodes before. ContentHash is MakeContentHash of the nodes the prompt described; if they were edited since, the
+	// summary describes nodes that no longer exist and is not stored. Open graph editors rebuild their node widgets so
+	// tooltips pick it up.
+	void Put(UEdGraph* Graph, const TArray<UEdGraphNode*>& Nodes, const FString& ContentHash, const FString& Summary, const FString& Details);
+
+	// Summary of exactly these nodes (the whole graph if empty), if they are unchanged since it was written
+	bool Find(UEdGraph* Graph, const TArray<UEdGraphNode*>& Nodes, FGeminiStoredSummary& OutSummary);
+
+	// Current summary of the fewest nodes that include this one
+	bool FindForNode(UEdGraphNode* Node, FGeminiStoredSummary& OutSummary);
+
+	// Whether any summary includes the node, current or not; cheap enough to ask for every node of a graph
+	bool HasAnyForNode(const UEdGraphNode* Node);
+
+	// Current whole-graph summaries of the Blueprint's graphs, by graph name
+	TArray<FGeminiStoredSummary> GetGraphSummaries(UBlueprint* Blueprint);
+
+	// Whether a whole-graph summary of the Blueprint no longer matches its graph; drops the ones that do not
+	bool HasStaleGraphSummaries(UBlueprint* Blueprint);
+
+	const FString& GetFilePath() const { return FilePath; }
+
+private:
+	FGeminiSummaryStore();
+
+	// Creates the tables on first use
+	bool Open();
+
+	// Sorted node GUIDs, hashed; "*" for the whole graph, whose nodes come and go
+	static FString MakeNodeSetKey(const TArray<UEdGraphNode*>& Nodes, bool bWholeGraph);
+
+	// Hash of the nodes as FBlueprintNodePreprocessor sees them, in GUID order
+	static FString HashNodes(const TArray<UEdGraphNode*>& Nodes);
+
+	// Whether the nodes of a stored summary still exist and hash as they did; deletes the summary if not
+	bool Validate(const FGeminiStoredSummary& Summary, UEdGraph* Graph, const FString& ContentHash);
+
+	void Delete(int64 SummaryId);
+
+	// Summaries of one graph that Validate found current, valid until the graph changes
+	struct FGraphValidation
+	{
+		TWeakObjectPtr<UEdGraph> Graph;
+		FDelegateHandle GraphChangedHandle;
+		TSet<int64> CurrentSummaryIds;
+	};
+	FGraphValidation& FindOrAddValidation(UEdGraph* Graph);
+	void ForgetValidation(const UEdGraph* Graph);
+	void OnGraphChanged(const FEdGraphEditAction& Action);
+	void OnObjectModified(UObject* Object);
+	void OnBlueprintCompiled();
+
+	// Whole-graph summaries of the Blueprint that are still current; counts the ones dropped
+	TArray<FGeminiStoredSummary> ReadGraphSummaries(UBlueprint* Blueprint, int32& OutNumDropped);
+
+	TUniquePtr<FSQLiteDatabase> Database;
+
+	// Kept prepared for HasAnyForNode, which runs for every node widget a graph editor builds
+	TUniquePtr<FSQLitePreparedStatement> HasNodeStatement;
+	FString FilePath;
+
+	// Tooltips look summaries up every second while a node is hovered, far more often than graphs change
+	TMap<TObjectKey<UEdGraph>, FGraphValidation> Validations;
+	FDelegateHandle ObjectModifiedHandle;
+	FDelegateHandle BlueprintCompiledHandle;
+};
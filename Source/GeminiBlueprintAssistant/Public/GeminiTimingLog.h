@@ -0,0 +1,97 @@
+// Public/GeminiTimingLog.h
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Stages one panel request goes through, from reading the graph to writing the comment
+enum class EGeminiTimingStage : uint8
+{
+	CollectNodes,
+	PreprocessNodes,
+	BuildPrompt,
+	SerializeRequest,
+	// Time spent queued, rate limited or in retry backoff
+	Wait,
+	Network,
+	ParseResponse,
+	UpdateUI,
+	WriteComments,
+	Num
+};
+
+/**
+ * Where the time of one request went. Stages are summed over retries and streamed chunks.
+ */
+struct FGeminiRequestTiming
+{
+	uint64 RequestId = 0;
+	FDateTime Timestamp;
+	FString Model;
+	int32 PromptChars = 0;
+	int32 ResponseChars = 0;
+	int32 Attempts = 0;
+	bool bSuccess = false;
+	bool bCompleted = false;
+
+	// Seconds per EGeminiTimingStage
+	double StageSeconds[static_cast<int32>(EGeminiTimingStage::Num)] = {};
+
+	// From sending the request to the first streamed text, 0 if not streamed
+	double TimeToFirstText = 0.0;
+
+	// From submission to the completion callback
+	double TotalSeconds = 0.0;
+
+	double SubmitTime = 0.0;
+};
+
+/**
+ * Per-request timing records of the most recent requests, dumped with "Gemini.DumpTimings [Path]".
+ * Game thread only.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiTimingLog
+{
+public:
+	static FGeminiTimingLog& Get();
+
+	// Record of a request, created on first use
+	FGeminiRequestTiming& FindOrAdd(uint64 RequestId);
+	FGeminiRequestTiming* Find(uint64 RequestId);
+
+	void AddStageTime(uint64 RequestId, EGeminiTimingStage Stage, double Seconds);
+
+	// Writes all records as CSV, one line per request
+	bool DumpToCsv(const FString& FilePath) const;
+
+	int32 Num() const { return Records.Num(); }
+	void Reset() { Records.Reset(); }
+
+	static const TCHAR* GetStageName(EGeminiTimingStage Stage);
+
+private:
+	FGeminiTimingLog();
+
+	TArray<FGeminiRequestTiming> Records;
+	int32 MaxRecords;
+};
+
+/**
+ * Adds the time of a scope to a local total, for stages that run before the request exists.
+ */
+struct FGeminiStageTimer
+{
+	explicit FGeminiStageTimer(double& InTotalSeconds)
+		: TotalSeconds(InTotalSeconds)
+		, StartTime(FPlatformTime::Seconds())
+	{
+	}
+
+	~FGeminiStageTimer()
+	{
+		TotalSeconds += FPlatformTime::Seconds() - StartTime;
+	}
+
+private:
+	double& TotalSeconds;
+	double StartTime;
+};
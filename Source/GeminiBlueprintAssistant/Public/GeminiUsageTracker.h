@@ -0,0 +1,128 @@
+// Public/GeminiUsageTracker.h
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GeminiResponseParser.h"
+
+/**
+ * Summed token counts of a group of requests.
+ */
+struct FGeminiUsageTotals
+{
+	int32 Requests = 0;
+	int64 PromptTokens = 0;
+	int64 CachedTokens = 0;
+	int64 OutputTokens = 0;
+	int64 ThoughtTokens = 0;
+
+	void Add(const FGeminiTokenUsage& Usage);
+	void Add(const FGeminiUsageTotals& Other);
+
+	// Tokens budgets are counted in: everything sent and generated, cached prompt tokens included
+	int64 GetTotal() const { return PromptTokens + OutputTokens + ThoughtTokens; }
+};
+
+/**
+ * Usage of one source (Blueprint and graph) by one user on one day.
+ */
+struct FGeminiUsageRecord
+{
+	// Local date, YYYY-MM-DD
+	FString Day;
+	FString User;
+
+	// "<Blueprint path>:<graph>", the graph left empty for requests about all of its graphs; see MakeSource
+	FString Source;
+
+	FGeminiUsageTotals Totals;
+};
+
+// How requests are grouped by FGeminiUsageTracker::GetTop
+enum class EGeminiUsageGrouping : uint8
+{
+	Source,
+	Blueprint,
+	User,
+	Day
+};
+
+enum class EGeminiBudgetStatus : uint8
+{
+	WithinBudget,
+	// Past BudgetWarningFraction of a budget
+	Warning,
+	Exceeded
+};
+
+// What the panel does once a budget is used up
+enum class EGeminiBudgetAction : uint8
+{
+	// Keep going with the cheaper BudgetDowngradeProfile
+	Downgrade,
+	Block
+};
+
+/**
+ * Token usage reported by the server for every request, summed per day, user and source and persisted as JSON
+ * (UsageLogPath), plus the daily and monthly budgets checked against it. Game thread only.
+ */
+class GEMINIBLUEPRINTASSISTANT_API FGeminiUsageTracker
+{
+public:
+	static FGeminiUsageTracker& Get();
+
+	// Adds the usage of one answered request and saves the log
+	void Record(const FString& Source, const FGeminiTokenUsage& Usage);
+
+	// Totals of the last Days days (today included) grouped as requested, largest first
+	TArray<TPair<FString, FGeminiUsageTotals>> GetTop(EGeminiUsageGrouping Grouping, int32 Days, int32 MaxEntries) const;
+
+	// Checks the current user's daily and monthly budgets and the daily budget of the Blueprint the source belongs to.
+	// OutMessage names the budget that is closest to or past its limit. bOutFirstWarning is set the first time a
+	// warning is returned on a day, so callers can notify once instead of on every request.
+	EGeminiBudgetStatus CheckBudget(const FString& Source, FString& OutMessage, bool& bOutFirstWarning);
+
+	EGeminiBudgetAction GetBudgetAction() const { return BudgetAction; }
+	const FString& GetDowngradeProfile() const { return DowngradeProfile; }
+
+	// Readable overview: today's and this month's totals, budgets, and the most expensive graphs, Blueprints and users
+	FString FormatReport(int32 Days, int32 MaxEntries) const;
+
+	bool Save() const;
+	const FString& GetFilePath() const { return FilePath; }
+
+	// Source of a request about the graph, or about all graphs of the Blueprint if GraphName is empty
+	static FString MakeSource(const FString& BlueprintPath, const FString& GraphName);
+
+	// Blueprint part of a source
+	static FString GetBlueprintOfSource(const FString& Source);
+
+private:
+	FGeminiUsageTracker();
+
+	void Load();
+
+	// Drops records older than RetentionDays
+	void Prune();
+
+	static FString GetDayString(const FDateTime& Time);
+
+	TArray<FGeminiUsageRecord> Records;
+
+	// Index into Records by "Day|User|Source"
+	TMap<FString, int32> RecordIndex;
+
+	FString FilePath;
+	FString UserName;
+	int32 RetentionDays;
+
+	int64 DailyTokenBudget;
+	int64 MonthlyTokenBudget;
+	int64 BlueprintDailyTokenBudget;
+	float BudgetWarningFraction;
+	EGeminiBudgetAction BudgetAction;
+	FString DowngradeProfile;
+
+	// Day the last first-of-the-day warning went out
+	FString WarnedDay;
+};